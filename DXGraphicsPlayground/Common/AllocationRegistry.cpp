@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "AllocationRegistry.h"
+#include <cassert>
+
+AllocationRegistry::AllocationRegistry()
+	: _snapshot{}, _dumpInterval(0), _dumpStream(nullptr)
+{
+}
+
+AllocationRegistry& AllocationRegistry::getShared() {
+	static AllocationRegistry registry;
+	return registry;
+}
+
+const char* AllocationRegistry::getCategoryName(AllocationCategory category) {
+	switch (category) {
+	case AllocationCategory::Upload:
+		return "Upload";
+	case AllocationCategory::RenderTarget:
+		return "Render target";
+	case AllocationCategory::Texture:
+		return "Texture";
+	case AllocationCategory::Buffer:
+		return "Buffer";
+	default:
+		return "Unknown";
+	}
+}
+
+void AllocationRegistry::recordAllocation(AllocationCategory category, uint64_t size) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	CategoryStatistics& statistics = _snapshot.categories[static_cast<uint32_t>(category)];
+	statistics.liveBytes += size;
+	statistics.peakBytes = statistics.liveBytes > statistics.peakBytes ? statistics.liveBytes : statistics.peakBytes;
+	statistics.liveCount++;
+	statistics.totalAllocationCount++;
+	statistics.frameAllocationCount++;
+	statistics.frameAllocatedBytes += size;
+
+	_snapshot.liveBytes += size;
+	_snapshot.peakBytes = _snapshot.liveBytes > _snapshot.peakBytes ? _snapshot.liveBytes : _snapshot.peakBytes;
+}
+
+void AllocationRegistry::recordFree(AllocationCategory category, uint64_t size) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	CategoryStatistics& statistics = _snapshot.categories[static_cast<uint32_t>(category)];
+	assert(statistics.liveBytes >= size && statistics.liveCount > 0 && "Freeing more than allocated.");
+	statistics.liveBytes -= size;
+	statistics.liveCount--;
+	statistics.frameFreeCount++;
+	_snapshot.liveBytes -= size;
+}
+
+void AllocationRegistry::endFrame() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_dumpInterval > 0 && _dumpStream != nullptr && (_snapshot.frameIndex + 1) % _dumpInterval == 0)
+		_dump(_snapshot, *_dumpStream);
+
+	_snapshot.frameIndex++;
+	for (CategoryStatistics& statistics : _snapshot.categories) {
+		statistics.frameAllocationCount = 0;
+		statistics.frameFreeCount = 0;
+		statistics.frameAllocatedBytes = 0;
+	}
+}
+
+void AllocationRegistry::reset() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_snapshot = Snapshot{};
+}
+
+AllocationRegistry::Snapshot AllocationRegistry::getSnapshot() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _snapshot;
+}
+
+void AllocationRegistry::dump(std::ostream& stream) const {
+	_dump(getSnapshot(), stream);
+}
+
+void AllocationRegistry::setDumpInterval(uint64_t frameInterval, std::ostream* stream) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_dumpInterval = frameInterval;
+	_dumpStream = stream;
+}
+
+void AllocationRegistry::_dump(const Snapshot& snapshot, std::ostream& stream) {
+	stream << "Allocation Statistics (frame " << snapshot.frameIndex << ") : "
+		<< snapshot.liveBytes << " bytes live, " << snapshot.peakBytes << " bytes peak" << std::endl;
+	for (uint32_t i = 0; i < kCategoryCount; i++) {
+		const CategoryStatistics& statistics = snapshot.categories[i];
+		if (statistics.totalAllocationCount == 0)
+			continue;
+
+		stream << "- " << getCategoryName(static_cast<AllocationCategory>(i)) << " : "
+			<< statistics.liveCount << " allocations, "
+			<< statistics.liveBytes << " bytes live, " << statistics.peakBytes << " bytes peak, "
+			<< statistics.frameAllocationCount << " allocated / " << statistics.frameFreeCount << " freed this frame" << std::endl;
+	}
+}
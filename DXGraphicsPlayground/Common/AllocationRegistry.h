@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+
+// Category of tracked GPU memory
+enum class AllocationCategory {
+	Upload,			// CPU-writable upload heaps
+	RenderTarget,	// render target and depth stencil textures
+	Texture,
+	Buffer,			// GPU-only buffers
+	Count
+};
+
+// Central registry of GPU memory allocations, grouped by category.
+class AllocationRegistry
+{
+public:
+	static constexpr uint32_t kCategoryCount = static_cast<uint32_t>(AllocationCategory::Count);
+
+	struct CategoryStatistics {
+		uint64_t liveBytes;
+		uint64_t peakBytes;
+		uint64_t liveCount;
+		uint64_t totalAllocationCount;
+		// current frame
+		uint64_t frameAllocationCount;
+		uint64_t frameFreeCount;
+		uint64_t frameAllocatedBytes;
+	};
+
+	struct Snapshot {
+		uint64_t frameIndex;
+		uint64_t liveBytes;
+		uint64_t peakBytes;		// peak of total live bytes
+		CategoryStatistics categories[kCategoryCount];
+	};
+
+	AllocationRegistry();
+	~AllocationRegistry() {}
+
+	// Registry shared by renderers and resources
+	static AllocationRegistry& getShared();
+	static const char* getCategoryName(AllocationCategory category);
+
+	// Recording
+	void recordAllocation(AllocationCategory category, uint64_t size);
+	void recordFree(AllocationCategory category, uint64_t size);
+	// Resets per-frame counters and dumps statistics periodically
+	void endFrame();
+	void reset();
+
+	// Statistics
+	Snapshot getSnapshot() const;
+	void dump(std::ostream& stream) const;
+	// Dumps statistics to stream every frameInterval frames (0 disables)
+	void setDumpInterval(uint64_t frameInterval, std::ostream* stream);
+
+private:
+	static void _dump(const Snapshot& snapshot, std::ostream& stream);
+
+	mutable std::mutex _mutex;
+	Snapshot _snapshot;
+	uint64_t _dumpInterval;
+	std::ostream* _dumpStream;
+};
@@ -0,0 +1,749 @@
+#include "pch.h"
+#include "BlockCompressor.h"
+#include "ParallelFor.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+namespace {
+	// rough cost of one block, blocks rows are not split across threads unless each thread gets enough work
+	constexpr size_t kWorkPerBlock = 1024;
+	constexpr size_t kMinWorkPerThread = 1 << 16;
+	// refinement iterations of high quality
+	constexpr int kRefineIterations = 2;
+	// BC7 4-bit index weights (out of 64)
+	constexpr int kBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct PixelBlock {
+		uint8_t pixels[16][4];
+	};
+
+	class BitWriter {
+	public:
+		BitWriter(uint8_t* data, size_t size) : _data(data), _position(0) { memset(data, 0, size); }
+		void write(uint32_t value, uint32_t bitCount) {
+			for (uint32_t i = 0; i < bitCount; i++, _position++) {
+				if ((value >> i) & 1)
+					_data[_position >> 3] |= static_cast<uint8_t>(1 << (_position & 7));
+			}
+		}
+
+	private:
+		uint8_t* _data;
+		uint32_t _position;
+	};
+
+	class BitReader {
+	public:
+		BitReader(const uint8_t* data) : _data(data), _position(0) {}
+		uint32_t read(uint32_t bitCount) {
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < bitCount; i++, _position++)
+				value |= static_cast<uint32_t>((_data[_position >> 3] >> (_position & 7)) & 1) << i;
+			return value;
+		}
+
+	private:
+		const uint8_t* _data;
+		uint32_t _position;
+	};
+
+	float _clampByte(float value) {
+		return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+	}
+
+	void _loadBlock(const uint8_t* pixels, size_t rowPitch, uint32_t channelCount, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, PixelBlock& block) {
+		for (uint32_t y = 0; y < 4; y++) {
+			const uint32_t py = blockY * 4 + y < height ? blockY * 4 + y : height - 1;
+			for (uint32_t x = 0; x < 4; x++) {
+				const uint32_t px = blockX * 4 + x < width ? blockX * 4 + x : width - 1;
+				uint8_t* pixel = block.pixels[y * 4 + x];
+				if (channelCount == 4) {
+					memcpy(pixel, pixels + rowPitch * py + px * 4, 4);
+					continue;
+				}
+				const uint8_t defaultPixel[4] = { 0, 0, 0, 255 };
+				memcpy(pixel, defaultPixel, 4);
+				memcpy(pixel, pixels + rowPitch * py + px * channelCount, channelCount);
+			}
+		}
+	}
+
+	void _storeBlock(const PixelBlock& block, uint32_t blockX, uint32_t blockY, uint32_t width, uint32_t height, uint8_t* pixels, size_t rowPitch) {
+		for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; y++) {
+			for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; x++)
+				memcpy(pixels + rowPitch * (blockY * 4 + y) + (blockX * 4 + x) * 4, block.pixels[y * 4 + x], 4);
+		}
+	}
+
+	// Endpoints enclosing points, on principal axis except fast quality
+	void _fitEndpoints(const float (*points)[4], uint32_t count, uint32_t channels, BlockCompressionQuality quality, float endpoint0[4], float endpoint1[4]) {
+		float minimum[4], maximum[4], mean[4];
+		for (uint32_t c = 0; c < channels; c++) {
+			minimum[c] = 255.0f;
+			maximum[c] = 0.0f;
+			mean[c] = 0.0f;
+			for (uint32_t i = 0; i < count; i++) {
+				minimum[c] = points[i][c] < minimum[c] ? points[i][c] : minimum[c];
+				maximum[c] = points[i][c] > maximum[c] ? points[i][c] : maximum[c];
+				mean[c] += points[i][c];
+			}
+			mean[c] /= count;
+		}
+
+		if (quality == BlockCompressionQuality::Fast) {
+			// inset bounding box by 1/16 of range to reduce error of extreme points
+			for (uint32_t c = 0; c < channels; c++) {
+				const float inset = (maximum[c] - minimum[c]) / 16.0f;
+				endpoint0[c] = minimum[c] + inset;
+				endpoint1[c] = maximum[c] - inset;
+			}
+			return;
+		}
+
+		float covariance[4][4] = {};
+		for (uint32_t i = 0; i < count; i++) {
+			for (uint32_t a = 0; a < channels; a++) {
+				for (uint32_t b = 0; b < channels; b++)
+					covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+			}
+		}
+
+		// power iteration from bounding box diagonal
+		float axis[4] = {};
+		for (uint32_t c = 0; c < channels; c++)
+			axis[c] = maximum[c] - minimum[c];
+		for (int iteration = 0; iteration < 8; iteration++) {
+			float next[4] = {};
+			float largest = 0.0f;
+			for (uint32_t a = 0; a < channels; a++) {
+				for (uint32_t b = 0; b < channels; b++)
+					next[a] += covariance[a][b] * axis[b];
+				largest = fabsf(next[a]) > largest ? fabsf(next[a]) : largest;
+			}
+			if (largest == 0.0f)
+				break;
+			for (uint32_t c = 0; c < channels; c++)
+				axis[c] = next[c] / largest;
+		}
+
+		float lengthSquared = 0.0f;
+		for (uint32_t c = 0; c < channels; c++)
+			lengthSquared += axis[c] * axis[c];
+		if (lengthSquared == 0.0f) {
+			for (uint32_t c = 0; c < channels; c++)
+				endpoint0[c] = endpoint1[c] = mean[c];
+			return;
+		}
+
+		float minimumT = 0.0f, maximumT = 0.0f;
+		for (uint32_t i = 0; i < count; i++) {
+			float t = 0.0f;
+			for (uint32_t c = 0; c < channels; c++)
+				t += (points[i][c] - mean[c]) * axis[c];
+			t /= lengthSquared;
+			minimumT = t < minimumT ? t : minimumT;
+			maximumT = t > maximumT ? t : maximumT;
+		}
+		for (uint32_t c = 0; c < channels; c++) {
+			endpoint0[c] = _clampByte(mean[c] + axis[c] * minimumT);
+			endpoint1[c] = _clampByte(mean[c] + axis[c] * maximumT);
+		}
+	}
+
+	// Least squares endpoints for interpolation weights of points (0 is endpoint0, 1 is endpoint1)
+	bool _refineEndpoints(const float (*points)[4], const float* weights, uint32_t count, uint32_t channels, float endpoint0[4], float endpoint1[4]) {
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[4] = {}, bx[4] = {};
+		for (uint32_t i = 0; i < count; i++) {
+			const float a = 1.0f - weights[i], b = weights[i];
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (uint32_t c = 0; c < channels; c++) {
+				ax[c] += a * points[i][c];
+				bx[c] += b * points[i][c];
+			}
+		}
+		const float determinant = aa * bb - ab * ab;
+		if (fabsf(determinant) < 1e-6f)
+			return false;
+		for (uint32_t c = 0; c < channels; c++) {
+			endpoint0[c] = _clampByte((bb * ax[c] - ab * bx[c]) / determinant);
+			endpoint1[c] = _clampByte((aa * bx[c] - ab * ax[c]) / determinant);
+		}
+		return true;
+	}
+
+	// BC1 color block
+
+	uint16_t _packColor565(const float color[4]) {
+		const uint32_t r = static_cast<uint32_t>(_clampByte(color[0]) * 31.0f / 255.0f + 0.5f);
+		const uint32_t g = static_cast<uint32_t>(_clampByte(color[1]) * 63.0f / 255.0f + 0.5f);
+		const uint32_t b = static_cast<uint32_t>(_clampByte(color[2]) * 31.0f / 255.0f + 0.5f);
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void _unpackColor565(uint16_t color, int output[4]) {
+		const int r = color >> 11, g = (color >> 5) & 63, b = color & 31;
+		output[0] = (r << 3) | (r >> 2);
+		output[1] = (g << 2) | (g >> 4);
+		output[2] = (b << 3) | (b >> 2);
+		output[3] = 255;
+	}
+
+	// BC2/BC3 color blocks are always in four color mode
+	bool _isFourColorMode(uint16_t color0, uint16_t color1, bool forceFourColor) {
+		return forceFourColor || color0 > color1;
+	}
+
+	void _colorPalette(uint16_t color0, uint16_t color1, bool forceFourColor, int palette[4][4]) {
+		_unpackColor565(color0, palette[0]);
+		_unpackColor565(color1, palette[1]);
+		if (_isFourColorMode(color0, color1, forceFourColor)) {
+			for (int c = 0; c < 3; c++) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			palette[2][3] = palette[3][3] = 255;
+		}
+		else {
+			for (int c = 0; c < 3; c++) {
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+			palette[2][3] = 255;
+			palette[3][3] = 0;
+		}
+	}
+
+	struct ColorCandidate {
+		uint16_t color0;
+		uint16_t color1;
+		uint8_t indices[16];
+		uint32_t error;
+	};
+
+	// Quantizes endpoints and selects nearest palette entries
+	void _evaluateColorEndpoints(const PixelBlock& block, const bool* transparent, const float endpoint0[4], const float endpoint1[4],
+		bool threeColor, bool forceFourColor, ColorCandidate& candidate) {
+		uint16_t color0 = _packColor565(endpoint0), color1 = _packColor565(endpoint1);
+		// endpoint order selects mode
+		if ((threeColor && color0 > color1) || (threeColor == false && forceFourColor == false && color0 < color1)) {
+			const uint16_t color = color0;
+			color0 = color1;
+			color1 = color;
+		}
+
+		int palette[4][4];
+		_colorPalette(color0, color1, forceFourColor, palette);
+		const int paletteCount = _isFourColorMode(color0, color1, forceFourColor) ? 4 : 3;
+
+		candidate.color0 = color0;
+		candidate.color1 = color1;
+		candidate.error = 0;
+		for (int i = 0; i < 16; i++) {
+			if (transparent != nullptr && transparent[i]) {
+				candidate.indices[i] = 3;
+				continue;
+			}
+
+			uint32_t bestError = std::numeric_limits<uint32_t>::max();
+			for (int p = 0; p < paletteCount; p++) {
+				uint32_t error = 0;
+				for (int c = 0; c < 3; c++) {
+					const int difference = block.pixels[i][c] - palette[p][c];
+					error += static_cast<uint32_t>(difference * difference);
+				}
+				if (error < bestError) {
+					bestError = error;
+					candidate.indices[i] = static_cast<uint8_t>(p);
+				}
+			}
+			candidate.error += bestError;
+		}
+	}
+
+	void _refineColorCandidate(const PixelBlock& block, const bool* transparent, const float (*points)[4], uint32_t pointCount,
+		bool threeColor, bool forceFourColor, ColorCandidate& best) {
+		for (int iteration = 0; iteration < kRefineIterations; iteration++) {
+			const bool fourColor = _isFourColorMode(best.color0, best.color1, forceFourColor);
+			const float fourColorWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+			const float threeColorWeights[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+			float weights[16];
+			for (uint32_t i = 0, point = 0; i < 16; i++) {
+				if (transparent != nullptr && transparent[i])
+					continue;
+				weights[point++] = fourColor ? fourColorWeights[best.indices[i]] : threeColorWeights[best.indices[i]];
+			}
+
+			float endpoint0[4], endpoint1[4];
+			if (_refineEndpoints(points, weights, pointCount, 3, endpoint0, endpoint1) == false)
+				return;
+			ColorCandidate candidate;
+			_evaluateColorEndpoints(block, transparent, endpoint0, endpoint1, threeColor, forceFourColor, candidate);
+			if (candidate.error >= best.error)
+				return;
+			best = candidate;
+		}
+	}
+
+	void _writeColorBlock(const ColorCandidate& candidate, uint8_t* output) {
+		uint32_t indices = 0;
+		for (int i = 0; i < 16; i++)
+			indices |= static_cast<uint32_t>(candidate.indices[i]) << (i * 2);
+		memcpy(output, &candidate.color0, 2);
+		memcpy(output + 2, &candidate.color1, 2);
+		memcpy(output + 4, &indices, 4);
+	}
+
+	void _encodeColorBlock(const PixelBlock& block, BlockCompressionQuality quality, bool allowTransparency, uint8_t* output) {
+		bool transparent[16];
+		float points[16][4];
+		uint32_t pointCount = 0;
+		for (int i = 0; i < 16; i++) {
+			transparent[i] = allowTransparency && block.pixels[i][3] < 128;
+			if (transparent[i])
+				continue;
+			for (int c = 0; c < 4; c++)
+				points[pointCount][c] = block.pixels[i][c];
+			pointCount++;
+		}
+		const bool hasTransparency = pointCount < 16;
+		const bool forceFourColor = allowTransparency == false;
+
+		ColorCandidate best;
+		if (pointCount == 0) {
+			// fully transparent
+			best.color0 = best.color1 = 0;
+			memset(best.indices, 3, sizeof(best.indices));
+			_writeColorBlock(best, output);
+			return;
+		}
+
+		float endpoint0[4], endpoint1[4];
+		_fitEndpoints(points, pointCount, 3, quality, endpoint0, endpoint1);
+		_evaluateColorEndpoints(block, hasTransparency ? transparent : nullptr, endpoint0, endpoint1, hasTransparency, forceFourColor, best);
+		if (quality == BlockCompressionQuality::High)
+			_refineColorCandidate(block, hasTransparency ? transparent : nullptr, points, pointCount, hasTransparency, forceFourColor, best);
+
+		// three color mode (without transparency) is sometimes closer for opaque blocks
+		if (hasTransparency == false && forceFourColor == false && quality != BlockCompressionQuality::Fast) {
+			ColorCandidate candidate;
+			_evaluateColorEndpoints(block, nullptr, endpoint0, endpoint1, true, false, candidate);
+			if (quality == BlockCompressionQuality::High)
+				_refineColorCandidate(block, nullptr, points, pointCount, true, false, candidate);
+			if (candidate.error < best.error)
+				best = candidate;
+		}
+		_writeColorBlock(best, output);
+	}
+
+	void _decodeColorBlock(const uint8_t* input, bool forceFourColor, PixelBlock& block) {
+		uint16_t color0, color1;
+		uint32_t indices;
+		memcpy(&color0, input, 2);
+		memcpy(&color1, input + 2, 2);
+		memcpy(&indices, input + 4, 4);
+
+		int palette[4][4];
+		_colorPalette(color0, color1, forceFourColor, palette);
+		for (int i = 0; i < 16; i++) {
+			const int index = (indices >> (i * 2)) & 3;
+			for (int c = 0; c < 4; c++)
+				block.pixels[i][c] = static_cast<uint8_t>(palette[index][c]);
+		}
+	}
+
+	// BC4 single channel block (also alpha of BC3 and channels of BC5)
+
+	void _alphaPalette(uint8_t value0, uint8_t value1, int palette[8]) {
+		palette[0] = value0;
+		palette[1] = value1;
+		if (value0 > value1) {
+			for (int i = 1; i <= 6; i++)
+				palette[i + 1] = ((7 - i) * value0 + i * value1 + 3) / 7;
+		}
+		else {
+			for (int i = 1; i <= 4; i++)
+				palette[i + 1] = ((5 - i) * value0 + i * value1 + 2) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	uint32_t _evaluateAlphaEndpoints(const uint8_t values[16], uint8_t value0, uint8_t value1, uint8_t indices[16]) {
+		int palette[8];
+		_alphaPalette(value0, value1, palette);
+		uint32_t totalError = 0;
+		for (int i = 0; i < 16; i++) {
+			uint32_t bestError = std::numeric_limits<uint32_t>::max();
+			for (int p = 0; p < 8; p++) {
+				const int difference = values[i] - palette[p];
+				const uint32_t error = static_cast<uint32_t>(difference * difference);
+				if (error < bestError) {
+					bestError = error;
+					indices[i] = static_cast<uint8_t>(p);
+				}
+			}
+			totalError += bestError;
+		}
+		return totalError;
+	}
+
+	void _encodeAlphaBlock(const uint8_t values[16], BlockCompressionQuality quality, uint8_t* output) {
+		uint8_t minimum = 255, maximum = 0;
+		uint8_t innerMinimum = 255, innerMaximum = 0;	// excluding 0 and 255, which six value mode has explicitly
+		for (int i = 0; i < 16; i++) {
+			minimum = values[i] < minimum ? values[i] : minimum;
+			maximum = values[i] > maximum ? values[i] : maximum;
+			if (values[i] != 0 && values[i] != 255) {
+				innerMinimum = values[i] < innerMinimum ? values[i] : innerMinimum;
+				innerMaximum = values[i] > innerMaximum ? values[i] : innerMaximum;
+			}
+		}
+
+		// eight value mode
+		uint8_t bestValue0 = maximum, bestValue1 = minimum;
+		uint8_t bestIndices[16], indices[16];
+		uint32_t bestError = _evaluateAlphaEndpoints(values, bestValue0, bestValue1, bestIndices);
+
+		auto tryEndpoints = [&](uint8_t value0, uint8_t value1) {
+			const uint32_t error = _evaluateAlphaEndpoints(values, value0, value1, indices);
+			if (error < bestError) {
+				bestError = error;
+				bestValue0 = value0;
+				bestValue1 = value1;
+				memcpy(bestIndices, indices, sizeof(indices));
+			}
+		};
+
+		// six value mode
+		if (quality != BlockCompressionQuality::Fast && bestError > 0 && innerMinimum <= innerMaximum)
+			tryEndpoints(innerMinimum, innerMaximum);
+
+		// shrink eight value range
+		if (quality == BlockCompressionQuality::High && bestError > 0) {
+			for (int shrink0 = 0; shrink0 < 4; shrink0++) {
+				for (int shrink1 = 0; shrink1 < 4; shrink1++) {
+					const int value0 = maximum - shrink0, value1 = minimum + shrink1;
+					if (value0 > value1)
+						tryEndpoints(static_cast<uint8_t>(value0), static_cast<uint8_t>(value1));
+				}
+			}
+		}
+
+		uint64_t packedIndices = 0;
+		for (int i = 0; i < 16; i++)
+			packedIndices |= static_cast<uint64_t>(bestIndices[i]) << (i * 3);
+		output[0] = bestValue0;
+		output[1] = bestValue1;
+		for (int i = 0; i < 6; i++)
+			output[2 + i] = static_cast<uint8_t>(packedIndices >> (i * 8));
+	}
+
+	void _decodeAlphaBlock(const uint8_t* input, PixelBlock& block, int channel) {
+		int palette[8];
+		_alphaPalette(input[0], input[1], palette);
+		uint64_t packedIndices = 0;
+		for (int i = 0; i < 6; i++)
+			packedIndices |= static_cast<uint64_t>(input[2 + i]) << (i * 8);
+		for (int i = 0; i < 16; i++)
+			block.pixels[i][channel] = static_cast<uint8_t>(palette[(packedIndices >> (i * 3)) & 7]);
+	}
+
+	// BC7 mode 6 : one subset, RGBA 7-bit endpoints with unique p-bits, 4-bit indices
+
+	struct BC7Candidate {
+		uint8_t endpoints[2][4];	// 7-bit
+		uint8_t pBits[2];
+		uint8_t indices[16];
+		uint32_t error;
+	};
+
+	void _evaluateBC7Endpoints(const PixelBlock& block, const float endpoint0[4], const float endpoint1[4], int pBit0, int pBit1, BC7Candidate& candidate) {
+		int values[2][4];
+		const float* endpoints[2] = { endpoint0, endpoint1 };
+		const int pBits[2] = { pBit0, pBit1 };
+		for (int e = 0; e < 2; e++) {
+			for (int c = 0; c < 4; c++) {
+				int quantized = static_cast<int>((endpoints[e][c] - pBits[e]) / 2.0f + 0.5f);
+				quantized = quantized < 0 ? 0 : (quantized > 127 ? 127 : quantized);
+				candidate.endpoints[e][c] = static_cast<uint8_t>(quantized);
+				values[e][c] = (quantized << 1) | pBits[e];
+			}
+			candidate.pBits[e] = static_cast<uint8_t>(pBits[e]);
+		}
+
+		int palette[16][4];
+		for (int p = 0; p < 16; p++) {
+			for (int c = 0; c < 4; c++)
+				palette[p][c] = ((64 - kBC7Weights4[p]) * values[0][c] + kBC7Weights4[p] * values[1][c] + 32) >> 6;
+		}
+
+		candidate.error = 0;
+		for (int i = 0; i < 16; i++) {
+			uint32_t bestError = std::numeric_limits<uint32_t>::max();
+			for (int p = 0; p < 16; p++) {
+				uint32_t error = 0;
+				for (int c = 0; c < 4; c++) {
+					const int difference = block.pixels[i][c] - palette[p][c];
+					error += static_cast<uint32_t>(difference * difference);
+				}
+				if (error < bestError) {
+					bestError = error;
+					candidate.indices[i] = static_cast<uint8_t>(p);
+				}
+			}
+			candidate.error += bestError;
+		}
+	}
+
+	void _tryBC7PBits(const PixelBlock& block, const float endpoint0[4], const float endpoint1[4], BlockCompressionQuality quality, BC7Candidate& best) {
+		// fast quality only tries equal p-bits
+		for (int pBits = 0; pBits < 4; pBits++) {
+			const int pBit0 = pBits & 1, pBit1 = pBits >> 1;
+			if (quality == BlockCompressionQuality::Fast && pBit0 != pBit1)
+				continue;
+			BC7Candidate candidate;
+			_evaluateBC7Endpoints(block, endpoint0, endpoint1, pBit0, pBit1, candidate);
+			if (candidate.error < best.error)
+				best = candidate;
+		}
+	}
+
+	void _encodeBC7Block(const PixelBlock& block, BlockCompressionQuality quality, uint8_t* output) {
+		float points[16][4];
+		for (int i = 0; i < 16; i++) {
+			for (int c = 0; c < 4; c++)
+				points[i][c] = block.pixels[i][c];
+		}
+
+		float endpoint0[4], endpoint1[4];
+		_fitEndpoints(points, 16, 4, quality, endpoint0, endpoint1);
+		BC7Candidate best;
+		best.error = std::numeric_limits<uint32_t>::max();
+		_tryBC7PBits(block, endpoint0, endpoint1, quality, best);
+
+		if (quality == BlockCompressionQuality::High) {
+			for (int iteration = 0; iteration < kRefineIterations && best.error > 0; iteration++) {
+				float weights[16];
+				for (int i = 0; i < 16; i++)
+					weights[i] = kBC7Weights4[best.indices[i]] / 64.0f;
+				if (_refineEndpoints(points, weights, 16, 4, endpoint0, endpoint1) == false)
+					break;
+				const uint32_t previousError = best.error;
+				_tryBC7PBits(block, endpoint0, endpoint1, quality, best);
+				if (best.error >= previousError)
+					break;
+			}
+		}
+
+		// most significant bit of first index is implicitly zero
+		if (best.indices[0] >= 8) {
+			for (int c = 0; c < 4; c++) {
+				const uint8_t endpoint = best.endpoints[0][c];
+				best.endpoints[0][c] = best.endpoints[1][c];
+				best.endpoints[1][c] = endpoint;
+			}
+			const uint8_t pBit = best.pBits[0];
+			best.pBits[0] = best.pBits[1];
+			best.pBits[1] = pBit;
+			for (int i = 0; i < 16; i++)
+				best.indices[i] = static_cast<uint8_t>(15 - best.indices[i]);
+		}
+
+		BitWriter writer(output, 16);
+		writer.write(1 << 6, 7);
+		for (int c = 0; c < 4; c++) {
+			writer.write(best.endpoints[0][c], 7);
+			writer.write(best.endpoints[1][c], 7);
+		}
+		writer.write(best.pBits[0], 1);
+		writer.write(best.pBits[1], 1);
+		for (int i = 0; i < 16; i++)
+			writer.write(best.indices[i], i == 0 ? 3 : 4);
+	}
+
+	void _decodeBC7Block(const uint8_t* input, PixelBlock& block) {
+		// only mode 6 is supported
+		if ((input[0] & 0x7f) != (1 << 6)) {
+			memset(block.pixels, 0, sizeof(block.pixels));
+			return;
+		}
+
+		BitReader reader(input);
+		reader.read(7);
+		int endpoints[2][4];
+		for (int c = 0; c < 4; c++) {
+			endpoints[0][c] = static_cast<int>(reader.read(7));
+			endpoints[1][c] = static_cast<int>(reader.read(7));
+		}
+		const int pBits[2] = { static_cast<int>(reader.read(1)), static_cast<int>(reader.read(1)) };
+		for (int e = 0; e < 2; e++) {
+			for (int c = 0; c < 4; c++)
+				endpoints[e][c] = (endpoints[e][c] << 1) | pBits[e];
+		}
+		for (int i = 0; i < 16; i++) {
+			const int weight = kBC7Weights4[reader.read(i == 0 ? 3 : 4)];
+			for (int c = 0; c < 4; c++)
+				block.pixels[i][c] = static_cast<uint8_t>(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+		}
+	}
+
+	void _encodeBlock(const PixelBlock& block, BlockFormat format, BlockCompressionQuality quality, uint8_t* output) {
+		uint8_t values[16];
+		switch (format) {
+		case BlockFormat::BC1:
+			_encodeColorBlock(block, quality, true, output);
+			break;
+		case BlockFormat::BC3:
+			for (int i = 0; i < 16; i++)
+				values[i] = block.pixels[i][3];
+			_encodeAlphaBlock(values, quality, output);
+			_encodeColorBlock(block, quality, false, output + 8);
+			break;
+		case BlockFormat::BC4:
+		case BlockFormat::BC5:
+			for (int channel = 0; channel < (format == BlockFormat::BC4 ? 1 : 2); channel++) {
+				for (int i = 0; i < 16; i++)
+					values[i] = block.pixels[i][channel];
+				_encodeAlphaBlock(values, quality, output + channel * 8);
+			}
+			break;
+		case BlockFormat::BC7:
+			_encodeBC7Block(block, quality, output);
+			break;
+		}
+	}
+
+	void _decodeBlock(const uint8_t* input, BlockFormat format, PixelBlock& block) {
+		switch (format) {
+		case BlockFormat::BC1:
+			_decodeColorBlock(input, false, block);
+			break;
+		case BlockFormat::BC3:
+			_decodeColorBlock(input + 8, true, block);
+			_decodeAlphaBlock(input, block, 3);
+			break;
+		case BlockFormat::BC4:
+		case BlockFormat::BC5:
+			memset(block.pixels, 0, sizeof(block.pixels));
+			for (int i = 0; i < 16; i++)
+				block.pixels[i][3] = 255;
+			_decodeAlphaBlock(input, block, 0);
+			if (format == BlockFormat::BC5)
+				_decodeAlphaBlock(input + 8, block, 1);
+			break;
+		case BlockFormat::BC7:
+			_decodeBC7Block(input, block);
+			break;
+		}
+	}
+
+	uint32_t _channelCount(BlockFormat format) {
+		switch (format) {
+		case BlockFormat::BC1:
+			return 3;
+		case BlockFormat::BC4:
+			return 1;
+		case BlockFormat::BC5:
+			return 2;
+		default:
+			return 4;
+		}
+	}
+}
+
+BlockCompressor::BlockCompressor(uint32_t threadCount)
+	: _threadCount(threadCount)
+{
+	if (_threadCount == 0)
+		_threadCount = std::thread::hardware_concurrency();
+	if (_threadCount == 0)
+		_threadCount = 1;
+}
+
+const char* BlockCompressor::getFormatName(BlockFormat format) {
+	switch (format) {
+	case BlockFormat::BC1:
+		return "bc1";
+	case BlockFormat::BC3:
+		return "bc3";
+	case BlockFormat::BC4:
+		return "bc4";
+	case BlockFormat::BC5:
+		return "bc5";
+	default:
+		return "bc7";
+	}
+}
+
+const char* BlockCompressor::getQualityName(BlockCompressionQuality quality) {
+	switch (quality) {
+	case BlockCompressionQuality::Fast:
+		return "fast";
+	case BlockCompressionQuality::High:
+		return "high";
+	default:
+		return "normal";
+	}
+}
+
+size_t BlockCompressor::getBlockSize(BlockFormat format) {
+	return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+}
+
+void BlockCompressor::compress(const uint8_t* pixels, uint32_t width, uint32_t height, size_t rowPitch, BlockFormat format, BlockCompressionQuality quality,
+	uint8_t* blocks, size_t blockRowPitch, uint32_t channelCount) const {
+	const uint32_t blockCountX = getBlockCount(width), blockCountY = getBlockCount(height);
+	const size_t blockSize = getBlockSize(format);
+	ParallelFor::rows(_threadCount, blockCountY, blockCountX * kWorkPerBlock, kMinWorkPerThread, [&](uint32_t firstRow, uint32_t lastRow) {
+		PixelBlock block;
+		for (uint32_t blockY = firstRow; blockY < lastRow; blockY++) {
+			for (uint32_t blockX = 0; blockX < blockCountX; blockX++) {
+				_loadBlock(pixels, rowPitch, channelCount, width, height, blockX, blockY, block);
+				_encodeBlock(block, format, quality, blocks + blockRowPitch * blockY + blockSize * blockX);
+			}
+		}
+	});
+}
+
+void BlockCompressor::decompress(const uint8_t* blocks, size_t blockRowPitch, uint32_t width, uint32_t height, BlockFormat format,
+	uint8_t* pixels, size_t rowPitch) {
+	const uint32_t blockCountX = getBlockCount(width), blockCountY = getBlockCount(height);
+	const size_t blockSize = getBlockSize(format);
+	PixelBlock block;
+	for (uint32_t blockY = 0; blockY < blockCountY; blockY++) {
+		for (uint32_t blockX = 0; blockX < blockCountX; blockX++) {
+			_decodeBlock(blocks + blockRowPitch * blockY + blockSize * blockX, format, block);
+			_storeBlock(block, blockX, blockY, width, height, pixels, rowPitch);
+		}
+	}
+}
+
+double BlockCompressor::computePSNR(const uint8_t* original, size_t originalRowPitch, const uint8_t* decoded, size_t decodedRowPitch,
+	uint32_t width, uint32_t height, BlockFormat format) {
+	const uint32_t channels = _channelCount(format);
+	double squaredError = 0.0;
+	size_t sampleCount = 0;
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t* a = original + originalRowPitch * y;
+		const uint8_t* b = decoded + decodedRowPitch * y;
+		for (uint32_t x = 0; x < width; x++) {
+			// color of BC1 punch-through pixels is undefined
+			if (format == BlockFormat::BC1 && a[x * 4 + 3] < 128)
+				continue;
+			sampleCount += channels;
+			for (uint32_t c = 0; c < channels; c++) {
+				const double difference = static_cast<double>(a[x * 4 + c]) - b[x * 4 + c];
+				squaredError += difference * difference;
+			}
+		}
+	}
+	if (squaredError == 0.0)
+		return std::numeric_limits<double>::infinity();
+	const double meanSquaredError = squaredError / sampleCount;
+	return 10.0 * log10(255.0 * 255.0 / meanSquaredError);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Block-compressed formats (4x4 pixels per block)
+enum class BlockFormat {
+	BC1,		// RGB + 1-bit alpha, 8 bytes per block
+	BC3,		// RGBA (BC1 color + BC4 alpha), 16 bytes per block
+	BC4,		// R, 8 bytes per block (heightmaps, masks)
+	BC5,		// RG, 16 bytes per block (tangent space normals)
+	BC7			// RGBA, 16 bytes per block (mode 6 only)
+};
+
+enum class BlockCompressionQuality {
+	Fast,		// bounding box endpoints
+	Normal,		// principal axis endpoints, alternative modes are tried
+	High		// principal axis endpoints refined by least squares
+};
+
+// Encodes 8-bit images into BC1/BC3/BC4/BC5/BC7 blocks on CPU.
+// BC4 encodes red channel, BC5 encodes red and green channels of source.
+// Block rows are split across threads.
+class BlockCompressor
+{
+public:
+	// threadCount 0 uses hardware concurrency
+	BlockCompressor(uint32_t threadCount = 0);
+	~BlockCompressor() {}
+
+	// Properties
+	uint32_t getThreadCount() const { return _threadCount; }
+
+	static const char* getFormatName(BlockFormat format);
+	static const char* getQualityName(BlockCompressionQuality quality);
+	static size_t getBlockSize(BlockFormat format);
+	static uint32_t getBlockCount(uint32_t size) { return (size + 3) / 4; }
+	// Bytes per row of blocks (tightly packed)
+	static size_t getRowPitch(BlockFormat format, uint32_t width) { return getBlockCount(width) * getBlockSize(format); }
+
+	// Source has channelCount 8-bit channels per pixel (missing channels are 0, alpha is 255).
+	// Partial blocks on right and bottom edge are filled by clamping.
+	void compress(const uint8_t* pixels, uint32_t width, uint32_t height, size_t rowPitch, BlockFormat format, BlockCompressionQuality quality,
+		uint8_t* blocks, size_t blockRowPitch, uint32_t channelCount = 4) const;
+
+	// Decodes blocks to RGBA8 (missing channels are 0, alpha is 255)
+	static void decompress(const uint8_t* blocks, size_t blockRowPitch, uint32_t width, uint32_t height, BlockFormat format,
+		uint8_t* pixels, size_t rowPitch);
+
+	// PSNR (dB) over channels stored in format, infinity if images are identical.
+	// Transparent pixels of BC1 are excluded.
+	static double computePSNR(const uint8_t* original, size_t originalRowPitch, const uint8_t* decoded, size_t decodedRowPitch,
+		uint32_t width, uint32_t height, BlockFormat format);
+
+private:
+	uint32_t _threadCount;
+};
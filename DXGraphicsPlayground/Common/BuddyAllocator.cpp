@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "BuddyAllocator.h"
+#include <cassert>
+
+BuddyAllocator::BuddyAllocator(uint64_t capacity, uint64_t minBlockSize)
+	: _minBlockSize(minBlockSize), _maxOrder(0), _allocatedSize(0), _requestedSize(0)
+{
+	assert(minBlockSize > 0 && (minBlockSize & (minBlockSize - 1)) == 0 && "Minimum block size must be power of two.");
+
+	while (_blockSize(_maxOrder) < capacity)
+		_maxOrder++;
+	_capacity = _blockSize(_maxOrder);
+
+	_freeBlocks.resize(_maxOrder + 1);
+	_freeBlocks[_maxOrder].insert(0);
+}
+
+uint32_t BuddyAllocator::_orderForSize(uint64_t size) const {
+	uint32_t order = 0;
+	while (_blockSize(order) < size)
+		order++;
+	return order;
+}
+
+uint64_t BuddyAllocator::allocate(uint64_t size, uint64_t alignment) {
+	if (size == 0)
+		return kInvalidOffset;
+
+	// blocks are aligned to their own size, so large alignment is satisfied by larger block.
+	uint32_t order = _orderForSize(size > alignment ? size : alignment);
+	if (order > _maxOrder)
+		return kInvalidOffset;
+
+	// find smallest free block which fits
+	uint32_t freeOrder = order;
+	while (freeOrder <= _maxOrder && _freeBlocks[freeOrder].empty())
+		freeOrder++;
+	if (freeOrder > _maxOrder)
+		return kInvalidOffset;
+
+	uint64_t offset = *_freeBlocks[freeOrder].begin();
+	_freeBlocks[freeOrder].erase(_freeBlocks[freeOrder].begin());
+
+	// split until block size matches
+	while (freeOrder > order) {
+		freeOrder--;
+		_freeBlocks[freeOrder].insert(offset + _blockSize(freeOrder));
+	}
+
+	_allocations[offset] = { order, size };
+	_allocatedSize += _blockSize(order);
+	_requestedSize += size;
+	return offset;
+}
+
+void BuddyAllocator::free(uint64_t offset) {
+	auto it = _allocations.find(offset);
+	assert(it != _allocations.end() && "Offset is not allocated.");
+	if (it == _allocations.end())
+		return;
+
+	uint32_t order = it->second.order;
+	_allocatedSize -= _blockSize(order);
+	_requestedSize -= it->second.requestedSize;
+	_allocations.erase(it);
+
+	// merge with free buddies
+	while (order < _maxOrder) {
+		uint64_t buddyOffset = offset ^ _blockSize(order);
+		auto buddy = _freeBlocks[order].find(buddyOffset);
+		if (buddy == _freeBlocks[order].end())
+			break;
+
+		_freeBlocks[order].erase(buddy);
+		offset = offset < buddyOffset ? offset : buddyOffset;
+		order++;
+	}
+	_freeBlocks[order].insert(offset);
+}
+
+BuddyAllocator::Statistics BuddyAllocator::getStatistics() const {
+	Statistics statistics{};
+	statistics.capacity = _capacity;
+	statistics.allocatedSize = _allocatedSize;
+	statistics.requestedSize = _requestedSize;
+	statistics.allocationCount = _allocations.size();
+	for (uint32_t order = 0; order <= _maxOrder; order++) {
+		statistics.freeBlockCount += _freeBlocks[order].size();
+		if (_freeBlocks[order].empty() == false)
+			statistics.largestFreeBlockSize = _blockSize(order);
+	}
+	return statistics;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Binary buddy allocator for sub-allocating large memory blocks.
+class BuddyAllocator
+{
+public:
+	static constexpr uint64_t kInvalidOffset = ~0ull;
+
+	struct Statistics {
+		uint64_t capacity;
+		uint64_t allocatedSize;		// sum of allocated blocks
+		uint64_t requestedSize;		// sum of requested sizes (without internal fragmentation)
+		uint64_t allocationCount;
+		uint64_t freeBlockCount;
+		uint64_t largestFreeBlockSize;
+	};
+
+	// capacity is rounded up to power of two multiple of minimum block size.
+	BuddyAllocator(uint64_t capacity, uint64_t minBlockSize);
+	~BuddyAllocator() {}
+
+	// Properties
+	uint64_t getCapacity() const { return _capacity; }
+	uint64_t getMinBlockSize() const { return _minBlockSize; }
+	uint64_t getAllocatedSize() const { return _allocatedSize; }
+	bool isEmpty() const { return _allocations.empty(); }
+
+	// Allocation (returns kInvalidOffset if there's no space left)
+	uint64_t allocate(uint64_t size, uint64_t alignment = 0);
+	void free(uint64_t offset);
+
+	// Statistics
+	Statistics getStatistics() const;
+
+private:
+	uint32_t _orderForSize(uint64_t size) const;
+	uint64_t _blockSize(uint32_t order) const { return _minBlockSize << order; }
+
+	struct Allocation {
+		uint32_t order;
+		uint64_t requestedSize;
+	};
+
+	uint64_t _capacity;
+	uint64_t _minBlockSize;
+	uint32_t _maxOrder;
+	uint64_t _allocatedSize;
+	uint64_t _requestedSize;
+	std::vector<std::set<uint64_t>> _freeBlocks;	// free block offsets per order
+	std::unordered_map<uint64_t, Allocation> _allocations;
+};
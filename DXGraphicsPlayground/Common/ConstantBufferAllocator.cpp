@@ -0,0 +1,70 @@
+#include "pch.h"
+#include "ConstantBufferAllocator.h"
+#include "GPUBuffer.h"
+#include <cassert>
+#include <iostream>
+
+ConstantBufferAllocator::ConstantBufferAllocator(ID3D12Device* device, size_t capacity)
+	: _device(device), _bufferPointer(nullptr), _bufferAddress(0), _ring(capacity), _overflowPageOffset(0)
+{
+	assert(_device != nullptr && "Device is null.");
+
+	// Map buffer pointer (we don't unmap until allocator is destroyed)
+	_buffer = std::make_unique<GPUBuffer>(_device, capacity, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+	std::wstring name = L"Constant buffer ring";
+	_buffer->setName(name);
+	if (_buffer->open()) {
+		_bufferPointer = static_cast<UINT8*>(_buffer->getMappedPointer());
+		_bufferAddress = _buffer->getResource()->GetGPUVirtualAddress();
+	}
+}
+
+ConstantBufferAllocator::~ConstantBufferAllocator() {
+	_buffer->close();
+}
+
+ConstantAllocation<void> ConstantBufferAllocator::allocate(size_t size) {
+	constexpr size_t alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+	size = (size + alignment - 1) & ~(alignment - 1);
+
+	UINT64 offset = _ring.allocate(size, alignment);
+	if (offset != RingAllocator::kInvalidOffset && _bufferPointer != nullptr)
+		return { _bufferPointer + offset, _bufferAddress + offset };
+
+	// Ring is full, so allocate from overflow page.
+	if (_overflowPage == nullptr || _overflowPageOffset + size > _overflowPage->getAlignedBufferSize()) {
+		if (_overflowPage != nullptr)
+			_pendingOverflowPages.push_back(std::move(_overflowPage));
+
+		std::cerr << "Constant buffer ring is out of space, allocating overflow page." << std::endl;
+		size_t pageSize = size > kOverflowPageSize ? size : kOverflowPageSize;
+		_overflowPage = std::make_unique<GPUBuffer>(_device, pageSize, alignment);
+		_overflowPageOffset = 0;
+		if (_overflowPage->open() == false)
+			return { nullptr, 0 };
+	}
+
+	UINT8* pointer = static_cast<UINT8*>(_overflowPage->getMappedPointer()) + _overflowPageOffset;
+	D3D12_GPU_VIRTUAL_ADDRESS address = _overflowPage->getResource()->GetGPUVirtualAddress() + _overflowPageOffset;
+	_overflowPageOffset += size;
+	return { pointer, address };
+}
+
+void ConstantBufferAllocator::finishSubmission(UINT64 fenceValue) {
+	_ring.finishSubmission(fenceValue);
+
+	if (_overflowPage != nullptr)
+		_pendingOverflowPages.push_back(std::move(_overflowPage));
+	while (_pendingOverflowPages.empty() == false) {
+		_overflowPages.emplace_back(fenceValue, std::move(_pendingOverflowPages.front()));
+		_pendingOverflowPages.pop_front();
+	}
+}
+
+void ConstantBufferAllocator::reclaim(ID3D12Fence* fence) {
+	const UINT64 completedFenceValue = fence->GetCompletedValue();
+	_ring.reclaim(completedFenceValue);
+	while (_overflowPages.empty() == false && _overflowPages.front().first <= completedFenceValue) {
+		_overflowPages.pop_front();
+	}
+}
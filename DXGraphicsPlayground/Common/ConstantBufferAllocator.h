@@ -0,0 +1,53 @@
+#pragma once
+
+#include "pch.h"
+#include "RingAllocator.h"
+#include <memory>
+#include <deque>
+
+class GPUBuffer;
+
+template <typename T>
+struct ConstantAllocation {
+	T* cpuPointer;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress;
+
+	bool isValid() const { return cpuPointer != nullptr; }
+};
+
+// Frame-scoped linear allocator for constant buffers on a persistently mapped upload buffer.
+// Allocations are retired with fence value of the frame and reused when the fence completes.
+class ConstantBufferAllocator
+{
+public:
+	ConstantBufferAllocator(ID3D12Device* device, size_t capacity = kDefaultCapacity);
+	~ConstantBufferAllocator();
+
+	// Allocation (256-byte aligned, valid until the frame's fence completes)
+	ConstantAllocation<void> allocate(size_t size);
+	template <typename T>
+	ConstantAllocation<T> allocate() {
+		ConstantAllocation<void> allocation = allocate(sizeof(T));
+		return { static_cast<T*>(allocation.cpuPointer), allocation.gpuAddress };
+	}
+
+	// Synchronization
+	void finishSubmission(UINT64 fenceValue);
+	void reclaim(ID3D12Fence* fence);
+
+private:
+	static constexpr size_t kDefaultCapacity = 4 * 1024 * 1024;
+	static constexpr size_t kOverflowPageSize = 1024 * 1024;
+
+	ID3D12Device* _device;
+	std::unique_ptr<GPUBuffer> _buffer;
+	UINT8* _bufferPointer;
+	D3D12_GPU_VIRTUAL_ADDRESS _bufferAddress;
+	RingAllocator _ring;
+
+	// pages for allocations which don't fit into the ring
+	std::unique_ptr<GPUBuffer> _overflowPage;
+	size_t _overflowPageOffset;
+	std::deque<std::unique_ptr<GPUBuffer>> _pendingOverflowPages;
+	std::deque<std::pair<UINT64, std::unique_ptr<GPUBuffer>>> _overflowPages;
+};
@@ -0,0 +1,153 @@
+#include "pch.h"
+#include "CookedTexture.h"
+#include "PitchedCopy.h"
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(_WIN32)
+static_assert(CookedTextureFormat::kR8G8B8A8UNorm == DXGI_FORMAT_R8G8B8A8_UNORM && CookedTextureFormat::kR8G8B8A8UNormSRGB == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,
+	"Cooked texture formats must match DXGI_FORMAT.");
+static_assert(CookedTextureFormat::kBC1UNorm == DXGI_FORMAT_BC1_UNORM && CookedTextureFormat::kBC1UNormSRGB == DXGI_FORMAT_BC1_UNORM_SRGB &&
+	CookedTextureFormat::kBC3UNorm == DXGI_FORMAT_BC3_UNORM && CookedTextureFormat::kBC3UNormSRGB == DXGI_FORMAT_BC3_UNORM_SRGB &&
+	CookedTextureFormat::kBC4UNorm == DXGI_FORMAT_BC4_UNORM && CookedTextureFormat::kBC5UNorm == DXGI_FORMAT_BC5_UNORM &&
+	CookedTextureFormat::kBC7UNorm == DXGI_FORMAT_BC7_UNORM && CookedTextureFormat::kBC7UNormSRGB == DXGI_FORMAT_BC7_UNORM_SRGB,
+	"Cooked texture formats must match DXGI_FORMAT.");
+#endif
+
+namespace {
+	uint64_t _alignUp(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	uint32_t _mipSize(uint32_t size, uint32_t mip) {
+		return (size >> mip) > 0 ? (size >> mip) : 1;
+	}
+
+	uint64_t _headerSize(uint32_t subresourceCount) {
+		return _alignUp(sizeof(CookedTextureHeader) + sizeof(CookedSubresource) * subresourceCount, CookedTextureWriter::kPlacementAlignment);
+	}
+}
+
+CookedTextureWriter::CookedTextureWriter(const CookedTextureDesc& desc)
+	: _header{}
+{
+	assert(desc.blockSize > 0 && desc.bytesPerBlock > 0 && "Invalid block size.");
+	const uint32_t maxMipCount = [&desc] {
+		uint32_t size = desc.width > desc.height ? desc.width : desc.height;
+		size = size > desc.depth ? size : desc.depth;
+		uint32_t count = 1;
+		while (size > 1) {
+			size >>= 1;
+			count++;
+		}
+		return count;
+	}();
+	assert(desc.mipCount > 0 && desc.mipCount <= maxMipCount && "Invalid mip count.");
+
+	_header.magic = CookedTextureHeader::kMagic;
+	_header.version = CookedTextureHeader::kVersion;
+	_header.format = desc.format;
+	_header.width = desc.width;
+	_header.height = desc.height;
+	_header.depth = desc.depth;
+	_header.arraySize = desc.arraySize;
+	_header.mipCount = desc.mipCount < maxMipCount ? desc.mipCount : maxMipCount;
+	_header.subresourceCount = _header.mipCount * desc.arraySize;
+	_header.bytesPerBlock = desc.bytesPerBlock;
+	_header.blockSize = desc.blockSize;
+	_header.dataOffset = _headerSize(_header.subresourceCount);
+
+	// footprints in the same layout as ID3D12Device::GetCopyableFootprints
+	uint64_t offset = 0;
+	_subresources.resize(_header.subresourceCount);
+	for (uint32_t slice = 0; slice < desc.arraySize; slice++) {
+		for (uint32_t mip = 0; mip < _header.mipCount; mip++) {
+			CookedSubresource& subresource = _subresources[mip + slice * _header.mipCount];
+			subresource.width = _mipSize(desc.width, mip);
+			subresource.height = _mipSize(desc.height, mip);
+			subresource.depth = _mipSize(desc.depth, mip);
+			subresource.numRows = (subresource.height + desc.blockSize - 1) / desc.blockSize;
+			subresource.rowSize = (subresource.width + desc.blockSize - 1) / desc.blockSize * desc.bytesPerBlock;
+			subresource.rowPitch = static_cast<uint32_t>(_alignUp(subresource.rowSize, kRowPitchAlignment));
+
+			offset = _alignUp(offset, kPlacementAlignment);
+			subresource.offset = offset;
+			offset += static_cast<uint64_t>(subresource.rowPitch) * subresource.numRows * subresource.depth;
+		}
+	}
+	_header.dataSize = offset;
+	_data.resize(static_cast<size_t>(offset));
+}
+
+void CookedTextureWriter::setSubresource(uint32_t index, const void* data, size_t rowPitch, size_t slicePitch) {
+	assert(index < _subresources.size() && "Subresource index is out of range.");
+	const CookedSubresource& subresource = _subresources[index];
+
+	PitchedRegion destination{};
+	destination.data = getSubresourceData(index);
+	destination.rowPitch = subresource.rowPitch;
+	destination.slicePitch = static_cast<size_t>(subresource.rowPitch) * subresource.numRows;
+	PitchedRegion source{};
+	source.data = const_cast<void*>(data);
+	source.rowPitch = rowPitch;
+	source.slicePitch = slicePitch;
+	PitchedCopy::copy(destination, source, subresource.rowSize, subresource.numRows, subresource.depth, PitchedCopyPath::Scalar);
+}
+
+bool CookedTextureWriter::save(const std::string& path) const {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false) {
+		std::cerr << "Can't open " << path << " for writing." << std::endl;
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+	file.write(reinterpret_cast<const char*>(_subresources.data()), sizeof(CookedSubresource) * _subresources.size());
+	const uint64_t paddingSize = _header.dataOffset - sizeof(_header) - sizeof(CookedSubresource) * _subresources.size();
+	const char padding[kPlacementAlignment] = {};
+	file.write(padding, static_cast<std::streamsize>(paddingSize));
+	file.write(reinterpret_cast<const char*>(_data.data()), static_cast<std::streamsize>(_data.size()));
+	return file.good();
+}
+
+bool CookedTextureFile::open(const std::string& path) {
+	close();
+	if (_file.open(path) == false)
+		return false;
+
+	// validate header and table before trusting any offset
+	const uint8_t* data = _file.getData();
+	const size_t size = _file.getSize();
+	const CookedTextureHeader* header = reinterpret_cast<const CookedTextureHeader*>(data);
+	bool valid = size >= sizeof(CookedTextureHeader)
+		&& header->magic == CookedTextureHeader::kMagic
+		&& header->version == CookedTextureHeader::kVersion
+		&& header->subresourceCount == header->mipCount * header->arraySize
+		&& sizeof(CookedTextureHeader) + sizeof(CookedSubresource) * static_cast<uint64_t>(header->subresourceCount) <= header->dataOffset
+		&& header->dataOffset + header->dataSize <= size;
+	if (valid) {
+		const CookedSubresource* subresources = reinterpret_cast<const CookedSubresource*>(data + sizeof(CookedTextureHeader));
+		for (uint32_t i = 0; i < header->subresourceCount && valid; i++) {
+			const CookedSubresource& subresource = subresources[i];
+			valid = subresource.rowSize <= subresource.rowPitch
+				&& subresource.offset + static_cast<uint64_t>(subresource.rowPitch) * subresource.numRows * subresource.depth <= header->dataSize;
+		}
+		_subresources = subresources;
+	}
+	if (valid == false) {
+		std::cerr << "Invalid cooked texture " << path << "." << std::endl;
+		close();
+		return false;
+	}
+
+	_header = header;
+	return true;
+}
+
+void CookedTextureFile::close() {
+	_file.close();
+	_header = nullptr;
+	_subresources = nullptr;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// DXGI_FORMAT values of cooked textures, so cooker and tests build without dxgiformat.h
+namespace CookedTextureFormat {
+	constexpr uint32_t kR8G8B8A8UNorm = 28;		// DXGI_FORMAT_R8G8B8A8_UNORM
+	constexpr uint32_t kR8G8B8A8UNormSRGB = 29;	// DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+	constexpr uint32_t kBC1UNorm = 71;			// DXGI_FORMAT_BC1_UNORM
+	constexpr uint32_t kBC1UNormSRGB = 72;		// DXGI_FORMAT_BC1_UNORM_SRGB
+	constexpr uint32_t kBC3UNorm = 77;			// DXGI_FORMAT_BC3_UNORM
+	constexpr uint32_t kBC3UNormSRGB = 78;		// DXGI_FORMAT_BC3_UNORM_SRGB
+	constexpr uint32_t kBC4UNorm = 80;			// DXGI_FORMAT_BC4_UNORM
+	constexpr uint32_t kBC5UNorm = 83;			// DXGI_FORMAT_BC5_UNORM
+	constexpr uint32_t kBC7UNorm = 98;			// DXGI_FORMAT_BC7_UNORM
+	constexpr uint32_t kBC7UNormSRGB = 99;		// DXGI_FORMAT_BC7_UNORM_SRGB
+}
+
+// Cooked texture container.
+// Subresources are stored in D3D12 placed footprint layout, so they can be copied into upload memory as they are.
+// File layout : header, subresource table, (padding), subresource data
+struct CookedTextureHeader {
+	static constexpr uint32_t kMagic = 0x58455443;	// 'CTEX'
+	static constexpr uint32_t kVersion = 1;
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t format;			// DXGI_FORMAT
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	uint32_t arraySize;
+	uint32_t mipCount;
+	uint32_t subresourceCount;	// mipCount * arraySize, ordered as D3D12 subresource index
+	uint32_t bytesPerBlock;		// bytes per pixel, or bytes per block for block-compressed formats
+	uint32_t blockSize;			// 1 for uncompressed formats, 4 for block-compressed formats
+	uint32_t reserved;
+	uint64_t dataOffset;		// from start of file
+	uint64_t dataSize;
+};
+
+struct CookedSubresource {
+	uint64_t offset;			// from start of data
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	uint32_t rowPitch;
+	uint32_t numRows;			// rows of blocks
+	uint32_t rowSize;			// bytes per row without padding
+};
+
+struct CookedTextureDesc {
+	uint32_t format = 0;
+	uint32_t width = 1;
+	uint32_t height = 1;
+	uint32_t depth = 1;
+	uint32_t arraySize = 1;
+	uint32_t mipCount = 1;
+	uint32_t bytesPerBlock = 4;
+	uint32_t blockSize = 1;
+};
+
+// Lays out subresources and writes cooked texture file
+class CookedTextureWriter
+{
+public:
+	static constexpr uint32_t kRowPitchAlignment = 256;		// D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+	static constexpr uint32_t kPlacementAlignment = 512;	// D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+
+	CookedTextureWriter(const CookedTextureDesc& desc);
+	~CookedTextureWriter() {}
+
+	// Properties
+	const CookedTextureHeader& getHeader() const { return _header; }
+	const CookedSubresource& getSubresource(uint32_t index) const { return _subresources[index]; }
+	uint8_t* getSubresourceData(uint32_t index) { return _data.data() + _subresources[index].offset; }
+
+	// Copies subresource (index = mip + arraySlice * mipCount) from source with given pitches
+	void setSubresource(uint32_t index, const void* data, size_t rowPitch, size_t slicePitch);
+
+	bool save(const std::string& path) const;
+
+private:
+	CookedTextureHeader _header;
+	std::vector<CookedSubresource> _subresources;
+	std::vector<uint8_t> _data;
+};
+
+// Memory-mapped cooked texture file
+class CookedTextureFile
+{
+public:
+	CookedTextureFile() : _header(nullptr), _subresources(nullptr) {}
+	~CookedTextureFile() {}
+
+	bool open(const std::string& path);
+	void close();
+
+	// Properties
+	bool isOpen() const { return _header != nullptr; }
+	const CookedTextureHeader& getHeader() const { return *_header; }
+	const CookedSubresource& getSubresource(uint32_t index) const { return _subresources[index]; }
+	const uint8_t* getSubresourceData(uint32_t index) const { return _file.getData() + _header->dataOffset + _subresources[index].offset; }
+
+private:
+	MappedFile _file;
+	const CookedTextureHeader* _header;
+	const CookedSubresource* _subresources;
+};
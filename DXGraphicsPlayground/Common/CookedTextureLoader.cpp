@@ -0,0 +1,61 @@
+#include "pch.h"
+#include "CookedTextureLoader.h"
+#include "CookedTexture.h"
+#include "AllocationRegistry.h"
+#include <cassert>
+#include <iostream>
+
+CookedTextureLoader::CookedTextureLoader(ID3D12Device* device, UploadQueue* uploadQueue)
+	: _device(device), _uploadQueue(uploadQueue)
+{
+	assert(_device != nullptr && "Device is null.");
+	assert(_uploadQueue != nullptr && "Upload queue is null.");
+}
+
+HRESULT CookedTextureLoader::load(const std::string& path, ComPtr<ID3D12Resource>& outTexture, UploadTicket& outTicket) {
+	outTicket = UploadQueue::kInvalidTicket;
+
+	CookedTextureFile file;
+	if (file.open(path) == false)
+		return E_FAIL;
+	const CookedTextureHeader& header = file.getHeader();
+
+	D3D12_HEAP_PROPERTIES heapProps{};
+	heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+	heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	heapProps.CreationNodeMask = 1;
+	heapProps.VisibleNodeMask = 1;
+	D3D12_RESOURCE_DESC textureDesc{};
+	textureDesc.Dimension = header.depth > 1 ? D3D12_RESOURCE_DIMENSION_TEXTURE3D : D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	textureDesc.Format = static_cast<DXGI_FORMAT>(header.format);
+	textureDesc.Width = header.width;
+	textureDesc.Height = header.height;
+	textureDesc.DepthOrArraySize = static_cast<UINT16>(header.depth > 1 ? header.depth : header.arraySize);
+	textureDesc.MipLevels = static_cast<UINT16>(header.mipCount);
+	textureDesc.SampleDesc.Count = 1;
+
+	HRESULT result = _device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &textureDesc,
+		D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&outTexture));
+	if (result < 0) {
+		std::cerr << "Failed to create texture for " << path << "! : " << result << std::endl;
+		return result;
+	}
+	AllocationRegistry::getShared().recordAllocation(AllocationCategory::Texture, _device->GetResourceAllocationInfo(0, 1, &textureDesc).SizeInBytes);
+
+	// subresources are already in footprint layout, so staging copy is a plain memcpy
+	_subresources.resize(header.subresourceCount);
+	for (UINT i = 0; i < header.subresourceCount; i++) {
+		const CookedSubresource& subresource = file.getSubresource(i);
+		_subresources[i].data = file.getSubresourceData(i);
+		_subresources[i].rowPitch = subresource.rowPitch;
+		_subresources[i].slicePitch = static_cast<size_t>(subresource.rowPitch) * subresource.numRows;
+	}
+
+	TextureUpload upload;
+	upload.texture = outTexture.Get();
+	upload.mipCount = header.mipCount;
+	upload.arraySize = header.depth > 1 ? 1 : header.arraySize;
+	upload.subresources = _subresources.data();
+	outTicket = _uploadQueue->uploadTextures(&upload, 1);
+	return S_OK;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "pch.h"
+#include "UploadQueue.h"
+#include <string>
+#include <vector>
+
+using Microsoft::WRL::ComPtr;
+
+// Creates textures from cooked texture files.
+// Subresources are copied from the mapped file into upload memory without decoding.
+class CookedTextureLoader
+{
+public:
+	CookedTextureLoader(ID3D12Device* device, UploadQueue* uploadQueue);
+	~CookedTextureLoader() {}
+
+	// Creates texture in COMMON state and uploads it on copy queue
+	HRESULT load(const std::string& path, ComPtr<ID3D12Resource>& outTexture, UploadTicket& outTicket);
+
+private:
+	ID3D12Device* _device;
+	UploadQueue* _uploadQueue;
+	std::vector<SubresourceData> _subresources;
+};
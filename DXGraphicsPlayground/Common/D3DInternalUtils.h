@@ -2,6 +2,8 @@
 
 #include <string>
 #include <d3dcommon.h>
+#include <dxgi1_5.h>
+#include <wrl/client.h>
 
 inline std::string FeatureLevelToString(D3D_FEATURE_LEVEL featureLevel) {
 	switch (featureLevel) {
@@ -26,4 +28,15 @@ inline std::string FeatureLevelToString(D3D_FEATURE_LEVEL featureLevel) {
 	default:
 		return "unknown";
 	}
+}
+
+// Whether Present(0, DXGI_PRESENT_ALLOW_TEARING) is available (needs flip model swap chain)
+inline bool IsTearingSupported(IDXGIFactory1* factory) {
+	Microsoft::WRL::ComPtr<IDXGIFactory5> factory5;
+	BOOL allowTearing = FALSE;
+	if (factory == nullptr || FAILED(factory->QueryInterface(IID_PPV_ARGS(&factory5))))
+		return false;
+	if (FAILED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))))
+		return false;
+	return allowTearing == TRUE;
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "pch.h"
+#include "DeferredReleaseQueue.h"
+
+DeferredReleaseQueue::~DeferredReleaseQueue() {
+	releaseAll();
+}
+
+void DeferredReleaseQueue::retire(std::function<void()> release) {
+	_entries.push_back({ 0, std::move(release) });
+}
+
+void DeferredReleaseQueue::finishSubmission(uint64_t fenceValue) {
+	// entries are tagged in order, so untagged ones are at the back
+	for (auto it = _entries.rbegin(); it != _entries.rend() && it->fenceValue == 0; ++it)
+		it->fenceValue = fenceValue;
+}
+
+void DeferredReleaseQueue::reclaim(uint64_t completedFenceValue) {
+	while (_entries.empty() == false && _entries.front().fenceValue != 0 && _entries.front().fenceValue <= completedFenceValue) {
+		// popped before release, so release can retire other objects
+		std::function<void()> release = std::move(_entries.front().release);
+		_entries.pop_front();
+		release();
+	}
+}
+
+void DeferredReleaseQueue::releaseAll() {
+	while (_entries.empty() == false) {
+		std::function<void()> release = std::move(_entries.front().release);
+		_entries.pop_front();
+		release();
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+// Defers destruction of objects that submitted frames may still reference.
+// Objects retired before finishSubmission(fenceValue) are released by reclaim() once GPU passes that fence value,
+// so resources can be replaced (resize, streaming, reload) without waiting for GPU.
+class DeferredReleaseQueue
+{
+public:
+	DeferredReleaseQueue() {}
+	// Releases everything, so GPU must be idle
+	~DeferredReleaseQueue();
+
+	DeferredReleaseQueue(const DeferredReleaseQueue&) = delete;
+	DeferredReleaseQueue& operator=(const DeferredReleaseQueue&) = delete;
+
+	// Properties
+	size_t getPendingCount() const { return _entries.size(); }
+
+	// Function is called when it's safe to release (e.g. frees descriptors or heap allocation)
+	void retire(std::function<void()> release);
+	// Keeps object alive until it's safe to release (ComPtr, unique_ptr...)
+	template <typename T>
+	void retireObject(T&& object) {
+		std::shared_ptr<typename std::decay<T>::type> holder = std::make_shared<typename std::decay<T>::type>(std::forward<T>(object));
+		retire([holder]() mutable { holder.reset(); });
+	}
+
+	// Synchronization
+	void finishSubmission(uint64_t fenceValue);
+	void reclaim(uint64_t completedFenceValue);
+	void releaseAll();
+
+private:
+	struct Entry {
+		uint64_t fenceValue;	// 0 until submission that may use the object is finished
+		std::function<void()> release;
+	};
+
+	std::deque<Entry> _entries;
+};
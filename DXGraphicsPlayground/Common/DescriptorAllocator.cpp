@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "DescriptorAllocator.h"
+#include <cassert>
+#include <iostream>
+
+DescriptorAllocator::DescriptorAllocator(ID3D12Device* device, UINT persistentDescriptorCount, UINT transientDescriptorCount,
+	UINT renderTargetDescriptorCount, UINT depthStencilDescriptorCount)
+	: _device(device), _persistentDescriptorCount(persistentDescriptorCount),
+	_persistentAllocator(persistentDescriptorCount), _transientAllocator(transientDescriptorCount)
+{
+	assert(_device != nullptr && "Device is null.");
+
+	HRESULT result = S_OK;
+
+	// Shader-visible heap
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	heapDesc.NumDescriptors = persistentDescriptorCount + transientDescriptorCount;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	heapDesc.NodeMask = 0;
+	result = _device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&_shaderVisibleHeap));
+	assert(result >= 0 && "Can't create shader-visible descriptor heap!");
+	_shaderVisibleHeap->SetName(L"Shader-visible descriptor heap");
+	_shaderVisibleDescriptorSize = _device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	// Staging heaps
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+	heapDesc.NumDescriptors = renderTargetDescriptorCount;
+	result = _device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&_renderTargetHeap.heap));
+	assert(result >= 0 && "Can't create RTV staging descriptor heap!");
+	_renderTargetHeap.allocator = std::make_unique<FreeListAllocator>(renderTargetDescriptorCount);
+	_renderTargetHeap.descriptorSize = _device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+	heapDesc.NumDescriptors = depthStencilDescriptorCount;
+	result = _device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&_depthStencilHeap.heap));
+	assert(result >= 0 && "Can't create DSV staging descriptor heap!");
+	_depthStencilHeap.allocator = std::make_unique<FreeListAllocator>(depthStencilDescriptorCount);
+	_depthStencilHeap.descriptorSize = _device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+}
+
+DescriptorAllocator::~DescriptorAllocator() {
+	// do nothing
+}
+
+DescriptorRange DescriptorAllocator::_makeRange(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT index, UINT count) const {
+	DescriptorRange range;
+	range.type = type;
+	range.index = index;
+	range.count = count;
+	if (type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV) {
+		range.descriptorSize = _shaderVisibleDescriptorSize;
+		range.cpuHandle = _shaderVisibleHeap->GetCPUDescriptorHandleForHeapStart();
+		range.gpuHandle = _shaderVisibleHeap->GetGPUDescriptorHandleForHeapStart();
+		range.cpuHandle.ptr += static_cast<SIZE_T>(index) * range.descriptorSize;
+		range.gpuHandle.ptr += static_cast<UINT64>(index) * range.descriptorSize;
+	}
+	else {
+		const StagingHeap& stagingHeap = type == D3D12_DESCRIPTOR_HEAP_TYPE_RTV ? _renderTargetHeap : _depthStencilHeap;
+		range.descriptorSize = stagingHeap.descriptorSize;
+		range.cpuHandle = stagingHeap.heap->GetCPUDescriptorHandleForHeapStart();
+		range.cpuHandle.ptr += static_cast<SIZE_T>(index) * range.descriptorSize;
+	}
+	return range;
+}
+
+DescriptorAllocator::StagingHeap* DescriptorAllocator::_stagingHeap(D3D12_DESCRIPTOR_HEAP_TYPE type) {
+	switch (type) {
+	case D3D12_DESCRIPTOR_HEAP_TYPE_RTV:
+		return &_renderTargetHeap;
+	case D3D12_DESCRIPTOR_HEAP_TYPE_DSV:
+		return &_depthStencilHeap;
+	default:
+		return nullptr;
+	}
+}
+
+DescriptorRange DescriptorAllocator::allocatePersistent(UINT count) {
+	UINT64 index = _persistentAllocator.allocate(count);
+	if (index == FreeListAllocator::kInvalidOffset) {
+		std::cerr << "Out of persistent descriptors (" << count << " requested)!" << std::endl;
+		return DescriptorRange{};
+	}
+	return _makeRange(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, static_cast<UINT>(index), count);
+}
+
+DescriptorRange DescriptorAllocator::allocateTransient(UINT count) {
+	UINT64 index = _transientAllocator.allocate(count);
+	if (index == RingAllocator::kInvalidOffset) {
+		std::cerr << "Out of transient descriptors (" << count << " requested)!" << std::endl;
+		return DescriptorRange{};
+	}
+	return _makeRange(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, _persistentDescriptorCount + static_cast<UINT>(index), count);
+}
+
+DescriptorRange DescriptorAllocator::allocateStaging(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT count) {
+	StagingHeap* stagingHeap = _stagingHeap(type);
+	assert(stagingHeap != nullptr && "Only RTV and DSV staging descriptors are supported.");
+	if (stagingHeap == nullptr)
+		return DescriptorRange{};
+
+	UINT64 index = stagingHeap->allocator->allocate(count);
+	if (index == FreeListAllocator::kInvalidOffset) {
+		std::cerr << "Out of staging descriptors (" << count << " requested)!" << std::endl;
+		return DescriptorRange{};
+	}
+	return _makeRange(type, static_cast<UINT>(index), count);
+}
+
+void DescriptorAllocator::free(DescriptorRange& range) {
+	if (range.isValid() == false)
+		return;
+
+	if (range.type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV) {
+		// transient descriptors are reclaimed by fence
+		if (range.index < _persistentDescriptorCount)
+			_persistentAllocator.free(range.index, range.count);
+	}
+	else {
+		StagingHeap* stagingHeap = _stagingHeap(range.type);
+		if (stagingHeap != nullptr)
+			stagingHeap->allocator->free(range.index, range.count);
+	}
+	range = DescriptorRange{};
+}
+
+void DescriptorAllocator::finishSubmission(UINT64 fenceValue) {
+	_transientAllocator.finishSubmission(fenceValue);
+}
+
+void DescriptorAllocator::reclaim(ID3D12Fence* fence) {
+	_transientAllocator.reclaim(fence->GetCompletedValue());
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "pch.h"
+#include "FreeListAllocator.h"
+#include "RingAllocator.h"
+#include <memory>
+
+using Microsoft::WRL::ComPtr;
+
+// Contiguous range of descriptors in a descriptor heap
+struct DescriptorRange {
+	D3D12_DESCRIPTOR_HEAP_TYPE type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	UINT index = 0;
+	UINT count = 0;
+	UINT descriptorSize = 0;
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle{};
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle{};	// null for CPU-only (staging) descriptors
+
+	bool isValid() const { return count > 0; }
+	D3D12_CPU_DESCRIPTOR_HANDLE getCPUHandle(UINT i) const { return { cpuHandle.ptr + static_cast<SIZE_T>(i) * descriptorSize }; }
+	D3D12_GPU_DESCRIPTOR_HANDLE getGPUHandle(UINT i) const { return { gpuHandle.ptr + static_cast<UINT64>(i) * descriptorSize }; }
+};
+
+// Allocates descriptors from one shader-visible CBV/SRV/UAV heap and CPU-only RTV/DSV staging heaps.
+// Shader-visible heap is split into persistent region (free-list) and transient region (per-frame ring).
+class DescriptorAllocator
+{
+public:
+	DescriptorAllocator(ID3D12Device* device,
+		UINT persistentDescriptorCount = kDefaultPersistentDescriptorCount,
+		UINT transientDescriptorCount = kDefaultTransientDescriptorCount,
+		UINT renderTargetDescriptorCount = kDefaultRenderTargetDescriptorCount,
+		UINT depthStencilDescriptorCount = kDefaultDepthStencilDescriptorCount);
+	~DescriptorAllocator();
+
+	// Properties
+	ID3D12DescriptorHeap* getShaderVisibleHeap() const { return _shaderVisibleHeap.Get(); }
+
+	// Persistent CBV/SRV/UAV descriptors (valid until freed)
+	DescriptorRange allocatePersistent(UINT count);
+	// Transient CBV/SRV/UAV descriptors (valid until fence of the frame completes)
+	DescriptorRange allocateTransient(UINT count);
+	// CPU-only RTV/DSV descriptors
+	DescriptorRange allocateStaging(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT count);
+	void free(DescriptorRange& range);
+
+	// Synchronization
+	void finishSubmission(UINT64 fenceValue);
+	void reclaim(ID3D12Fence* fence);
+
+private:
+	static constexpr UINT kDefaultPersistentDescriptorCount = 4096;
+	static constexpr UINT kDefaultTransientDescriptorCount = 4096;
+	static constexpr UINT kDefaultRenderTargetDescriptorCount = 256;
+	static constexpr UINT kDefaultDepthStencilDescriptorCount = 64;
+
+	struct StagingHeap {
+		ComPtr<ID3D12DescriptorHeap> heap;
+		std::unique_ptr<FreeListAllocator> allocator;
+		UINT descriptorSize;
+	};
+
+	DescriptorRange _makeRange(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT index, UINT count) const;
+	StagingHeap* _stagingHeap(D3D12_DESCRIPTOR_HEAP_TYPE type);
+
+	ID3D12Device* _device;
+
+	// shader-visible CBV/SRV/UAV heap
+	ComPtr<ID3D12DescriptorHeap> _shaderVisibleHeap;
+	UINT _shaderVisibleDescriptorSize;
+	UINT _persistentDescriptorCount;
+	FreeListAllocator _persistentAllocator;
+	RingAllocator _transientAllocator;
+
+	// CPU-only heaps
+	StagingHeap _renderTargetHeap;
+	StagingHeap _depthStencilHeap;
+};
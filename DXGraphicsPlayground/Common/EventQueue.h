@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free queue between one producer thread and one consumer thread.
+// Producer only writes tail and consumer only writes head, so neither of them locks or waits for the other.
+template <typename T>
+class EventQueue
+{
+public:
+	EventQueue(size_t capacity) : _items(capacity + 1), _head(0), _tail(0) {}
+	~EventQueue() {}
+
+	EventQueue(const EventQueue&) = delete;
+	EventQueue& operator=(const EventQueue&) = delete;
+
+	// Properties
+	size_t getCapacity() const { return _items.size() - 1; }
+
+	// Producer thread only. Returns false if queue is full.
+	bool tryPush(const T& item) {
+		const size_t tail = _tail.load(std::memory_order_relaxed);
+		const size_t nextTail = _next(tail);
+		if (nextTail == _head.load(std::memory_order_acquire))
+			return false;
+		_items[tail] = item;
+		_tail.store(nextTail, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer thread only. Returns false if queue is empty.
+	bool tryPop(T& item) {
+		const size_t head = _head.load(std::memory_order_relaxed);
+		if (head == _tail.load(std::memory_order_acquire))
+			return false;
+		item = std::move(_items[head]);
+		_head.store(_next(head), std::memory_order_release);
+		return true;
+	}
+
+private:
+	size_t _next(size_t index) const { return index + 1 < _items.size() ? index + 1 : 0; }
+
+	std::vector<T> _items;			// one slot is always empty, so full and empty queues differ
+	std::atomic<size_t> _head;		// written by consumer
+	std::atomic<size_t> _tail;		// written by producer
+};
@@ -0,0 +1,60 @@
+#include "pch.h"
+#include "FramePacer.h"
+
+FramePacer::FramePacer(FramePacingMode mode, uint32_t maxFrameLatency)
+	: _mode(mode), _maxFrameLatency(maxFrameLatency > 0 ? maxFrameLatency : 1), _state(State::Idle),
+	_waitStartTime(0), _frameStartTime(0), _lastPresentTime(-1.0)
+{
+}
+
+bool FramePacer::beginWait(double time) {
+	if (_state != State::Idle)
+		return false;
+	_state = State::Waiting;
+	_waitStartTime = time;
+	return true;
+}
+
+bool FramePacer::beginFrame(double time) {
+	if (_state == State::Recording)
+		return false;
+
+	// first frame takes values as they are instead of averaging from 0
+	const double waitTime = _state == State::Waiting ? time - _waitStartTime : 0.0;
+	_stats.averageWaitTime = _stats.frameCount > 0 ? _stats.averageWaitTime * (1.0 - kSmoothing) + waitTime * kSmoothing : waitTime;
+	_state = State::Recording;
+	_frameStartTime = time;
+	return true;
+}
+
+bool FramePacer::present(double time) {
+	if (_state != State::Recording)
+		return false;
+
+	const double latency = time - _frameStartTime;
+	if (_stats.frameCount == 0) {
+		_stats.averageLatency = _stats.minLatency = _stats.maxLatency = latency;
+	}
+	else {
+		_stats.averageLatency = _stats.averageLatency * (1.0 - kSmoothing) + latency * kSmoothing;
+		_stats.minLatency = latency < _stats.minLatency ? latency : _stats.minLatency;
+		_stats.maxLatency = latency > _stats.maxLatency ? latency : _stats.maxLatency;
+	}
+	if (_lastPresentTime >= 0.0) {
+		const double interval = time - _lastPresentTime;
+		_stats.averageFrameInterval = _stats.averageFrameInterval > 0.0 ? _stats.averageFrameInterval * (1.0 - kSmoothing) + interval * kSmoothing : interval;
+	}
+	_stats.frameCount++;
+	_lastPresentTime = time;
+	_state = State::Idle;
+	return true;
+}
+
+void FramePacer::cancel() {
+	_state = State::Idle;
+}
+
+void FramePacer::resetStats() {
+	_stats = FramePacingStats();
+	_lastPresentTime = -1.0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+enum class FramePacingMode {
+	Throughput,		// CPU blocks after Present on fence of next frame (frames queue up to swap chain limit)
+	LowLatency,		// CPU waits for frame latency object before it starts frame, so input is sampled as late as possible
+};
+
+struct FramePacingStats {
+	uint64_t frameCount = 0;
+	// in seconds, moving averages (min/max since reset)
+	double averageLatency = 0;		// CPU start of frame to Present
+	double minLatency = 0;
+	double maxLatency = 0;
+	double averageWaitTime = 0;		// waiting at frame start
+	double averageFrameInterval = 0;	// between Presents
+};
+
+// State machine of frame pacing : Idle -> (Waiting ->) Recording -> Idle.
+// Times are passed in by caller, so it runs against a simulated clock as well as a real one.
+class FramePacer
+{
+public:
+	enum class State { Idle, Waiting, Recording };
+
+	FramePacer(FramePacingMode mode = FramePacingMode::Throughput, uint32_t maxFrameLatency = 1);
+	~FramePacer() {}
+
+	// Properties
+	FramePacingMode getMode() const { return _mode; }
+	uint32_t getMaxFrameLatency() const { return _maxFrameLatency; }
+	State getState() const { return _state; }
+	bool waitsAtFrameStart() const { return _mode == FramePacingMode::LowLatency; }
+	const FramePacingStats& getStats() const { return _stats; }
+
+	// Each returns false (and does nothing) on transition from wrong state
+	bool beginWait(double time);
+	bool beginFrame(double time);
+	bool present(double time);
+	// Drops a frame that is not presented (e.g. swap chain is being resized)
+	void cancel();
+	void resetStats();
+
+private:
+	static constexpr double kSmoothing = 0.1;
+
+	FramePacingMode _mode;
+	uint32_t _maxFrameLatency;
+	State _state;
+	double _waitStartTime;
+	double _frameStartTime;
+	double _lastPresentTime;
+	FramePacingStats _stats;
+};
@@ -0,0 +1,71 @@
+#include "pch.h"
+#include "FreeListAllocator.h"
+#include <cassert>
+#include <iterator>
+
+FreeListAllocator::FreeListAllocator(uint64_t capacity)
+	: _capacity(capacity), _usedSize(0)
+{
+	reset();
+}
+
+uint64_t FreeListAllocator::getLargestFreeRange() const {
+	uint64_t largest = 0;
+	for (const auto& range : _freeRanges)
+		largest = range.second > largest ? range.second : largest;
+	return largest;
+}
+
+uint64_t FreeListAllocator::allocate(uint64_t size) {
+	if (size == 0)
+		return kInvalidOffset;
+
+	for (auto it = _freeRanges.begin(); it != _freeRanges.end(); ++it) {
+		if (it->second < size)
+			continue;
+
+		uint64_t offset = it->first;
+		uint64_t remainingSize = it->second - size;
+		_freeRanges.erase(it);
+		if (remainingSize > 0)
+			_freeRanges[offset + size] = remainingSize;
+		_usedSize += size;
+		return offset;
+	}
+	return kInvalidOffset;
+}
+
+void FreeListAllocator::free(uint64_t offset, uint64_t size) {
+	assert(offset + size <= _capacity && "Range is out of capacity.");
+	if (size == 0)
+		return;
+
+	_usedSize -= size;
+	auto next = _freeRanges.lower_bound(offset);
+	assert((next == _freeRanges.end() || offset + size <= next->first) && "Range is already free.");
+
+	// merge with previous range
+	if (next != _freeRanges.begin()) {
+		auto prev = std::prev(next);
+		assert(prev->first + prev->second <= offset && "Range is already free.");
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			size += prev->second;
+			_freeRanges.erase(prev);
+		}
+	}
+
+	// merge with next range
+	if (next != _freeRanges.end() && offset + size == next->first) {
+		size += next->second;
+		_freeRanges.erase(next);
+	}
+
+	_freeRanges[offset] = size;
+}
+
+void FreeListAllocator::reset() {
+	_freeRanges.clear();
+	_freeRanges[0] = _capacity;
+	_usedSize = 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+// First-fit free-list allocator over a range of units (bytes, descriptors...).
+// Adjacent free ranges are merged on free.
+class FreeListAllocator
+{
+public:
+	static constexpr uint64_t kInvalidOffset = ~0ull;
+
+	FreeListAllocator(uint64_t capacity);
+	~FreeListAllocator() {}
+
+	// Properties
+	uint64_t getCapacity() const { return _capacity; }
+	uint64_t getUsedSize() const { return _usedSize; }
+	uint64_t getFreeRangeCount() const { return _freeRanges.size(); }
+	uint64_t getLargestFreeRange() const;
+
+	// Allocation (returns kInvalidOffset if there's no free range large enough)
+	uint64_t allocate(uint64_t size);
+	void free(uint64_t offset, uint64_t size);
+	void reset();
+
+private:
+	uint64_t _capacity;
+	uint64_t _usedSize;
+	std::map<uint64_t, uint64_t> _freeRanges;	// offset -> size
+};
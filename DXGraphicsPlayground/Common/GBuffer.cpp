@@ -1,34 +1,128 @@
 #include "pch.h"
 #include "GBuffer.h"
+#include "AllocationRegistry.h"
 #include "../Common/d3dx12.h"
 #include <cassert>
 
-GBuffer::GBuffer(ID3D12Device* device, size_t newWidth, size_t newHeight)
-	: _device(device), _width(newWidth), _height(newHeight)
+GBuffer::GBuffer(ID3D12Device* device, DescriptorAllocator* descriptorAllocator, size_t newWidth, size_t newHeight)
+	: _device(device), _heapAllocator(nullptr), _transientAllocator(nullptr), _descriptorAllocator(descriptorAllocator),
+	_deferredReleaseQueue(nullptr), _firstPass(0), _lastPass(0), _width(newWidth), _height(newHeight)
 {
 	assert(_device != nullptr && "Device is null.");
+	assert(_descriptorAllocator != nullptr && "Descriptor allocator is null.");
 
 	makeGBufferResources();
-	makeDescriptorHeaps();
+	makeDescriptors();
+}
+
+GBuffer::GBuffer(HeapAllocator* heapAllocator, DescriptorAllocator* descriptorAllocator, size_t newWidth, size_t newHeight)
+	: _device(heapAllocator->getDevice()), _heapAllocator(heapAllocator), _transientAllocator(nullptr), _descriptorAllocator(descriptorAllocator),
+	_deferredReleaseQueue(nullptr), _firstPass(0), _lastPass(0), _width(newWidth), _height(newHeight)
+{
+	assert(_device != nullptr && "Device is null.");
+	assert(_descriptorAllocator != nullptr && "Descriptor allocator is null.");
+
+	makeGBufferResources();
+	makeDescriptors();
+}
+
+GBuffer::GBuffer(TransientResourceAllocator* transientAllocator, DescriptorAllocator* descriptorAllocator, UINT firstPass, UINT lastPass, size_t newWidth, size_t newHeight)
+	: _device(transientAllocator->getDevice()), _heapAllocator(nullptr), _transientAllocator(transientAllocator), _descriptorAllocator(descriptorAllocator),
+	_deferredReleaseQueue(nullptr), _firstPass(firstPass), _lastPass(lastPass), _width(newWidth), _height(newHeight)
+{
+	assert(_device != nullptr && "Device is null.");
+	assert(_descriptorAllocator != nullptr && "Descriptor allocator is null.");
+
+	// resources and descriptors are made after transient allocator is compiled
+	makeGBufferResources();
 }
 
 GBuffer::~GBuffer() {
-	// do nothing
+	releaseGBufferResources();
+	if (_deferredReleaseQueue != nullptr) {
+		_retireDescriptors();
+		return;
+	}
+	_descriptorAllocator->free(_SRVDescriptors);
+	_descriptorAllocator->free(_RTVDescriptors);
+}
+
+void GBuffer::releaseGBufferResources() {
+	ComPtr<ID3D12Resource>* targets[kTargetCount] = { &_albedo, &_normal, &_pos, &_shading, &_tangent };
+	for (int i = 0; i < kTargetCount; i++) {
+		ComPtr<ID3D12Resource>& target = *targets[i];
+		if (target == nullptr)
+			continue;
+
+		// transient targets are counted (and retired) by transient allocator
+		if (_transientAllocator != nullptr) {
+			target.Reset();
+			continue;
+		}
+		const UINT64 allocationSize = _allocationSize(target->GetDesc());
+		if (_deferredReleaseQueue == nullptr) {
+			AllocationRegistry::getShared().recordFree(AllocationCategory::RenderTarget, allocationSize);
+			target.Reset();
+			if (_heapAllocator != nullptr)
+				_heapAllocator->free(_allocations[i]);
+			continue;
+		}
+
+		// placed memory is freed after resource, when frames using it are complete
+		HeapAllocator* heapAllocator = _heapAllocator;
+		ComPtr<ID3D12Resource> retiredTarget = std::move(target);
+		HeapAllocation retiredAllocation = _allocations[i];
+		_deferredReleaseQueue->retire([heapAllocator, retiredTarget, retiredAllocation, allocationSize]() mutable {
+			AllocationRegistry::getShared().recordFree(AllocationCategory::RenderTarget, allocationSize);
+			retiredTarget.Reset();
+			if (heapAllocator != nullptr)
+				heapAllocator->free(retiredAllocation);
+		});
+		_allocations[i] = HeapAllocation{};
+	}
+}
+
+void GBuffer::_retireDescriptors() {
+	// descriptors may be referenced by frames in flight, so new ones are allocated instead of rewritten
+	DescriptorAllocator* descriptorAllocator = _descriptorAllocator;
+	DescriptorRange retiredSRVs = _SRVDescriptors, retiredRTVs = _RTVDescriptors;
+	_deferredReleaseQueue->retire([descriptorAllocator, retiredSRVs, retiredRTVs]() mutable {
+		descriptorAllocator->free(retiredSRVs);
+		descriptorAllocator->free(retiredRTVs);
+	});
+	_SRVDescriptors = DescriptorRange{};
+	_RTVDescriptors = DescriptorRange{};
+}
+
+UINT64 GBuffer::_allocationSize(const D3D12_RESOURCE_DESC& resourceDesc) const {
+	return _device->GetResourceAllocationInfo(0, 1, &resourceDesc).SizeInBytes;
+}
+
+HRESULT GBuffer::makeRenderTarget(const D3D12_RESOURCE_DESC& resourceDesc, ComPtr<ID3D12Resource>& target, HeapAllocation& allocation) {
+	HRESULT result = S_OK;
+	if (_heapAllocator != nullptr) {
+		result = _heapAllocator->createPlacedResource(D3D12_HEAP_TYPE_DEFAULT, resourceDesc, D3D12_RESOURCE_STATE_RENDER_TARGET,
+			nullptr, allocation, IID_PPV_ARGS(&target));
+	}
+	else {
+		D3D12_HEAP_PROPERTIES heapProps{};
+		heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+		heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+		heapProps.VisibleNodeMask = 1;
+		heapProps.CreationNodeMask = 1;
+		heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+
+		result = _device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc,
+			D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr, IID_PPV_ARGS(&target));
+	}
+
+	if (result >= 0)
+		AllocationRegistry::getShared().recordAllocation(AllocationCategory::RenderTarget, _allocationSize(resourceDesc));
+	return result;
 }
 
 void GBuffer::makeGBufferResources() {
-	_albedo.Reset();
-	_normal.Reset();
-	_pos.Reset();
-	_shading.Reset();
-	_tangent.Reset();
-
-	D3D12_HEAP_PROPERTIES heapProps{};
-	heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
-	heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-	heapProps.VisibleNodeMask = 1;
-	heapProps.CreationNodeMask = 1;
-	heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	releaseGBufferResources();
 
 	D3D12_RESOURCE_DESC resourceDesc{};
 	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
@@ -36,83 +130,60 @@ void GBuffer::makeGBufferResources() {
 	resourceDesc.Height = (UINT)_height;
 	resourceDesc.DepthOrArraySize = 1;
 	resourceDesc.MipLevels = 1;
-	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 	resourceDesc.SampleDesc.Count = 1;
 	resourceDesc.SampleDesc.Quality = 0;
 	resourceDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
 	resourceDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
 
-	HRESULT result = S_OK;
+	const DXGI_FORMAT formats[kTargetCount] = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT,
+		DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT };
+	const wchar_t* names[kTargetCount] = { L"Albedo G-buffer", L"Normal G-buffer", L"Position G-buffer", L"Shading G-buffer", L"Tangent G-buffer" };
+	ComPtr<ID3D12Resource>* targets[kTargetCount] = { &_albedo, &_normal, &_pos, &_shading, &_tangent };
 
-	// albedo
-	result = _device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc,
-		D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr, IID_PPV_ARGS(&_albedo));
-	assert(result >= 0 && "Can't create Albedo G-buffer texture!");
-	_albedo->SetName(L"Albedo G-buffer");
-
-	// normal
-	resourceDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-	result = _device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc,
-		D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr, IID_PPV_ARGS(&_normal));
-	assert(result >= 0 && "Can't create Normal G-buffer texture!");
-	_normal->SetName(L"Normal G-buffer");
-
-	// pos
-	resourceDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	result = _device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc,
-		D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr, IID_PPV_ARGS(&_pos));
-	assert(result >= 0 && "Can't create Position G-buffer texture!");
-	_pos->SetName(L"Position G-buffer");
-
-	// shading
-	resourceDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	result = _device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc,
-		D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr, IID_PPV_ARGS(&_shading));
-	assert(result >= 0 && "Can't create Shading G-buffer texture!");
-	_shading->SetName(L"Shading G-buffer");
-
-	// tangent
-	resourceDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-	result = _device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc,
-		D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr, IID_PPV_ARGS(&_tangent));
-	assert(result >= 0 && "Can't create Tangent G-buffer texture!");
-	_tangent->SetName(L"Tangent G-buffer");
+	HRESULT result = S_OK;
+	for (int i = 0; i < kTargetCount; i++) {
+		resourceDesc.Format = formats[i];
+		if (_transientAllocator != nullptr) {
+			_transientHandles[i] = _transientAllocator->declare(resourceDesc, D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr, _firstPass, _lastPass, names[i]);
+			assert(_transientHandles[i] != TransientResourceAllocator::kInvalidHandle && "Can't declare G-buffer texture!");
+			continue;
+		}
+
+		result = makeRenderTarget(resourceDesc, *targets[i], _allocations[i]);
+		assert(result >= 0 && "Can't create G-buffer texture!");
+		(*targets[i])->SetName(names[i]);
+	}
 }
 
-void GBuffer::makeDescriptorHeaps() {
-	D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
-	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	heapDesc.NumDescriptors = 5;
-	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	heapDesc.NodeMask = 0;
+void GBuffer::bindTransientTargets() {
+	assert(_transientAllocator != nullptr && "G-buffer doesn't use transient allocator.");
 
-	// SRV
-	HRESULT result = S_OK;
-	result = _device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&_SRVDescriptorHeap));
-	assert(result >= 0 && "Can't create SRV descriptor heap for G-buffer!");
-
-	// Create shader-resource views
-	size_t srvSize = _device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	auto srvHandle = _SRVDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-	_device->CreateShaderResourceView(_albedo.Get(), nullptr, srvHandle); srvHandle.ptr += srvSize;
-	_device->CreateShaderResourceView(_normal.Get(), nullptr, srvHandle); srvHandle.ptr += srvSize;
-	_device->CreateShaderResourceView(_pos.Get(), nullptr, srvHandle); srvHandle.ptr += srvSize;
-	_device->CreateShaderResourceView(_shading.Get(), nullptr, srvHandle); srvHandle.ptr += srvSize;
-	_device->CreateShaderResourceView(_tangent.Get(), nullptr, srvHandle);
-
-	// RTV
-	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-	result = _device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&_RTVDescriptorHeap));
-	assert(result >= 0 && "Can't create RTV descriptor heap for G-buffer!");
-
-	// Create render-target views
-	size_t rtvSize = _device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-	auto rtvHandle = _RTVDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-	_device->CreateRenderTargetView(_albedo.Get(), nullptr, rtvHandle); rtvHandle.ptr += rtvSize;
-	_device->CreateRenderTargetView(_normal.Get(), nullptr, rtvHandle); rtvHandle.ptr += rtvSize;
-	_device->CreateRenderTargetView(_pos.Get(), nullptr, rtvHandle); rtvHandle.ptr += rtvSize;
-	_device->CreateRenderTargetView(_shading.Get(), nullptr, rtvHandle); rtvHandle.ptr += rtvSize;
-	_device->CreateRenderTargetView(_tangent.Get(), nullptr, rtvHandle);
+	ComPtr<ID3D12Resource>* targets[kTargetCount] = { &_albedo, &_normal, &_pos, &_shading, &_tangent };
+	for (int i = 0; i < kTargetCount; i++)
+		*targets[i] = _transientAllocator->getResource(_transientHandles[i]);
+	makeDescriptors();
+}
+
+void GBuffer::makeDescriptors() {
+	// Descriptors are allocated once and rewritten on resize (or retired and reallocated with deferred release queue).
+	if (_SRVDescriptors.isValid() == false) {
+		_SRVDescriptors = _descriptorAllocator->allocatePersistent(kTargetCount);
+		assert(_SRVDescriptors.isValid() && "Can't allocate SRV descriptors for G-buffer!");
+	}
+	if (_RTVDescriptors.isValid() == false) {
+		_RTVDescriptors = _descriptorAllocator->allocateStaging(D3D12_DESCRIPTOR_HEAP_TYPE_RTV, kTargetCount);
+		assert(_RTVDescriptors.isValid() && "Can't allocate RTV descriptors for G-buffer!");
+	}
+
+	ID3D12Resource* targets[kTargetCount] = { _albedo.Get(), _normal.Get(), _pos.Get(), _shading.Get(), _tangent.Get() };
+	for (UINT i = 0; i < kTargetCount; i++) {
+		// Create shader-resource views
+		_device->CreateShaderResourceView(targets[i], nullptr, _SRVDescriptors.getCPUHandle(i));
+
+		// Create render-target views
+		_device->CreateRenderTargetView(targets[i], nullptr, _RTVDescriptors.getCPUHandle(i));
+	}
 }
 
 void GBuffer::makeRootSignatures() {
@@ -153,6 +224,9 @@ void GBuffer::resize(size_t newWidth, size_t newHeight) {
 	_width = newWidth;
 	_height = newHeight;
 
+	if (_deferredReleaseQueue != nullptr)
+		_retireDescriptors();
 	makeGBufferResources();
-	makeDescriptorHeaps();
+	if (_transientAllocator == nullptr)
+		makeDescriptors();
 }
\ No newline at end of file
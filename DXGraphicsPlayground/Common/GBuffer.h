@@ -1,13 +1,23 @@
 #pragma once
 
 #include "pch.h"
+#include "HeapAllocator.h"
+#include "DescriptorAllocator.h"
+#include "DeferredReleaseQueue.h"
+#include "TransientResourceAllocator.h"
 
 using Microsoft::WRL::ComPtr;
 
 class GBuffer
 {
 public:
-	GBuffer(ID3D12Device* device, size_t newWidth = 800, size_t newHeight = 600);
+	GBuffer(ID3D12Device* device, DescriptorAllocator* descriptorAllocator, size_t newWidth = 800, size_t newHeight = 600);
+	// Creates G-buffer targets as placed resources from heap allocator
+	GBuffer(HeapAllocator* heapAllocator, DescriptorAllocator* descriptorAllocator, size_t newWidth = 800, size_t newHeight = 600);
+	// Declares G-buffer targets as transient resources alive from firstPass to lastPass.
+	// Call bindTransientTargets() after the transient allocator is compiled.
+	GBuffer(TransientResourceAllocator* transientAllocator, DescriptorAllocator* descriptorAllocator, UINT firstPass, UINT lastPass,
+		size_t newWidth = 800, size_t newHeight = 600);
 	~GBuffer();
 
 	inline ID3D12Resource* getAlbedo() const { return _albedo.Get(); }
@@ -19,30 +29,49 @@ public:
 	inline size_t getWidth() const { return _width; }
 	inline size_t getHeight() const { return _height; }
 
-	inline ID3D12DescriptorHeap* getSRVDescriptorHeap() const { return _SRVDescriptorHeap.Get(); }
-	inline ID3D12DescriptorHeap* getRTVDescriptorHeap() const { return _RTVDescriptorHeap.Get(); }
+	// albedo, normal, pos, shading, tangent
+	inline const DescriptorRange& getSRVDescriptors() const { return _SRVDescriptors; }
+	inline const DescriptorRange& getRTVDescriptors() const { return _RTVDescriptors; }
 
 	inline ID3D12RootSignature* getGBufferRootSignature() const { return _gBufferRootSignature.Get(); }
 	inline ID3D12RootSignature* getLightingRootSignature() const { return _lightingRootSignature.Get(); }
 
+	// With queue, old targets and descriptors are retired on resize instead of released (GPU doesn't need to be idle)
+	inline void setDeferredReleaseQueue(DeferredReleaseQueue* queue) { _deferredReleaseQueue = queue; }
+
 	void resize(size_t newWidth, size_t newHeight);
+	void bindTransientTargets();
 
 protected:
 	void makeGBufferResources();
-	void makeDescriptorHeaps();
+	void makeDescriptors();
 	void makeRootSignatures();
+	HRESULT makeRenderTarget(const D3D12_RESOURCE_DESC& resourceDesc, ComPtr<ID3D12Resource>& target, HeapAllocation& allocation);
+	void releaseGBufferResources();
 
 	ID3D12Device* _device;
+	HeapAllocator* _heapAllocator;
+	TransientResourceAllocator* _transientAllocator;
+	DescriptorAllocator* _descriptorAllocator;
+	DeferredReleaseQueue* _deferredReleaseQueue;
 
 private:
+	UINT64 _allocationSize(const D3D12_RESOURCE_DESC& resourceDesc) const;
+	void _retireDescriptors();
+
 	ComPtr<ID3D12Resource> _albedo;
 	ComPtr<ID3D12Resource> _normal;		// world-space
 	ComPtr<ID3D12Resource> _pos;		// world-space
 	ComPtr<ID3D12Resource> _shading;	// R:roughness,G:metalic,BA:todo
 	ComPtr<ID3D12Resource> _tangent;	// world-space
 
-	ComPtr<ID3D12DescriptorHeap> _SRVDescriptorHeap;	// SRV
-	ComPtr<ID3D12DescriptorHeap> _RTVDescriptorHeap;	// RTV
+	enum { kAlbedo, kNormal, kPos, kShading, kTangent, kTargetCount };
+	HeapAllocation _allocations[kTargetCount];
+	TransientResourceHandle _transientHandles[kTargetCount];
+	UINT _firstPass, _lastPass;
+
+	DescriptorRange _SRVDescriptors;	// persistent shader-visible
+	DescriptorRange _RTVDescriptors;	// staging
 
 	ComPtr<ID3D12RootSignature> _gBufferRootSignature;
 	ComPtr<ID3D12RootSignature> _lightingRootSignature;
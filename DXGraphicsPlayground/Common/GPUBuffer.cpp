@@ -5,7 +5,16 @@
 
 GPUBuffer::GPUBuffer(ID3D12Device* device, const size_t bufferSize, StorageMode storageMode) : GPUBuffer(device, bufferSize, 0, storageMode) { }
 
-GPUBuffer::GPUBuffer(ID3D12Device* device, const size_t bufferSize, const size_t alignment, StorageMode storageMode) : _bufferPointer(nullptr), _open(false) {
+GPUBuffer::GPUBuffer(ID3D12Device* device, const size_t bufferSize, const size_t alignment, StorageMode storageMode) : _heapAllocator(nullptr), _deferredReleaseQueue(nullptr), _bufferPointer(nullptr), _open(false), _writtenRange{ 0, 0 } {
+	_createBuffer(device, bufferSize, alignment, storageMode);
+}
+
+GPUBuffer::GPUBuffer(HeapAllocator* heapAllocator, const size_t bufferSize, const size_t alignment, StorageMode storageMode) : _heapAllocator(heapAllocator), _deferredReleaseQueue(nullptr), _bufferPointer(nullptr), _open(false), _writtenRange{ 0, 0 } {
+	assert(heapAllocator != nullptr && "Heap allocator is null.");
+	_createBuffer(heapAllocator->getDevice(), bufferSize, alignment, storageMode);
+}
+
+void GPUBuffer::_createBuffer(ID3D12Device* device, const size_t bufferSize, const size_t alignment, StorageMode storageMode) {
 	assert(device != nullptr && "Device is null.");
 
 	// adjust buffer size with alignment
@@ -35,12 +44,43 @@ GPUBuffer::GPUBuffer(ID3D12Device* device, const size_t bufferSize, const size_t
 	resourceDesc.SampleDesc.Count = 1;
 	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
 	
-	result = device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&_buffer));
+	if (_heapAllocator != nullptr)
+		result = _heapAllocator->createPlacedResource(heapProps.Type, resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, _heapAllocation, IID_PPV_ARGS(&_buffer));
+	else
+		result = device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&_buffer));
 	_storageMode = storageMode;
+
+	if (result >= 0)
+		AllocationRegistry::getShared().recordAllocation(_allocationCategory(), _allocationSize());
 }
 
 GPUBuffer::~GPUBuffer() {
 	close();
+
+	const AllocationCategory category = _allocationCategory();
+	const UINT64 allocationSize = _buffer != nullptr ? _allocationSize() : 0;
+	if (_deferredReleaseQueue == nullptr) {
+		if (_buffer != nullptr)
+			AllocationRegistry::getShared().recordFree(category, allocationSize);
+
+		// release resource before returning its memory to the heap
+		_buffer.Reset();
+		if (_heapAllocator != nullptr)
+			_heapAllocator->free(_heapAllocation);
+		return;
+	}
+
+	// placed memory is freed after resource, when frames using it are complete
+	HeapAllocator* heapAllocator = _heapAllocator;
+	ComPtr<ID3D12Resource> retiredBuffer = std::move(_buffer);
+	HeapAllocation retiredAllocation = _heapAllocation;
+	_deferredReleaseQueue->retire([heapAllocator, retiredBuffer, retiredAllocation, category, allocationSize]() mutable {
+		if (retiredBuffer != nullptr)
+			AllocationRegistry::getShared().recordFree(category, allocationSize);
+		retiredBuffer.Reset();
+		if (heapAllocator != nullptr)
+			heapAllocator->free(retiredAllocation);
+	});
 }
 
 void GPUBuffer::setName(std::wstring& name) {
@@ -54,8 +94,11 @@ bool GPUBuffer::open() {
 		return false;
 	}
 
-	HRESULT result = _buffer->Map(0, nullptr, &_bufferPointer);
+	// CPU never reads upload heap
+	D3D12_RANGE readRange{ 0, 0 };
+	HRESULT result = _buffer->Map(0, &readRange, &_bufferPointer);
 	_open = result >= 0;
+	_writtenRange = { 0, 0 };
 	if (!_open) {
 		std::wcerr << L"Failed to open buffer " << _name << L"." << std::endl;
 	}
@@ -64,8 +107,12 @@ bool GPUBuffer::open() {
 
 void GPUBuffer::close() {
 	if (_open) {
-		D3D12_RANGE writeRange{ 0, _alignedBufferSize };
-		_buffer->Unmap(0, &writeRange);
+		// only dirty range needs to be flushed
+		D3D12_RANGE writtenRange = _writtenRange;
+		if (writtenRange.Begin >= writtenRange.End)
+			writtenRange = { 0, 0 };
+		_buffer->Unmap(0, &writtenRange);
+		_writtenRange = { 0, 0 };
 		_open = false;
 	}
 }
@@ -73,10 +120,25 @@ void GPUBuffer::close() {
 void GPUBuffer::copy(void* ptr, const size_t length, const size_t offset) {
 	if (_open) {
 		if (_alignedBufferSize < length + offset) {
-			std::cerr << "Out of range (" << _alignedBufferSize << " < " + (length + offset) << ")." << std::endl;
+			std::cerr << "Out of range (" << _alignedBufferSize << " < " << (length + offset) << ")." << std::endl;
 			return;
 		}
 
 		memcpy(static_cast<UINT8*>(_bufferPointer) + offset, ptr, length);
+		markWritten(offset, length);
+	}
+}
+
+void GPUBuffer::markWritten(const size_t offset, const size_t length) {
+	if (length == 0)
+		return;
+
+	assert(offset + length <= _alignedBufferSize && "Written range is out of buffer.");
+	if (_writtenRange.Begin >= _writtenRange.End) {
+		_writtenRange = { offset, offset + length };
+	}
+	else {
+		_writtenRange.Begin = min(_writtenRange.Begin, offset);
+		_writtenRange.End = max(_writtenRange.End, offset + length);
 	}
 }
\ No newline at end of file
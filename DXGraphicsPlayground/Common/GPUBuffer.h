@@ -1,6 +1,9 @@
 #pragma once
 
 #include "pch.h"
+#include "HeapAllocator.h"
+#include "AllocationRegistry.h"
+#include "DeferredReleaseQueue.h"
 #include <string>
 
 using Microsoft::WRL::ComPtr;
@@ -14,6 +17,9 @@ class GPUBuffer {
 public:
 	GPUBuffer(ID3D12Device* device, const size_t bufferSize, StorageMode storageMode = StorageMode::Managed);
 	GPUBuffer(ID3D12Device* device, const size_t bufferSize, const size_t alignment, StorageMode storageMode = StorageMode::Managed);
+	// Creates placed buffer from heap allocator
+	GPUBuffer(HeapAllocator* heapAllocator, const size_t bufferSize, const size_t alignment, StorageMode storageMode = StorageMode::Managed);
+	// Without deferred release queue, GPU must be done with the buffer before it's destroyed
 	~GPUBuffer();
 
 	// Properties
@@ -21,20 +27,35 @@ public:
 	const size_t getAlignment() const { return _alignment; }
 	const size_t getAlignedBufferSize() const { return _alignedBufferSize; }
 	StorageMode getStorageMode() const { return _storageMode; }
+	const HeapAllocation& getHeapAllocation() const { return _heapAllocation; }
+	void* getMappedPointer() const { return _open ? _bufferPointer : nullptr; }
 	const std::wstring& getName() const { return _name; }
 	void setName(std::wstring& name);
+	// With queue, resource and its heap range are retired on destruction instead of released (GPU doesn't need to be idle)
+	void setDeferredReleaseQueue(DeferredReleaseQueue* queue) { _deferredReleaseQueue = queue; }
 
 	// Data management
 	bool open();
 	void close();
 	void copy(void* from, const size_t length, const size_t offset = 0);
+	// Records CPU writes made through mapped pointer, so close() only flushes dirty range
+	void markWritten(const size_t offset, const size_t length);
+	const D3D12_RANGE& getWrittenRange() const { return _writtenRange; }
 
 private:
+	void _createBuffer(ID3D12Device* device, const size_t bufferSize, const size_t alignment, StorageMode storageMode);
+	AllocationCategory _allocationCategory() const { return _storageMode == StorageMode::Managed ? AllocationCategory::Upload : AllocationCategory::Buffer; }
+	UINT64 _allocationSize() const { return _heapAllocation.isValid() ? _heapAllocation.size : _alignedBufferSize; }
+
 	ComPtr<ID3D12Resource> _buffer;
+	HeapAllocator* _heapAllocator;
+	HeapAllocation _heapAllocation;
+	DeferredReleaseQueue* _deferredReleaseQueue;
 	void* _bufferPointer;
 	size_t _alignment;
 	size_t _alignedBufferSize;
 	StorageMode _storageMode;
 	std::wstring _name;
 	bool _open;
+	D3D12_RANGE _writtenRange;		// dirty range since open(), empty if Begin >= End
 };
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "GPUBuffer.h"
+#include <cassert>
+#include <utility>
+
+// Typed view of mapped GPUBuffer memory.
+// Elements are written directly into the buffer, and written range is reported to the buffer
+// when the view is committed or destroyed, so close() only flushes dirty range.
+template<typename T>
+class GPUBufferView {
+public:
+	GPUBufferView() : _buffer(nullptr), _pointer(nullptr), _offset(0), _count(0), _writtenBegin(0), _writtenEnd(0) {}
+	GPUBufferView(GPUBuffer* buffer, const size_t offset = 0, const size_t count = 1)
+		: _buffer(buffer), _pointer(nullptr), _offset(offset), _count(count), _writtenBegin(0), _writtenEnd(0)
+	{
+		assert(buffer != nullptr && "Buffer is null.");
+		assert(offset + sizeof(T) * count <= buffer->getAlignedBufferSize() && "View is out of buffer.");
+		UINT8* mappedPointer = static_cast<UINT8*>(buffer->getMappedPointer());
+		assert(mappedPointer != nullptr && "Buffer is not opened.");
+		if (mappedPointer != nullptr)
+			_pointer = reinterpret_cast<T*>(mappedPointer + offset);
+	}
+	GPUBufferView(GPUBufferView&& other) : GPUBufferView() {
+		*this = std::move(other);
+	}
+	~GPUBufferView() {
+		commit();
+	}
+
+	GPUBufferView& operator=(GPUBufferView&& other) {
+		if (this != &other) {
+			commit();
+			_buffer = other._buffer;
+			_pointer = other._pointer;
+			_offset = other._offset;
+			_count = other._count;
+			_writtenBegin = other._writtenBegin;
+			_writtenEnd = other._writtenEnd;
+			other._buffer = nullptr;
+			other._pointer = nullptr;
+			other._count = 0;
+			other._writtenBegin = other._writtenEnd = 0;
+		}
+		return *this;
+	}
+	GPUBufferView(const GPUBufferView&) = delete;
+	GPUBufferView& operator=(const GPUBufferView&) = delete;
+
+	// Properties
+	bool isValid() const { return _pointer != nullptr; }
+	size_t size() const { return _count; }
+	size_t getOffset() const { return _offset; }
+	D3D12_GPU_VIRTUAL_ADDRESS getGPUVirtualAddress(const size_t index = 0) const {
+		return _buffer->getResource()->GetGPUVirtualAddress() + _offset + sizeof(T) * index;
+	}
+
+	// Writing (mapped memory is write-combined, so don't read from it)
+	T& operator[](const size_t index) {
+		markWritten(index, 1);
+		return _pointer[index];
+	}
+	void write(const size_t index, const T& value) {
+		markWritten(index, 1);
+		_pointer[index] = value;
+	}
+	// Returns raw pointer for bulk writes, caller must mark written elements
+	T* data() { return _pointer; }
+	void markWritten(const size_t index, const size_t count) {
+		assert(index + count <= _count && "Index is out of view.");
+		if (_writtenBegin >= _writtenEnd) {
+			_writtenBegin = index;
+			_writtenEnd = index + count;
+		}
+		else {
+			_writtenBegin = index < _writtenBegin ? index : _writtenBegin;
+			_writtenEnd = index + count > _writtenEnd ? index + count : _writtenEnd;
+		}
+	}
+
+	// Reports written range to the buffer
+	void commit() {
+		if (_buffer != nullptr && _writtenBegin < _writtenEnd)
+			_buffer->markWritten(_offset + sizeof(T) * _writtenBegin, sizeof(T) * (_writtenEnd - _writtenBegin));
+		_writtenBegin = _writtenEnd = 0;
+	}
+
+private:
+	GPUBuffer* _buffer;
+	T* _pointer;
+	size_t _offset;
+	size_t _count;
+	size_t _writtenBegin, _writtenEnd;	// in elements
+};
@@ -0,0 +1,94 @@
+#include "pch.h"
+#include "Hash.h"
+#include <cstring>
+
+namespace {
+	constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+	constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+	inline uint64_t _rotateLeft(uint64_t value, int bits) {
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	// unaligned little-endian reads
+	inline uint64_t _read64(const uint8_t* data) {
+		uint64_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	inline uint32_t _read32(const uint8_t* data) {
+		uint32_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	inline uint64_t _round(uint64_t accumulator, uint64_t input) {
+		accumulator += input * kPrime2;
+		accumulator = _rotateLeft(accumulator, 31);
+		return accumulator * kPrime1;
+	}
+
+	inline uint64_t _mergeRound(uint64_t accumulator, uint64_t value) {
+		accumulator ^= _round(0, value);
+		return accumulator * kPrime1 + kPrime4;
+	}
+}
+
+uint64_t Hash::xxHash64(const void* data, size_t size, uint64_t seed) {
+	const uint8_t* input = static_cast<const uint8_t*>(data);
+	const uint8_t* const end = input + size;
+	uint64_t hash;
+
+	// 4 lanes of 8 bytes per stripe
+	if (size >= 32) {
+		const uint8_t* const limit = end - 32;
+		uint64_t v1 = seed + kPrime1 + kPrime2;
+		uint64_t v2 = seed + kPrime2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - kPrime1;
+		do {
+			v1 = _round(v1, _read64(input));
+			v2 = _round(v2, _read64(input + 8));
+			v3 = _round(v3, _read64(input + 16));
+			v4 = _round(v4, _read64(input + 24));
+			input += 32;
+		} while (input <= limit);
+
+		hash = _rotateLeft(v1, 1) + _rotateLeft(v2, 7) + _rotateLeft(v3, 12) + _rotateLeft(v4, 18);
+		hash = _mergeRound(hash, v1);
+		hash = _mergeRound(hash, v2);
+		hash = _mergeRound(hash, v3);
+		hash = _mergeRound(hash, v4);
+	}
+	else {
+		hash = seed + kPrime5;
+	}
+	hash += static_cast<uint64_t>(size);
+
+	// remaining bytes
+	for (; input + 8 <= end; input += 8) {
+		hash ^= _round(0, _read64(input));
+		hash = _rotateLeft(hash, 27) * kPrime1 + kPrime4;
+	}
+	if (input + 4 <= end) {
+		hash ^= static_cast<uint64_t>(_read32(input)) * kPrime1;
+		hash = _rotateLeft(hash, 23) * kPrime2 + kPrime3;
+		input += 4;
+	}
+	for (; input < end; input++) {
+		hash ^= (*input) * kPrime5;
+		hash = _rotateLeft(hash, 11) * kPrime1;
+	}
+
+	// avalanche
+	hash ^= hash >> 33;
+	hash *= kPrime2;
+	hash ^= hash >> 29;
+	hash *= kPrime3;
+	hash ^= hash >> 32;
+	return hash;
+}
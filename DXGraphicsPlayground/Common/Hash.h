@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Non-cryptographic hashes for content keys.
+namespace Hash {
+	// xxHash64 (same result as XXH64() of reference implementation), around memory bandwidth on large inputs
+	uint64_t xxHash64(const void* data, size_t size, uint64_t seed = 0);
+}
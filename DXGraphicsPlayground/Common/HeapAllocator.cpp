@@ -0,0 +1,205 @@
+#include "pch.h"
+#include "HeapAllocator.h"
+#include <cassert>
+#include <iostream>
+
+HeapAllocator::HeapAllocator(ID3D12Device* device, UINT64 blockSize)
+	: _device(device), _blockSize(blockSize)
+{
+	assert(_device != nullptr && "Device is null.");
+
+	const D3D12_HEAP_TYPE heapTypes[kHeapTypeCount] = { D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_TYPE_READBACK };
+	for (UINT32 i = 0; i < kHeapTypeCount; i++) {
+		for (UINT32 k = 0; k < static_cast<UINT32>(HeapResourceKind::Count); k++) {
+			Pool& pool = _pools[_poolIndex(heapTypes[i], static_cast<HeapResourceKind>(k))];
+			pool.heapType = heapTypes[i];
+			pool.kind = static_cast<HeapResourceKind>(k);
+		}
+	}
+}
+
+HeapAllocator::~HeapAllocator() {
+	// do nothing (heaps are released by ComPtr)
+}
+
+HeapResourceKind HeapAllocator::_resourceKind(const D3D12_RESOURCE_DESC& resourceDesc) {
+	if (resourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+		return HeapResourceKind::Buffer;
+	if (resourceDesc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+		return HeapResourceKind::RenderTarget;
+	return HeapResourceKind::Texture;
+}
+
+UINT32 HeapAllocator::_poolIndex(D3D12_HEAP_TYPE heapType, HeapResourceKind kind) {
+	UINT32 heapTypeIndex = 0;
+	switch (heapType) {
+	case D3D12_HEAP_TYPE_UPLOAD:
+		heapTypeIndex = 1;
+		break;
+	case D3D12_HEAP_TYPE_READBACK:
+		heapTypeIndex = 2;
+		break;
+	default:
+		heapTypeIndex = 0;
+		break;
+	}
+	return heapTypeIndex * static_cast<UINT32>(HeapResourceKind::Count) + static_cast<UINT32>(kind);
+}
+
+bool HeapAllocator::_addBlock(Pool& pool, UINT64 minimumSize) {
+	UINT64 heapSize = _blockSize;
+	while (heapSize < minimumSize)
+		heapSize <<= 1;
+
+	D3D12_HEAP_DESC heapDesc{};
+	heapDesc.SizeInBytes = heapSize;
+	heapDesc.Properties.Type = pool.heapType;
+	heapDesc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	heapDesc.Properties.CreationNodeMask = 1;
+	heapDesc.Properties.VisibleNodeMask = 1;
+	heapDesc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+	switch (pool.kind) {
+	case HeapResourceKind::Buffer:
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+		break;
+	case HeapResourceKind::Texture:
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+		break;
+	default:
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+		break;
+	}
+
+	ComPtr<ID3D12Heap> heap;
+	HRESULT result = _device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap));
+	if (result < 0) {
+		std::cerr << "Failed to create heap block (" << heapSize << " bytes)!" << std::endl;
+		return false;
+	}
+
+	Block block;
+	block.heap = heap;
+	block.allocator = std::make_unique<BuddyAllocator>(heapSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+
+	// reuse released block slot so that indices of live allocations stay valid
+	for (Block& slot : pool.blocks) {
+		if (slot.heap == nullptr) {
+			slot = std::move(block);
+			return true;
+		}
+	}
+	pool.blocks.push_back(std::move(block));
+	return true;
+}
+
+HeapAllocation HeapAllocator::allocate(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& resourceDesc) {
+	HeapAllocation allocation{};
+	D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = _device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+	if (allocationInfo.SizeInBytes == UINT64_MAX) {
+		std::cerr << "Invalid resource description for heap allocation!" << std::endl;
+		return allocation;
+	}
+
+	const UINT32 poolIndex = _poolIndex(heapType, _resourceKind(resourceDesc));
+	Pool& pool = _pools[poolIndex];
+
+	// try existing blocks first, then add a new one
+	for (int attempt = 0; attempt < 2; attempt++) {
+		for (UINT32 blockIndex = 0; blockIndex < pool.blocks.size(); blockIndex++) {
+			Block& block = pool.blocks[blockIndex];
+			if (block.heap == nullptr)
+				continue;
+
+			UINT64 offset = block.allocator->allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+			if (offset != BuddyAllocator::kInvalidOffset) {
+				allocation.heap = block.heap.Get();
+				allocation.offset = offset;
+				allocation.size = allocationInfo.SizeInBytes;
+				allocation.poolIndex = poolIndex;
+				allocation.blockIndex = blockIndex;
+				return allocation;
+			}
+		}
+
+		if (attempt == 0 && _addBlock(pool, allocationInfo.SizeInBytes) == false)
+			break;
+	}
+	return allocation;
+}
+
+void HeapAllocator::free(HeapAllocation& allocation) {
+	if (allocation.isValid() == false)
+		return;
+
+	Pool& pool = _pools[allocation.poolIndex];
+	Block& block = pool.blocks[allocation.blockIndex];
+	assert(block.heap.Get() == allocation.heap && "Allocation doesn't belong to this allocator.");
+	block.allocator->free(allocation.offset);
+
+	// release empty block unless it's the last one of pool
+	if (block.allocator->isEmpty()) {
+		UINT32 liveBlockCount = 0;
+		for (const Block& b : pool.blocks)
+			liveBlockCount += b.heap != nullptr ? 1 : 0;
+		if (liveBlockCount > 1) {
+			block.heap.Reset();
+			block.allocator.reset();
+		}
+	}
+	allocation = HeapAllocation{};
+}
+
+HRESULT HeapAllocator::createPlacedResource(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& resourceDesc, D3D12_RESOURCE_STATES initialState,
+	const D3D12_CLEAR_VALUE* optimizedClearValue, HeapAllocation& outAllocation, REFIID riid, void** resource) {
+	outAllocation = allocate(heapType, resourceDesc);
+	if (outAllocation.isValid() == false)
+		return E_OUTOFMEMORY;
+
+	HRESULT result = _device->CreatePlacedResource(outAllocation.heap, outAllocation.offset, &resourceDesc, initialState, optimizedClearValue, riid, resource);
+	if (result < 0)
+		free(outAllocation);
+	return result;
+}
+
+HeapAllocator::Statistics HeapAllocator::getStatistics(D3D12_HEAP_TYPE heapType, HeapResourceKind kind) const {
+	Statistics statistics{};
+	UINT64 freeSize = 0;
+	const Pool& pool = _pools[_poolIndex(heapType, kind)];
+	for (const Block& block : pool.blocks) {
+		if (block.heap == nullptr)
+			continue;
+
+		BuddyAllocator::Statistics blockStatistics = block.allocator->getStatistics();
+		statistics.blockCount++;
+		statistics.reservedSize += blockStatistics.capacity;
+		statistics.allocatedSize += blockStatistics.allocatedSize;
+		statistics.requestedSize += blockStatistics.requestedSize;
+		statistics.allocationCount += blockStatistics.allocationCount;
+		statistics.freeBlockCount += blockStatistics.freeBlockCount;
+		statistics.largestFreeBlockSize = max(statistics.largestFreeBlockSize, blockStatistics.largestFreeBlockSize);
+		freeSize += blockStatistics.capacity - blockStatistics.allocatedSize;
+	}
+	statistics.fragmentation = freeSize > 0 ? 1.0f - static_cast<float>(statistics.largestFreeBlockSize) / freeSize : 0.0f;
+	return statistics;
+}
+
+void HeapAllocator::printStatistics(std::ostream& stream) const {
+	const char* heapTypeNames[kHeapTypeCount] = { "Default", "Upload", "Readback" };
+	const D3D12_HEAP_TYPE heapTypes[kHeapTypeCount] = { D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_TYPE_READBACK };
+	const char* kindNames[] = { "buffer", "texture", "render target" };
+
+	stream << "Heap Allocator Statistics" << std::endl;
+	for (UINT32 i = 0; i < kHeapTypeCount; i++) {
+		for (UINT32 k = 0; k < static_cast<UINT32>(HeapResourceKind::Count); k++) {
+			Statistics statistics = getStatistics(heapTypes[i], static_cast<HeapResourceKind>(k));
+			if (statistics.blockCount == 0)
+				continue;
+
+			stream << "- " << heapTypeNames[i] << " " << kindNames[k] << " : "
+				<< statistics.allocationCount << " allocations, "
+				<< statistics.allocatedSize << " / " << statistics.reservedSize << " bytes in " << statistics.blockCount << " blocks, "
+				<< "fragmentation " << statistics.fragmentation * 100.0f << "%" << std::endl;
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "pch.h"
+#include "BuddyAllocator.h"
+#include <memory>
+#include <vector>
+#include <ostream>
+
+using Microsoft::WRL::ComPtr;
+
+// Kind of resources which can be placed in the same heap (resource heap tier 1)
+enum class HeapResourceKind {
+	Buffer,
+	Texture,
+	RenderTarget,	// render target and depth stencil textures
+	Count
+};
+
+struct HeapAllocation {
+	ID3D12Heap* heap = nullptr;
+	UINT64 offset = 0;
+	UINT64 size = 0;
+	UINT32 poolIndex = 0;
+	UINT32 blockIndex = 0;
+
+	bool isValid() const { return heap != nullptr; }
+};
+
+// Sub-allocates placed resources from large ID3D12Heap blocks, pooled by heap type and resource kind.
+class HeapAllocator
+{
+public:
+	struct Statistics {
+		UINT64 blockCount;
+		UINT64 reservedSize;		// sum of heap block sizes
+		UINT64 allocatedSize;
+		UINT64 requestedSize;
+		UINT64 allocationCount;
+		UINT64 freeBlockCount;
+		UINT64 largestFreeBlockSize;
+		float fragmentation;		// 1 - (largest free block / total free size)
+	};
+
+	HeapAllocator(ID3D12Device* device, UINT64 blockSize = kDefaultBlockSize);
+	~HeapAllocator();
+
+	// Properties
+	ID3D12Device* getDevice() const { return _device; }
+	UINT64 getBlockSize() const { return _blockSize; }
+
+	// Allocation
+	HeapAllocation allocate(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& resourceDesc);
+	void free(HeapAllocation& allocation);
+	HRESULT createPlacedResource(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& resourceDesc, D3D12_RESOURCE_STATES initialState,
+		const D3D12_CLEAR_VALUE* optimizedClearValue, HeapAllocation& outAllocation, REFIID riid, void** resource);
+
+	// Statistics
+	Statistics getStatistics(D3D12_HEAP_TYPE heapType, HeapResourceKind kind) const;
+	void printStatistics(std::ostream& stream) const;
+
+private:
+	static constexpr UINT64 kDefaultBlockSize = 64 * 1024 * 1024;
+	static constexpr UINT32 kHeapTypeCount = 3;		// default, upload, readback
+
+	struct Block {
+		ComPtr<ID3D12Heap> heap;
+		std::unique_ptr<BuddyAllocator> allocator;
+	};
+	struct Pool {
+		D3D12_HEAP_TYPE heapType;
+		HeapResourceKind kind;
+		std::vector<Block> blocks;
+	};
+
+	static HeapResourceKind _resourceKind(const D3D12_RESOURCE_DESC& resourceDesc);
+	static UINT32 _poolIndex(D3D12_HEAP_TYPE heapType, HeapResourceKind kind);
+	bool _addBlock(Pool& pool, UINT64 minimumSize);
+
+	ID3D12Device* _device;
+	UINT64 _blockSize;
+	Pool _pools[kHeapTypeCount * static_cast<UINT32>(HeapResourceKind::Count)];
+};
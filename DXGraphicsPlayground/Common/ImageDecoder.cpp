@@ -0,0 +1,223 @@
+#include "pch.h"
+#include "ImageDecoder.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+	// Memory reserved by worker thread for output of current decode.
+	// stb_image allocates its result with STBI_MALLOC, so the allocation of matching size is redirected here
+	// and pixels are decoded in place without an intermediate buffer.
+	struct _OutputReservation {
+		unsigned char* memory;
+		size_t minSize;			// size of decoded pixels
+		size_t capacity;		// some decoders ask for a few extra bytes
+		bool isTaken;
+	};
+	thread_local _OutputReservation* _reservation = nullptr;
+
+	void* _stbiMalloc(size_t size) {
+		_OutputReservation* reservation = _reservation;
+		if (reservation != nullptr && reservation->isTaken == false && size >= reservation->minSize && size <= reservation->capacity) {
+			reservation->isTaken = true;
+			return reservation->memory;
+		}
+		return malloc(size);
+	}
+
+	void* _stbiRealloc(void* pointer, size_t size) {
+		_OutputReservation* reservation = _reservation;
+		if (reservation != nullptr && pointer != nullptr && pointer == reservation->memory) {
+			if (size <= reservation->capacity)
+				return pointer;
+			// grows out of reservation (original stays valid on failure)
+			void* newPointer = malloc(size);
+			if (newPointer != nullptr) {
+				memcpy(newPointer, pointer, reservation->capacity);
+				reservation->isTaken = false;
+			}
+			return newPointer;
+		}
+		return realloc(pointer, size);
+	}
+
+	void _stbiFree(void* pointer) {
+		_OutputReservation* reservation = _reservation;
+		if (reservation != nullptr && pointer != nullptr && pointer == reservation->memory) {
+			reservation->isTaken = false;
+			return;
+		}
+		free(pointer);
+	}
+}
+
+#define STBI_MALLOC(size) _stbiMalloc(size)
+#define STBI_REALLOC(pointer, size) _stbiRealloc(pointer, size)
+#define STBI_FREE(pointer) _stbiFree(pointer)
+#define STB_IMAGE_IMPLEMENTATION 1
+#include "stb_image.h"
+
+void DecodedImage::PixelDeleter::operator()(unsigned char* pixels) const {
+	stbi_image_free(pixels);
+}
+
+ImageDecoder::ImageDecoder(uint32_t threadCount)
+	: _nextJobId(1), _runningCount(0), _quit(false)
+{
+	if (threadCount == 0)
+		threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0)
+		threadCount = 1;
+
+	for (uint32_t i = 0; i < threadCount; i++)
+		_workers.emplace_back(&ImageDecoder::_workerMain, this);
+}
+
+ImageDecoder::~ImageDecoder() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_quit = true;
+		_jobs.clear();
+	}
+	_jobCondition.notify_all();
+	for (std::thread& worker : _workers)
+		worker.join();
+}
+
+size_t ImageDecoder::getPendingCount() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _jobs.size() + _runningCount;
+}
+
+uint32_t ImageDecoder::decode(std::vector<unsigned char>&& encoded, const std::string& name, int requestedChannels, bool flipVertically,
+	DecodeTarget target) {
+	Job job;
+	job.path = name;
+	job.encoded = std::move(encoded);
+	job.requestedChannels = requestedChannels;
+	job.flipVertically = flipVertically;
+	job.target = target;
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	job.id = _nextJobId++;
+	const uint32_t jobId = job.id;
+	_jobs.push_back(std::move(job));
+	lock.unlock();
+	_jobCondition.notify_one();
+	return jobId;
+}
+
+uint32_t ImageDecoder::decodeFile(const std::string& path, int requestedChannels, bool flipVertically, DecodeTarget target) {
+	return decode(std::vector<unsigned char>(), path, requestedChannels, flipVertically, target);
+}
+
+bool ImageDecoder::tryPop(DecodedImage& image) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_results.empty())
+		return false;
+	image = std::move(_results.front());
+	_results.pop_front();
+	return true;
+}
+
+void ImageDecoder::waitAll() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	_completeCondition.wait(lock, [this] { return _jobs.empty() && _runningCount == 0; });
+}
+
+void ImageDecoder::_workerMain() {
+	for (;;) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_jobCondition.wait(lock, [this] { return _quit || _jobs.empty() == false; });
+			if (_quit)
+				return;
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+			_runningCount++;
+		}
+
+		DecodedImage image;
+		_decode(job, image);
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_results.push_back(std::move(image));
+			_runningCount--;
+		}
+		_completeCondition.notify_all();
+	}
+}
+
+void ImageDecoder::_decode(Job& job, DecodedImage& image) {
+	image.jobId = job.id;
+	image.name = job.path;
+
+	if (job.encoded.empty()) {
+		std::ifstream file(job.path, std::ios::binary);
+		if (file.is_open() == false) {
+			image.error = "Can't open file";
+			return;
+		}
+		job.encoded.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	if (job.encoded.empty()) {
+		image.error = "Empty image data";
+		return;
+	}
+
+	// flip flag is per thread, so workers don't affect each other
+	stbi_set_flip_vertically_on_load_thread(job.flipVertically ? 1 : 0);
+	if (job.target == DecodeTarget::MipChain && (job.requestedChannels == 1 || job.requestedChannels == 4)) {
+		_decodeIntoMipChain(job, image);
+		return;
+	}
+
+	unsigned char* pixels = stbi_load_from_memory(job.encoded.data(), static_cast<int>(job.encoded.size()),
+		&image.width, &image.height, &image.sourceChannels, job.requestedChannels);
+	if (pixels == nullptr) {
+		const char* reason = stbi_failure_reason();
+		image.error = reason != nullptr ? reason : "Unknown error";
+		return;
+	}
+	image.channels = job.requestedChannels != 0 ? job.requestedChannels : image.sourceChannels;
+	image.pixels.reset(pixels);
+}
+
+void ImageDecoder::_decodeIntoMipChain(Job& job, DecodedImage& image) {
+	const stbi_uc* encoded = job.encoded.data();
+	const int encodedSize = static_cast<int>(job.encoded.size());
+
+	// reserve chain from header before decoding
+	int width = 0, height = 0, sourceChannels = 0;
+	if (stbi_info_from_memory(encoded, encodedSize, &width, &height, &sourceChannels) == 0) {
+		const char* reason = stbi_failure_reason();
+		image.error = reason != nullptr ? reason : "Unknown error";
+		return;
+	}
+	MipChain& chain = image.mipChain;
+	MipGenerator::reserve(width, height, job.requestedChannels == 1 ? MipFormat::R8 : MipFormat::RGBA8, chain);
+
+	_OutputReservation reservation{ chain.data.data(), chain.levels[0].size, chain.data.size(), false };
+	_reservation = &reservation;
+	unsigned char* pixels = stbi_load_from_memory(encoded, encodedSize, &image.width, &image.height, &image.sourceChannels, job.requestedChannels);
+	_reservation = nullptr;
+
+	if (pixels == nullptr || image.width != width || image.height != height) {
+		const char* reason = pixels == nullptr ? stbi_failure_reason() : "Image size doesn't match header";
+		image.error = reason != nullptr ? reason : "Unknown error";
+		if (pixels != nullptr && pixels != reservation.memory)
+			stbi_image_free(pixels);
+		image.mipChain = MipChain();
+		return;
+	}
+	image.channels = job.requestedChannels;
+
+	// result came from a buffer allocated before the reservation was free (e.g. channel conversion)
+	if (pixels != reservation.memory) {
+		memcpy(chain.getLevelData(0), pixels, chain.levels[0].size);
+		stbi_image_free(pixels);
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "MipGenerator.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Where decoder writes pixels
+enum class DecodeTarget {
+	Pixels,			// buffer allocated by stb_image
+	MipChain		// level 0 of reserved mip chain (1 or 4 channels only, others fall back to Pixels)
+};
+
+// Decoded 8-bit image. Pixels are owned by stb_image and handed over without copy.
+// With DecodeTarget::MipChain, pixels are decoded in place into level 0 of mipChain instead,
+// and remaining levels are left for MipGenerator::generateLevels().
+struct DecodedImage {
+	struct PixelDeleter {
+		void operator()(unsigned char* pixels) const;
+	};
+
+	uint32_t jobId = 0;
+	std::string name;
+	int width = 0;
+	int height = 0;
+	int channels = 0;			// channels of pixels (requested channels, or source channels if 0 was requested)
+	int sourceChannels = 0;		// channels stored in encoded image
+	std::unique_ptr<unsigned char, PixelDeleter> pixels;
+	MipChain mipChain;			// format is R8 or RGBA8 (can be changed to RGBA8_SRGB before generating levels)
+	std::string error;
+
+	bool isValid() const { return pixels != nullptr || mipChain.levels.empty() == false; }
+	const unsigned char* getPixels() const { return pixels != nullptr ? pixels.get() : (mipChain.levels.empty() ? nullptr : mipChain.getLevelData(0)); }
+	size_t getRowPitch() const { return static_cast<size_t>(width) * channels; }
+	size_t getSize() const { return getRowPitch() * height; }
+};
+
+// Decodes JPEG/PNG/... images with stb_image on worker threads.
+// Completed images are polled with tryPop() in completion order.
+class ImageDecoder
+{
+public:
+	// threadCount 0 uses hardware concurrency
+	ImageDecoder(uint32_t threadCount = 0);
+	~ImageDecoder();
+
+	ImageDecoder(const ImageDecoder&) = delete;
+	ImageDecoder& operator=(const ImageDecoder&) = delete;
+
+	// Properties
+	uint32_t getThreadCount() const { return static_cast<uint32_t>(_workers.size()); }
+	size_t getPendingCount() const;
+
+	// Requests (return job id)
+	uint32_t decode(std::vector<unsigned char>&& encoded, const std::string& name, int requestedChannels = 4, bool flipVertically = true,
+		DecodeTarget target = DecodeTarget::Pixels);
+	uint32_t decodeFile(const std::string& path, int requestedChannels = 4, bool flipVertically = true,
+		DecodeTarget target = DecodeTarget::Pixels);
+
+	// Results
+	bool tryPop(DecodedImage& image);
+	// Blocks until all requested jobs are complete
+	void waitAll();
+
+private:
+	struct Job {
+		uint32_t id;
+		std::string path;					// read by worker if encoded data is empty
+		std::vector<unsigned char> encoded;
+		int requestedChannels;
+		bool flipVertically;
+		DecodeTarget target;
+	};
+
+	void _workerMain();
+	static void _decode(Job& job, DecodedImage& image);
+	static void _decodeIntoMipChain(Job& job, DecodedImage& image);
+
+	std::vector<std::thread> _workers;
+	mutable std::mutex _mutex;
+	std::condition_variable _jobCondition;
+	std::condition_variable _completeCondition;
+	std::deque<Job> _jobs;
+	std::deque<DecodedImage> _results;
+	uint32_t _nextJobId;
+	size_t _runningCount;
+	bool _quit;
+};
@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+MappedFile::MappedFile() : _data(nullptr), _size(0), _file(INVALID_HANDLE_VALUE), _mapping(nullptr) {}
+#else
+MappedFile::MappedFile() : _data(nullptr), _size(0), _file(-1) {}
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+bool MappedFile::open(const std::string& path) {
+	close();
+
+#if defined(_WIN32)
+	_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize{};
+	if (GetFileSizeEx(_file, &fileSize) == FALSE || fileSize.QuadPart == 0) {
+		close();
+		return false;
+	}
+
+	_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping == nullptr) {
+		close();
+		return false;
+	}
+	_data = static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	_file = ::open(path.c_str(), O_RDONLY);
+	if (_file < 0)
+		return false;
+
+	struct stat fileStat {};
+	if (fstat(_file, &fileStat) != 0 || fileStat.st_size == 0) {
+		close();
+		return false;
+	}
+
+	void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, _file, 0);
+	_data = data != MAP_FAILED ? static_cast<const uint8_t*>(data) : nullptr;
+	_size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+	if (_data == nullptr) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() {
+#if defined(_WIN32)
+	if (_data != nullptr)
+		UnmapViewOfFile(_data);
+	if (_mapping != nullptr)
+		CloseHandle(_mapping);
+	if (_file != INVALID_HANDLE_VALUE)
+		CloseHandle(_file);
+	_mapping = nullptr;
+	_file = INVALID_HANDLE_VALUE;
+#else
+	if (_data != nullptr)
+		munmap(const_cast<uint8_t*>(_data), _size);
+	if (_file >= 0)
+		::close(_file);
+	_file = -1;
+#endif
+	_data = nullptr;
+	_size = 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory-mapped file.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+
+	// Properties
+	bool isOpen() const { return _data != nullptr; }
+	const uint8_t* getData() const { return _data; }
+	size_t getSize() const { return _size; }
+
+private:
+	const uint8_t* _data;
+	size_t _size;
+#if defined(_WIN32)
+	void* _file;
+	void* _mapping;
+#else
+	int _file;
+#endif
+};
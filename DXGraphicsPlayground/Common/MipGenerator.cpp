@@ -0,0 +1,532 @@
+#include "pch.h"
+#include "MipGenerator.h"
+#include "ParallelFor.h"
+#include "PitchedCopy.h"
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MIP_GENERATOR_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define MIP_GENERATOR_TARGET_AVX
+#else
+#define MIP_GENERATOR_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+namespace {
+	// rows are not split across threads unless each thread gets this many multiply-adds
+	constexpr size_t kMinWorkPerThread = 1 << 16;
+	// linear to sRGB table resolution (error is below 0.3 steps of 8-bit sRGB)
+	constexpr uint32_t kLinearToSRGBTableSize = 16384;
+	constexpr float kPi = 3.14159265358979f;
+
+	// Filter weights of one dimension. Each output pixel has same number of taps (padded with zero weights).
+	struct FilterTaps {
+		uint32_t tapCount = 0;
+		std::vector<uint32_t> indices;		// clamped source index per tap
+		std::vector<float> weights;
+	};
+
+	struct ConversionTables {
+		float unormToFloat[256];
+		float srgbToLinear[256];
+		uint8_t linearToSRGB[kLinearToSRGBTableSize];
+
+		ConversionTables() {
+			for (uint32_t i = 0; i < 256; i++) {
+				const float value = i / 255.0f;
+				unormToFloat[i] = value;
+				srgbToLinear[i] = value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+			}
+			for (uint32_t i = 0; i < kLinearToSRGBTableSize; i++) {
+				const float value = static_cast<float>(i) / (kLinearToSRGBTableSize - 1);
+				const float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+				linearToSRGB[i] = static_cast<uint8_t>(srgb * 255.0f + 0.5f);
+			}
+		}
+	};
+
+	const ConversionTables& _getConversionTables() {
+		static const ConversionTables tables;
+		return tables;
+	}
+
+	float _sinc(float x) {
+		if (fabsf(x) < 1e-5f)
+			return 1.0f;
+		return sinf(kPi * x) / (kPi * x);
+	}
+
+	// zeroth order modified Bessel function of the first kind
+	float _besselI0(float x) {
+		float sum = 1.0f, term = 1.0f;
+		const float halfSquared = x * x * 0.25f;
+		for (int k = 1; k < 32; k++) {
+			term *= halfSquared / (static_cast<float>(k) * k);
+			sum += term;
+			if (term < sum * 1e-7f)
+				break;
+		}
+		return sum;
+	}
+
+	// support of filter in destination pixels
+	float _filterRadius(MipFilter filter) {
+		return filter == MipFilter::Box ? 0.5f : 3.0f;
+	}
+
+	float _filterWeight(MipFilter filter, float x) {
+		const float radius = _filterRadius(filter);
+		const float distance = fabsf(x);
+		switch (filter) {
+		case MipFilter::Box:
+			// half weight on edge, so odd sizes are averaged by covered area
+			return distance < radius ? 1.0f : (distance == radius ? 0.5f : 0.0f);
+		case MipFilter::Kaiser: {
+			if (distance >= radius)
+				return 0.0f;
+			const float alpha = 4.0f;
+			const float ratio = distance / radius;
+			return _sinc(x) * _besselI0(alpha * sqrtf(1.0f - ratio * ratio)) / _besselI0(alpha);
+		}
+		case MipFilter::Lanczos:
+			return distance < radius ? _sinc(x) * _sinc(x / radius) : 0.0f;
+		}
+		return 0.0f;
+	}
+
+	void _makeTaps(uint32_t sourceSize, uint32_t destinationSize, MipFilter filter, FilterTaps& taps) {
+		const float scale = static_cast<float>(sourceSize) / destinationSize;
+		const float support = _filterRadius(filter) * scale;
+
+		int maxTapCount = 1;
+		for (uint32_t i = 0; i < destinationSize; i++) {
+			const float center = (i + 0.5f) * scale;
+			const int first = static_cast<int>(ceilf(center - support - 0.5f));
+			const int last = static_cast<int>(floorf(center + support - 0.5f));
+			maxTapCount = last - first + 1 > maxTapCount ? last - first + 1 : maxTapCount;
+		}
+
+		taps.tapCount = static_cast<uint32_t>(maxTapCount);
+		taps.indices.assign(static_cast<size_t>(destinationSize) * taps.tapCount, 0);
+		taps.weights.assign(static_cast<size_t>(destinationSize) * taps.tapCount, 0.0f);
+		for (uint32_t i = 0; i < destinationSize; i++) {
+			const float center = (i + 0.5f) * scale;
+			const int first = static_cast<int>(ceilf(center - support - 0.5f));
+			uint32_t* indices = &taps.indices[static_cast<size_t>(i) * taps.tapCount];
+			float* weights = &taps.weights[static_cast<size_t>(i) * taps.tapCount];
+
+			float weightSum = 0.0f;
+			for (uint32_t k = 0; k < taps.tapCount; k++) {
+				const int source = first + static_cast<int>(k);
+				// clamp to edge
+				indices[k] = static_cast<uint32_t>(source < 0 ? 0 : (source >= static_cast<int>(sourceSize) ? sourceSize - 1 : source));
+				weights[k] = _filterWeight(filter, (source + 0.5f - center) / scale);
+				weightSum += weights[k];
+			}
+			for (uint32_t k = 0; k < taps.tapCount; k++)
+				weights[k] /= weightSum;
+		}
+	}
+
+	uint32_t _channelCount(MipFormat format) {
+		return format == MipFormat::R8 ? 1 : 4;
+	}
+
+	// Half precision conversion (round to nearest even, overflow is clamped to largest finite value)
+	uint16_t _floatToHalf(float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+		const uint32_t absBits = bits & 0x7fffffff;
+		if (absBits > 0x7f800000)
+			return sign | 0x7e00;
+		if (absBits >= 0x47800000)
+			return sign | 0x7bff;
+		if (absBits < 0x38800000) {
+			// subnormal
+			if (absBits < 0x33000000)
+				return sign;
+			const uint32_t mantissa = (absBits & 0x7fffff) | 0x800000;
+			const uint32_t shift = 126 - (absBits >> 23);
+			return sign | static_cast<uint16_t>((mantissa + (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1)) >> shift);
+		}
+		const uint32_t half = (absBits - (112u << 23) + 0xfff + ((absBits >> 13) & 1)) >> 13;
+		return sign | static_cast<uint16_t>(half > 0x7bff ? 0x7bff : half);
+	}
+
+	float _halfToFloat(uint16_t half) {
+		const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+		const uint32_t exponent = (half >> 10) & 0x1f;
+		const uint32_t mantissa = half & 0x3ff;
+		uint32_t bits = sign;
+		if (exponent == 0x1f) {
+			bits |= 0x7f800000 | (mantissa << 13);
+		}
+		else if (exponent != 0) {
+			bits |= ((exponent + 112) << 23) | (mantissa << 13);
+		}
+		else if (mantissa != 0) {
+			const float subnormal = mantissa * (1.0f / 16777216.0f);
+			return sign ? -subnormal : subnormal;
+		}
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	void _decodeRow(MipFormat format, const uint8_t* source, uint32_t width, float* destination) {
+		const ConversionTables& tables = _getConversionTables();
+		switch (format) {
+		case MipFormat::R8:
+		case MipFormat::RGBA8:
+			for (size_t i = 0, count = static_cast<size_t>(width) * _channelCount(format); i < count; i++)
+				destination[i] = tables.unormToFloat[source[i]];
+			break;
+		case MipFormat::RGBA8_SRGB:
+			for (size_t i = 0, count = static_cast<size_t>(width) * 4; i < count; i += 4) {
+				destination[i] = tables.srgbToLinear[source[i]];
+				destination[i + 1] = tables.srgbToLinear[source[i + 1]];
+				destination[i + 2] = tables.srgbToLinear[source[i + 2]];
+				destination[i + 3] = tables.unormToFloat[source[i + 3]];
+			}
+			break;
+		case MipFormat::RGBA16F: {
+			const uint16_t* halves = reinterpret_cast<const uint16_t*>(source);
+			for (size_t i = 0, count = static_cast<size_t>(width) * 4; i < count; i++)
+				destination[i] = _halfToFloat(halves[i]);
+			break;
+		}
+		}
+	}
+
+	uint8_t _floatToUnorm8(float value) {
+		value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		return static_cast<uint8_t>(value * 255.0f + 0.5f);
+	}
+
+	void _encodeRow(MipFormat format, const float* source, uint32_t width, uint8_t* destination, MipGeneratorPath path) {
+		const ConversionTables& tables = _getConversionTables();
+		size_t i = 0;
+		switch (format) {
+		case MipFormat::R8:
+		case MipFormat::RGBA8: {
+			const size_t count = static_cast<size_t>(width) * _channelCount(format);
+#if MIP_GENERATOR_X86
+			if (path != MipGeneratorPath::Scalar) {
+				const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), scale = _mm_set1_ps(255.0f), half = _mm_set1_ps(0.5f);
+				for (; i + 16 <= count; i += 16) {
+					__m128i v[4];
+					for (int k = 0; k < 4; k++) {
+						__m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + k * 4), zero), one);
+						v[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+					}
+					const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+				}
+			}
+#endif
+			for (; i < count; i++)
+				destination[i] = _floatToUnorm8(source[i]);
+			break;
+		}
+		case MipFormat::RGBA8_SRGB:
+			for (size_t count = static_cast<size_t>(width) * 4; i < count; i += 4) {
+				for (int c = 0; c < 3; c++) {
+					float value = source[i + c];
+					value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+					destination[i + c] = tables.linearToSRGB[static_cast<uint32_t>(value * (kLinearToSRGBTableSize - 1) + 0.5f)];
+				}
+				destination[i + 3] = _floatToUnorm8(source[i + 3]);
+			}
+			break;
+		case MipFormat::RGBA16F: {
+			uint16_t* halves = reinterpret_cast<uint16_t*>(destination);
+			for (size_t count = static_cast<size_t>(width) * 4; i < count; i++)
+				halves[i] = _floatToHalf(source[i]);
+			break;
+		}
+		}
+	}
+
+	// Horizontal pass : filters one row (channels floats per pixel)
+	void _filterRowScalar(const float* source, uint32_t channels, const FilterTaps& taps, uint32_t width, float* destination) {
+		for (uint32_t x = 0; x < width; x++) {
+			const uint32_t* indices = &taps.indices[static_cast<size_t>(x) * taps.tapCount];
+			const float* weights = &taps.weights[static_cast<size_t>(x) * taps.tapCount];
+			for (uint32_t c = 0; c < channels; c++) {
+				float sum = 0.0f;
+				for (uint32_t k = 0; k < taps.tapCount; k++)
+					sum += weights[k] * source[indices[k] * channels + c];
+				destination[x * channels + c] = sum;
+			}
+		}
+	}
+
+	// Vertical pass : weighted sum of source rows
+	void _sumRowsScalar(const float* const* rows, const float* weights, uint32_t rowCount, size_t count, float* destination) {
+		for (size_t i = 0; i < count; i++) {
+			float sum = 0.0f;
+			for (uint32_t k = 0; k < rowCount; k++)
+				sum += weights[k] * rows[k][i];
+			destination[i] = sum;
+		}
+	}
+
+#if MIP_GENERATOR_X86
+	// one pixel (4 channels) per register
+	void _filterRowSSE2(const float* source, const FilterTaps& taps, uint32_t width, float* destination) {
+		for (uint32_t x = 0; x < width; x++) {
+			const uint32_t* indices = &taps.indices[static_cast<size_t>(x) * taps.tapCount];
+			const float* weights = &taps.weights[static_cast<size_t>(x) * taps.tapCount];
+			__m128 sum = _mm_setzero_ps();
+			for (uint32_t k = 0; k < taps.tapCount; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(source + indices[k] * 4)));
+			_mm_storeu_ps(destination + x * 4, sum);
+		}
+	}
+
+	void _sumRowsSSE2(const float* const* rows, const float* weights, uint32_t rowCount, size_t count, float* destination) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 sum = _mm_setzero_ps();
+			for (uint32_t k = 0; k < rowCount; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+			_mm_storeu_ps(destination + i, sum);
+		}
+		for (; i < count; i++) {
+			float sum = 0.0f;
+			for (uint32_t k = 0; k < rowCount; k++)
+				sum += weights[k] * rows[k][i];
+			destination[i] = sum;
+		}
+	}
+
+	// two pixels per register
+	MIP_GENERATOR_TARGET_AVX
+	void _filterRowAVX(const float* source, const FilterTaps& taps, uint32_t width, float* destination) {
+		uint32_t x = 0;
+		for (; x + 2 <= width; x += 2) {
+			const uint32_t* indices0 = &taps.indices[static_cast<size_t>(x) * taps.tapCount];
+			const float* weights0 = &taps.weights[static_cast<size_t>(x) * taps.tapCount];
+			const uint32_t* indices1 = indices0 + taps.tapCount;
+			const float* weights1 = weights0 + taps.tapCount;
+			__m256 sum = _mm256_setzero_ps();
+			for (uint32_t k = 0; k < taps.tapCount; k++) {
+				const __m256 weight = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(weights0[k])), _mm_set1_ps(weights1[k]), 1);
+				const __m256 pixels = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(source + indices0[k] * 4)), _mm_loadu_ps(source + indices1[k] * 4), 1);
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(weight, pixels));
+			}
+			_mm256_storeu_ps(destination + x * 4, sum);
+		}
+		for (; x < width; x++) {
+			const uint32_t* indices = &taps.indices[static_cast<size_t>(x) * taps.tapCount];
+			const float* weights = &taps.weights[static_cast<size_t>(x) * taps.tapCount];
+			__m128 sum = _mm_setzero_ps();
+			for (uint32_t k = 0; k < taps.tapCount; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(source + indices[k] * 4)));
+			_mm_storeu_ps(destination + x * 4, sum);
+		}
+	}
+
+	MIP_GENERATOR_TARGET_AVX
+	void _sumRowsAVX(const float* const* rows, const float* weights, uint32_t rowCount, size_t count, float* destination) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 sum = _mm256_setzero_ps();
+			for (uint32_t k = 0; k < rowCount; k++)
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(rows[k] + i)));
+			_mm256_storeu_ps(destination + i, sum);
+		}
+		for (; i < count; i++) {
+			float sum = 0.0f;
+			for (uint32_t k = 0; k < rowCount; k++)
+				sum += weights[k] * rows[k][i];
+			destination[i] = sum;
+		}
+	}
+#endif
+
+	void _filterRow(MipGeneratorPath path, const float* source, uint32_t channels, const FilterTaps& taps, uint32_t width, float* destination) {
+#if MIP_GENERATOR_X86
+		if (channels == 4 && path == MipGeneratorPath::AVX) {
+			_filterRowAVX(source, taps, width, destination);
+			return;
+		}
+		if (channels == 4 && path == MipGeneratorPath::SSE2) {
+			_filterRowSSE2(source, taps, width, destination);
+			return;
+		}
+#endif
+		_filterRowScalar(source, channels, taps, width, destination);
+	}
+
+	void _sumRows(MipGeneratorPath path, const float* const* rows, const float* weights, uint32_t rowCount, size_t count, float* destination) {
+#if MIP_GENERATOR_X86
+		if (path == MipGeneratorPath::AVX) {
+			_sumRowsAVX(rows, weights, rowCount, count, destination);
+			return;
+		}
+		if (path == MipGeneratorPath::SSE2) {
+			_sumRowsSSE2(rows, weights, rowCount, count, destination);
+			return;
+		}
+#endif
+		_sumRowsScalar(rows, weights, rowCount, count, destination);
+	}
+}
+
+MipGenerator::MipGenerator(uint32_t threadCount)
+	: _threadCount(threadCount), _path(getBestPath())
+{
+	if (_threadCount == 0)
+		_threadCount = std::thread::hardware_concurrency();
+	if (_threadCount == 0)
+		_threadCount = 1;
+}
+
+void MipGenerator::setPath(MipGeneratorPath path) {
+	const MipGeneratorPath bestPath = getBestPath();
+	_path = static_cast<int>(path) <= static_cast<int>(bestPath) ? path : bestPath;
+}
+
+MipGeneratorPath MipGenerator::getBestPath() {
+	// same CPU features as streaming copy
+	switch (PitchedCopy::getBestPath()) {
+	case PitchedCopyPath::AVX:
+		return MipGeneratorPath::AVX;
+	case PitchedCopyPath::SSE2:
+		return MipGeneratorPath::SSE2;
+	default:
+		return MipGeneratorPath::Scalar;
+	}
+}
+
+const char* MipGenerator::getPathName(MipGeneratorPath path) {
+	switch (path) {
+	case MipGeneratorPath::SSE2:
+		return "SSE2";
+	case MipGeneratorPath::AVX:
+		return "AVX";
+	default:
+		return "Scalar";
+	}
+}
+
+const char* MipGenerator::getFilterName(MipFilter filter) {
+	switch (filter) {
+	case MipFilter::Kaiser:
+		return "kaiser";
+	case MipFilter::Lanczos:
+		return "lanczos";
+	default:
+		return "box";
+	}
+}
+
+size_t MipGenerator::getPixelSize(MipFormat format) {
+	switch (format) {
+	case MipFormat::R8:
+		return 1;
+	case MipFormat::RGBA16F:
+		return 8;
+	default:
+		return 4;
+	}
+}
+
+uint32_t MipGenerator::getMipCount(uint32_t width, uint32_t height) {
+	uint32_t mipCount = 1;
+	for (uint32_t size = width > height ? width : height; size > 1; size >>= 1)
+		mipCount++;
+	return mipCount;
+}
+
+void MipGenerator::reserve(uint32_t width, uint32_t height, MipFormat format, MipChain& chain, uint32_t mipCount) {
+	const uint32_t fullMipCount = getMipCount(width, height);
+	mipCount = mipCount == 0 || mipCount > fullMipCount ? fullMipCount : mipCount;
+	const size_t pixelSize = getPixelSize(format);
+
+	chain.format = format;
+	chain.levels.resize(mipCount);
+	size_t offset = 0;
+	for (uint32_t level = 0; level < mipCount; level++) {
+		MipLevel& mip = chain.levels[level];
+		mip.width = width >> level > 0 ? width >> level : 1;
+		mip.height = height >> level > 0 ? height >> level : 1;
+		mip.offset = offset;
+		mip.rowPitch = mip.width * pixelSize;
+		mip.size = mip.rowPitch * mip.height;
+		offset += mip.size;
+	}
+	chain.data.resize(offset);
+}
+
+void MipGenerator::generate(const void* pixels, uint32_t width, uint32_t height, size_t rowPitch, MipFormat format, MipFilter filter,
+	MipChain& chain, uint32_t mipCount) const {
+	reserve(width, height, format, chain, mipCount);
+
+	// level 0 is copied as it is
+	const MipLevel& baseLevel = chain.levels[0];
+	for (uint32_t y = 0; y < height; y++)
+		memcpy(chain.data.data() + baseLevel.rowPitch * y, static_cast<const uint8_t*>(pixels) + rowPitch * y, baseLevel.rowPitch);
+
+	generateLevels(chain, filter);
+}
+
+void MipGenerator::generateLevels(MipChain& chain, MipFilter filter) const {
+	const MipFormat format = chain.format;
+	const uint32_t mipCount = chain.getLevelCount();
+	const uint32_t channels = _channelCount(format);
+	const MipGeneratorPath path = _path;
+
+	// previous level in linear float (level 0 is decoded row by row in horizontal pass)
+	std::vector<float> previousLevel, currentLevel, horizontal;
+	FilterTaps horizontalTaps, verticalTaps;
+	for (uint32_t level = 1; level < mipCount; level++) {
+		const MipLevel& source = chain.levels[level - 1];
+		const MipLevel& destination = chain.levels[level];
+		const size_t sourceRowFloats = static_cast<size_t>(source.width) * channels;
+		const size_t destinationRowFloats = static_cast<size_t>(destination.width) * channels;
+		_makeTaps(source.width, destination.width, filter, horizontalTaps);
+		_makeTaps(source.height, destination.height, filter, verticalTaps);
+
+		// horizontal pass : source.width x source.height -> destination.width x source.height
+		horizontal.resize(destinationRowFloats * source.height);
+		const bool decodeSource = level == 1;
+		ParallelFor::rows(_threadCount, source.height, destinationRowFloats * horizontalTaps.tapCount, kMinWorkPerThread, [&](uint32_t firstRow, uint32_t lastRow) {
+			std::vector<float> decodedRow(decodeSource ? sourceRowFloats : 0);
+			for (uint32_t y = firstRow; y < lastRow; y++) {
+				const float* sourceRow = nullptr;
+				if (decodeSource) {
+					_decodeRow(format, chain.data.data() + source.offset + source.rowPitch * y, source.width, decodedRow.data());
+					sourceRow = decodedRow.data();
+				}
+				else {
+					sourceRow = previousLevel.data() + sourceRowFloats * y;
+				}
+				_filterRow(path, sourceRow, channels, horizontalTaps, destination.width, horizontal.data() + destinationRowFloats * y);
+			}
+		});
+
+		// vertical pass and encoding
+		currentLevel.resize(destinationRowFloats * destination.height);
+		ParallelFor::rows(_threadCount, destination.height, destinationRowFloats * verticalTaps.tapCount, kMinWorkPerThread, [&](uint32_t firstRow, uint32_t lastRow) {
+			std::vector<const float*> rows(verticalTaps.tapCount);
+			for (uint32_t y = firstRow; y < lastRow; y++) {
+				const uint32_t* indices = &verticalTaps.indices[static_cast<size_t>(y) * verticalTaps.tapCount];
+				const float* weights = &verticalTaps.weights[static_cast<size_t>(y) * verticalTaps.tapCount];
+				for (uint32_t k = 0; k < verticalTaps.tapCount; k++)
+					rows[k] = horizontal.data() + destinationRowFloats * indices[k];
+
+				float* destinationRow = currentLevel.data() + destinationRowFloats * y;
+				_sumRows(path, rows.data(), weights, verticalTaps.tapCount, destinationRowFloats, destinationRow);
+				_encodeRow(format, destinationRow, destination.width, chain.data.data() + destination.offset + destination.rowPitch * y, path);
+			}
+		});
+		previousLevel.swap(currentLevel);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Pixel formats supported by mip generator
+enum class MipFormat {
+	R8,				// DXGI_FORMAT_R8_UNORM
+	RGBA8,			// DXGI_FORMAT_R8G8B8A8_UNORM
+	RGBA8_SRGB,		// DXGI_FORMAT_R8G8B8A8_UNORM_SRGB (color is filtered in linear space, alpha stays linear)
+	RGBA16F			// DXGI_FORMAT_R16G16B16A16_FLOAT
+};
+
+enum class MipFilter {
+	Box,			// average of covered pixels
+	Kaiser,			// Kaiser-windowed sinc (radius 3, alpha 4)
+	Lanczos			// Lanczos-3
+};
+
+// Instruction set used by mip generator
+enum class MipGeneratorPath {
+	Scalar,
+	SSE2,			// 4 floats per instruction
+	AVX				// 8 floats per instruction
+};
+
+struct MipLevel {
+	uint32_t width;
+	uint32_t height;
+	size_t offset;		// from start of chain data
+	size_t rowPitch;	// tightly packed
+	size_t size;
+};
+
+// Mip levels packed in one allocation. Level 0 is source image.
+struct MipChain {
+	MipFormat format = MipFormat::RGBA8;
+	std::vector<MipLevel> levels;
+	std::vector<uint8_t> data;
+
+	uint32_t getLevelCount() const { return static_cast<uint32_t>(levels.size()); }
+	const uint8_t* getLevelData(uint32_t level) const { return data.data() + levels[level].offset; }
+	uint8_t* getLevelData(uint32_t level) { return data.data() + levels[level].offset; }
+};
+
+// Generates mip chain on CPU with separable filters.
+// Each level is filtered in 32-bit float from previous level, so quantization error doesn't accumulate.
+// Rows of large levels are split across threads.
+class MipGenerator
+{
+public:
+	// threadCount 0 uses hardware concurrency
+	MipGenerator(uint32_t threadCount = 0);
+	~MipGenerator() {}
+
+	// Properties
+	uint32_t getThreadCount() const { return _threadCount; }
+	MipGeneratorPath getPath() const { return _path; }
+	// Falls back to best supported path if CPU doesn't support given one
+	void setPath(MipGeneratorPath path);
+
+	static MipGeneratorPath getBestPath();
+	static const char* getPathName(MipGeneratorPath path);
+	static const char* getFilterName(MipFilter filter);
+	static size_t getPixelSize(MipFormat format);
+	static uint32_t getMipCount(uint32_t width, uint32_t height);
+
+	// Lays out levels 0 ~ mipCount-1 and allocates chain data without filling it (mipCount 0 reserves full chain down to 1x1)
+	static void reserve(uint32_t width, uint32_t height, MipFormat format, MipChain& chain, uint32_t mipCount = 0);
+
+	// Generates levels 0 ~ mipCount-1 (mipCount 0 generates full chain down to 1x1)
+	void generate(const void* pixels, uint32_t width, uint32_t height, size_t rowPitch, MipFormat format, MipFilter filter,
+		MipChain& chain, uint32_t mipCount = 0) const;
+	// Generates levels 1 ~ of reserved chain from level 0 which is already written (e.g. decoded in place)
+	void generateLevels(MipChain& chain, MipFilter filter) const;
+
+private:
+	uint32_t _threadCount;
+	MipGeneratorPath _path;
+};
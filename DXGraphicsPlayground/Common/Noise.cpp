@@ -0,0 +1,369 @@
+#include "pch.h"
+#include "Noise.h"
+#include "ParallelFor.h"
+#include "PitchedCopy.h"
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NOISE_X86 1
+#include <emmintrin.h>
+#endif
+
+// SIMD functions mirror order of scalar operations, so both paths give same values.
+namespace {
+	// rows are not split across threads unless each thread gets this many samples
+	constexpr size_t kMinSamplesPerThread = 1 << 14;
+	constexpr uint32_t kOctaveSeedStep = 0x9e3779b9;
+	constexpr float kSimplexSkew = 0.366025403784f;		// (sqrt(3) - 1) / 2
+	constexpr float kSimplexUnskew = 0.211324865405f;	// (3 - sqrt(3)) / 6
+	constexpr float kSimplexScale = 70.0f;				// maps simplex noise with diagonal gradients to about [-1, 1]
+
+	// Scalar
+
+	uint32_t _hash(int32_t x, int32_t y, uint32_t seed) {
+		uint32_t hash = (static_cast<uint32_t>(x) * 0x8da6b343u) ^ (static_cast<uint32_t>(y) * 0xd8163841u) ^ seed;
+		hash ^= hash >> 15;
+		hash *= 0x2c1b3c6du;
+		hash ^= hash >> 12;
+		hash *= 0x297a2d39u;
+		hash ^= hash >> 15;
+		return hash;
+	}
+
+	// [-1, 1]
+	float _hashToFloat(uint32_t hash) {
+		return static_cast<float>(static_cast<int32_t>(hash >> 8)) * (2.0f / 16777215.0f) - 1.0f;
+	}
+
+	// one of four diagonal gradients
+	float _gradient(uint32_t hash, float x, float y) {
+		return ((hash & 1) ? -x : x) + ((hash & 2) ? -y : y);
+	}
+
+	float _fade(float t) {
+		return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+	}
+
+	float _lerp(float a, float b, float t) {
+		return a + (b - a) * t;
+	}
+
+	float _valueNoise(float x, float y, uint32_t seed) {
+		const float xFloor = floorf(x), yFloor = floorf(y);
+		const int32_t xi = static_cast<int32_t>(xFloor), yi = static_cast<int32_t>(yFloor);
+		const float u = _fade(x - xFloor), v = _fade(y - yFloor);
+		const float a = _lerp(_hashToFloat(_hash(xi, yi, seed)), _hashToFloat(_hash(xi + 1, yi, seed)), u);
+		const float b = _lerp(_hashToFloat(_hash(xi, yi + 1, seed)), _hashToFloat(_hash(xi + 1, yi + 1, seed)), u);
+		return _lerp(a, b, v);
+	}
+
+	float _perlinNoise(float x, float y, uint32_t seed) {
+		const float xFloor = floorf(x), yFloor = floorf(y);
+		const int32_t xi = static_cast<int32_t>(xFloor), yi = static_cast<int32_t>(yFloor);
+		const float fx = x - xFloor, fy = y - yFloor;
+		const float u = _fade(fx), v = _fade(fy);
+		const float a = _lerp(_gradient(_hash(xi, yi, seed), fx, fy), _gradient(_hash(xi + 1, yi, seed), fx - 1.0f, fy), u);
+		const float b = _lerp(_gradient(_hash(xi, yi + 1, seed), fx, fy - 1.0f), _gradient(_hash(xi + 1, yi + 1, seed), fx - 1.0f, fy - 1.0f), u);
+		return _lerp(a, b, v);
+	}
+
+	float _simplexCorner(uint32_t hash, float x, float y) {
+		float t = 0.5f - x * x - y * y;
+		t = t < 0.0f ? 0.0f : t;
+		t = t * t;
+		return t * t * _gradient(hash, x, y);
+	}
+
+	float _simplexNoise(float x, float y, uint32_t seed) {
+		const float skew = (x + y) * kSimplexSkew;
+		const float iFloor = floorf(x + skew), jFloor = floorf(y + skew);
+		const int32_t i = static_cast<int32_t>(iFloor), j = static_cast<int32_t>(jFloor);
+		const float unskew = (iFloor + jFloor) * kSimplexUnskew;
+		const float x0 = x - (iFloor - unskew), y0 = y - (jFloor - unskew);
+
+		// middle corner depends on which triangle of cell contains point
+		const int32_t i1 = x0 > y0 ? 1 : 0, j1 = 1 - i1;
+		const float x1 = x0 - static_cast<float>(i1) + kSimplexUnskew, y1 = y0 - static_cast<float>(j1) + kSimplexUnskew;
+		const float x2 = x0 + (2.0f * kSimplexUnskew - 1.0f), y2 = y0 + (2.0f * kSimplexUnskew - 1.0f);
+
+		const float n0 = _simplexCorner(_hash(i, j, seed), x0, y0);
+		const float n1 = _simplexCorner(_hash(i + i1, j + j1, seed), x1, y1);
+		const float n2 = _simplexCorner(_hash(i + 1, j + 1, seed), x2, y2);
+		return (n0 + n1 + n2) * kSimplexScale;
+	}
+
+	float _basisNoise(NoiseBasis basis, float x, float y, uint32_t seed) {
+		switch (basis) {
+		case NoiseBasis::Value:
+			return _valueNoise(x, y, seed);
+		case NoiseBasis::Simplex:
+			return _simplexNoise(x, y, seed);
+		default:
+			return _perlinNoise(x, y, seed);
+		}
+	}
+
+	float _clamp01(float value) {
+		return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	}
+
+	uint32_t _octaveCount(const NoiseDesc& desc) {
+		return desc.fractal == NoiseFractal::Single || desc.octaveCount == 0 ? 1 : desc.octaveCount;
+	}
+
+	float _fractalNoise(const NoiseDesc& desc, float amplitudeScale, float x, float y) {
+		const uint32_t octaveCount = _octaveCount(desc);
+		float total = 0.0f, amplitude = 1.0f, frequency = 1.0f;
+		for (uint32_t octave = 0; octave < octaveCount; octave++) {
+			const float noise = _basisNoise(desc.basis, x * frequency, y * frequency, desc.seed + octave * kOctaveSeedStep);
+			if (desc.fractal == NoiseFractal::Ridged) {
+				const float ridge = 1.0f - fabsf(noise);
+				total = total + ridge * ridge * amplitude;
+			}
+			else {
+				total = total + noise * amplitude;
+			}
+			amplitude *= desc.gain;
+			frequency *= desc.lacunarity;
+		}
+		if (desc.fractal == NoiseFractal::Ridged)
+			return _clamp01(total * amplitudeScale);
+		return _clamp01(total * amplitudeScale * 0.5f + 0.5f);
+	}
+
+#if NOISE_X86
+	// SSE2 (4 samples)
+
+	__m128i _mullo(__m128i a, uint32_t b) {
+		// SSE2 has no 32-bit low multiply, so multiply even and odd lanes separately
+		const __m128i multiplier = _mm_set1_epi32(static_cast<int>(b));
+		const __m128i even = _mm_mul_epu32(a, multiplier);
+		const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), multiplier);
+		return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	}
+
+	__m128i _hash4(__m128i x, __m128i y, uint32_t seed) {
+		__m128i hash = _mm_xor_si128(_mm_xor_si128(_mullo(x, 0x8da6b343u), _mullo(y, 0xd8163841u)), _mm_set1_epi32(static_cast<int>(seed)));
+		hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 15));
+		hash = _mullo(hash, 0x2c1b3c6du);
+		hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 12));
+		hash = _mullo(hash, 0x297a2d39u);
+		hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 15));
+		return hash;
+	}
+
+	__m128 _hashToFloat4(__m128i hash) {
+		return _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(hash, 8)), _mm_set1_ps(2.0f / 16777215.0f)), _mm_set1_ps(1.0f));
+	}
+
+	__m128 _gradient4(__m128i hash, __m128 x, __m128 y) {
+		// move hash bits 0 and 1 to sign bits
+		const __m128 xSign = _mm_castsi128_ps(_mm_slli_epi32(hash, 31));
+		const __m128 ySign = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(hash, 1), 31));
+		return _mm_add_ps(_mm_xor_ps(x, xSign), _mm_xor_ps(y, ySign));
+	}
+
+	__m128 _fade4(__m128 t) {
+		const __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+		return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+	}
+
+	__m128 _lerp4(__m128 a, __m128 b, __m128 t) {
+		return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+	}
+
+	// floor for values in int range (SSE2 has no round instruction)
+	__m128i _floor4(__m128 x, __m128& xFloor) {
+		__m128i truncated = _mm_cvttps_epi32(x);
+		const __m128 truncatedFloat = _mm_cvtepi32_ps(truncated);
+		truncated = _mm_sub_epi32(truncated, _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(truncatedFloat, x)), _mm_set1_epi32(1)));
+		xFloor = _mm_cvtepi32_ps(truncated);
+		return truncated;
+	}
+
+	__m128 _valueNoise4(__m128 x, __m128 y, uint32_t seed) {
+		__m128 xFloor, yFloor;
+		const __m128i xi = _floor4(x, xFloor), yi = _floor4(y, yFloor);
+		const __m128i one = _mm_set1_epi32(1);
+		const __m128i xi1 = _mm_add_epi32(xi, one), yi1 = _mm_add_epi32(yi, one);
+		const __m128 u = _fade4(_mm_sub_ps(x, xFloor)), v = _fade4(_mm_sub_ps(y, yFloor));
+		const __m128 a = _lerp4(_hashToFloat4(_hash4(xi, yi, seed)), _hashToFloat4(_hash4(xi1, yi, seed)), u);
+		const __m128 b = _lerp4(_hashToFloat4(_hash4(xi, yi1, seed)), _hashToFloat4(_hash4(xi1, yi1, seed)), u);
+		return _lerp4(a, b, v);
+	}
+
+	__m128 _perlinNoise4(__m128 x, __m128 y, uint32_t seed) {
+		__m128 xFloor, yFloor;
+		const __m128i xi = _floor4(x, xFloor), yi = _floor4(y, yFloor);
+		const __m128i one = _mm_set1_epi32(1);
+		const __m128i xi1 = _mm_add_epi32(xi, one), yi1 = _mm_add_epi32(yi, one);
+		const __m128 fx = _mm_sub_ps(x, xFloor), fy = _mm_sub_ps(y, yFloor);
+		const __m128 fx1 = _mm_sub_ps(fx, _mm_set1_ps(1.0f)), fy1 = _mm_sub_ps(fy, _mm_set1_ps(1.0f));
+		const __m128 u = _fade4(fx), v = _fade4(fy);
+		const __m128 a = _lerp4(_gradient4(_hash4(xi, yi, seed), fx, fy), _gradient4(_hash4(xi1, yi, seed), fx1, fy), u);
+		const __m128 b = _lerp4(_gradient4(_hash4(xi, yi1, seed), fx, fy1), _gradient4(_hash4(xi1, yi1, seed), fx1, fy1), u);
+		return _lerp4(a, b, v);
+	}
+
+	__m128 _simplexCorner4(__m128i hash, __m128 x, __m128 y) {
+		__m128 t = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.5f), _mm_mul_ps(x, x)), _mm_mul_ps(y, y));
+		t = _mm_max_ps(t, _mm_setzero_ps());
+		t = _mm_mul_ps(t, t);
+		return _mm_mul_ps(_mm_mul_ps(t, t), _gradient4(hash, x, y));
+	}
+
+	__m128 _simplexNoise4(__m128 x, __m128 y, uint32_t seed) {
+		const __m128 skew = _mm_mul_ps(_mm_add_ps(x, y), _mm_set1_ps(kSimplexSkew));
+		__m128 iFloor, jFloor;
+		const __m128i i = _floor4(_mm_add_ps(x, skew), iFloor), j = _floor4(_mm_add_ps(y, skew), jFloor);
+		const __m128 unskew = _mm_mul_ps(_mm_add_ps(iFloor, jFloor), _mm_set1_ps(kSimplexUnskew));
+		const __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(iFloor, unskew)), y0 = _mm_sub_ps(y, _mm_sub_ps(jFloor, unskew));
+
+		const __m128i one = _mm_set1_epi32(1);
+		const __m128i i1 = _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(x0, y0)), one);
+		const __m128i j1 = _mm_sub_epi32(one, i1);
+		const __m128 unskew4 = _mm_set1_ps(kSimplexUnskew), lastOffset = _mm_set1_ps(2.0f * kSimplexUnskew - 1.0f);
+		const __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, _mm_cvtepi32_ps(i1)), unskew4), y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_cvtepi32_ps(j1)), unskew4);
+		const __m128 x2 = _mm_add_ps(x0, lastOffset), y2 = _mm_add_ps(y0, lastOffset);
+
+		const __m128 n0 = _simplexCorner4(_hash4(i, j, seed), x0, y0);
+		const __m128 n1 = _simplexCorner4(_hash4(_mm_add_epi32(i, i1), _mm_add_epi32(j, j1), seed), x1, y1);
+		const __m128 n2 = _simplexCorner4(_hash4(_mm_add_epi32(i, one), _mm_add_epi32(j, one), seed), x2, y2);
+		return _mm_mul_ps(_mm_add_ps(_mm_add_ps(n0, n1), n2), _mm_set1_ps(kSimplexScale));
+	}
+
+	__m128 _basisNoise4(NoiseBasis basis, __m128 x, __m128 y, uint32_t seed) {
+		switch (basis) {
+		case NoiseBasis::Value:
+			return _valueNoise4(x, y, seed);
+		case NoiseBasis::Simplex:
+			return _simplexNoise4(x, y, seed);
+		default:
+			return _perlinNoise4(x, y, seed);
+		}
+	}
+
+	__m128 _fractalNoise4(const NoiseDesc& desc, float amplitudeScale, __m128 x, __m128 y) {
+		const uint32_t octaveCount = _octaveCount(desc);
+		const __m128 signMask = _mm_set1_ps(-0.0f), one = _mm_set1_ps(1.0f);
+		__m128 total = _mm_setzero_ps();
+		float amplitude = 1.0f, frequency = 1.0f;
+		for (uint32_t octave = 0; octave < octaveCount; octave++) {
+			const __m128 octaveFrequency = _mm_set1_ps(frequency);
+			const __m128 noise = _basisNoise4(desc.basis, _mm_mul_ps(x, octaveFrequency), _mm_mul_ps(y, octaveFrequency), desc.seed + octave * kOctaveSeedStep);
+			if (desc.fractal == NoiseFractal::Ridged) {
+				const __m128 ridge = _mm_sub_ps(one, _mm_andnot_ps(signMask, noise));
+				total = _mm_add_ps(total, _mm_mul_ps(_mm_mul_ps(ridge, ridge), _mm_set1_ps(amplitude)));
+			}
+			else {
+				total = _mm_add_ps(total, _mm_mul_ps(noise, _mm_set1_ps(amplitude)));
+			}
+			amplitude *= desc.gain;
+			frequency *= desc.lacunarity;
+		}
+
+		__m128 result = _mm_mul_ps(total, _mm_set1_ps(amplitudeScale));
+		if (desc.fractal != NoiseFractal::Ridged)
+			result = _mm_add_ps(_mm_mul_ps(result, _mm_set1_ps(0.5f)), _mm_set1_ps(0.5f));
+		return _mm_min_ps(_mm_max_ps(result, _mm_setzero_ps()), one);
+	}
+#endif
+}
+
+NoiseGenerator::NoiseGenerator(const NoiseDesc& desc, uint32_t threadCount)
+	: _desc(desc), _threadCount(threadCount), _path(getBestPath()), _amplitudeScale(1.0f)
+{
+	if (_threadCount == 0)
+		_threadCount = std::thread::hardware_concurrency();
+	if (_threadCount == 0)
+		_threadCount = 1;
+
+	float amplitudeSum = 0.0f, amplitude = 1.0f;
+	for (uint32_t octave = 0; octave < _octaveCount(_desc); octave++) {
+		amplitudeSum += amplitude;
+		amplitude *= _desc.gain;
+	}
+	_amplitudeScale = amplitudeSum > 0.0f ? 1.0f / amplitudeSum : 1.0f;
+}
+
+void NoiseGenerator::setPath(NoisePath path) {
+	_path = path == NoisePath::SSE2 ? getBestPath() : NoisePath::Scalar;
+}
+
+NoisePath NoiseGenerator::getBestPath() {
+	// same CPU detection as streaming copy
+	return PitchedCopy::getBestPath() != PitchedCopyPath::Scalar ? NoisePath::SSE2 : NoisePath::Scalar;
+}
+
+const char* NoiseGenerator::getPathName(NoisePath path) {
+	return path == NoisePath::SSE2 ? "SSE2" : "Scalar";
+}
+
+const char* NoiseGenerator::getBasisName(NoiseBasis basis) {
+	switch (basis) {
+	case NoiseBasis::Value:
+		return "value";
+	case NoiseBasis::Simplex:
+		return "simplex";
+	default:
+		return "perlin";
+	}
+}
+
+const char* NoiseGenerator::getFractalName(NoiseFractal fractal) {
+	switch (fractal) {
+	case NoiseFractal::Single:
+		return "single";
+	case NoiseFractal::Ridged:
+		return "ridged";
+	default:
+		return "fbm";
+	}
+}
+
+float NoiseGenerator::sample(float x, float y) const {
+	return _fractalNoise(_desc, _amplitudeScale, x, y);
+}
+
+template <typename RowFunction>
+void NoiseGenerator::_fillRows(uint32_t width, uint32_t height, const RowFunction& function) const {
+	const float scaleX = _desc.frequency / width, scaleY = _desc.frequency / height;
+	ParallelFor::rows(_threadCount, height, width * _octaveCount(_desc), kMinSamplesPerThread, [&](uint32_t firstRow, uint32_t lastRow) {
+		std::vector<float> row(width);
+		for (uint32_t y = firstRow; y < lastRow; y++) {
+			const float sampleY = (static_cast<float>(y) + 0.5f) * scaleY;
+			uint32_t x = 0;
+#if NOISE_X86
+			if (_path == NoisePath::SSE2) {
+				const __m128 sampleY4 = _mm_set1_ps(sampleY);
+				const __m128 laneOffset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+				for (; x + 4 <= width; x += 4) {
+					const __m128 sampleX4 = _mm_mul_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffset), _mm_set1_ps(scaleX));
+					_mm_storeu_ps(row.data() + x, _fractalNoise4(_desc, _amplitudeScale, sampleX4, sampleY4));
+				}
+			}
+#endif
+			for (; x < width; x++)
+				row[x] = _fractalNoise(_desc, _amplitudeScale, (static_cast<float>(x) + 0.5f) * scaleX, sampleY);
+			function(y, row.data());
+		}
+	});
+}
+
+void NoiseGenerator::fill(float* values, uint32_t width, uint32_t height, size_t rowPitch) const {
+	_fillRows(width, height, [&](uint32_t y, const float* row) {
+		float* destination = reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(values) + rowPitch * y);
+		for (uint32_t x = 0; x < width; x++)
+			destination[x] = row[x];
+	});
+}
+
+void NoiseGenerator::fillUnorm8(uint8_t* values, uint32_t width, uint32_t height, size_t rowPitch) const {
+	_fillRows(width, height, [&](uint32_t y, const float* row) {
+		uint8_t* destination = values + rowPitch * y;
+		for (uint32_t x = 0; x < width; x++)
+			destination[x] = static_cast<uint8_t>(row[x] * 255.0f + 0.5f);
+	});
+}
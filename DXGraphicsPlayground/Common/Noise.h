@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class NoiseBasis {
+	Value,			// interpolated random values on lattice
+	Perlin,			// gradient noise on square lattice
+	Simplex			// gradient noise on triangular lattice
+};
+
+enum class NoiseFractal {
+	Single,			// one octave
+	FBm,			// sum of octaves
+	Ridged			// sum of inverted absolute octaves (sharp ridges)
+};
+
+// Instruction set used by noise generator
+enum class NoisePath {
+	Scalar,
+	SSE2			// 4 samples per instruction
+};
+
+struct NoiseDesc {
+	NoiseBasis basis = NoiseBasis::Perlin;
+	NoiseFractal fractal = NoiseFractal::FBm;
+	uint32_t seed = 0;
+	float frequency = 4.0f;		// lattice cells across filled image (first octave)
+	uint32_t octaveCount = 4;
+	float lacunarity = 2.0f;	// frequency multiplier per octave
+	float gain = 0.5f;			// amplitude multiplier per octave
+};
+
+// Seeded 2D noise.
+// Lattice values come from integer hash of coordinates and seed (no permutation table or global state),
+// so output is identical for any thread count and row order.
+class NoiseGenerator
+{
+public:
+	// threadCount 0 uses hardware concurrency
+	NoiseGenerator(const NoiseDesc& desc, uint32_t threadCount = 0);
+	~NoiseGenerator() {}
+
+	// Properties
+	const NoiseDesc& getDesc() const { return _desc; }
+	uint32_t getThreadCount() const { return _threadCount; }
+	NoisePath getPath() const { return _path; }
+	// Falls back to best supported path if CPU doesn't support given one
+	void setPath(NoisePath path);
+
+	static NoisePath getBestPath();
+	static const char* getPathName(NoisePath path);
+	static const char* getBasisName(NoiseBasis basis);
+	static const char* getFractalName(NoiseFractal fractal);
+
+	// Value at lattice coordinate of first octave, in [0, 1]
+	float sample(float x, float y) const;
+
+	// Fills image so that it spans desc.frequency lattice cells on each axis, values in [0, 1]
+	void fill(float* values, uint32_t width, uint32_t height, size_t rowPitch) const;
+	void fillUnorm8(uint8_t* values, uint32_t width, uint32_t height, size_t rowPitch) const;
+
+private:
+	template <typename RowFunction>
+	void _fillRows(uint32_t width, uint32_t height, const RowFunction& function) const;
+
+	NoiseDesc _desc;
+	uint32_t _threadCount;
+	NoisePath _path;
+	float _amplitudeScale;		// normalizes sum of octave amplitudes
+};
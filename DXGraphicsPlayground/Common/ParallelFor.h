@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Splits rows into contiguous ranges and runs them on short-lived threads.
+// Work is done on calling thread only if there's not enough work for each thread.
+namespace ParallelFor {
+	// Calls function(firstRow, lastRow) for ranges covering [0, rowCount)
+	template <typename Function>
+	void rows(uint32_t threadCount, uint32_t rowCount, size_t workPerRow, size_t minWorkPerThread, const Function& function) {
+		const size_t work = static_cast<size_t>(rowCount) * workPerRow;
+		size_t jobCount = minWorkPerThread > 0 ? work / minWorkPerThread : rowCount;
+		jobCount = jobCount < threadCount ? jobCount : threadCount;
+		jobCount = jobCount < rowCount ? jobCount : rowCount;
+		if (jobCount <= 1) {
+			function(0u, rowCount);
+			return;
+		}
+
+		std::vector<std::thread> threads;
+		const uint32_t rowsPerJob = static_cast<uint32_t>((rowCount + jobCount - 1) / jobCount);
+		for (uint32_t first = rowsPerJob; first < rowCount; first += rowsPerJob) {
+			const uint32_t last = first + rowsPerJob < rowCount ? first + rowsPerJob : rowCount;
+			threads.emplace_back([&function, first, last]() { function(first, last); });
+		}
+		function(0u, rowsPerJob);
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+}
@@ -0,0 +1,182 @@
+#include "pch.h"
+#include "PitchedCopy.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PITCHED_COPY_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define PITCHED_COPY_TARGET_AVX
+#else
+#include <cpuid.h>
+#define PITCHED_COPY_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+namespace {
+	// rows shorter than this are not worth aligning for streaming stores
+	constexpr size_t kMinStreamingRowSize = 64;
+
+	void _copyRowsScalar(uint8_t* destination, size_t destinationPitch, const uint8_t* source, size_t sourcePitch, size_t rowSize, size_t rowCount) {
+		if (destinationPitch == rowSize && sourcePitch == rowSize) {
+			memcpy(destination, source, rowSize * rowCount);
+			return;
+		}
+		for (size_t row = 0; row < rowCount; row++)
+			memcpy(destination + destinationPitch * row, source + sourcePitch * row, rowSize);
+	}
+
+#if PITCHED_COPY_X86
+	void _copyRowsSSE2(uint8_t* destination, size_t destinationPitch, const uint8_t* source, size_t sourcePitch, size_t rowSize, size_t rowCount) {
+		for (size_t row = 0; row < rowCount; row++) {
+			uint8_t* d = destination + destinationPitch * row;
+			const uint8_t* s = source + sourcePitch * row;
+			size_t remaining = rowSize;
+
+			// head until destination is aligned
+			size_t head = (16 - (reinterpret_cast<uintptr_t>(d) & 15)) & 15;
+			head = head < remaining ? head : remaining;
+			memcpy(d, s, head);
+			d += head;
+			s += head;
+			remaining -= head;
+
+			for (; remaining >= 64; remaining -= 64, d += 64, s += 64) {
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+				__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+				__m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+				_mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+			}
+			for (; remaining >= 16; remaining -= 16, d += 16, s += 16)
+				_mm_stream_si128(reinterpret_cast<__m128i*>(d), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+			memcpy(d, s, remaining);
+		}
+		_mm_sfence();
+	}
+
+	PITCHED_COPY_TARGET_AVX
+	void _copyRowsAVX(uint8_t* destination, size_t destinationPitch, const uint8_t* source, size_t sourcePitch, size_t rowSize, size_t rowCount) {
+		for (size_t row = 0; row < rowCount; row++) {
+			uint8_t* d = destination + destinationPitch * row;
+			const uint8_t* s = source + sourcePitch * row;
+			size_t remaining = rowSize;
+
+			// head until destination is aligned
+			size_t head = (32 - (reinterpret_cast<uintptr_t>(d) & 31)) & 31;
+			head = head < remaining ? head : remaining;
+			memcpy(d, s, head);
+			d += head;
+			s += head;
+			remaining -= head;
+
+			for (; remaining >= 128; remaining -= 128, d += 128, s += 128) {
+				__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+				__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 32));
+				__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 64));
+				__m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 96));
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(d), a);
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(d + 32), b);
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(d + 64), c);
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(d + 96), e);
+			}
+			for (; remaining >= 32; remaining -= 32, d += 32, s += 32)
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(d), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+			memcpy(d, s, remaining);
+		}
+		_mm256_zeroupper();
+		_mm_sfence();
+	}
+
+	PitchedCopyPath _detectPath() {
+		int info[4] = {};
+#if defined(_MSC_VER)
+		__cpuid(info, 1);
+#else
+		__cpuid(1, info[0], info[1], info[2], info[3]);
+#endif
+		const bool hasSSE2 = (info[3] & (1 << 26)) != 0;
+		const bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+		const bool hasAVX = (info[2] & (1 << 28)) != 0;
+		if (hasAVX && hasOSXSAVE) {
+			// OS must save YMM registers on context switch
+#if defined(_MSC_VER)
+			const unsigned long long xcr0 = _xgetbv(0);
+#else
+			unsigned int eax = 0, edx = 0;
+			__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			const unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+			if ((xcr0 & 0x6) == 0x6)
+				return PitchedCopyPath::AVX;
+		}
+		return hasSSE2 ? PitchedCopyPath::SSE2 : PitchedCopyPath::Scalar;
+	}
+#else
+	PitchedCopyPath _detectPath() {
+		return PitchedCopyPath::Scalar;
+	}
+#endif
+}
+
+PitchedCopyPath PitchedCopy::getBestPath() {
+	static const PitchedCopyPath path = _detectPath();
+	return path;
+}
+
+const char* PitchedCopy::getPathName(PitchedCopyPath path) {
+	switch (path) {
+	case PitchedCopyPath::SSE2:
+		return "SSE2";
+	case PitchedCopyPath::AVX:
+		return "AVX";
+	default:
+		return "Scalar";
+	}
+}
+
+void PitchedCopy::copy(const PitchedRegion& destination, const PitchedRegion& source, size_t rowSize, size_t rowCount, size_t sliceCount) {
+	copy(destination, source, rowSize, rowCount, sliceCount, getBestPath());
+}
+
+void PitchedCopy::copy(const PitchedRegion& destination, const PitchedRegion& source, size_t rowSize, size_t rowCount, size_t sliceCount, PitchedCopyPath path) {
+	// contiguous slices are copied as one tall 2D region
+	if (sliceCount > 1 && destination.slicePitch == destination.rowPitch * rowCount && source.slicePitch == source.rowPitch * rowCount) {
+		rowCount *= sliceCount;
+		sliceCount = 1;
+	}
+
+	// rows with the same pitch are copied as one span (padding included)
+	if (rowCount > 1 && destination.rowPitch == source.rowPitch && sliceCount == 1) {
+		rowSize += destination.rowPitch * (rowCount - 1);
+		rowCount = 1;
+	}
+	if (rowSize < kMinStreamingRowSize)
+		path = PitchedCopyPath::Scalar;
+
+	uint8_t* d = static_cast<uint8_t*>(destination.data);
+	const uint8_t* s = static_cast<const uint8_t*>(source.data);
+
+	for (size_t slice = 0; slice < sliceCount; slice++) {
+		uint8_t* sliceDestination = d + destination.slicePitch * slice;
+		const uint8_t* sliceSource = s + source.slicePitch * slice;
+		switch (path) {
+#if PITCHED_COPY_X86
+		case PitchedCopyPath::AVX:
+			_copyRowsAVX(sliceDestination, destination.rowPitch, sliceSource, source.rowPitch, rowSize, rowCount);
+			break;
+		case PitchedCopyPath::SSE2:
+			_copyRowsSSE2(sliceDestination, destination.rowPitch, sliceSource, source.rowPitch, rowSize, rowCount);
+			break;
+#endif
+		default:
+			_copyRowsScalar(sliceDestination, destination.rowPitch, sliceSource, source.rowPitch, rowSize, rowCount);
+			break;
+		}
+	}
+}
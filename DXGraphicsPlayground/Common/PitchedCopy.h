@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+// Instruction set used by pitched copy
+enum class PitchedCopyPath {
+	Scalar,		// memcpy per row
+	SSE2,		// 16-byte non-temporal stores
+	AVX			// 32-byte non-temporal stores
+};
+
+// 2D/3D region with row and slice pitch
+struct PitchedRegion {
+	void* data;
+	size_t rowPitch;
+	size_t slicePitch;
+};
+
+// Copies rows between buffers of different pitches.
+// Streaming stores bypass cache, which suits write-combined upload heaps.
+namespace PitchedCopy {
+	// Fastest path supported by current CPU (detected once)
+	PitchedCopyPath getBestPath();
+	const char* getPathName(PitchedCopyPath path);
+
+	void copy(const PitchedRegion& destination, const PitchedRegion& source, size_t rowSize, size_t rowCount, size_t sliceCount = 1);
+	void copy(const PitchedRegion& destination, const PitchedRegion& source, size_t rowSize, size_t rowCount, size_t sliceCount, PitchedCopyPath path);
+}
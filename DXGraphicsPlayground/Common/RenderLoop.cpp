@@ -0,0 +1,166 @@
+#include "pch.h"
+#include "RenderLoop.h"
+#include "Time.h"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+RenderLoop::RenderLoop(RenderLoopDelegate* delegate, const RendererOptions& options)
+	: _delegate(delegate), _options(options), _events(kEventCapacity), _hasOverflow(false), _isStopRequested(false), _pendingWidth(0), _pendingHeight(0), _isResizePending(false),
+	_previousTime(0), _frameCount(0), _frameTime(0), _timeSinceStartup(0),
+	_isSizing(false), _sizeEventCount(0), _resizeCount(0), _sizingFrameCount(0), _sizingFrameTimeSum(0), _sizingMaxFrameTime(0)
+{
+	assert(_delegate != nullptr && "Delegate is null.");
+}
+
+void RenderLoop::_post(const RenderEvent& event) {
+	// once overflowed, later events are merged too, so queued events are always older than merged ones.
+	// Only this thread sets the flag, so the lock is taken only while queue is full or overflow isn't processed yet.
+	if (_hasOverflow.load(std::memory_order_acquire) || _events.tryPush(event) == false) {
+		std::lock_guard<std::mutex> lock(_overflowMutex);
+		switch (event.type) {
+		case RenderEventType::Resize:
+			_overflowEvents.resizeCount++;
+			_overflowEvents.resize = event;
+			break;
+		case RenderEventType::Move:
+			_overflowEvents.isMoved = true;
+			_overflowEvents.move = event;
+			break;
+		case RenderEventType::DisplayChange:
+			_overflowEvents.isDisplayChanged = true;
+			break;
+		case RenderEventType::BeginSizing:
+		case RenderEventType::EndSizing:
+			_overflowEvents.isSizingChanged = true;
+			_overflowEvents.isSizing = event.type == RenderEventType::BeginSizing;
+			break;
+		}
+		_hasOverflow.store(true, std::memory_order_release);
+	}
+
+	// events are handled as they arrive without both render thread and coalescing (for comparison)
+	if (_options.renderThread == false && _options.coalesceResize == false)
+		_processEvents();
+}
+
+void RenderLoop::_processEvents() {
+	RenderEvent event;
+	while (_events.tryPop(event))
+		_processEvent(event);
+	_processOverflowEvents();
+
+	// only the last size of this frame is applied
+	_applyPendingResize();
+}
+
+void RenderLoop::_processEvent(const RenderEvent& event) {
+	switch (event.type) {
+	case RenderEventType::Resize:
+		_sizeEventCount += _isSizing ? 1 : 0;
+		_pendingWidth = event.x;
+		_pendingHeight = event.y;
+		_isResizePending = true;
+		if (_options.coalesceResize == false)
+			_applyPendingResize();
+		break;
+	case RenderEventType::Move:
+		_delegate->move(event.x, event.y);
+		break;
+	case RenderEventType::DisplayChange:
+		_delegate->displayDidChange();
+		break;
+	case RenderEventType::BeginSizing:
+		_isSizing = true;
+		_sizeEventCount = _resizeCount = _sizingFrameCount = 0;
+		_sizingFrameTimeSum = _sizingMaxFrameTime = 0;
+		break;
+	case RenderEventType::EndSizing:
+		_applyPendingResize();
+		_reportSizing();
+		_isSizing = false;
+		break;
+	}
+}
+
+void RenderLoop::_processOverflowEvents() {
+	if (_hasOverflow.load(std::memory_order_acquire) == false)
+		return;
+
+	OverflowEvents events;
+	{
+		std::lock_guard<std::mutex> lock(_overflowMutex);
+		events = _overflowEvents;
+		_overflowEvents = OverflowEvents();
+		_hasOverflow.store(false, std::memory_order_release);
+	}
+
+	if (events.isSizingChanged && events.isSizing)
+		_processEvent({ RenderEventType::BeginSizing, 0, 0 });
+	if (events.resizeCount > 0) {
+		_sizeEventCount += _isSizing ? events.resizeCount - 1 : 0;
+		_processEvent(events.resize);
+	}
+	if (events.isMoved)
+		_processEvent(events.move);
+	if (events.isDisplayChanged)
+		_processEvent({ RenderEventType::DisplayChange, 0, 0 });
+	if (events.isSizingChanged && events.isSizing == false && _isSizing)
+		_processEvent({ RenderEventType::EndSizing, 0, 0 });
+}
+
+void RenderLoop::_applyPendingResize() {
+	if (_isResizePending == false)
+		return;
+	_isResizePending = false;
+	_resizeCount += _isSizing ? 1 : 0;
+	_delegate->resize(_pendingWidth, _pendingHeight);
+}
+
+void RenderLoop::_reportSizing() {
+	// moving window doesn't resize
+	if (_sizeEventCount == 0 || _sizingFrameCount == 0)
+		return;
+	std::cout << "Sizing : " << _sizeEventCount << " size events, " << _resizeCount << " resizes, " << _sizingFrameCount << " frames ("
+		<< (_options.coalesceResize ? "coalesced" : "immediate") << ", " << (_options.renderThread ? "render thread" : "window thread")
+		<< "), frame time avg " << _sizingFrameTimeSum * 1000.0f / _sizingFrameCount << " ms, max " << _sizingMaxFrameTime * 1000.0f << " ms" << std::endl;
+}
+
+void RenderLoop::runFrame() {
+	_processEvents();
+	_delegate->waitForNextFrame();
+
+	const double time = _getTime();
+	const uint64_t frameCount = _frameCount.load(std::memory_order_relaxed);
+	const float deltaTime = frameCount > 0 ? static_cast<float>(time - _previousTime) : 0.0f;
+	_previousTime = time;
+	_timeSinceStartup += deltaTime;
+	Time::_deltaTime = deltaTime;
+	Time::_timeSinceStartup = _timeSinceStartup;
+
+	_delegate->update(deltaTime);
+	_delegate->beginFrame();
+	_delegate->render();
+	_delegate->endFrame();
+
+	if (frameCount > 0) {
+		const float frameTime = _frameTime.load(std::memory_order_relaxed);
+		_frameTime.store(frameTime > 0 ? frameTime * 0.9f + deltaTime * 0.1f : deltaTime, std::memory_order_relaxed);
+	}
+	_frameCount.store(frameCount + 1, std::memory_order_relaxed);
+
+	if (_isSizing) {
+		_sizingFrameCount++;
+		_sizingFrameTimeSum += deltaTime;
+		_sizingMaxFrameTime = deltaTime > _sizingMaxFrameTime ? deltaTime : _sizingMaxFrameTime;
+	}
+}
+
+void RenderLoop::run() {
+	while (isStopRequested() == false)
+		runFrame();
+}
+
+double RenderLoop::_getTime() {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
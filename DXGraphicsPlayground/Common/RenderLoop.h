@@ -0,0 +1,115 @@
+#pragma once
+
+#include "EventQueue.h"
+#include "RendererOptions.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// Window events delivered to render loop
+enum class RenderEventType {
+	Resize,			// x, y : client size
+	Move,			// x, y : window position (-1 if unknown)
+	DisplayChange,
+	BeginSizing,	// user started dragging window border
+	EndSizing,
+};
+
+struct RenderEvent {
+	RenderEventType type;
+	int x;
+	int y;
+};
+
+// What render loop drives (RendererBase, or fake renderer in tests)
+class RenderLoopDelegate
+{
+public:
+	virtual ~RenderLoopDelegate() {}
+
+	virtual void update(float deltaTime) = 0;
+	virtual void render() = 0;
+	virtual void move(int windowX, int windowY) = 0;
+	virtual void resize(int newWidth, int newHeight) = 0;
+	virtual void displayDidChange() = 0;
+
+	// Called before update(), so renderers that pace frames can block before input is sampled
+	virtual void waitForNextFrame() {}
+	virtual void beginFrame() = 0;
+	virtual void endFrame() = 0;
+};
+
+// Frame loop of a renderer, fed with window events through lock-free queue.
+// Window thread posts events, and render thread (or window thread itself, without render thread) runs frames.
+// Resizes are coalesced into one per frame unless RendererOptions::coalesceResize is off.
+// Posting never waits for render thread: when queue is full, events are merged into latest values until next frame.
+class RenderLoop
+{
+public:
+	static constexpr size_t kEventCapacity = 256;
+
+	RenderLoop(RenderLoopDelegate* delegate, const RendererOptions& options = RendererOptions());
+	~RenderLoop() {}
+
+	// Properties
+	uint64_t getFrameCount() const { return _frameCount.load(std::memory_order_relaxed); }
+	// Moving average of frame time in seconds (readable from any thread)
+	float getFrameTime() const { return _frameTime.load(std::memory_order_relaxed); }
+
+	// Events (window thread)
+	void postResize(int newWidth, int newHeight) { _post({ RenderEventType::Resize, newWidth, newHeight }); }
+	void postMove(int windowX = -1, int windowY = -1) { _post({ RenderEventType::Move, windowX, windowY }); }
+	void postDisplayChange() { _post({ RenderEventType::DisplayChange, 0, 0 }); }
+	void postBeginSizing() { _post({ RenderEventType::BeginSizing, 0, 0 }); }
+	void postEndSizing() { _post({ RenderEventType::EndSizing, 0, 0 }); }
+
+	// Frames (render thread)
+	void runFrame();
+	// Runs frames until stop is requested
+	void run();
+	// Any thread
+	void requestStop() { _isStopRequested.store(true, std::memory_order_release); }
+	bool isStopRequested() const { return _isStopRequested.load(std::memory_order_acquire); }
+
+private:
+	// Events that didn't fit in queue, only latest of each type is kept
+	struct OverflowEvents {
+		uint32_t resizeCount = 0;
+		RenderEvent resize = {};
+		bool isMoved = false;
+		RenderEvent move = {};
+		bool isDisplayChanged = false;
+		bool isSizingChanged = false;
+		bool isSizing = false;
+	};
+
+	void _post(const RenderEvent& event);
+	void _processEvents();
+	void _processEvent(const RenderEvent& event);
+	void _processOverflowEvents();
+	void _applyPendingResize();
+	void _reportSizing();
+	static double _getTime();
+
+	RenderLoopDelegate* _delegate;
+	RendererOptions _options;
+	EventQueue<RenderEvent> _events;
+	// Overflow is only locked after queue was full, never during frame
+	std::atomic<bool> _hasOverflow;
+	std::mutex _overflowMutex;
+	OverflowEvents _overflowEvents;
+	std::atomic<bool> _isStopRequested;
+	int _pendingWidth, _pendingHeight;
+	bool _isResizePending;
+
+	// frame time
+	double _previousTime;
+	std::atomic<uint64_t> _frameCount;
+	std::atomic<float> _frameTime;
+	float _timeSinceStartup;
+
+	// frame times while window is sized (reported at RenderEventType::EndSizing)
+	bool _isSizing;
+	int _sizeEventCount, _resizeCount, _sizingFrameCount;
+	float _sizingFrameTimeSum, _sizingMaxFrameTime;
+};
@@ -0,0 +1,29 @@
+#include "pch.h"
+#include "RenderTargetBuckets.h"
+
+RenderTargetBuckets::RenderTargetBuckets(uint32_t granularity)
+	: _granularity(granularity > 0 ? granularity : 1), _targetWidth(0), _targetHeight(0), _rebuildCount(0)
+{
+}
+
+uint32_t RenderTargetBuckets::roundUp(uint32_t size, uint32_t granularity) {
+	// empty window still gets one bucket
+	const uint32_t bucketCount = size > 0 ? (size + granularity - 1) / granularity : 1;
+	return bucketCount * granularity;
+}
+
+bool RenderTargetBuckets::update(uint32_t width, uint32_t height) {
+	const uint32_t bucketWidth = roundUp(width, _granularity);
+	const uint32_t bucketHeight = roundUp(height, _granularity);
+
+	// current targets are reused if they contain the window and aren't more than twice as large as its bucket
+	const uint64_t bucketArea = static_cast<uint64_t>(bucketWidth) * bucketHeight;
+	const uint64_t targetArea = static_cast<uint64_t>(_targetWidth) * _targetHeight;
+	if (_targetWidth >= bucketWidth && _targetHeight >= bucketHeight && targetArea <= bucketArea * 2)
+		return false;
+
+	_targetWidth = bucketWidth;
+	_targetHeight = bucketHeight;
+	_rebuildCount++;
+	return true;
+}
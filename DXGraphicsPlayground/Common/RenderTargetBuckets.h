@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// Picks sizes of window-sized render targets.
+// Sizes are rounded up to buckets, so targets survive resizes within a bucket and are kept when shrinking
+// until they'd waste more than half of their texels. Renderers draw the window-sized region of targets.
+class RenderTargetBuckets
+{
+public:
+	static constexpr uint32_t kDefaultGranularity = 128;
+
+	RenderTargetBuckets(uint32_t granularity = kDefaultGranularity);
+	~RenderTargetBuckets() {}
+
+	// Properties
+	uint32_t getGranularity() const { return _granularity; }
+	uint32_t getTargetWidth() const { return _targetWidth; }
+	uint32_t getTargetHeight() const { return _targetHeight; }
+	uint32_t getRebuildCount() const { return _rebuildCount; }
+
+	static uint32_t roundUp(uint32_t size, uint32_t granularity);
+
+	// Returns true if targets must be recreated with new target size
+	bool update(uint32_t width, uint32_t height);
+
+private:
+	uint32_t _granularity;
+	uint32_t _targetWidth;
+	uint32_t _targetHeight;
+	uint32_t _rebuildCount;
+};
@@ -1,30 +1,27 @@
 #pragma once
 
+#include "RendererOptions.h"
+#include "RenderLoop.h"
 #include <Windows.h>
 
-// Renderer base class
-class RendererBase
+// Renderer base class (frames are driven by RenderLoop through RenderLoopDelegate)
+class RendererBase : public RenderLoopDelegate
 {
 public:
-	RendererBase() : _hWnd(0) {}
+	RendererBase(const RendererOptions& options = RendererOptions()) : _hWnd(0), _options(options) {}
 	virtual ~RendererBase() {}
 
+	const RendererOptions& getOptions() const { return _options; }
 	HWND getHWnd() const { return _hWnd; }
 	virtual void setHWnd(HWND hWnd) { _hWnd = hWnd; }
 
 	virtual void init() = 0;
 
-	virtual void update(float deltaTime) = 0;
-	virtual void render() = 0;
-	virtual void move(int windowX = -1, int windowY = -1) = 0;
-	virtual void resize(int newWidth, int newHeight) = 0;
-	virtual void displayDidChange() = 0;
-
-	virtual void beginFrame() = 0;
-	virtual void endFrame() = 0;
-
 protected:
 	// window handle
 	HWND _hWnd;
+
+	// startup options (not every renderer uses all of them)
+	RendererOptions _options;
 };
 
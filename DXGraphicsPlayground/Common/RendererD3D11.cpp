@@ -3,7 +3,10 @@
 #include "D3DInternalUtils.h"
 #include <iostream>
 
-RendererD3D11::RendererD3D11() : _width(512), _height(512) {
+RendererD3D11::RendererD3D11(const RendererOptions& options)
+	: RendererBase(options), _width(512), _height(512), _currentFrameIndex(0),
+	_isTearingSupported(false), _swapChainBufferCount(kMaxBuffersInFlight), _swapChainFlags(0) {
+	std::cout << "Present : " << RendererOptions::getPresentModeName(_options.presentMode) << std::endl;
 	createDevice();
 }
 
@@ -146,18 +149,27 @@ void RendererD3D11::setHWnd(HWND hWnd) {
 
 void RendererD3D11::_initSwapChain() {
 	if (_swapChain.Get() == nullptr) {
+		_isTearingSupported = _options.presentMode == PresentMode::Immediate && IsTearingSupported(_factory.Get());
+		if (_options.presentMode == PresentMode::Immediate && _isTearingSupported == false)
+			std::cout << "Tearing is not supported, immediate presents are blitted." << std::endl;
+		_swapChainBufferCount = _isTearingSupported ? 2 : kMaxBuffersInFlight;
+		_swapChainFlags = _isTearingSupported ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0;
+
 		HRESULT result = 0;
 		DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
 		swapChainDesc.BufferDesc.Width = _width;
 		swapChainDesc.BufferDesc.Height = _height;
 		swapChainDesc.BufferDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-		swapChainDesc.BufferCount = kMaxBuffersInFlight;
+		swapChainDesc.BufferCount = _swapChainBufferCount;
 		swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
 		swapChainDesc.SampleDesc.Count = 1;
 		swapChainDesc.Windowed = true;
 		swapChainDesc.OutputWindow = _hWnd;
+		swapChainDesc.Flags = _swapChainFlags;
 		if (swapChainDesc.BufferCount == 1)
 			swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+		else if (_isTearingSupported)
+			swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
 		else
 			swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
 		if (_factory != nullptr) {
@@ -237,12 +249,13 @@ void RendererD3D11::render() {}
 void RendererD3D11::move(int windowX, int windowY) {}
 
 void RendererD3D11::resize(int newWidth, int newHeight) {
-	if (_swapChain != nullptr) {
+	// restoring from minimized or maximized state may repeat current size
+	if (_swapChain != nullptr && (newWidth != _width || newHeight != _height)) {
 		_cleanupBackBuffers();
 
 		_width = newWidth;
 		_height = newHeight;
-		_swapChain->ResizeBuffers(kMaxBuffersInFlight, newWidth, newHeight, DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH);
+		_swapChain->ResizeBuffers(_swapChainBufferCount, newWidth, newHeight, DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH | _swapChainFlags);
 		_initBackBuffers();
 	}
 }
@@ -263,6 +276,10 @@ void RendererD3D11::beginFrame() {
 }
 
 void RendererD3D11::endFrame() {
-	_swapChain->Present(1, 0);
+	// PresentMode::None leaves frame in back buffer
+	if (_options.presentMode == PresentMode::VSync)
+		_swapChain->Present(_options.syncInterval, 0);
+	else if (_options.presentMode == PresentMode::Immediate)
+		_swapChain->Present(0, _isTearingSupported ? DXGI_PRESENT_ALLOW_TEARING : 0);
 	_currentFrameIndex = (_currentFrameIndex + 1) % kMaxBuffersInFlight;
 }
\ No newline at end of file
@@ -13,7 +13,7 @@ class RendererD3D11 : public RendererBase
 {
 	/* Member functions */
 public:
-	RendererD3D11();
+	RendererD3D11(const RendererOptions& options = RendererOptions());
 	~RendererD3D11();
 
 	// Properties
@@ -70,5 +70,10 @@ protected:
 	ComPtr<ID3D11DepthStencilView> _depthStencilView;
 	int _width, _height;
 	int _currentFrameIndex;
+
+	// PresentMode::Immediate uses flip model with tearing if it's supported (buffer 0 is always back buffer)
+	bool _isTearingSupported;
+	UINT _swapChainBufferCount;
+	UINT _swapChainFlags;
 };
 
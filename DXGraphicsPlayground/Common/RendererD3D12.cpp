@@ -1,10 +1,35 @@
 #include "pch.h"
 #include "RendererD3D12.h"
 #include "D3DInternalUtils.h"
+#include "ResourceUploader.h"
+#include "HeapAllocator.h"
+#include "ConstantBufferAllocator.h"
+#include "DescriptorAllocator.h"
+#include "UploadQueue.h"
+#include "DeferredReleaseQueue.h"
+#include "TextureStreamer.h"
+#include "AllocationRegistry.h"
 #include <iostream>
 #include <dxgi1_6.h>
 
-RendererD3D12::RendererD3D12() : _width(512), _height(512), _referenceSDRWhiteNits(80), _isHDROutputSupported(false) {
+namespace {
+	constexpr double kFramePacingReportInterval = 5.0;
+
+	// seconds, for frame pacing
+	double _getTime() {
+		LARGE_INTEGER counter = {}, frequency = {};
+		QueryPerformanceCounter(&counter);
+		QueryPerformanceFrequency(&frequency);
+		return static_cast<double>(counter.QuadPart) / frequency.QuadPart;
+	}
+}
+
+RendererD3D12::RendererD3D12(const RendererOptions& options)
+	: RendererBase(options), _width(512), _height(512), _currentFrameIndex(0), _currentBackBufferIndex(0), _frameWaitTime(0),
+	_framePacer(options.framePacing, options.maxFrameLatency), _frameLatencyWaitableObject(nullptr), _lastFramePacingReportTime(0),
+	_referenceSDRWhiteNits(80), _isHDROutputSupported(false), _isTearingSupported(false) {
+	std::cout << "Frames in flight : " << _options.framesInFlight << ", back buffers : " << _options.backBufferCount
+		<< ", present : " << RendererOptions::getPresentModeName(_options.presentMode) << std::endl;
 	createDevice();
 }
 
@@ -147,8 +172,8 @@ void RendererD3D12::_initDevice() {
 	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
 	_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&_queue));
 
-	// frame buffers
-	for (int i = 0; i < kMaxBuffersInFlight; i++) {
+	// command allocators of frames in flight
+	for (UINT i = 0; i < _options.framesInFlight; i++) {
 		// allocator
 		_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&_renderCommandAllocators[i]));
 
@@ -156,14 +181,36 @@ void RendererD3D12::_initDevice() {
 		_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, _renderCommandAllocators[i].Get(), nullptr, IID_PPV_ARGS(&_renderCommandLists[i]));
 		_renderCommandLists[i]->Close();
 	}
+
+	// placed resource heaps and upload ring buffer
+	_heapAllocator = std::make_unique<HeapAllocator>(_device.Get());
+	_resourceUploader = std::make_unique<ResourceUploader>(_device.Get());
+	_constantBufferAllocator = std::make_unique<ConstantBufferAllocator>(_device.Get());
+
+	// descriptor heaps
+	_descriptorAllocator = std::make_unique<DescriptorAllocator>(_device.Get());
+
+	// copy queue for streaming
+	_uploadQueue = std::make_unique<UploadQueue>(_device.Get(), _options.framesInFlight + 1);
+
+	// destruction deferred by fence (declared before users, so they can retire on destruction)
+	_deferredReleaseQueue = std::make_unique<DeferredReleaseQueue>();
+	_textureStreamer = std::make_unique<TextureStreamer>(_device.Get(), _uploadQueue.get(), _descriptorAllocator.get(), _deferredReleaseQueue.get());
 }
 
 void RendererD3D12::_cleanupDevice() {
-	for (int i = 0; i < kMaxBuffersInFlight; i++) {
+	for (UINT i = 0; i < _options.framesInFlight; i++) {
 		_renderCommandAllocators[i].Reset();
 		_renderCommandLists[i].Reset();
 	}
 
+	_textureStreamer.reset();
+	_deferredReleaseQueue.reset();
+	_uploadQueue.reset();
+	_descriptorAllocator.reset();
+	_constantBufferAllocator.reset();
+	_resourceUploader.reset();
+	_heapAllocator.reset();
 	_queue.Reset();
 	_device.Reset();
 	_currentAdapter.Reset();
@@ -224,17 +271,22 @@ void RendererD3D12::_initSwapChain() {
 	}
 
 	if (_swapChain.Get() == nullptr) {
+		_isTearingSupported = _options.presentMode == PresentMode::Immediate && IsTearingSupported(_factory.Get());
+		if (_options.presentMode == PresentMode::Immediate && _isTearingSupported == false)
+			std::cout << "Tearing is not supported, immediate presents are still composed." << std::endl;
+
 		HRESULT result = 0;
 		DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
 		swapChainDesc.Width = _width;
 		swapChainDesc.Height = _height;
 		swapChainDesc.Format = _isHDROutputSupported ? DXGI_FORMAT_R10G10B10A2_UNORM : DXGI_FORMAT_B8G8R8A8_UNORM;
 		swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
-		swapChainDesc.BufferCount = kMaxBuffersInFlight;
+		swapChainDesc.BufferCount = _options.backBufferCount;
 		swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT | DXGI_USAGE_BACK_BUFFER;
 		swapChainDesc.SampleDesc.Count = 1;
 		swapChainDesc.SampleDesc.Quality = 0;
 		swapChainDesc.Scaling = DXGI_SCALING_STRETCH;
+		swapChainDesc.Flags = _getSwapChainFlags();
 		if (_factory != nullptr) {
 			ComPtr<IDXGISwapChain1> swapChain;
 			result = _factory->CreateSwapChainForHwnd(_queue.Get(), _hWnd, &swapChainDesc, nullptr, nullptr, &swapChain);
@@ -248,7 +300,13 @@ void RendererD3D12::_initSwapChain() {
 				return;
 			}
 		}
-		_currentFrameIndex = _swapChain->GetCurrentBackBufferIndex();
+		_currentBackBufferIndex = _swapChain->GetCurrentBackBufferIndex();
+
+		// Present blocks no more, frames are throttled by waiting on this object at frame start
+		if (_framePacer.waitsAtFrameStart()) {
+			_swapChain->SetMaximumFrameLatency(_framePacer.getMaxFrameLatency());
+			_frameLatencyWaitableObject = _swapChain->GetFrameLatencyWaitableObject();
+		}
 
 		if (_isHDROutputSupported) {
 			std::cerr << "Enabling ST2084 color space for HDR!" << std::endl;
@@ -271,7 +329,7 @@ void RendererD3D12::_initSwapChain() {
 
 	if (_renderTargetViewHeap.Get() == nullptr) {
 		D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-		heapDesc.NumDescriptors = kMaxBuffersInFlight;
+		heapDesc.NumDescriptors = _options.backBufferCount;
 		heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
 		_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&_renderTargetViewHeap));
 	}
@@ -279,16 +337,26 @@ void RendererD3D12::_initSwapChain() {
 
 void RendererD3D12::_cleanupSwapChain() {
 	_cleanupBackBuffers();
+	if (_frameLatencyWaitableObject != nullptr) {
+		CloseHandle(_frameLatencyWaitableObject);
+		_frameLatencyWaitableObject = nullptr;
+	}
+	_framePacer.cancel();
 	_renderTargetViewHeap.Reset();
 	_swapChain.Reset();
 }
 
+UINT RendererD3D12::_getSwapChainFlags() const {
+	return (_framePacer.waitsAtFrameStart() ? DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0)
+		| (_isTearingSupported ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0);
+}
+
 void RendererD3D12::_initBackBuffers() {
 	if (_swapChain.Get() != nullptr) {
 		D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = _renderTargetViewHeap->GetCPUDescriptorHandleForHeapStart();
 		size_t rtvDescriptorSize = _device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
-		for (int i = 0; i < kMaxBuffersInFlight; i++) {
+		for (UINT i = 0; i < _options.backBufferCount; i++) {
 			_swapChain->GetBuffer(i, IID_PPV_ARGS(&_backBuffers[i]));
 			_device->CreateRenderTargetView(_backBuffers[i].Get(), nullptr, rtvHandle);
 			rtvHandle.ptr += rtvDescriptorSize;
@@ -297,15 +365,15 @@ void RendererD3D12::_initBackBuffers() {
 }
 
 void RendererD3D12::_cleanupBackBuffers() {
-	for (int i = 0; i < kMaxBuffersInFlight; i++) {
+	for (UINT i = 0; i < _options.backBufferCount; i++)
 		_backBuffers[i].Reset();
+	for (UINT i = 0; i < _options.framesInFlight; i++)
 		_fenceValues[i] = _fenceValues[_currentFrameIndex];
-	}
 }
 
 void RendererD3D12::_initFences() {
 	if (_fence.Get() == nullptr) {
-		for (int i = 0; i < kMaxBuffersInFlight; i++) {
+		for (UINT i = 0; i < _options.framesInFlight; i++) {
 			_fenceValues[i] = 0;
 		}
 
@@ -367,30 +435,54 @@ void RendererD3D12::_waitForGpu() {
 	// Signal fence value
 	if (_queue != nullptr && _fence != nullptr) {
 		const UINT64 currentFenceValue = _fenceValues[_currentFrameIndex];
+		_finishSubmission(currentFenceValue);
 		_queue->Signal(_fence.Get(), currentFenceValue);
 
 		// Wait for completion
 		_fence->SetEventOnCompletion(currentFenceValue, _fenceEvent);
 		WaitForSingleObjectEx(_fenceEvent, INFINITE, false);
 		_fenceValues[_currentFrameIndex] = currentFenceValue + 1;
+		_reclaimCompletedSubmissions();
 	}
 }
 
 void RendererD3D12::_prepareNextBackBuffer() {
 	// Signal fence value
 	const UINT64 currentFenceValue = _fenceValues[_currentFrameIndex];
+	_finishSubmission(currentFenceValue);
 	_queue->Signal(_fence.Get(), currentFenceValue);
 
-	// Get next back buffer index
-	_currentFrameIndex = _swapChain->GetCurrentBackBufferIndex();
+	// Next frame slot rotates by frames in flight, independently of back buffer
+	_currentFrameIndex = (_currentFrameIndex + 1) % _options.framesInFlight;
+	_currentBackBufferIndex = _swapChain->GetCurrentBackBufferIndex();
 
-	// Wait for fence value
-	UINT64 completedFenceValue = _fence->GetCompletedValue();
+	// Wait until GPU is done with commands recorded in this slot
+	const double waitBeginTime = _getTime();
 	if (_fence->GetCompletedValue() < _fenceValues[_currentFrameIndex]) {
 		_fence->SetEventOnCompletion(_fenceValues[_currentFrameIndex], _fenceEvent);
 		WaitForSingleObjectEx(_fenceEvent, INFINITE, false);
 	}
 	_fenceValues[_currentFrameIndex] = currentFenceValue + 1;
+	const float waitTime = static_cast<float>((_getTime() - waitBeginTime) * 1000.0);
+	_frameWaitTime = _frameWaitTime * 0.9f + waitTime * 0.1f;
+
+	// Reclaim transient memory of retired frames
+	_reclaimCompletedSubmissions();
+}
+
+void RendererD3D12::_finishSubmission(UINT64 fenceValue) {
+	_resourceUploader->finishSubmission(fenceValue);
+	_constantBufferAllocator->finishSubmission(fenceValue);
+	_descriptorAllocator->finishSubmission(fenceValue);
+	_deferredReleaseQueue->finishSubmission(fenceValue);
+}
+
+void RendererD3D12::_reclaimCompletedSubmissions() {
+	_resourceUploader->reclaim(_fence.Get());
+	_constantBufferAllocator->reclaim(_fence.Get());
+	_deferredReleaseQueue->reclaim(_fence->GetCompletedValue());
+	_descriptorAllocator->reclaim(_fence.Get());
+	_uploadQueue->update();
 }
 
 void RendererD3D12::update(float deltaTime) {}
@@ -404,12 +496,15 @@ void RendererD3D12::move(int windowX, int windowY) {
 }
 
 void RendererD3D12::resize(int newWidth, int newHeight) {
-	if (_swapChain != nullptr) {
+	// restoring from minimized or maximized state may repeat current size
+	if (_swapChain != nullptr && (newWidth != _width || newHeight != _height)) {
+		// ResizeBuffers needs back buffers unreferenced by GPU, so only swap chain waits.
+		// Other size-dependent resources are retired to deferred release queue.
 		_waitForGpu();
 		_cleanupBackBuffers();
 
-		_swapChain->ResizeBuffers(kMaxBuffersInFlight, newWidth, newHeight, _isHDROutputSupported ? DXGI_FORMAT_R10G10B10A2_UNORM : DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH);
-		_currentFrameIndex = _swapChain->GetCurrentBackBufferIndex();
+		_swapChain->ResizeBuffers(_options.backBufferCount, newWidth, newHeight, _isHDROutputSupported ? DXGI_FORMAT_R10G10B10A2_UNORM : DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH | _getSwapChainFlags());
+		_currentBackBufferIndex = _swapChain->GetCurrentBackBufferIndex();
 
 		if (_isHDROutputSupported)
 			_updateSDRWhiteLevel();
@@ -420,7 +515,19 @@ void RendererD3D12::resize(int newWidth, int newHeight) {
 	}
 }
 
+void RendererD3D12::waitForNextFrame() {
+	// Low latency pacing blocks here, before update() samples input for this frame
+	if (_framePacer.waitsAtFrameStart() && _frameLatencyWaitableObject != nullptr) {
+		_framePacer.beginWait(_getTime());
+		WaitForSingleObjectEx(_frameLatencyWaitableObject, 1000, true);
+	}
+	_framePacer.beginFrame(_getTime());
+}
+
 void RendererD3D12::beginFrame() {
+	if (_framePacer.getState() != FramePacer::State::Recording)
+		_framePacer.beginFrame(_getTime());
+
 	auto commandAllocator = _renderCommandAllocators[_currentFrameIndex];
 	auto commandList = _renderCommandLists[_currentFrameIndex];
 	HRESULT result = S_OK;
@@ -434,7 +541,7 @@ void RendererD3D12::beginFrame() {
 	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
 	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
 	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-	barrier.Transition.pResource = _backBuffers[_currentFrameIndex].Get();
+	barrier.Transition.pResource = _backBuffers[_currentBackBufferIndex].Get();
 	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 	commandList->ResourceBarrier(1, &barrier);
 
@@ -447,7 +554,7 @@ void RendererD3D12::beginFrame() {
 	// Set render target
 	size_t renderTargetViewSize = _device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 	D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = _renderTargetViewHeap->GetCPUDescriptorHandleForHeapStart();
-	rtvHandle.ptr += (renderTargetViewSize * _currentFrameIndex);
+	rtvHandle.ptr += (renderTargetViewSize * _currentBackBufferIndex);
 	commandList->OMSetRenderTargets(1, &rtvHandle, false, nullptr);
 	static float clearColor[4] = { 0.2f, 0.2f, 0.2f, 0.0f };
 	commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
@@ -461,7 +568,7 @@ void RendererD3D12::endFrame() {
 	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
 	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
 	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
-	barrier.Transition.pResource = _backBuffers[_currentFrameIndex].Get();
+	barrier.Transition.pResource = _backBuffers[_currentBackBufferIndex].Get();
 	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 	commandList->ResourceBarrier(1, &barrier);
 	commandList->Close();
@@ -470,9 +577,31 @@ void RendererD3D12::endFrame() {
 	ID3D12CommandList* commandLists[] = { commandList.Get() };
 	_queue->ExecuteCommandLists(1, commandLists);
 
-	// Swap buffers
-	_swapChain->Present(1, 0);
+	// Swap buffers (PresentMode::None leaves frame in back buffer)
+	if (_options.presentMode == PresentMode::VSync)
+		_swapChain->Present(_options.syncInterval, 0);
+	else if (_options.presentMode == PresentMode::Immediate)
+		_swapChain->Present(0, _isTearingSupported ? DXGI_PRESENT_ALLOW_TEARING : 0);
+	_framePacer.present(_getTime());
+	_reportFramePacing();
 
 	// Prepare next backbuffer...
 	_prepareNextBackBuffer();
+
+	AllocationRegistry::getShared().endFrame();
+}
+
+void RendererD3D12::_reportFramePacing() {
+	const double time = _getTime();
+	if (time - _lastFramePacingReportTime < kFramePacingReportInterval)
+		return;
+
+	const FramePacingStats& stats = _framePacer.getStats();
+	if (_lastFramePacingReportTime > 0 && stats.frameCount > 0) {
+		std::cout << "Frame pacing (" << (_framePacer.waitsAtFrameStart() ? "low latency" : "throughput")
+			<< ") : CPU start to present " << stats.averageLatency * 1000.0 << " ms (" << stats.minLatency * 1000.0 << " ~ " << stats.maxLatency * 1000.0
+			<< "), wait " << stats.averageWaitTime * 1000.0 << " ms, fence wait " << _frameWaitTime << " ms, interval " << stats.averageFrameInterval * 1000.0 << " ms" << std::endl;
+	}
+	_framePacer.resetStats();
+	_lastFramePacingReportTime = time;
 }
\ No newline at end of file
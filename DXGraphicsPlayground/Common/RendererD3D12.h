@@ -5,20 +5,39 @@
 #include <d3d12.h>
 #include <dxgi1_4.h>
 #include <wrl/client.h>
+#include <memory>
 
 using Microsoft::WRL::ComPtr;
 
+class ResourceUploader;
+class HeapAllocator;
+class ConstantBufferAllocator;
+class DescriptorAllocator;
+class UploadQueue;
+class DeferredReleaseQueue;
+class TextureStreamer;
+
 // Direct3D 12 Renderer base class.
 class RendererD3D12 : public RendererBase
 {
 	/* Member functions */
 public:
-	RendererD3D12();
+	RendererD3D12(const RendererOptions& options = RendererOptions());
 	~RendererD3D12();
 
 	// Properties
+	// CPU time blocked on fence of next frame (moving average, in milliseconds)
+	float getFrameWaitTime() const { return _frameWaitTime; }
+	const FramePacer& getFramePacer() const { return _framePacer; }
 	ID3D12Device* getDevice() const { return _device.Get(); }
 	ID3D12CommandQueue* getQueue() const { return _queue.Get(); }
+	ResourceUploader* getResourceUploader() const { return _resourceUploader.get(); }
+	HeapAllocator* getHeapAllocator() const { return _heapAllocator.get(); }
+	ConstantBufferAllocator* getConstantBufferAllocator() const { return _constantBufferAllocator.get(); }
+	DescriptorAllocator* getDescriptorAllocator() const { return _descriptorAllocator.get(); }
+	UploadQueue* getUploadQueue() const { return _uploadQueue.get(); }
+	DeferredReleaseQueue* getDeferredReleaseQueue() const { return _deferredReleaseQueue.get(); }
+	TextureStreamer* getTextureStreamer() const { return _textureStreamer.get(); }
 	virtual void setHWnd(HWND hWnd) override;
 
 	// Device
@@ -34,6 +53,7 @@ public:
 	virtual void render() override;
 	virtual void move(int windowX, int windowY) override;
 	virtual void resize(int newWidth, int newHeight) override;
+	virtual void waitForNextFrame() override;
 	virtual void beginFrame() override;
 	virtual void endFrame() override;
 
@@ -41,6 +61,9 @@ protected:
 	// Synchronization
 	void _waitForGpu();
 	void _prepareNextBackBuffer();
+	void _finishSubmission(UINT64 fenceValue);
+	void _reclaimCompletedSubmissions();
+	void _reportFramePacing();
 
 	// Properties
 	ID3D12GraphicsCommandList* _getRenderCommandList() const { return _renderCommandLists[_currentFrameIndex].Get(); }
@@ -53,6 +76,7 @@ private:
 
 	void _initSwapChain();
 	void _cleanupSwapChain();
+	UINT _getSwapChainFlags() const;
 	void _initBackBuffers();
 	void _cleanupBackBuffers();
 
@@ -61,9 +85,6 @@ private:
 
 	/* Member variables */
 protected:
-	// constants
-	static constexpr int kMaxBuffersInFlight = 3;
-
 	// Device
 	ComPtr<IDXGIFactory4> _factory;
 	ComPtr<IDXGIAdapter1> _currentAdapter;
@@ -72,20 +93,39 @@ protected:
 
 	// Queue
 	ComPtr<ID3D12CommandQueue> _queue;
-	ComPtr<ID3D12CommandAllocator> _renderCommandAllocators[kMaxBuffersInFlight];
-	ComPtr<ID3D12GraphicsCommandList> _renderCommandLists[kMaxBuffersInFlight];
+	ComPtr<ID3D12CommandAllocator> _renderCommandAllocators[RendererOptions::kMaxFramesInFlight];
+	ComPtr<ID3D12GraphicsCommandList> _renderCommandLists[RendererOptions::kMaxFramesInFlight];
+
+	// Resource allocation and upload
+	std::unique_ptr<HeapAllocator> _heapAllocator;
+	std::unique_ptr<ResourceUploader> _resourceUploader;
+	std::unique_ptr<ConstantBufferAllocator> _constantBufferAllocator;
+	std::unique_ptr<DescriptorAllocator> _descriptorAllocator;
+	std::unique_ptr<UploadQueue> _uploadQueue;	// streaming uploads on copy queue
+	std::unique_ptr<DeferredReleaseQueue> _deferredReleaseQueue;	// resources replaced while frames in flight use them
+	std::unique_ptr<TextureStreamer> _textureStreamer;	// mip streaming of cooked textures
 
 	// Swap chain
 	ComPtr<IDXGISwapChain3> _swapChain;
-	ComPtr<ID3D12Resource> _backBuffers[kMaxBuffersInFlight];
+	ComPtr<ID3D12Resource> _backBuffers[RendererOptions::kMaxBackBufferCount];
 	ComPtr<ID3D12DescriptorHeap> _renderTargetViewHeap;
 	ComPtr<ID3D12Fence> _fence;
 	int _width, _height;
 	HANDLE _fenceEvent;
-	UINT64 _fenceValues[kMaxBuffersInFlight];
-	int _currentFrameIndex;
+	UINT64 _fenceValues[RendererOptions::kMaxFramesInFlight];
+	int _currentFrameIndex;			// slot of command allocator and fence value, rotates by frames in flight
+	int _currentBackBufferIndex;	// from swap chain
+	float _frameWaitTime;
+
+	// Frame pacing
+	FramePacer _framePacer;
+	HANDLE _frameLatencyWaitableObject;		// only for FramePacingMode::LowLatency
+	double _lastFramePacingReportTime;
 
 	// HDR
 	int _referenceSDRWhiteNits;
 	bool _isHDROutputSupported;
+
+	// PresentMode::Immediate
+	bool _isTearingSupported;
 };
\ No newline at end of file
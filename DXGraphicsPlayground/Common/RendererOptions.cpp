@@ -0,0 +1,83 @@
+#include "pch.h"
+#include "RendererOptions.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+	uint32_t _parseCount(const char* name, const char* value, uint32_t minCount, uint32_t maxCount) {
+		const uint32_t count = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+		const uint32_t clampedCount = count < minCount ? minCount : (count > maxCount ? maxCount : count);
+		if (clampedCount != count)
+			std::cerr << name << " " << value << " is out of range, using " << clampedCount << "." << std::endl;
+		return clampedCount;
+	}
+}
+
+RendererOptions RendererOptions::parse(int argc, char** argv) {
+	RendererOptions options;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--low-latency") == 0) {
+			options.framePacing = FramePacingMode::LowLatency;
+			if (i + 1 < argc && argv[i + 1][0] != '-') {
+				i++;
+				options.maxFrameLatency = _parseCount(argv[i - 1], argv[i], 1, kMaxFrameLatency);
+			}
+		}
+		else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc) {
+			i++;
+			options.framesInFlight = _parseCount(argv[i - 1], argv[i], 1, kMaxFramesInFlight);
+		}
+		else if (strcmp(argv[i], "--back-buffers") == 0 && i + 1 < argc) {
+			// flip model swap chains need at least 2 buffers
+			i++;
+			options.backBufferCount = _parseCount(argv[i - 1], argv[i], 2, kMaxBackBufferCount);
+		}
+		else if (strcmp(argv[i], "--present") == 0 && i + 1 < argc) {
+			i++;
+			const PresentMode modes[] = { PresentMode::VSync, PresentMode::Immediate, PresentMode::None };
+			bool found = false;
+			for (PresentMode mode : modes) {
+				if (strcmp(argv[i], getPresentModeName(mode)) == 0) {
+					options.presentMode = mode;
+					found = true;
+				}
+			}
+			if (found == false)
+				std::cerr << "Unknown present mode : " << argv[i] << std::endl;
+		}
+		else if (strcmp(argv[i], "--sync-interval") == 0 && i + 1 < argc) {
+			i++;
+			options.syncInterval = _parseCount(argv[i - 1], argv[i], 1, 4);
+		}
+		else if (strcmp(argv[i], "--immediate-resize") == 0) {
+			options.coalesceResize = false;
+		}
+		else if (strcmp(argv[i], "--no-render-thread") == 0) {
+			options.renderThread = false;
+		}
+		else if (strcmp(argv[i], "--no-image") == 0) {
+			options.loadImage = false;
+		}
+	}
+
+	// frame latency object is signaled by presents
+	if (options.presentMode == PresentMode::None && options.framePacing == FramePacingMode::LowLatency) {
+		std::cerr << "--low-latency is ignored without present." << std::endl;
+		options.framePacing = FramePacingMode::Throughput;
+	}
+	return options;
+}
+
+const char* RendererOptions::getPresentModeName(PresentMode mode) {
+	switch (mode) {
+	case PresentMode::VSync:
+		return "vsync";
+	case PresentMode::Immediate:
+		return "immediate";
+	case PresentMode::None:
+		return "none";
+	default:
+		return "unknown";
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "FramePacer.h"
+#include <cstdint>
+
+enum class PresentMode {
+	VSync,			// Present(syncInterval)
+	Immediate,		// Present(0), tearing if supported
+	None,			// frames are rendered but never presented (measures rendering alone)
+};
+
+// Startup options of renderers, parsed from command line
+//   --frames-in-flight <n> : frames CPU may record ahead of GPU (each has its own command allocator and fence value)
+//   --back-buffers <n>     : buffers of swap chain
+//   --low-latency [n]      : waits at frame start on frame latency waitable object, with max n queued frames (1 by default)
+//   --present <mode>       : vsync, immediate or none
+//   --sync-interval <n>    : vertical blanks per frame with vsync
+//   --immediate-resize     : resizes on every WM_SIZE instead of once per frame (for comparing frame times while sizing)
+//   --no-render-thread     : runs frames in WM_PAINT on window thread instead of dedicated render thread
+//   --no-image             : shows placeholder texture instead of loading image from Assets
+// Fewer frames in flight lower input latency, more back buffers keep GPU busy while a buffer is on screen.
+struct RendererOptions {
+	static constexpr uint32_t kMaxFramesInFlight = 4;
+	static constexpr uint32_t kMaxBackBufferCount = 4;
+	static constexpr uint32_t kMaxFrameLatency = 16;	// IDXGISwapChain2::SetMaximumFrameLatency
+
+	uint32_t framesInFlight = 3;
+	uint32_t backBufferCount = 3;
+	FramePacingMode framePacing = FramePacingMode::Throughput;
+	uint32_t maxFrameLatency = 1;	// for FramePacingMode::LowLatency
+	PresentMode presentMode = PresentMode::VSync;
+	uint32_t syncInterval = 1;		// for PresentMode::VSync
+	bool coalesceResize = true;		// window size is applied at frame start, so sizing costs at most one resize per frame
+	bool renderThread = true;		// frames don't wait for window messages (dragging, title updates)
+	bool loadImage = true;			// decodes image with stb_image (or streams its cooked texture)
+
+	// Unknown arguments are ignored, and counts are clamped to supported range
+	static RendererOptions parse(int argc, char** argv);
+	static const char* getPresentModeName(PresentMode mode);
+};
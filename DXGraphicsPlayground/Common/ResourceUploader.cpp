@@ -1,67 +1,208 @@
 #include "pch.h"
 #include "ResourceUploader.h"
 #include "GPUBuffer.h"
+#include "PitchedCopy.h"
 #include <cassert>
+#include <iostream>
+
+ResourceUploader::ResourceUploader(ID3D12Device* device, size_t ringBufferSize)
+	: _device(device), _ring(ringBufferSize)
+{
+	assert(_device != nullptr && "Device is null.");
+
+	// Persistent upload heap (we don't unmap until uploader is destroyed)
+	_uploadBuffer = std::make_unique<GPUBuffer>(_device, ringBufferSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	std::wstring name = L"Upload ring buffer";
+	_uploadBuffer->setName(name);
+	_uploadBuffer->open();
+}
+
+ResourceUploader::~ResourceUploader() {
+	_uploadBuffer->close();
+}
+
+ResourceUploader::StagingAllocation ResourceUploader::_allocateStaging(UINT64 size) {
+	UINT64 offset = _ring.allocate(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	if (offset != RingAllocator::kInvalidOffset)
+		return { _uploadBuffer.get(), offset };
+
+	// Ring is full or too small, so fall back to dedicated buffer.
+	std::cerr << "Upload ring buffer is out of space, allocating dedicated buffer (" << size << " bytes)." << std::endl;
+	auto overflowBuffer = std::make_unique<GPUBuffer>(_device, size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	overflowBuffer->open();
+	GPUBuffer* buffer = overflowBuffer.get();
+	_pendingOverflowBuffers.push_back(std::move(overflowBuffer));
+	return { buffer, 0 };
+}
+
+void ResourceUploader::finishSubmission(UINT64 fenceValue) {
+	_ring.finishSubmission(fenceValue);
+	while (_pendingOverflowBuffers.empty() == false) {
+		_pendingOverflowBuffers.front()->close();
+		_overflowBuffers.emplace_back(fenceValue, std::move(_pendingOverflowBuffers.front()));
+		_pendingOverflowBuffers.pop_front();
+	}
+}
+
+void ResourceUploader::reclaim(ID3D12Fence* fence) {
+	const UINT64 completedFenceValue = fence->GetCompletedValue();
+	_ring.reclaim(completedFenceValue);
+	while (_overflowBuffers.empty() == false && _overflowBuffers.front().first <= completedFenceValue) {
+		_overflowBuffers.pop_front();
+	}
+}
 
 void ResourceUploader::updateSubresource(ID3D12GraphicsCommandList* commandList, UINT subresource, void* ptr, size_t length, ID3D12Resource* destinationTexture) {
 	assert(destinationTexture != nullptr && "Destination resource is null.");
 
-	// Get device object from texture 
-	ComPtr<ID3D12Device> device = nullptr;
-	destinationTexture->GetDevice(IID_PPV_ARGS(&device));
-
-	// Query minimum required intermediate buffer size
-	size_t intermediateBufferSize = 0;
 	D3D12_RESOURCE_DESC destDesc = destinationTexture->GetDesc();
-	D3D12_PLACED_SUBRESOURCE_FOOTPRINT destFootprint{};
-	device->GetCopyableFootprints(&destDesc, 0, 1, 0, &destFootprint, nullptr, nullptr, &intermediateBufferSize);
+	const UINT mipLevels = destDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER ? 1 : destDesc.MipLevels;
+	const UINT depth = destDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? destDesc.DepthOrArraySize : 1;
+	const UINT mip = subresource % mipLevels;
+	const UINT sliceCount = max(1u, depth >> mip);
 
-	if (_uploadBuffer == nullptr || _uploadBuffer->getAlignedBufferSize() < intermediateBufferSize) {
-		_uploadBuffer = std::make_unique<GPUBuffer>(device.Get(), intermediateBufferSize);
-	}
+	// rows of block-compressed formats are block rows, so row count comes from footprint instead of height
+	UINT numRows = 0;
+	UINT64 rowSize = 0;
+	_device->GetCopyableFootprints(&destDesc, subresource, 1, 0, nullptr, &numRows, &rowSize, nullptr);
 
-	if (_uploadBuffer->open()) {
-		if (intermediateBufferSize == length) {
-			_uploadBuffer->copy(ptr, length, 0);
-		}
-		else {
-			// texture's row pitch is different with buffer's row pitch. so we need to copy each rows manually.
-			size_t srcRowPitch = length / destFootprint.Footprint.Height;
-			size_t rowPitch = destFootprint.Footprint.RowPitch;
-			for (UINT i = 0; i < destFootprint.Footprint.Height; i++) {
-				_uploadBuffer->copy(reinterpret_cast<UINT8*>(ptr) + srcRowPitch * i, srcRowPitch, rowPitch * i);
+	// source data is tightly packed
+	SubresourceData data{};
+	data.data = ptr;
+	data.slicePitch = length / sliceCount;
+	data.rowPitch = data.slicePitch / numRows;
+	assert(data.rowPitch >= rowSize && "Source data is smaller than subresource.");
+
+	TextureUpload upload;
+	upload.texture = destinationTexture;
+	upload.firstMip = mip;
+	upload.firstArraySlice = subresource / mipLevels;
+	upload.subresources = &data;
+	uploadTextures(commandList, &upload, 1);
+}
+
+void ResourceUploader::uploadTextures(ID3D12GraphicsCommandList* commandList, const TextureUpload* uploads, UINT uploadCount) {
+	_copies.clear();
+
+	// Query footprints of all subresources, packing them into one staging allocation
+	UINT64 stagingSize = 0;
+	for (UINT uploadIndex = 0; uploadIndex < uploadCount; uploadIndex++) {
+		const TextureUpload& upload = uploads[uploadIndex];
+		assert(upload.texture != nullptr && "Destination resource is null.");
+
+		D3D12_RESOURCE_DESC destDesc = upload.texture->GetDesc();
+		const UINT mipLevels = destDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER ? 1 : destDesc.MipLevels;
+		const UINT firstSubresource = upload.firstMip + upload.firstArraySlice * mipLevels;
+		const UINT lastSubresource = (upload.firstMip + upload.mipCount - 1) + (upload.firstArraySlice + upload.arraySize - 1) * mipLevels;
+		const UINT subresourceCount = lastSubresource - firstSubresource + 1;
+		const UINT arraySize = destDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : destDesc.DepthOrArraySize;
+		const bool coversAllSubresources = upload.mipCount == mipLevels && upload.arraySize == arraySize;
+
+		// one query for the whole range (includes unused mips between array slices)
+		_footprints.resize(subresourceCount);
+		_numRows.resize(subresourceCount);
+		_rowSizes.resize(subresourceCount);
+		_device->GetCopyableFootprints(&destDesc, firstSubresource, subresourceCount, 0, _footprints.data(), _numRows.data(), _rowSizes.data(), nullptr);
+
+		for (UINT slice = 0; slice < upload.arraySize; slice++) {
+			for (UINT mip = 0; mip < upload.mipCount; mip++) {
+				const UINT subresource = (upload.firstMip + mip) + (upload.firstArraySlice + slice) * mipLevels;
+				const UINT i = subresource - firstSubresource;
+
+				SubresourceCopy copy{};
+				copy.uploadIndex = uploadIndex;
+				copy.subresource = subresource;
+				copy.coversAllSubresources = coversAllSubresources;
+				copy.source = &upload.subresources[slice * upload.mipCount + mip];
+				copy.footprint = _footprints[i];
+				copy.numRows = _numRows[i];
+				copy.rowSize = _rowSizes[i];
+
+				stagingSize = (stagingSize + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~static_cast<UINT64>(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+				copy.footprint.Offset = stagingSize;
+				stagingSize += static_cast<UINT64>(copy.footprint.Footprint.RowPitch) * copy.numRows * copy.footprint.Footprint.Depth;
+				_copies.push_back(copy);
 			}
 		}
-		_uploadBuffer->close();
+	}
+	if (_copies.empty())
+		return;
 
-		// common->copy dest
-		D3D12_RESOURCE_BARRIER destBarrier{};
-		destBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-		destBarrier.Transition.pResource = destinationTexture;
-		destBarrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
-		destBarrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
-		destBarrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-		commandList->ResourceBarrier(1, &destBarrier);
+	StagingAllocation staging = _allocateStaging(stagingSize);
+
+	// Copy source data into staging memory
+	for (SubresourceCopy& copy : _copies) {
+		copy.footprint.Offset += staging.offset;
+
+		const D3D12_SUBRESOURCE_FOOTPRINT& footprint = copy.footprint.Footprint;
+		UINT8* stagingPointer = static_cast<UINT8*>(staging.buffer->getMappedPointer());
+		assert(stagingPointer != nullptr && "Staging buffer is not mapped.");
+
+		PitchedRegion destination{};
+		destination.data = stagingPointer + copy.footprint.Offset;
+		destination.rowPitch = footprint.RowPitch;
+		destination.slicePitch = static_cast<size_t>(footprint.RowPitch) * copy.numRows;
+		PitchedRegion source{};
+		source.data = const_cast<void*>(copy.source->data);
+		source.rowPitch = copy.source->rowPitch;
+		source.slicePitch = copy.source->slicePitch;
+		PitchedCopy::copy(destination, source, static_cast<size_t>(copy.rowSize), copy.numRows, footprint.Depth);
+		staging.buffer->markWritten(static_cast<size_t>(copy.footprint.Offset), destination.slicePitch * footprint.Depth);
+	}
+
+	// Transition all destinations to copy dest at once
+	_appendTransitionBarriers(uploads, true);
+	if (_barriers.empty() == false)
+		commandList->ResourceBarrier(static_cast<UINT>(_barriers.size()), _barriers.data());
+
+	// Record copies
+	for (const SubresourceCopy& copy : _copies) {
+		ID3D12Resource* destination = uploads[copy.uploadIndex].texture;
+		if (copy.footprint.Footprint.Format == DXGI_FORMAT_UNKNOWN) {
+			// buffer
+			commandList->CopyBufferRegion(destination, 0, staging.buffer->getResource(), copy.footprint.Offset, copy.rowSize);
+			continue;
+		}
 
 		D3D12_TEXTURE_COPY_LOCATION srcLoc{};
-		srcLoc.pResource = _uploadBuffer->getResource();
-		srcLoc.PlacedFootprint = destFootprint;
+		srcLoc.pResource = staging.buffer->getResource();
+		srcLoc.PlacedFootprint = copy.footprint;
 		srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
 		D3D12_TEXTURE_COPY_LOCATION destLoc{};
-		destLoc.pResource = destinationTexture;
-		destLoc.SubresourceIndex = 0;
+		destLoc.pResource = destination;
+		destLoc.SubresourceIndex = copy.subresource;
 		destLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+		commandList->CopyTextureRegion(&destLoc, 0, 0, 0, &srcLoc, nullptr);
+	}
 
-		if (destDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
-			commandList->CopyBufferRegion(destinationTexture, 0, _uploadBuffer->getResource(), 0, length);
+	// Transition all destinations to their final states at once
+	_appendTransitionBarriers(uploads, false);
+	if (_barriers.empty() == false)
+		commandList->ResourceBarrier(static_cast<UINT>(_barriers.size()), _barriers.data());
+}
+
+void ResourceUploader::_appendTransitionBarriers(const TextureUpload* uploads, bool toCopyDest) {
+	_barriers.clear();
+
+	D3D12_RESOURCE_BARRIER barrier{};
+	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+	for (const SubresourceCopy& copy : _copies) {
+		const TextureUpload& upload = uploads[copy.uploadIndex];
+		barrier.Transition.pResource = upload.texture;
+		barrier.Transition.StateBefore = toCopyDest ? upload.stateBefore : D3D12_RESOURCE_STATE_COPY_DEST;
+		barrier.Transition.StateAfter = toCopyDest ? D3D12_RESOURCE_STATE_COPY_DEST : upload.stateAfter;
+		if (barrier.Transition.StateBefore == barrier.Transition.StateAfter)
+			continue;
+
+		if (copy.coversAllSubresources) {
+			// one barrier per resource
+			if (_barriers.empty() == false && _barriers.back().Transition.pResource == upload.texture)
+				continue;
+			barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 		}
 		else {
-			commandList->CopyTextureRegion(&destLoc, 0, 0, 0, &srcLoc, nullptr);
+			barrier.Transition.Subresource = copy.subresource;
 		}
-
-		// copy dest->pixel shader resource
-		destBarrier.Transition.StateBefore = destBarrier.Transition.StateAfter;
-		destBarrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-		commandList->ResourceBarrier(1, &destBarrier);
+		_barriers.push_back(barrier);
 	}
-}
\ No newline at end of file
+}
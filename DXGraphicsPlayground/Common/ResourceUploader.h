@@ -1,21 +1,83 @@
 #pragma once
 
+#include "RingAllocator.h"
 #include <d3d12.h>
 #include <wrl.h>
 #include <memory>
+#include <deque>
+#include <vector>
 
 using Microsoft::WRL::ComPtr;
 
+// Source data of one subresource
+struct SubresourceData {
+	const void* data;
+	size_t rowPitch;		// bytes between rows (block rows for compressed formats)
+	size_t slicePitch;		// bytes between depth slices
+};
+
+// Upload job for a range of mips and array slices of a texture
+struct TextureUpload {
+	ID3D12Resource* texture = nullptr;
+	UINT firstMip = 0;
+	UINT mipCount = 1;
+	UINT firstArraySlice = 0;
+	UINT arraySize = 1;
+	const SubresourceData* subresources = nullptr;	// mipCount * arraySize entries (array slice-major)
+	D3D12_RESOURCE_STATES stateBefore = D3D12_RESOURCE_STATE_COMMON;
+	D3D12_RESOURCE_STATES stateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+};
+
 class GPUBuffer;
 class ResourceUploader
 {
 public:
-	ResourceUploader() {}
-	~ResourceUploader() {}
+	ResourceUploader(ID3D12Device* device, size_t ringBufferSize = kDefaultRingBufferSize);
+	~ResourceUploader();
 
+	// Uploads tightly packed rows (block rows for compressed formats) of one subresource
 	void updateSubresource(ID3D12GraphicsCommandList* commandList, UINT subresource, void* ptr, size_t length, ID3D12Resource* destinationTexture);
 
+	// Packs all jobs into one staging allocation and records copies between two batched barriers.
+	void uploadTextures(ID3D12GraphicsCommandList* commandList, const TextureUpload* uploads, UINT uploadCount);
+
+	// Synchronization
+	// Call before signaling the fence value of the submission which contains recorded uploads.
+	void finishSubmission(UINT64 fenceValue);
+	void reclaim(ID3D12Fence* fence);
+
 private:
+	static constexpr size_t kDefaultRingBufferSize = 32 * 1024 * 1024;
+
+	struct StagingAllocation {
+		GPUBuffer* buffer;
+		UINT64 offset;
+	};
+	StagingAllocation _allocateStaging(UINT64 size);
+	void _appendTransitionBarriers(const TextureUpload* uploads, bool toCopyDest);
+
+	// scratch arrays reused between batches
+	struct SubresourceCopy {
+		UINT uploadIndex;
+		UINT subresource;
+		bool coversAllSubresources;
+		const SubresourceData* source;
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+		UINT numRows;
+		UINT64 rowSize;
+	};
+	std::vector<SubresourceCopy> _copies;
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> _footprints;
+	std::vector<UINT> _numRows;
+	std::vector<UINT64> _rowSizes;
+	std::vector<D3D12_RESOURCE_BARRIER> _barriers;
+
+	ID3D12Device* _device;
 	std::unique_ptr<GPUBuffer> _uploadBuffer;
+	RingAllocator _ring;
+
+	// dedicated buffers for uploads which don't fit into the ring
+	std::deque<std::unique_ptr<GPUBuffer>> _pendingOverflowBuffers;
+	std::deque<std::pair<UINT64, std::unique_ptr<GPUBuffer>>> _overflowBuffers;
 };
 
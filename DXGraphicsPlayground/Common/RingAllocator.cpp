@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "RingAllocator.h"
+#include <cassert>
+
+RingAllocator::RingAllocator(uint64_t capacity)
+	: _capacity(capacity), _head(0), _tail(0), _usedSize(0), _pendingSize(0)
+{
+	assert(capacity > 0 && "Capacity must be greater than zero.");
+}
+
+uint64_t RingAllocator::allocate(uint64_t size, uint64_t alignment) {
+	assert((alignment & (alignment - 1)) == 0 && "Alignment must be power of two.");
+	if (size == 0 || size > _capacity || _usedSize == _capacity)
+		return kInvalidOffset;
+
+	if (alignment == 0)
+		alignment = 1;
+
+	uint64_t offset = (_head + alignment - 1) & ~(alignment - 1);
+	uint64_t newHead = 0;
+	if (_head >= _tail) {
+		// [tail, head) is used, so [head, capacity) and [0, tail) are free.
+		if (offset + size <= _capacity) {
+			newHead = offset + size;
+		}
+		else if (size <= _tail) {
+			// wrap around (the rest of ring is wasted until the submission is reclaimed)
+			offset = 0;
+			newHead = size;
+		}
+		else {
+			return kInvalidOffset;
+		}
+	}
+	else {
+		// [head, tail) is free.
+		if (offset + size <= _tail)
+			newHead = offset + size;
+		else
+			return kInvalidOffset;
+	}
+
+	uint64_t allocatedSize = newHead >= _head ? newHead - _head : _capacity - _head + newHead;
+	_head = newHead == _capacity ? 0 : newHead;
+	_usedSize += allocatedSize;
+	_pendingSize += allocatedSize;
+	return offset;
+}
+
+void RingAllocator::finishSubmission(uint64_t fenceValue) {
+	if (_pendingSize == 0)
+		return;
+
+	if (_submissions.empty() == false && _submissions.back().fenceValue == fenceValue) {
+		// merge into the same submission
+		_submissions.back().head = _head;
+		_submissions.back().size += _pendingSize;
+	}
+	else {
+		assert((_submissions.empty() || _submissions.back().fenceValue < fenceValue) && "Fence values must be increasing.");
+		_submissions.push_back({ fenceValue, _head, _pendingSize });
+	}
+	_pendingSize = 0;
+}
+
+void RingAllocator::reclaim(uint64_t completedFenceValue) {
+	while (_submissions.empty() == false && _submissions.front().fenceValue <= completedFenceValue) {
+		const Submission& submission = _submissions.front();
+		_tail = submission.head;
+		_usedSize -= submission.size;
+		_submissions.pop_front();
+	}
+
+	// rewind to the beginning if ring is empty, so large allocations don't have to wrap.
+	if (_usedSize == 0) {
+		_head = 0;
+		_tail = 0;
+	}
+}
+
+void RingAllocator::reset() {
+	_submissions.clear();
+	_head = 0;
+	_tail = 0;
+	_usedSize = 0;
+	_pendingSize = 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+// Linear ring allocator tracked by fence values.
+class RingAllocator
+{
+public:
+	static constexpr uint64_t kInvalidOffset = ~0ull;
+
+	RingAllocator(uint64_t capacity);
+	~RingAllocator() {}
+
+	// Properties
+	uint64_t getCapacity() const { return _capacity; }
+	uint64_t getUsedSize() const { return _usedSize; }
+	uint64_t getPendingSize() const { return _pendingSize; }
+	bool isEmpty() const { return _usedSize == 0; }
+
+	// Allocation (returns kInvalidOffset if there's no space left)
+	uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+
+	// Tags every allocation since last call with fence value of the submission using them.
+	void finishSubmission(uint64_t fenceValue);
+	// Reclaims space of submissions whose fence value is less than or equal to completed one.
+	void reclaim(uint64_t completedFenceValue);
+	void reset();
+
+private:
+	struct Submission {
+		uint64_t fenceValue;
+		uint64_t head;		// ring head after the submission
+		uint64_t size;		// allocated size including alignment padding
+	};
+
+	uint64_t _capacity;
+	uint64_t _head;			// next allocation offset
+	uint64_t _tail;			// oldest live offset
+	uint64_t _usedSize;
+	uint64_t _pendingSize;	// allocated but not submitted yet
+	std::deque<Submission> _submissions;
+};
@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "SkylinePacker.h"
+
+SkylinePacker::SkylinePacker(uint32_t width, uint32_t height)
+	: _width(width), _height(height), _usedArea(0)
+{
+	reset();
+}
+
+void SkylinePacker::reset() {
+	_usedArea = 0;
+	_skyline.clear();
+	_skyline.push_back({ 0, 0, _width });
+}
+
+bool SkylinePacker::pack(uint32_t width, uint32_t height, uint32_t& outX, uint32_t& outY) {
+	if (width == 0 || height == 0 || width > _width || height > _height)
+		return false;
+
+	size_t bestIndex = _skyline.size();
+	uint32_t bestY = 0, bestTop = ~0u;
+	uint64_t bestWaste = ~0ull;
+	for (size_t i = 0; i < _skyline.size(); i++) {
+		uint32_t y = 0;
+		uint64_t waste = 0;
+		if (_fit(i, width, height, y, waste) == false)
+			continue;
+		const uint32_t top = y + height;
+		if (top < bestTop || (top == bestTop && waste < bestWaste)) {
+			bestIndex = i;
+			bestY = y;
+			bestTop = top;
+			bestWaste = waste;
+		}
+	}
+	if (bestIndex == _skyline.size())
+		return false;
+
+	// new segment on top of rectangle, and segments under it are cut off
+	const uint32_t x = _skyline[bestIndex].x;
+	_skyline.insert(_skyline.begin() + bestIndex, { x, bestTop, width });
+	const uint32_t right = x + width;
+	for (size_t i = bestIndex + 1; i < _skyline.size() && _skyline[i].x < right;) {
+		Segment& segment = _skyline[i];
+		const uint32_t overlap = right - segment.x;
+		if (overlap >= segment.width) {
+			_skyline.erase(_skyline.begin() + i);
+			continue;
+		}
+		segment.x += overlap;
+		segment.width -= overlap;
+		break;
+	}
+
+	// merge neighbors of same height
+	for (size_t i = 1; i < _skyline.size();) {
+		if (_skyline[i - 1].y == _skyline[i].y) {
+			_skyline[i - 1].width += _skyline[i].width;
+			_skyline.erase(_skyline.begin() + i);
+		}
+		else {
+			i++;
+		}
+	}
+
+	_usedArea += static_cast<uint64_t>(width) * height;
+	outX = x;
+	outY = bestY;
+	return true;
+}
+
+bool SkylinePacker::_fit(size_t index, uint32_t width, uint32_t height, uint32_t& outY, uint64_t& outWaste) const {
+	const uint32_t x = _skyline[index].x;
+	if (x + width > _width)
+		return false;
+
+	// rectangle rests on highest segment under it
+	uint32_t y = 0;
+	for (size_t i = index; i < _skyline.size() && _skyline[i].x < x + width; i++)
+		y = _skyline[i].y > y ? _skyline[i].y : y;
+	if (y + height > _height)
+		return false;
+
+	uint64_t waste = 0;
+	for (size_t i = index; i < _skyline.size() && _skyline[i].x < x + width; i++) {
+		const uint32_t segmentRight = _skyline[i].x + _skyline[i].width;
+		const uint32_t overlap = (segmentRight < x + width ? segmentRight : x + width) - _skyline[i].x;
+		waste += static_cast<uint64_t>(y - _skyline[i].y) * overlap;
+	}
+	outY = y;
+	outWaste = waste;
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Packs rectangles into a fixed-size bin with skyline bottom-left rule.
+// Skyline is the top edge of packed rectangles, so free space below it is never reused,
+// which keeps packing O(skyline segments) per rectangle.
+class SkylinePacker
+{
+public:
+	SkylinePacker(uint32_t width, uint32_t height);
+	~SkylinePacker() {}
+
+	// Properties
+	uint32_t getWidth() const { return _width; }
+	uint32_t getHeight() const { return _height; }
+	uint64_t getUsedArea() const { return _usedArea; }
+	float getOccupancy() const { return static_cast<float>(static_cast<double>(_usedArea) / (static_cast<double>(_width) * _height)); }
+
+	// Lowest position whose top is lowest (ties are broken by less wasted area under the rectangle).
+	// Returns false if rectangle doesn't fit.
+	bool pack(uint32_t width, uint32_t height, uint32_t& outX, uint32_t& outY);
+	void reset();
+
+private:
+	struct Segment {
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+	};
+
+	bool _fit(size_t index, uint32_t width, uint32_t height, uint32_t& outY, uint64_t& outWaste) const;
+
+	uint32_t _width;
+	uint32_t _height;
+	uint64_t _usedArea;
+	std::vector<Segment> _skyline;		// sorted by x, covers 0 ~ width
+};
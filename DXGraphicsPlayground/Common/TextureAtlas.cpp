@@ -0,0 +1,162 @@
+#include "pch.h"
+#include "TextureAtlas.h"
+#include "SkylinePacker.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+float TextureAtlas::getOccupancy() const {
+	if (pages.empty())
+		return 0.0f;
+	double usedArea = 0.0;
+	for (const TextureAtlasEntry& entry : entries)
+		usedArea += static_cast<double>(entry.width) * entry.height;
+	return static_cast<float>(usedArea / (static_cast<double>(pageWidth) * pageHeight * pages.size()));
+}
+
+TextureAtlasBuilder::TextureAtlasBuilder(const TextureAtlasDesc& desc)
+	: _desc(desc)
+{
+}
+
+uint32_t TextureAtlasBuilder::addTexture(const MipChain* chain) {
+	_textures.push_back(chain);
+	return static_cast<uint32_t>(_textures.size() - 1);
+}
+
+bool TextureAtlasBuilder::build(TextureAtlas& atlas) const {
+	atlas = TextureAtlas();
+	atlas.pageWidth = _desc.pageWidth;
+	atlas.pageHeight = _desc.pageHeight;
+	if (_textures.empty())
+		return true;
+
+	// textures are aligned to the smallest mip, and border of every mip is at least desc.border texels
+	const uint32_t fullMipCount = MipGenerator::getMipCount(_desc.pageWidth, _desc.pageHeight);
+	const uint32_t pageMipCount = _desc.mipCount == 0 ? 1 : (_desc.mipCount < fullMipCount ? _desc.mipCount : fullMipCount);
+	const uint32_t alignment = 1u << (pageMipCount - 1);
+	const uint32_t padding = _desc.border << (pageMipCount - 1);
+	atlas.format = _textures[0]->format;
+
+	struct Footprint {
+		uint32_t index;
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+		uint32_t height;
+	};
+	std::vector<Footprint> footprints;
+	std::vector<uint32_t> wholeSlices;
+	for (uint32_t i = 0; i < _textures.size(); i++) {
+		const MipChain& chain = *_textures[i];
+		if (chain.format != atlas.format) {
+			std::cerr << "Textures in atlas must have same format (texture " << i << ")." << std::endl;
+			return false;
+		}
+		const uint32_t width = chain.levels[0].width, height = chain.levels[0].height;
+		const uint32_t requiredMipCount = MipGenerator::getMipCount(width, height);
+		if (chain.getLevelCount() < (requiredMipCount < pageMipCount ? requiredMipCount : pageMipCount)) {
+			std::cerr << "Texture " << i << " needs " << pageMipCount << " mips for atlas." << std::endl;
+			return false;
+		}
+
+		if (width == _desc.pageWidth && height == _desc.pageHeight) {
+			wholeSlices.push_back(i);
+			continue;
+		}
+		const uint32_t footprintWidth = (width + padding * 2 + alignment - 1) & ~(alignment - 1);
+		const uint32_t footprintHeight = (height + padding * 2 + alignment - 1) & ~(alignment - 1);
+		if (footprintWidth > _desc.pageWidth || footprintHeight > _desc.pageHeight) {
+			std::cerr << "Texture " << i << " (" << width << "x" << height << ") doesn't fit in atlas page with border." << std::endl;
+			return false;
+		}
+		footprints.push_back({ i, 0, 0, footprintWidth, footprintHeight });
+	}
+
+	// tall ones first, then first page that has room
+	std::sort(footprints.begin(), footprints.end(), [](const Footprint& a, const Footprint& b) {
+		if (a.height != b.height)
+			return a.height > b.height;
+		if (a.width != b.width)
+			return a.width > b.width;
+		return a.index < b.index;
+	});
+	std::vector<SkylinePacker> packers;
+	atlas.entries.resize(_textures.size());
+	for (Footprint& footprint : footprints) {
+		uint32_t slice = 0;
+		while (slice < packers.size() && packers[slice].pack(footprint.width, footprint.height, footprint.x, footprint.y) == false)
+			slice++;
+		if (slice == packers.size()) {
+			packers.emplace_back(_desc.pageWidth, _desc.pageHeight);
+			packers.back().pack(footprint.width, footprint.height, footprint.x, footprint.y);
+		}
+
+		const MipLevel& level = _textures[footprint.index]->levels[0];
+		TextureAtlasEntry& entry = atlas.entries[footprint.index];
+		entry.slice = slice;
+		entry.x = footprint.x + padding;
+		entry.y = footprint.y + padding;
+		entry.width = level.width;
+		entry.height = level.height;
+	}
+	for (uint32_t i = 0; i < wholeSlices.size(); i++) {
+		TextureAtlasEntry& entry = atlas.entries[wholeSlices[i]];
+		entry.slice = static_cast<uint32_t>(packers.size()) + i;
+		entry.x = 0;
+		entry.y = 0;
+		entry.width = _desc.pageWidth;
+		entry.height = _desc.pageHeight;
+	}
+	for (TextureAtlasEntry& entry : atlas.entries) {
+		entry.uvScale[0] = static_cast<float>(entry.width) / _desc.pageWidth;
+		entry.uvScale[1] = static_cast<float>(entry.height) / _desc.pageHeight;
+		entry.uvOffset[0] = static_cast<float>(entry.x) / _desc.pageWidth;
+		entry.uvOffset[1] = static_cast<float>(entry.y) / _desc.pageHeight;
+	}
+
+	// copy every mip of textures (textures smaller than alignment stay 1x1 on smallest mips)
+	atlas.pages.resize(packers.size() + wholeSlices.size());
+	for (MipChain& page : atlas.pages)
+		MipGenerator::reserve(_desc.pageWidth, _desc.pageHeight, atlas.format, page, pageMipCount);
+	for (const Footprint& footprint : footprints) {
+		const MipChain& chain = *_textures[footprint.index];
+		const TextureAtlasEntry& entry = atlas.entries[footprint.index];
+		for (uint32_t level = 0; level < pageMipCount; level++) {
+			const uint32_t sourceLevel = level < chain.getLevelCount() ? level : chain.getLevelCount() - 1;
+			_copyLevel(chain, sourceLevel, atlas.pages[entry.slice], level, entry.x >> level, entry.y >> level,
+				footprint.x >> level, footprint.y >> level, footprint.width >> level, footprint.height >> level);
+		}
+	}
+	for (uint32_t index : wholeSlices) {
+		const MipChain& chain = *_textures[index];
+		MipChain& page = atlas.pages[atlas.entries[index].slice];
+		for (uint32_t level = 0; level < pageMipCount; level++)
+			memcpy(page.getLevelData(level), chain.getLevelData(level), page.levels[level].size);
+	}
+	return true;
+}
+
+void TextureAtlasBuilder::_copyLevel(const MipChain& source, uint32_t sourceLevel, MipChain& page, uint32_t pageLevel,
+	uint32_t contentX, uint32_t contentY, uint32_t footprintX, uint32_t footprintY, uint32_t footprintWidth, uint32_t footprintHeight) {
+	const MipLevel& sourceMip = source.levels[sourceLevel];
+	const MipLevel& pageMip = page.levels[pageLevel];
+	const size_t pixelSize = MipGenerator::getPixelSize(source.format);
+	const uint8_t* sourceData = source.getLevelData(sourceLevel);
+	uint8_t* pageData = page.getLevelData(pageLevel);
+
+	// border is filled by clamping to edge of texture
+	for (uint32_t y = footprintY; y < footprintY + footprintHeight; y++) {
+		const int sourceY = static_cast<int>(y) - static_cast<int>(contentY);
+		const uint32_t clampedY = sourceY < 0 ? 0 : (sourceY >= static_cast<int>(sourceMip.height) ? sourceMip.height - 1 : sourceY);
+		const uint8_t* sourceRow = sourceData + sourceMip.rowPitch * clampedY;
+		uint8_t* pageRow = pageData + pageMip.rowPitch * y;
+
+		for (uint32_t x = footprintX; x < contentX; x++)
+			memcpy(pageRow + pixelSize * x, sourceRow, pixelSize);
+		memcpy(pageRow + pixelSize * contentX, sourceRow, pixelSize * sourceMip.width);
+		const uint8_t* lastPixel = sourceRow + pixelSize * (sourceMip.width - 1);
+		for (uint32_t x = contentX + sourceMip.width; x < footprintX + footprintWidth; x++)
+			memcpy(pageRow + pixelSize * x, lastPixel, pixelSize);
+	}
+}
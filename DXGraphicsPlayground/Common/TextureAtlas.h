@@ -0,0 +1,66 @@
+#pragma once
+
+#include "MipGenerator.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct TextureAtlasDesc {
+	uint32_t pageWidth = 2048;
+	uint32_t pageHeight = 2048;
+	uint32_t mipCount = 4;		// mips of pages (textures are aligned to 2^(mipCount-1) texels)
+	uint32_t border = 1;		// texels of replicated edge around each texture on every mip
+};
+
+// Where a texture is placed. Sample page with uv * uvScale + uvOffset (and slice as array index).
+struct TextureAtlasEntry {
+	uint32_t slice;
+	uint32_t x;					// texture rect on mip 0 of page (without border)
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+	float uvScale[2];
+	float uvOffset[2];
+};
+
+// Pages are slices of one Texture2DArray, so every texture in atlas is bound by one descriptor.
+struct TextureAtlas {
+	MipFormat format = MipFormat::RGBA8;
+	uint32_t pageWidth = 0;
+	uint32_t pageHeight = 0;
+	std::vector<MipChain> pages;
+	std::vector<TextureAtlasEntry> entries;		// in order of TextureAtlasBuilder::addTexture()
+
+	uint32_t getPageCount() const { return static_cast<uint32_t>(pages.size()); }
+	// Texels of textures over texels of pages (mip 0)
+	float getOccupancy() const;
+};
+
+// Bins textures of same format into pages.
+// Textures of page size take whole slices without border (so they can still wrap, like plain texture array),
+// and others are skyline-packed with borders replicated on every mip, so filtering doesn't bleed between textures.
+class TextureAtlasBuilder
+{
+public:
+	TextureAtlasBuilder(const TextureAtlasDesc& desc = TextureAtlasDesc());
+	~TextureAtlasBuilder() {}
+
+	// Properties
+	const TextureAtlasDesc& getDesc() const { return _desc; }
+	uint32_t getTextureCount() const { return static_cast<uint32_t>(_textures.size()); }
+
+	// Chain must stay alive until build(). It needs levels down to page mip count (or down to 1x1 if it's smaller).
+	// Returns index of entry.
+	uint32_t addTexture(const MipChain* chain);
+	void clear() { _textures.clear(); }
+
+	// Returns false if textures have different formats, are larger than page or lack mips
+	bool build(TextureAtlas& atlas) const;
+
+private:
+	static void _copyLevel(const MipChain& source, uint32_t sourceLevel, MipChain& page, uint32_t pageLevel,
+		uint32_t contentX, uint32_t contentY, uint32_t footprintX, uint32_t footprintY, uint32_t footprintWidth, uint32_t footprintHeight);
+
+	TextureAtlasDesc _desc;
+	std::vector<const MipChain*> _textures;
+};
@@ -0,0 +1,231 @@
+#include "pch.h"
+#include "TextureCache.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+	constexpr size_t kKeyLength = 16;
+	const char* const kExtension = ".ctex";
+
+	bool _parseKey(const std::string& fileName, uint64_t& outKey) {
+		if (fileName.size() != kKeyLength + strlen(kExtension) || fileName.compare(kKeyLength, std::string::npos, kExtension) != 0)
+			return false;
+		const std::string digits = fileName.substr(0, kKeyLength);
+		char* end = nullptr;
+		outKey = strtoull(digits.c_str(), &end, 16);
+		return end == digits.c_str() + kKeyLength;
+	}
+
+#if defined(_WIN32)
+	uint64_t _fileTime(const FILETIME& time) {
+		return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+	}
+#endif
+
+	// Calls function(fileName, size, lastWriteTime) for files in directory
+	template <typename Function>
+	void _listFiles(const std::string& directory, const Function& function) {
+#if defined(_WIN32)
+		WIN32_FIND_DATAA findData{};
+		HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &findData);
+		if (find == INVALID_HANDLE_VALUE)
+			return;
+		do {
+			if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+				const uint64_t size = (static_cast<uint64_t>(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow;
+				function(std::string(findData.cFileName), size, _fileTime(findData.ftLastWriteTime));
+			}
+		} while (FindNextFileA(find, &findData) != FALSE);
+		FindClose(find);
+#else
+		DIR* dir = opendir(directory.c_str());
+		if (dir == nullptr)
+			return;
+		while (dirent* entry = readdir(dir)) {
+			struct stat fileStat {};
+			if (stat((directory + "/" + entry->d_name).c_str(), &fileStat) == 0 && S_ISREG(fileStat.st_mode)) {
+				const uint64_t time = static_cast<uint64_t>(fileStat.st_mtim.tv_sec) * 1000000000ull + fileStat.st_mtim.tv_nsec;
+				function(std::string(entry->d_name), static_cast<uint64_t>(fileStat.st_size), time);
+			}
+		}
+		closedir(dir);
+#endif
+	}
+
+	// Sets last write time to now, and returns it
+	uint64_t _touch(const std::string& path) {
+#if defined(_WIN32)
+		FILETIME now{};
+		GetSystemTimeAsFileTime(&now);
+		HANDLE file = CreateFileA(path.c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+		if (file != INVALID_HANDLE_VALUE) {
+			SetFileTime(file, nullptr, nullptr, &now);
+			CloseHandle(file);
+		}
+		return _fileTime(now);
+#else
+		utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+		struct stat fileStat {};
+		stat(path.c_str(), &fileStat);
+		return static_cast<uint64_t>(fileStat.st_mtim.tv_sec) * 1000000000ull + fileStat.st_mtim.tv_nsec;
+#endif
+	}
+
+	void _createDirectory(const std::string& path) {
+#if defined(_WIN32)
+		CreateDirectoryA(path.c_str(), nullptr);
+#else
+		mkdir(path.c_str(), 0755);
+#endif
+	}
+}
+
+TextureCache::TextureCache(const std::string& directory, uint64_t sizeLimit)
+	: _directory(directory), _sizeLimit(sizeLimit)
+{
+	_createDirectory(_directory);
+	_listFiles(_directory, [this](const std::string& fileName, uint64_t size, uint64_t lastWriteTime) {
+		// temporary files are left by interrupted stores
+		uint64_t key = 0;
+		if (fileName.size() > 4 && fileName.compare(fileName.size() - 4, 4, ".tmp") == 0)
+			std::remove((_directory + "/" + fileName).c_str());
+		if (_parseKey(fileName, key) == false)
+			return;
+		_entries[key] = { size, lastWriteTime };
+		_stats.size += size;
+	});
+	trim();
+}
+
+uint64_t TextureCache::computeKey(const void* source, size_t sourceSize, const std::string& parameters) {
+	return Hash::xxHash64(parameters.data(), parameters.size(), Hash::xxHash64(source, sourceSize));
+}
+
+std::string TextureCache::getPath(uint64_t key) const {
+	char fileName[kKeyLength + 1];
+	snprintf(fileName, sizeof(fileName), "%016llx", static_cast<unsigned long long>(key));
+	return _directory + "/" + fileName + kExtension;
+}
+
+bool TextureCache::find(uint64_t key, std::string& outPath) {
+	auto it = _entries.find(key);
+	if (it == _entries.end()) {
+		_stats.misses++;
+		return false;
+	}
+
+	const std::string path = getPath(key);
+	if (_validate(key, path) == false) {
+		std::cerr << "Removed invalid texture cache entry " << path << "." << std::endl;
+		_stats.invalidEntries++;
+		_stats.misses++;
+		remove(key);
+		return false;
+	}
+
+	it->second.lastUse = _touch(path);
+	_stats.hits++;
+	outPath = path;
+	return true;
+}
+
+bool TextureCache::store(uint64_t key, const CookedTextureWriter& writer) {
+	// written under temporary name, so a partial file is never found
+	const std::string path = getPath(key);
+	const std::string temporaryPath = path + ".tmp";
+	if (writer.save(temporaryPath) == false)
+		return false;
+
+	Footer footer{};
+	footer.magic = Footer::kMagic;
+	footer.version = kVersion;
+	footer.key = key;
+	{
+		MappedFile file;
+		if (file.open(temporaryPath) == false) {
+			std::remove(temporaryPath.c_str());
+			return false;
+		}
+		footer.contentSize = file.getSize();
+		footer.contentHash = Hash::xxHash64(file.getData(), file.getSize());
+	}
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::app);
+		file.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+		if (file.good() == false) {
+			file.close();
+			std::remove(temporaryPath.c_str());
+			return false;
+		}
+	}
+
+	remove(key);
+	if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+		std::cerr << "Can't move texture cache entry to " << path << "." << std::endl;
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+
+	const uint64_t size = footer.contentSize + sizeof(footer);
+	_entries[key] = { size, _touch(path) };
+	_stats.size += size;
+	_stats.stores++;
+	trim();
+	return true;
+}
+
+void TextureCache::remove(uint64_t key) {
+	auto it = _entries.find(key);
+	if (it == _entries.end())
+		return;
+	std::remove(getPath(key).c_str());
+	_stats.size -= it->second.size;
+	_entries.erase(it);
+}
+
+void TextureCache::trim() {
+	if (_stats.size <= _sizeLimit)
+		return;
+
+	std::vector<std::pair<uint64_t, uint64_t>> lastUses;	// (last use, key)
+	lastUses.reserve(_entries.size());
+	for (const auto& entry : _entries)
+		lastUses.emplace_back(entry.second.lastUse, entry.first);
+	std::sort(lastUses.begin(), lastUses.end());
+	for (size_t i = 0; i < lastUses.size() && _stats.size > _sizeLimit; i++) {
+		remove(lastUses[i].second);
+		_stats.evictions++;
+	}
+}
+
+bool TextureCache::_validate(uint64_t key, const std::string& path) const {
+	MappedFile file;
+	if (file.open(path) == false || file.getSize() < sizeof(Footer) + sizeof(CookedTextureHeader))
+		return false;
+
+	Footer footer;
+	const size_t contentSize = file.getSize() - sizeof(Footer);
+	memcpy(&footer, file.getData() + contentSize, sizeof(Footer));
+	const CookedTextureHeader* header = reinterpret_cast<const CookedTextureHeader*>(file.getData());
+	return footer.magic == Footer::kMagic
+		&& footer.version == kVersion
+		&& footer.key == key
+		&& footer.contentSize == contentSize
+		&& header->magic == CookedTextureHeader::kMagic
+		&& header->version == CookedTextureHeader::kVersion
+		&& footer.contentHash == Hash::xxHash64(file.getData(), contentSize);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CookedTexture.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+struct TextureCacheStats {
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+	uint32_t invalidEntries = 0;	// removed by validation
+	uint32_t stores = 0;
+	uint32_t evictions = 0;
+	uint64_t size = 0;				// bytes of entries on disk
+};
+
+// Persistent cache of processed textures in cooked format (<directory>/<key>.ctex).
+// Key is hash of source bytes with processing parameters, so a changed source or setting misses by itself.
+// Each entry ends with a footer holding its key and hash of contents, which are checked before it's used.
+// Least recently used entries (by file time, which is refreshed on hit) are removed over size limit.
+// Not thread-safe.
+class TextureCache
+{
+public:
+	static constexpr uint32_t kVersion = 1;		// bump to invalidate every entry
+
+	TextureCache(const std::string& directory, uint64_t sizeLimit = 256ull * 1024 * 1024);
+	~TextureCache() {}
+
+	// Properties
+	const std::string& getDirectory() const { return _directory; }
+	uint64_t getSizeLimit() const { return _sizeLimit; }
+	const TextureCacheStats& getStats() const { return _stats; }
+
+	// Parameters describe everything that changes the result (channels, flip, mip filter, format, quality...)
+	static uint64_t computeKey(const void* source, size_t sourceSize, const std::string& parameters);
+	std::string getPath(uint64_t key) const;
+
+	// Returns true with path of valid entry (it can be opened with CookedTextureFile). Corrupt entries are removed.
+	bool find(uint64_t key, std::string& outPath);
+	bool store(uint64_t key, const CookedTextureWriter& writer);
+	void remove(uint64_t key);
+	// Removes least recently used entries until size is within limit
+	void trim();
+
+private:
+	struct Footer {
+		static constexpr uint32_t kMagic = 0x48435443;	// 'CTCH'
+
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint64_t contentSize;	// bytes before footer
+		uint64_t contentHash;
+	};
+	struct Entry {
+		uint64_t size;
+		uint64_t lastUse;		// file time
+	};
+
+	bool _validate(uint64_t key, const std::string& path) const;
+
+	std::string _directory;
+	uint64_t _sizeLimit;
+	std::unordered_map<uint64_t, Entry> _entries;
+	TextureCacheStats _stats;
+};
@@ -0,0 +1,159 @@
+#include "pch.h"
+#include "TextureStreamer.h"
+#include "AllocationRegistry.h"
+#include <cassert>
+#include <iostream>
+
+TextureStreamer::TextureStreamer(ID3D12Device* device, UploadQueue* uploadQueue, DescriptorAllocator* descriptorAllocator,
+	DeferredReleaseQueue* deferredReleaseQueue, const TextureStreamingConfig& config)
+	: _device(device), _uploadQueue(uploadQueue), _descriptorAllocator(descriptorAllocator), _deferredReleaseQueue(deferredReleaseQueue),
+	_frameIndex(0), _policy(config)
+{
+	assert(_device != nullptr && "Device is null.");
+	assert(_uploadQueue != nullptr && "Upload queue is null.");
+	assert(_descriptorAllocator != nullptr && "Descriptor allocator is null.");
+	assert(_deferredReleaseQueue != nullptr && "Deferred release queue is null.");
+}
+
+TextureStreamer::~TextureStreamer() {
+	// uploads must be complete before textures are released with queue
+	for (std::unique_ptr<Texture>& texture : _textures) {
+		if (texture == nullptr)
+			continue;
+		_uploadQueue->waitForCompletion(texture->pendingTicket);
+		DescriptorRange noSRV;
+		_retire(texture->pendingResource, noSRV, texture->pendingAllocationSize);
+		_retire(texture->resource, texture->srv, texture->allocationSize);
+	}
+}
+
+StreamingTextureId TextureStreamer::addTexture(const std::string& path) {
+	std::unique_ptr<Texture> texture = std::make_unique<Texture>();
+	if (texture->file.open(path) == false) {
+		std::cerr << "Failed to open texture " << path << " for streaming." << std::endl;
+		return TextureStreamingPolicy::kInvalidTexture;
+	}
+	const CookedTextureHeader& header = texture->file.getHeader();
+	if (header.depth > 1 || header.arraySize > 1) {
+		std::cerr << "Only 2D textures can be streamed (" << path << ")." << std::endl;
+		return TextureStreamingPolicy::kInvalidTexture;
+	}
+
+	std::vector<uint64_t> mipSizes(header.mipCount);
+	for (uint32_t mip = 0; mip < header.mipCount; mip++) {
+		const CookedSubresource& subresource = texture->file.getSubresource(mip);
+		mipSizes[mip] = static_cast<uint64_t>(subresource.rowSize) * subresource.numRows;
+	}
+	const StreamingTextureId id = _policy.addTexture(header.width, header.height, header.mipCount, mipSizes.data(), header.blockSize);
+	if (id >= _textures.size())
+		_textures.resize(id + 1);
+	_textures[id] = std::move(texture);
+	return id;
+}
+
+void TextureStreamer::removeTexture(StreamingTextureId id) {
+	std::unique_ptr<Texture>& texture = _textures[id];
+	// pending upload isn't tracked by frame fences, so it's finished here
+	_uploadQueue->waitForCompletion(texture->pendingTicket);
+	DescriptorRange noSRV;
+	_retire(texture->pendingResource, noSRV, texture->pendingAllocationSize);
+	_retire(texture->resource, texture->srv, texture->allocationSize);
+	texture.reset();
+	_policy.removeTexture(id);
+}
+
+void TextureStreamer::requestScreenSize(StreamingTextureId id, float screenWidth, float screenHeight) {
+	const CookedTextureHeader& header = _textures[id]->file.getHeader();
+	_policy.requestMip(id, TextureStreamingPolicy::computeMip(header.width, header.height, screenWidth, screenHeight));
+}
+
+void TextureStreamer::update() {
+	// swap in completed uploads
+	for (StreamingTextureId id = 0; id < _textures.size(); id++) {
+		Texture* texture = _textures[id].get();
+		if (texture == nullptr || texture->pendingResource == nullptr || _uploadQueue->isComplete(texture->pendingTicket) == false)
+			continue;
+
+		_retire(texture->resource, texture->srv, texture->allocationSize);
+		texture->resource = std::move(texture->pendingResource);
+		texture->allocationSize = texture->pendingAllocationSize;
+		texture->pendingAllocationSize = 0;
+		texture->pendingTicket = UploadQueue::kInvalidTicket;
+
+		D3D12_RESOURCE_DESC textureDesc = texture->resource->GetDesc();
+		texture->srv = _descriptorAllocator->allocatePersistent(1);
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+		srvDesc.Format = textureDesc.Format;
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
+		_device->CreateShaderResourceView(texture->resource.Get(), &srvDesc, texture->srv.cpuHandle);
+
+		_policy.completeChange(id);
+	}
+
+	// start residency changes of this frame
+	_changes.clear();
+	_policy.update(++_frameIndex, _changes);
+	for (const TextureResidencyChange& change : _changes)
+		_startChange(change.texture, change.firstMip);
+}
+
+void TextureStreamer::_startChange(StreamingTextureId id, uint32_t firstMip) {
+	Texture& texture = *_textures[id];
+	const CookedTextureHeader& header = texture.file.getHeader();
+	const CookedSubresource& topSubresource = texture.file.getSubresource(firstMip);
+
+	D3D12_HEAP_PROPERTIES heapProps{};
+	heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+	heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	heapProps.CreationNodeMask = 1;
+	heapProps.VisibleNodeMask = 1;
+	D3D12_RESOURCE_DESC textureDesc{};
+	textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	textureDesc.Format = static_cast<DXGI_FORMAT>(header.format);
+	textureDesc.Width = topSubresource.width;
+	textureDesc.Height = topSubresource.height;
+	textureDesc.DepthOrArraySize = 1;
+	textureDesc.MipLevels = static_cast<UINT16>(header.mipCount - firstMip);
+	textureDesc.SampleDesc.Count = 1;
+
+	HRESULT result = _device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &textureDesc,
+		D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&texture.pendingResource));
+	if (result < 0) {
+		std::cerr << "Failed to create streamed texture (mip " << firstMip << ")! : " << result << std::endl;
+		_policy.cancelChange(id);
+		return;
+	}
+	texture.pendingAllocationSize = _device->GetResourceAllocationInfo(0, 1, &textureDesc).SizeInBytes;
+	AllocationRegistry::getShared().recordAllocation(AllocationCategory::Texture, texture.pendingAllocationSize);
+
+	// mips firstMip ~ of file become mips 0 ~ of new texture
+	_subresources.resize(textureDesc.MipLevels);
+	for (UINT mip = 0; mip < textureDesc.MipLevels; mip++) {
+		const CookedSubresource& subresource = texture.file.getSubresource(firstMip + mip);
+		_subresources[mip].data = texture.file.getSubresourceData(firstMip + mip);
+		_subresources[mip].rowPitch = subresource.rowPitch;
+		_subresources[mip].slicePitch = static_cast<size_t>(subresource.rowPitch) * subresource.numRows;
+	}
+	TextureUpload upload;
+	upload.texture = texture.pendingResource.Get();
+	upload.mipCount = textureDesc.MipLevels;
+	upload.subresources = _subresources.data();
+	texture.pendingTicket = _uploadQueue->uploadTextures(&upload, 1);
+}
+
+void TextureStreamer::_retire(ComPtr<ID3D12Resource>& resource, DescriptorRange& srv, UINT64 allocationSize) {
+	if (resource == nullptr)
+		return;
+	DescriptorAllocator* descriptorAllocator = _descriptorAllocator;
+	ComPtr<ID3D12Resource> retiredResource = std::move(resource);
+	DescriptorRange retiredSRV = srv;
+	_deferredReleaseQueue->retire([descriptorAllocator, retiredResource, retiredSRV, allocationSize]() mutable {
+		descriptorAllocator->free(retiredSRV);
+		AllocationRegistry::getShared().recordFree(AllocationCategory::Texture, allocationSize);
+		retiredResource.Reset();
+	});
+	resource.Reset();
+	srv = DescriptorRange{};
+}
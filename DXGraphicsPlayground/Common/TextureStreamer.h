@@ -0,0 +1,71 @@
+#pragma once
+
+#include "pch.h"
+#include "TextureStreamingPolicy.h"
+#include "CookedTexture.h"
+#include "DescriptorAllocator.h"
+#include "DeferredReleaseQueue.h"
+#include "UploadQueue.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using Microsoft::WRL::ComPtr;
+
+// Streams mips of cooked 2D textures by decisions of TextureStreamingPolicy.
+// Each residency change creates texture with mips firstMip ~ and uploads them from the mapped file on copy queue,
+// then swaps texture and SRV when the upload is complete. Old ones are retired to deferred release queue.
+class TextureStreamer
+{
+public:
+	TextureStreamer(ID3D12Device* device, UploadQueue* uploadQueue, DescriptorAllocator* descriptorAllocator,
+		DeferredReleaseQueue* deferredReleaseQueue, const TextureStreamingConfig& config = TextureStreamingConfig());
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	// Properties
+	TextureStreamingPolicy& getPolicy() { return _policy; }
+	const TextureStreamingStats& getStats() const { return _policy.getStats(); }
+
+	// Textures (returns TextureStreamingPolicy::kInvalidTexture if file can't be streamed)
+	StreamingTextureId addTexture(const std::string& path);
+	void removeTexture(StreamingTextureId texture);
+	// SRV of resident mips (invalid until mip tail is uploaded)
+	const DescriptorRange& getSRV(StreamingTextureId texture) const { return _textures[texture]->srv; }
+
+	// Feedback (see TextureStreamingPolicy::requestMip())
+	void requestMip(StreamingTextureId texture, float mip) { _policy.requestMip(texture, mip); }
+	void requestScreenSize(StreamingTextureId texture, float screenWidth, float screenHeight);
+
+	// Swaps in completed uploads and starts residency changes (once per frame)
+	void update();
+
+private:
+	struct Texture {
+		CookedTextureFile file;
+		ComPtr<ID3D12Resource> resource;
+		DescriptorRange srv;
+		UINT64 allocationSize = 0;
+
+		// change in progress
+		ComPtr<ID3D12Resource> pendingResource;
+		UINT64 pendingAllocationSize = 0;
+		UploadTicket pendingTicket = UploadQueue::kInvalidTicket;
+	};
+
+	void _startChange(StreamingTextureId texture, uint32_t firstMip);
+	void _retire(ComPtr<ID3D12Resource>& resource, DescriptorRange& srv, UINT64 allocationSize);
+
+	ID3D12Device* _device;
+	UploadQueue* _uploadQueue;
+	DescriptorAllocator* _descriptorAllocator;
+	DeferredReleaseQueue* _deferredReleaseQueue;
+	uint64_t _frameIndex;
+	TextureStreamingPolicy _policy;
+
+	std::vector<std::unique_ptr<Texture>> _textures;
+	std::vector<TextureResidencyChange> _changes;
+	std::vector<SubresourceData> _subresources;
+};
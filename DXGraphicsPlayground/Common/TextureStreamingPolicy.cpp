@@ -0,0 +1,227 @@
+#include "pch.h"
+#include "TextureStreamingPolicy.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+TextureStreamingPolicy::TextureStreamingPolicy(const TextureStreamingConfig& config)
+	: _config(config)
+{
+}
+
+StreamingTextureId TextureStreamingPolicy::addTexture(uint32_t width, uint32_t height, uint32_t mipCount, const uint64_t* mipSizes, uint32_t blockSize) {
+	assert(mipCount > 0 && "Texture has no mip.");
+
+	StreamingTextureId id = 0;
+	if (_freeTextures.empty() == false) {
+		id = _freeTextures.back();
+		_freeTextures.pop_back();
+	}
+	else {
+		id = static_cast<StreamingTextureId>(_textures.size());
+		_textures.emplace_back();
+	}
+
+	Texture& texture = _textures[id];
+	texture.isUsed = true;
+	texture.mipCount = mipCount;
+	texture.residentFirstMip = mipCount;
+	texture.pendingFirstMip = kNoMip;
+	texture.requestedFirstMip = kNoMip;
+	texture.lastRequestFrame = 0;
+	texture.sizes.assign(mipCount + 1, 0);
+	for (uint32_t mip = mipCount; mip > 0; mip--)
+		texture.sizes[mip - 1] = texture.sizes[mip] + mipSizes[mip - 1];
+
+	// most detailed mip of tail, but not beyond mips that can be top level of texture
+	texture.tailFirstMip = mipCount - 1;
+	for (uint32_t mip = 0; mip < mipCount; mip++) {
+		const uint32_t mipWidth = width >> mip > 0 ? width >> mip : 1;
+		const uint32_t mipHeight = height >> mip > 0 ? height >> mip : 1;
+		if (mip > 0 && (mipWidth % blockSize != 0 || mipHeight % blockSize != 0)) {
+			texture.tailFirstMip = mip - 1;
+			break;
+		}
+		if (mipWidth <= _config.tailSize && mipHeight <= _config.tailSize) {
+			texture.tailFirstMip = mip;
+			break;
+		}
+	}
+	texture.wantedFirstMip = texture.tailFirstMip;
+	return id;
+}
+
+void TextureStreamingPolicy::removeTexture(StreamingTextureId id) {
+	Texture& texture = _textures[id];
+	assert(texture.isUsed && "Texture is already removed.");
+	_stats.residentSize -= texture.sizes[texture.residentFirstMip];
+	if (texture.pendingFirstMip != kNoMip)
+		_stats.pendingSize -= texture.sizes[texture.pendingFirstMip];
+	texture.isUsed = false;
+	texture.sizes.clear();
+	_freeTextures.push_back(id);
+}
+
+void TextureStreamingPolicy::requestMip(StreamingTextureId id, float mip) {
+	Texture& texture = _textures[id];
+	uint32_t firstMip = mip > 0.0f ? static_cast<uint32_t>(mip < 32.0f ? mip : 32.0f) : 0;
+	firstMip = firstMip < texture.tailFirstMip ? firstMip : texture.tailFirstMip;
+	texture.requestedFirstMip = firstMip < texture.requestedFirstMip ? firstMip : texture.requestedFirstMip;
+}
+
+float TextureStreamingPolicy::computeMip(uint32_t width, uint32_t height, float screenWidth, float screenHeight) {
+	if (screenWidth <= 0.0f || screenHeight <= 0.0f)
+		return 32.0f;
+	const float horizontalRatio = width / screenWidth;
+	const float verticalRatio = height / screenHeight;
+	return std::log2(horizontalRatio > verticalRatio ? horizontalRatio : verticalRatio);
+}
+
+void TextureStreamingPolicy::update(uint64_t frameIndex, std::vector<TextureResidencyChange>& changes) {
+	// wanted mips from requests (textures that weren't requested only need their tail)
+	_stats.requestedTextureCount = 0;
+	_stats.missingMipCount = 0;
+	uint64_t maxTailSize = 0;
+	for (Texture& texture : _textures) {
+		if (texture.isUsed == false)
+			continue;
+		maxTailSize = texture.sizes[texture.tailFirstMip] > maxTailSize ? texture.sizes[texture.tailFirstMip] : maxTailSize;
+		if (texture.requestedFirstMip != kNoMip) {
+			texture.wantedFirstMip = texture.requestedFirstMip;
+			texture.requestedFirstMip = kNoMip;
+			texture.lastRequestFrame = frameIndex;
+			_stats.requestedTextureCount++;
+			if (texture.residentFirstMip > texture.wantedFirstMip)
+				_stats.missingMipCount += texture.residentFirstMip - texture.wantedFirstMip;
+		}
+		else {
+			texture.wantedFirstMip = texture.tailFirstMip;
+		}
+	}
+
+	// mip tail is loaded regardless of budget
+	for (StreamingTextureId id = 0; id < _textures.size(); id++) {
+		const Texture& texture = _textures[id];
+		if (texture.isUsed && texture.pendingFirstMip == kNoMip && texture.residentFirstMip > texture.tailFirstMip)
+			_issueChange(id, texture.tailFirstMip, changes);
+	}
+
+	// loads, most blurry and most recently requested ones first
+	_candidates.clear();
+	for (StreamingTextureId id = 0; id < _textures.size(); id++) {
+		const Texture& texture = _textures[id];
+		if (texture.isUsed && texture.pendingFirstMip == kNoMip && texture.wantedFirstMip < texture.residentFirstMip)
+			_candidates.push_back(id);
+	}
+	std::sort(_candidates.begin(), _candidates.end(), [this](StreamingTextureId a, StreamingTextureId b) {
+		const Texture& textureA = _textures[a];
+		const Texture& textureB = _textures[b];
+		const uint32_t missingA = textureA.residentFirstMip - textureA.wantedFirstMip;
+		const uint32_t missingB = textureB.residentFirstMip - textureB.wantedFirstMip;
+		if (missingA != missingB)
+			return missingA > missingB;
+		if (textureA.lastRequestFrame != textureB.lastRequestFrame)
+			return textureA.lastRequestFrame > textureB.lastRequestFrame;
+		return a < b;
+	});
+	size_t loadCount = 0;
+	uint64_t loadSize = 0;
+	while (loadCount < _candidates.size() && (loadCount == 0 || loadSize < _config.maxLoadSizePerUpdate)) {
+		const Texture& texture = _textures[_candidates[loadCount]];
+		loadSize += texture.sizes[texture.wantedFirstMip];
+		loadCount++;
+	}
+
+	// evict for loads of this update and overshoot of budget.
+	// Evicted memory is released when eviction completes, so loads that don't fit now are retried later.
+	// Loads leave room for one tail, so eviction can always make progress when budget is full.
+	const uint64_t loadBudget = _config.budget > maxTailSize ? _config.budget - maxTailSize : 0;
+	const uint64_t usedSize = getUsedSize();
+	const uint64_t availableSize = loadBudget > usedSize ? loadBudget - usedSize : 0;
+	const uint64_t neededSize = loadSize + (usedSize > loadBudget ? usedSize - loadBudget : 0);
+	if (neededSize > availableSize)
+		_evict(neededSize - availableSize, changes);
+
+	// most detailed mips that fit in budget (old mips are alive until load completes)
+	for (size_t i = 0; i < loadCount; i++) {
+		const StreamingTextureId id = _candidates[i];
+		const Texture& texture = _textures[id];
+		const uint64_t currentUsedSize = getUsedSize();
+		const uint64_t currentAvailableSize = loadBudget > currentUsedSize ? loadBudget - currentUsedSize : 0;
+		for (uint32_t mip = texture.wantedFirstMip; mip < texture.residentFirstMip; mip++) {
+			if (texture.sizes[mip] <= currentAvailableSize) {
+				_issueChange(id, mip, changes);
+				break;
+			}
+		}
+	}
+}
+
+void TextureStreamingPolicy::completeChange(StreamingTextureId id) {
+	Texture& texture = _textures[id];
+	assert(texture.pendingFirstMip != kNoMip && "Texture has no pending change.");
+	_stats.residentSize -= texture.sizes[texture.residentFirstMip];
+	_stats.residentSize += texture.sizes[texture.pendingFirstMip];
+	_stats.pendingSize -= texture.sizes[texture.pendingFirstMip];
+	texture.residentFirstMip = texture.pendingFirstMip;
+	texture.pendingFirstMip = kNoMip;
+}
+
+void TextureStreamingPolicy::cancelChange(StreamingTextureId id) {
+	Texture& texture = _textures[id];
+	assert(texture.pendingFirstMip != kNoMip && "Texture has no pending change.");
+	_stats.pendingSize -= texture.sizes[texture.pendingFirstMip];
+	texture.pendingFirstMip = kNoMip;
+}
+
+void TextureStreamingPolicy::_issueChange(StreamingTextureId id, uint32_t firstMip, std::vector<TextureResidencyChange>& changes) {
+	Texture& texture = _textures[id];
+	texture.pendingFirstMip = firstMip;
+	_stats.pendingSize += texture.sizes[firstMip];
+	if (firstMip < texture.residentFirstMip) {
+		_stats.loadCount++;
+		_stats.loadedSize += texture.sizes[firstMip];
+	}
+	else {
+		_stats.evictionCount++;
+	}
+	changes.push_back({ id, firstMip });
+}
+
+uint64_t TextureStreamingPolicy::_evict(uint64_t size, std::vector<TextureResidencyChange>& changes) {
+	// textures resident beyond wanted mip, least recently requested and largest ones first
+	std::vector<StreamingTextureId> evictions;
+	for (StreamingTextureId id = 0; id < _textures.size(); id++) {
+		const Texture& texture = _textures[id];
+		if (texture.isUsed && texture.pendingFirstMip == kNoMip && texture.residentFirstMip < texture.wantedFirstMip)
+			evictions.push_back(id);
+	}
+	std::sort(evictions.begin(), evictions.end(), [this](StreamingTextureId a, StreamingTextureId b) {
+		const Texture& textureA = _textures[a];
+		const Texture& textureB = _textures[b];
+		if (textureA.lastRequestFrame != textureB.lastRequestFrame)
+			return textureA.lastRequestFrame < textureB.lastRequestFrame;
+		const uint64_t sizeA = textureA.sizes[textureA.residentFirstMip] - textureA.sizes[textureA.wantedFirstMip];
+		const uint64_t sizeB = textureB.sizes[textureB.residentFirstMip] - textureB.sizes[textureB.wantedFirstMip];
+		if (sizeA != sizeB)
+			return sizeA > sizeB;
+		return a < b;
+	});
+
+	// mips of eviction are alive with resident ones until eviction completes,
+	// so texture is evicted down to its tail if wanted mips don't fit in budget now.
+	uint64_t evictedSize = 0;
+	for (StreamingTextureId id : evictions) {
+		if (evictedSize >= size)
+			break;
+		const Texture& texture = _textures[id];
+		uint32_t firstMip = texture.wantedFirstMip;
+		if (getUsedSize() + texture.sizes[firstMip] > _config.budget)
+			firstMip = texture.tailFirstMip;
+		if (getUsedSize() + texture.sizes[firstMip] > _config.budget)
+			continue;
+		evictedSize += texture.sizes[texture.residentFirstMip] - texture.sizes[firstMip];
+		_issueChange(id, firstMip, changes);
+	}
+	return evictedSize;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+typedef uint32_t StreamingTextureId;
+
+struct TextureStreamingConfig {
+	uint64_t budget = 256ull << 20;					// memory of resident mips (bytes)
+	uint32_t tailSize = 64;							// mips whose width and height are less than or equal to this are always resident
+	uint64_t maxLoadSizePerUpdate = 32ull << 20;	// at least one load is issued per update regardless of this
+};
+
+// Change of most detailed resident mip. Mips firstMip ~ mipCount-1 are resident after the change.
+struct TextureResidencyChange {
+	StreamingTextureId texture;
+	uint32_t firstMip;
+};
+
+struct TextureStreamingStats {
+	uint64_t residentSize = 0;		// mips resident now
+	uint64_t pendingSize = 0;		// mips of changes in progress (old and new mips are both alive until change completes)
+	uint64_t loadCount = 0;			// changes to more detailed mip (total)
+	uint64_t evictionCount = 0;		// changes to less detailed mip (total)
+	uint64_t loadedSize = 0;		// total
+	uint32_t requestedTextureCount = 0;		// textures requested in last update
+	uint32_t missingMipCount = 0;			// sum of (resident - requested) mips of textures requested in last update
+};
+
+// Decides mip residency of streamed textures from requested mips (e.g. estimated screen-space size).
+// Mip tail is always resident. More detailed mips are loaded on request, and evicted in LRU order
+// when the budget is exceeded.
+// Used memory (resident and pending mips) stays within the budget, unless mip tails alone exceed it.
+class TextureStreamingPolicy
+{
+public:
+	static constexpr StreamingTextureId kInvalidTexture = ~0u;
+
+	TextureStreamingPolicy(const TextureStreamingConfig& config = TextureStreamingConfig());
+	~TextureStreamingPolicy() {}
+
+	// Properties
+	const TextureStreamingConfig& getConfig() const { return _config; }
+	void setBudget(uint64_t budget) { _config.budget = budget; }
+	const TextureStreamingStats& getStats() const { return _stats; }
+	uint64_t getUsedSize() const { return _stats.residentSize + _stats.pendingSize; }
+	// mipCount if nothing is resident yet
+	uint32_t getResidentFirstMip(StreamingTextureId texture) const { return _textures[texture].residentFirstMip; }
+	uint32_t getTailFirstMip(StreamingTextureId texture) const { return _textures[texture].tailFirstMip; }
+	bool isChangePending(StreamingTextureId texture) const { return _textures[texture].pendingFirstMip != kNoMip; }
+
+	// Mip 0 is most detailed one, and mipSizes[i] is memory size of mip i.
+	// Mips of block-compressed textures (blockSize 4) can be most detailed resident mip only if their size is multiple of block size.
+	StreamingTextureId addTexture(uint32_t width, uint32_t height, uint32_t mipCount, const uint64_t* mipSizes, uint32_t blockSize = 1);
+	// Memory of resident and pending mips is released immediately
+	void removeTexture(StreamingTextureId texture);
+
+	// Requests mip (can be fractional) for the next update. Most detailed request since last update is used.
+	void requestMip(StreamingTextureId texture, float mip);
+	// Mip that maps texels of texture to pixels one to one, when it covers screenWidth x screenHeight pixels
+	static float computeMip(uint32_t width, uint32_t height, float screenWidth, float screenHeight);
+
+	// Appends residency changes for this frame. Each change stays pending until completeChange() is called.
+	void update(uint64_t frameIndex, std::vector<TextureResidencyChange>& changes);
+	void completeChange(StreamingTextureId texture);
+	// Drops pending change (e.g. resource for it can't be created)
+	void cancelChange(StreamingTextureId texture);
+
+private:
+	static constexpr uint32_t kNoMip = ~0u;
+
+	struct Texture {
+		bool isUsed;
+		uint32_t mipCount;
+		uint32_t tailFirstMip;
+		uint32_t residentFirstMip;
+		uint32_t pendingFirstMip;		// kNoMip if there's no change in progress
+		uint32_t requestedFirstMip;		// from requests since last update (kNoMip if there's none)
+		uint32_t wantedFirstMip;		// requested one of last update, or tail if it wasn't requested
+		uint64_t lastRequestFrame;
+		std::vector<uint64_t> sizes;	// sizes[m] is size of mips m ~ mipCount-1 (sizes[mipCount] is 0)
+	};
+
+	void _issueChange(StreamingTextureId texture, uint32_t firstMip, std::vector<TextureResidencyChange>& changes);
+	uint64_t _evict(uint64_t size, std::vector<TextureResidencyChange>& changes);
+
+	TextureStreamingConfig _config;
+	TextureStreamingStats _stats;
+	std::vector<Texture> _textures;
+	std::vector<StreamingTextureId> _freeTextures;
+	std::vector<StreamingTextureId> _candidates;	// scratch
+};
@@ -1,8 +1,8 @@
 #pragma once
 
-class Win32App;
+class RenderLoop;
 class Time {
-	friend class Win32App;
+	friend class RenderLoop;
 
 public:
 	Time() = delete;
@@ -0,0 +1,191 @@
+#include "pch.h"
+#include "TransientResourceAllocator.h"
+#include "AllocationRegistry.h"
+#include <cassert>
+#include <iostream>
+
+TransientResourceAllocator::TransientResourceAllocator(ID3D12Device* device)
+	: _device(device), _deferredReleaseQueue(nullptr), _heapSize(0), _heapCreationCount(0), _heapPool(std::make_shared<std::vector<PooledHeap>>())
+{
+	assert(_device != nullptr && "Device is null.");
+}
+
+TransientResourceAllocator::~TransientResourceAllocator() {
+	reset();
+	_releaseHeap();
+	for (PooledHeap& pooledHeap : *_heapPool)
+		AllocationRegistry::getShared().recordFree(AllocationCategory::RenderTarget, pooledHeap.size);
+	_heapPool->clear();
+}
+
+TransientResourceHandle TransientResourceAllocator::declare(const D3D12_RESOURCE_DESC& resourceDesc, D3D12_RESOURCE_STATES initialState,
+	const D3D12_CLEAR_VALUE* optimizedClearValue, UINT firstPass, UINT lastPass, const wchar_t* name) {
+	D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = _device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+	if (allocationInfo.SizeInBytes == UINT64_MAX) {
+		std::cerr << "Invalid resource description for transient resource!" << std::endl;
+		return kInvalidHandle;
+	}
+
+	Resource resource{};
+	resource.desc = resourceDesc;
+	resource.initialState = initialState;
+	resource.hasClearValue = optimizedClearValue != nullptr;
+	if (optimizedClearValue != nullptr)
+		resource.clearValue = *optimizedClearValue;
+	resource.name = name != nullptr ? name : L"Transient resource";
+	resource.aliased = false;
+	_resources.push_back(resource);
+
+	uint32_t index = _planner.addResource(allocationInfo.SizeInBytes, allocationInfo.Alignment, firstPass, lastPass);
+	assert(index == _resources.size() - 1);
+	return index;
+}
+
+bool TransientResourceAllocator::compile() {
+	_releaseResources();
+
+	const UINT64 heapSize = _planner.plan();
+	if (heapSize == 0)
+		return true;
+
+	// grow heap if needed (pooled heaps first)
+	if (_heap != nullptr && _heapSize < heapSize)
+		_releaseHeap();
+	if (_heap == nullptr && _acquireHeap(heapSize) == false) {
+		D3D12_HEAP_DESC heapDesc{};
+		heapDesc.SizeInBytes = heapSize;
+		heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+		heapDesc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+		heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+		heapDesc.Properties.CreationNodeMask = 1;
+		heapDesc.Properties.VisibleNodeMask = 1;
+		heapDesc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+
+		HRESULT result = _device->CreateHeap(&heapDesc, IID_PPV_ARGS(&_heap));
+		if (result < 0) {
+			std::cerr << "Failed to create transient heap (" << heapSize << " bytes)!" << std::endl;
+			return false;
+		}
+		_heap->SetName(L"Transient resource heap");
+		_heapSize = heapSize;
+		_heapCreationCount++;
+		AllocationRegistry::getShared().recordAllocation(AllocationCategory::RenderTarget, _heapSize);
+	}
+
+	for (uint32_t i = 0; i < _resources.size(); i++) {
+		Resource& resource = _resources[i];
+		HRESULT result = _device->CreatePlacedResource(_heap.Get(), _planner.getOffset(i), &resource.desc, resource.initialState,
+			resource.hasClearValue ? &resource.clearValue : nullptr, IID_PPV_ARGS(&resource.resource));
+		if (result < 0) {
+			std::cerr << "Failed to create transient resource!" << std::endl;
+			return false;
+		}
+		resource.resource->SetName(resource.name.c_str());
+		resource.aliased = _planner.isAliased(i);
+	}
+
+	const UINT64 unaliasedSize = _planner.getUnaliasedSize();
+	std::cout << "Transient resources : " << _resources.size() << " resources, " << unaliasedSize << " bytes aliased into " << heapSize << " bytes (saved "
+		<< (unaliasedSize - heapSize) / (1024.0 * 1024.0) << " MB)" << std::endl;
+	return true;
+}
+
+void TransientResourceAllocator::reset() {
+	// heap is kept for next compile
+	_releaseResources();
+	_resources.clear();
+	_planner.clear();
+}
+
+void TransientResourceAllocator::_releaseResources() {
+	bool retired = false;
+	for (Resource& resource : _resources) {
+		if (resource.resource == nullptr)
+			continue;
+		if (_deferredReleaseQueue != nullptr) {
+			_deferredReleaseQueue->retireObject(std::move(resource.resource));
+			retired = true;
+		}
+		resource.resource.Reset();
+	}
+
+	// frames in flight may still use memory of retired resources, so new ones are placed in new heap
+	if (retired)
+		_releaseHeap();
+}
+
+void TransientResourceAllocator::_releaseHeap() {
+	if (_heap == nullptr)
+		return;
+	const UINT64 heapSize = _heapSize;
+	if (_deferredReleaseQueue != nullptr) {
+		// back to pool when GPU is done with it (or released if allocator is gone)
+		ComPtr<ID3D12Heap> retiredHeap = std::move(_heap);
+		std::weak_ptr<std::vector<PooledHeap>> weakPool = _heapPool;
+		_deferredReleaseQueue->retire([retiredHeap, heapSize, weakPool]() mutable {
+			std::shared_ptr<std::vector<PooledHeap>> pool = weakPool.lock();
+			if (pool != nullptr) {
+				_returnHeap(*pool, retiredHeap, heapSize);
+				return;
+			}
+			AllocationRegistry::getShared().recordFree(AllocationCategory::RenderTarget, heapSize);
+			retiredHeap.Reset();
+		});
+	}
+	else {
+		AllocationRegistry::getShared().recordFree(AllocationCategory::RenderTarget, heapSize);
+	}
+	_heap.Reset();
+	_heapSize = 0;
+}
+
+bool TransientResourceAllocator::_acquireHeap(UINT64 size) {
+	// smallest pooled heap that fits, unless it's more than twice as large
+	std::vector<PooledHeap>& pool = *_heapPool;
+	size_t bestIndex = pool.size();
+	for (size_t i = 0; i < pool.size(); i++) {
+		if (pool[i].size < size || pool[i].size > size * 2)
+			continue;
+		if (bestIndex == pool.size() || pool[i].size < pool[bestIndex].size)
+			bestIndex = i;
+	}
+	if (bestIndex == pool.size())
+		return false;
+
+	_heap = std::move(pool[bestIndex].heap);
+	_heapSize = pool[bestIndex].size;
+	pool.erase(pool.begin() + bestIndex);
+	return true;
+}
+
+void TransientResourceAllocator::_returnHeap(std::vector<PooledHeap>& pool, ComPtr<ID3D12Heap>& heap, UINT64 size) {
+	// oldest heap is released if pool is full
+	if (pool.size() >= kMaxPooledHeaps) {
+		AllocationRegistry::getShared().recordFree(AllocationCategory::RenderTarget, pool.front().size);
+		pool.erase(pool.begin());
+	}
+	pool.push_back({ std::move(heap), size });
+}
+
+void TransientResourceAllocator::beginPass(ID3D12GraphicsCommandList* commandList, UINT pass) {
+	_barriers.clear();
+
+	// resource which shares memory must be activated before use
+	D3D12_RESOURCE_BARRIER barrier{};
+	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+	for (uint32_t i = 0; i < _resources.size(); i++) {
+		if (_resources[i].aliased == false || _planner.getFirstPass(i) != pass)
+			continue;
+		barrier.Aliasing.pResourceBefore = nullptr;
+		barrier.Aliasing.pResourceAfter = _resources[i].resource.Get();
+		_barriers.push_back(barrier);
+	}
+	if (_barriers.empty())
+		return;
+	commandList->ResourceBarrier(static_cast<UINT>(_barriers.size()), _barriers.data());
+
+	// contents are undefined after aliasing, so targets need to be initialized
+	for (const D3D12_RESOURCE_BARRIER& aliasingBarrier : _barriers)
+		commandList->DiscardResource(aliasingBarrier.Aliasing.pResourceAfter, nullptr);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "pch.h"
+#include "TransientResourcePlanner.h"
+#include "DeferredReleaseQueue.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using Microsoft::WRL::ComPtr;
+
+typedef uint32_t TransientResourceHandle;
+
+// Places transient render targets in one shared heap, aliasing resources whose pass lifetimes don't overlap.
+// Resources are declared with pass range, compiled once, and activated with aliasing barriers at their first pass.
+// Transient resources must be back in their initial state at the end of their last pass.
+class TransientResourceAllocator
+{
+public:
+	static constexpr TransientResourceHandle kInvalidHandle = ~0u;
+
+	TransientResourceAllocator(ID3D12Device* device);
+	~TransientResourceAllocator();
+
+	// Properties
+	ID3D12Device* getDevice() const { return _device; }
+	UINT64 getHeapSize() const { return _heapSize; }
+	UINT getHeapCreationCount() const { return _heapCreationCount; }
+	UINT64 getUnaliasedSize() const { return _planner.getUnaliasedSize(); }
+	ID3D12Resource* getResource(TransientResourceHandle handle) const { return _resources[handle].resource.Get(); }
+	// With queue, previous resources and their heap are retired instead of released, so GPU doesn't need to be idle on recompile
+	void setDeferredReleaseQueue(DeferredReleaseQueue* queue) { _deferredReleaseQueue = queue; }
+
+	// Declaration (lifetime is inclusive pass range)
+	TransientResourceHandle declare(const D3D12_RESOURCE_DESC& resourceDesc, D3D12_RESOURCE_STATES initialState,
+		const D3D12_CLEAR_VALUE* optimizedClearValue, UINT firstPass, UINT lastPass, const wchar_t* name);
+	// Plans memory and creates placed resources (GPU must not use previous resources, unless they're retired)
+	bool compile();
+	// Releases all declarations and resources, keeping heap for reuse (GPU must not use them, unless they're retired)
+	void reset();
+
+	// Rendering
+	// Activates resources whose lifetime begins at the pass
+	void beginPass(ID3D12GraphicsCommandList* commandList, UINT pass);
+
+private:
+	struct Resource {
+		D3D12_RESOURCE_DESC desc;
+		D3D12_RESOURCE_STATES initialState;
+		D3D12_CLEAR_VALUE clearValue;
+		bool hasClearValue;
+		std::wstring name;
+		ComPtr<ID3D12Resource> resource;
+		bool aliased;
+	};
+
+	struct PooledHeap {
+		ComPtr<ID3D12Heap> heap;
+		UINT64 size;
+	};
+	static constexpr size_t kMaxPooledHeaps = 2;
+
+	void _releaseResources();
+	void _releaseHeap();
+	bool _acquireHeap(UINT64 size);
+	static void _returnHeap(std::vector<PooledHeap>& pool, ComPtr<ID3D12Heap>& heap, UINT64 size);
+
+	ID3D12Device* _device;
+	DeferredReleaseQueue* _deferredReleaseQueue;
+	ComPtr<ID3D12Heap> _heap;
+	UINT64 _heapSize;
+	UINT _heapCreationCount;
+	// Retired heaps come back once GPU is done with them, so recompiling (e.g. on resize) reuses memory.
+	// Shared with release callbacks, which may run after allocator is destroyed.
+	std::shared_ptr<std::vector<PooledHeap>> _heapPool;
+	TransientResourcePlanner _planner;
+	std::vector<Resource> _resources;
+	std::vector<D3D12_RESOURCE_BARRIER> _barriers;
+};
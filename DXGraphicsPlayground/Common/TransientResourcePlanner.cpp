@@ -0,0 +1,76 @@
+#include "pch.h"
+#include "TransientResourcePlanner.h"
+#include <algorithm>
+#include <cassert>
+
+uint32_t TransientResourcePlanner::addResource(uint64_t size, uint64_t alignment, uint32_t firstPass, uint32_t lastPass) {
+	assert(firstPass <= lastPass && "Invalid lifetime.");
+	assert((alignment == 0 || (alignment & (alignment - 1)) == 0) && "Alignment must be power of two.");
+
+	Resource resource{};
+	resource.size = size;
+	resource.alignment = alignment > 0 ? alignment : 1;
+	resource.firstPass = firstPass;
+	resource.lastPass = lastPass;
+	resource.offset = kInvalidOffset;
+	_resources.push_back(resource);
+	return static_cast<uint32_t>(_resources.size() - 1);
+}
+
+void TransientResourcePlanner::clear() {
+	_resources.clear();
+	_heapSize = 0;
+	_unaliasedSize = 0;
+}
+
+uint64_t TransientResourcePlanner::plan() {
+	_heapSize = 0;
+	_unaliasedSize = 0;
+
+	// place larger resources first, they are hardest to fit
+	_order.resize(_resources.size());
+	for (uint32_t i = 0; i < _order.size(); i++) {
+		_order[i] = i;
+		_resources[i].offset = kInvalidOffset;
+	}
+	std::stable_sort(_order.begin(), _order.end(), [this](uint32_t a, uint32_t b) {
+		return _resources[a].size > _resources[b].size;
+	});
+
+	for (uint32_t index : _order) {
+		Resource& resource = _resources[index];
+		_unaliasedSize += resource.size;
+
+		// placed resources alive at the same time, sorted by offset
+		_conflicts.clear();
+		for (const Resource& other : _resources) {
+			if (&other != &resource && other.offset != kInvalidOffset && _overlapsInTime(resource, other))
+				_conflicts.push_back(&other);
+		}
+		std::sort(_conflicts.begin(), _conflicts.end(), [](const Resource* a, const Resource* b) {
+			return a->offset < b->offset;
+		});
+
+		// lowest gap which fits
+		uint64_t offset = 0;
+		for (const Resource* conflict : _conflicts) {
+			if (offset + resource.size <= conflict->offset)
+				break;
+			uint64_t end = conflict->offset + conflict->size;
+			if (end > offset)
+				offset = (end + resource.alignment - 1) & ~(resource.alignment - 1);
+		}
+		resource.offset = offset;
+		_heapSize = offset + resource.size > _heapSize ? offset + resource.size : _heapSize;
+	}
+	return _heapSize;
+}
+
+bool TransientResourcePlanner::isAliased(uint32_t index) const {
+	const Resource& resource = _resources[index];
+	for (uint32_t i = 0; i < _resources.size(); i++) {
+		if (i != index && _overlapsInMemory(resource, _resources[i]))
+			return true;
+	}
+	return false;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Packs transient resources into shared memory by their pass lifetimes.
+// Resources whose lifetimes don't overlap can share (alias) the same memory range.
+class TransientResourcePlanner
+{
+public:
+	static constexpr uint64_t kInvalidOffset = ~0ull;
+
+	TransientResourcePlanner() : _heapSize(0), _unaliasedSize(0) {}
+	~TransientResourcePlanner() {}
+
+	// Declaration (lifetime is inclusive pass range)
+	uint32_t addResource(uint64_t size, uint64_t alignment, uint32_t firstPass, uint32_t lastPass);
+	void clear();
+
+	// Computes offsets of all resources and returns required memory size
+	uint64_t plan();
+
+	// Properties
+	uint32_t getResourceCount() const { return static_cast<uint32_t>(_resources.size()); }
+	uint64_t getOffset(uint32_t index) const { return _resources[index].offset; }
+	uint64_t getSize(uint32_t index) const { return _resources[index].size; }
+	uint32_t getFirstPass(uint32_t index) const { return _resources[index].firstPass; }
+	uint32_t getLastPass(uint32_t index) const { return _resources[index].lastPass; }
+	uint64_t getHeapSize() const { return _heapSize; }
+	uint64_t getUnaliasedSize() const { return _unaliasedSize; }
+	// Whether the resource shares memory with any other resource
+	bool isAliased(uint32_t index) const;
+
+private:
+	struct Resource {
+		uint64_t size;
+		uint64_t alignment;
+		uint32_t firstPass;
+		uint32_t lastPass;
+		uint64_t offset;
+	};
+
+	bool _overlapsInTime(const Resource& a, const Resource& b) const { return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass; }
+	bool _overlapsInMemory(const Resource& a, const Resource& b) const { return a.offset < b.offset + b.size && b.offset < a.offset + a.size; }
+
+	std::vector<Resource> _resources;
+	std::vector<uint32_t> _order;
+	std::vector<const Resource*> _conflicts;
+	uint64_t _heapSize;
+	uint64_t _unaliasedSize;
+};
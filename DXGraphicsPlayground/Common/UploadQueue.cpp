@@ -0,0 +1,114 @@
+#include "pch.h"
+#include "UploadQueue.h"
+#include <cassert>
+#include <iostream>
+
+UploadQueue::UploadQueue(ID3D12Device* device, UINT maxAllocatorCount)
+	: _device(device), _allocatorCount(0), _maxAllocatorCount(maxAllocatorCount), _recording(false), _fenceEvent(NULL), _nextFenceValue(1)
+{
+	assert(_device != nullptr && "Device is null.");
+	assert(_maxAllocatorCount > 0 && "Upload queue needs at least one command allocator.");
+
+	HRESULT result = S_OK;
+
+	// copy queue
+	D3D12_COMMAND_QUEUE_DESC queueDesc{};
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	result = _device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&_queue));
+	assert(result >= 0 && "Can't create copy queue!");
+	_queue->SetName(L"Upload copy queue");
+
+	// fence
+	result = _device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&_fence));
+	assert(result >= 0 && "Can't create upload fence!");
+	_fenceEvent = CreateEvent(nullptr, false, false, nullptr);
+
+	_uploader = std::make_unique<ResourceUploader>(_device);
+}
+
+UploadQueue::~UploadQueue() {
+	if (_nextFenceValue > 1)
+		waitForCompletion(_nextFenceValue - 1);
+	CloseHandle(_fenceEvent);
+}
+
+ID3D12GraphicsCommandList* UploadQueue::begin() {
+	if (_recording)
+		return _commandList.Get();
+
+	// reuse the oldest allocator if GPU is done with it, or wait for it when pool is full
+	const bool isPoolFull = _allocatorCount >= _maxAllocatorCount;
+	if (_retiredAllocators.empty() == false && (isPoolFull || _retiredAllocators.front().fenceValue <= _fence->GetCompletedValue())) {
+		waitForCompletion(_retiredAllocators.front().fenceValue);
+		_currentAllocator = _retiredAllocators.front().allocator;
+		_retiredAllocators.pop_front();
+		_currentAllocator->Reset();
+	}
+	else {
+		_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&_currentAllocator));
+		_allocatorCount++;
+	}
+
+	if (_commandList == nullptr) {
+		_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, _currentAllocator.Get(), nullptr, IID_PPV_ARGS(&_commandList));
+		_commandList->SetName(L"Upload");
+	}
+	else {
+		_commandList->Reset(_currentAllocator.Get(), nullptr);
+	}
+
+	_recording = true;
+	return _commandList.Get();
+}
+
+UploadTicket UploadQueue::submit() {
+	if (_recording == false)
+		return kInvalidTicket;
+
+	_commandList->Close();
+	ID3D12CommandList* commandLists[] = { _commandList.Get() };
+	_queue->ExecuteCommandLists(1, commandLists);
+
+	const UINT64 fenceValue = _nextFenceValue++;
+	_uploader->finishSubmission(fenceValue);
+	_queue->Signal(_fence.Get(), fenceValue);
+
+	_retiredAllocators.push_back({ _currentAllocator, fenceValue });
+	_currentAllocator.Reset();
+	_recording = false;
+	return fenceValue;
+}
+
+UploadTicket UploadQueue::uploadTextures(const TextureUpload* uploads, UINT uploadCount) {
+	// copy queue only allows COMMON and COPY_DEST states
+	_uploads.assign(uploads, uploads + uploadCount);
+	for (TextureUpload& upload : _uploads) {
+		upload.stateBefore = D3D12_RESOURCE_STATE_COMMON;
+		upload.stateAfter = D3D12_RESOURCE_STATE_COMMON;
+	}
+
+	ID3D12GraphicsCommandList* commandList = begin();
+	_uploader->uploadTextures(commandList, _uploads.data(), uploadCount);
+	return submit();
+}
+
+bool UploadQueue::isComplete(UploadTicket ticket) const {
+	return _fence->GetCompletedValue() >= ticket;
+}
+
+void UploadQueue::waitOnQueue(ID3D12CommandQueue* queue, UploadTicket ticket) {
+	if (ticket != kInvalidTicket && isComplete(ticket) == false)
+		queue->Wait(_fence.Get(), ticket);
+}
+
+void UploadQueue::waitForCompletion(UploadTicket ticket) {
+	if (ticket != kInvalidTicket && isComplete(ticket) == false) {
+		_fence->SetEventOnCompletion(ticket, _fenceEvent);
+		WaitForSingleObjectEx(_fenceEvent, INFINITE, false);
+	}
+	update();
+}
+
+void UploadQueue::update() {
+	_uploader->reclaim(_fence.Get());
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "pch.h"
+#include "ResourceUploader.h"
+#include <memory>
+#include <deque>
+#include <vector>
+
+using Microsoft::WRL::ComPtr;
+
+// Fence value of the copy queue submission which contains an upload
+typedef UINT64 UploadTicket;
+
+// Streams resource uploads on a dedicated copy queue, so they overlap rendering.
+// Textures are left in COMMON state and promoted implicitly on first use by the direct queue.
+// At most maxAllocatorCount submissions are in flight, begin() blocks on the oldest one beyond that.
+class UploadQueue
+{
+public:
+	static constexpr UploadTicket kInvalidTicket = 0;
+	static constexpr UINT kDefaultMaxAllocatorCount = 4;
+
+	UploadQueue(ID3D12Device* device, UINT maxAllocatorCount = kDefaultMaxAllocatorCount);
+	~UploadQueue();
+
+	// Properties
+	ID3D12CommandQueue* getQueue() const { return _queue.Get(); }
+	ResourceUploader* getResourceUploader() const { return _uploader.get(); }
+
+	// Recording
+	ID3D12GraphicsCommandList* begin();
+	UploadTicket submit();
+	UploadTicket uploadTextures(const TextureUpload* uploads, UINT uploadCount);
+
+	// Tickets
+	bool isComplete(UploadTicket ticket) const;
+	// Makes the queue wait on GPU until the upload is complete (doesn't block CPU)
+	void waitOnQueue(ID3D12CommandQueue* queue, UploadTicket ticket);
+	// Blocks CPU until the upload is complete
+	void waitForCompletion(UploadTicket ticket);
+
+	// Recycles command allocators and staging memory of completed uploads
+	void update();
+
+private:
+	struct CommandAllocatorEntry {
+		ComPtr<ID3D12CommandAllocator> allocator;
+		UINT64 fenceValue;
+	};
+
+	ID3D12Device* _device;
+	ComPtr<ID3D12CommandQueue> _queue;
+	ComPtr<ID3D12GraphicsCommandList> _commandList;
+	ComPtr<ID3D12CommandAllocator> _currentAllocator;
+	std::deque<CommandAllocatorEntry> _retiredAllocators;
+	UINT _allocatorCount;
+	UINT _maxAllocatorCount;
+	bool _recording;
+
+	ComPtr<ID3D12Fence> _fence;
+	HANDLE _fenceEvent;
+	UINT64 _nextFenceValue;
+
+	std::unique_ptr<ResourceUploader> _uploader;
+	std::vector<TextureUpload> _uploads;
+};
@@ -1,8 +1,9 @@
 #include "pch.h"
 #include "Win32App.h"
-#include "Time.h"
 #include "RendererBase.h"
+#include "RenderLoop.h"
 #include <cassert>
+#include <iostream>
 
 Win32App::Win32App(string& newTitle) :
 	_title(newTitle), _hWnd(NULL), _renderThread(NULL), _renderer(NULL) {
@@ -11,6 +12,8 @@ Win32App::Win32App(string& newTitle) :
 }
 
 Win32App::~Win32App() {
+	stopRenderThread();
+	_renderLoop.reset();
 	_renderer.reset();
 }
 
@@ -54,20 +57,76 @@ void Win32App::show() {
 }
 
 int Win32App::messageLoop() {
-	// initialize time values
-	QueryPerformanceFrequency(&_timeFrequency);
-	QueryPerformanceCounter(&_timePrev);
-	_timeCurrent = _timePrev;
+	if (_renderer != nullptr && _renderer->getOptions().renderThread)
+		startRenderThread();
 
-	// Message loop
+	// Message loop (without render thread, frames are rendered on WM_PAINT whenever there's no other message)
 	MSG msg = {};
 	while (msg.message != WM_QUIT) {
-		if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+		if (_renderThread != NULL) {
+			if (GetMessage(&msg, NULL, 0, 0) == -1)
+				break;
+		}
+		else if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE) == FALSE) {
+			continue;
+		}
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+	}
+	stopRenderThread();
+	return 0;
+}
+
+DWORD WINAPI Win32App::staticRenderThreadProc(LPVOID parameter) {
+	Win32App* app = reinterpret_cast<Win32App*>(parameter);
+	app->_renderLoop->run();
+	return 0;
+}
+
+void Win32App::startRenderThread() {
+	if (_renderThread != NULL || _renderLoop == nullptr)
+		return;
+	_renderThread = CreateThread(NULL, 0, &Win32App::staticRenderThreadProc, this, 0, NULL);
+	if (_renderThread == NULL)
+		std::cerr << "Failed to create render thread, rendering on window thread." << std::endl;
+}
+
+void Win32App::stopRenderThread() {
+	if (_renderThread == NULL)
+		return;
+
+	// DXGI may send messages to window while resizing or presenting, so messages are pumped while waiting
+	_renderLoop->requestStop();
+	while (_renderThread != NULL && MsgWaitForMultipleObjects(1, &_renderThread, FALSE, INFINITE, QS_ALLINPUT) == WAIT_OBJECT_0 + 1) {
+		MSG msg = {};
+		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
 			TranslateMessage(&msg);
 			DispatchMessage(&msg);
 		}
 	}
-	return 0;
+	if (_renderThread != NULL) {
+		CloseHandle(_renderThread);
+		_renderThread = NULL;
+	}
+}
+
+void Win32App::updateTitle() {
+	const float frameTime = _renderLoop != nullptr ? _renderLoop->getFrameTime() : 0.0f;
+	if (frameTime <= 0.0f)
+		return;
+
+	TCHAR newTitle[kMaxNameLength] = {};
+	int len = MultiByteToWideChar(CP_UTF8, 0, _title.c_str(), (int)_title.length(), NULL, NULL);
+	MultiByteToWideChar(CP_UTF8, 0, _title.c_str(), (int)_title.length(), newTitle, len);
+
+	// frame rate is uncapped with immediate and none present modes
+	const float fps = 1.0f / frameTime;
+	const int frameMicroseconds = (int)(frameTime * 1000000.0f + 0.5f);
+	wsprintf(&newTitle[len], TEXT(" - %d FPS (%d.%03d ms, %hs)"), (int)(fps + 0.5f), frameMicroseconds / 1000, frameMicroseconds % 1000,
+		RendererOptions::getPresentModeName(_renderer->getOptions().presentMode));
+	SetWindowText(_hWnd, newTitle);
+	if (_renderer->getOptions().presentMode != PresentMode::VSync)
+		std::cout << (int)(fps + 0.5f) << " FPS (" << frameMicroseconds / 1000.0f << " ms)" << std::endl;
 }
 
 LRESULT CALLBACK Win32App::staticWndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
@@ -91,43 +150,44 @@ LRESULT CALLBACK Win32App::wndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lP
 	case WM_CREATE:
 	{
 		_renderer->setHWnd(hWnd);
+		SetTimer(hWnd, kTitleTimerId, 1000, NULL);
 		return 0;
 	}
 	case WM_PAINT:
 	{
-		if (_renderer != nullptr) {
-			QueryPerformanceCounter(&_timeCurrent);
-			_deltaTime = static_cast<float>((double)(_timeCurrent.QuadPart - _timePrev.QuadPart) / (double)_timeFrequency.QuadPart);
-			_fpsCheck += _deltaTime;
-			_fps = _fps * 0.9f + (1.0f / _deltaTime) * 0.1f;
-			if (_fpsCheck >= 1.0f) {
-				TCHAR newTitle[kMaxNameLength] = {};
-				int len = MultiByteToWideChar(CP_UTF8, 0, _title.c_str(), (int)_title.length(), NULL, NULL);
-				MultiByteToWideChar(CP_UTF8, 0, _title.c_str(), (int)_title.length(), newTitle, len);
-
-				wsprintf(&newTitle[len], TEXT(" - %d FPS"), (int)(_fps+0.5f));
-				_fpsCheck -= 1.0f;
-				SetWindowText(hWnd, newTitle);
-			}
-
-			// rendering loop
-			_renderer->update(_deltaTime);
-			_renderer->beginFrame();
-			_renderer->render();
-			_renderer->endFrame();
-
-			_timePrev = _timeCurrent;
-			_timeSinceStartup += _deltaTime;
-
-			Time::_deltaTime = _deltaTime;
-			Time::_timeSinceStartup = _timeSinceStartup;
+		// without render thread, window isn't validated so WM_PAINT keeps coming for next frame
+		if (_renderLoop != nullptr && _renderThread == NULL) {
+			_renderLoop->runFrame();
+			return 0;
 		}
+		ValidateRect(hWnd, NULL);
+		return 0;
+	}
+	case WM_TIMER:
+	{
+		if (wParam == kTitleTimerId)
+			updateTitle();
 		return 0;
 	}
 	case WM_SIZE:
 	{
-		if (_renderer != nullptr) {
-			_renderer->resize(LOWORD(lParam), HIWORD(lParam));
+		// minimized window keeps its swap chain
+		if (_renderLoop != nullptr && wParam != SIZE_MINIMIZED) {
+			_renderLoop->postResize(LOWORD(lParam), HIWORD(lParam));
+		}
+		return 0;
+	}
+	case WM_ENTERSIZEMOVE:
+	{
+		if (_renderLoop != nullptr) {
+			_renderLoop->postBeginSizing();
+		}
+		return 0;
+	}
+	case WM_EXITSIZEMOVE:
+	{
+		if (_renderLoop != nullptr) {
+			_renderLoop->postEndSizing();
 		}
 		return 0;
 	}
@@ -135,18 +195,25 @@ LRESULT CALLBACK Win32App::wndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lP
 	case WM_MOVING:
 	case WM_SETFOCUS:
 	{
-		if (_renderer != nullptr) {
-			_renderer->move();
+		if (_renderLoop != nullptr) {
+			_renderLoop->postMove();
 		}
 		return 0;
 	}
 	case WM_DISPLAYCHANGE:
 	{
-		if (_renderer != nullptr) {
-			_renderer->displayDidChange();
+		if (_renderLoop != nullptr) {
+			_renderLoop->postDisplayChange();
 		}
 		return 0;
 	}
+	case WM_CLOSE:
+	{
+		// renderer must be done with window before it's destroyed
+		stopRenderThread();
+		KillTimer(hWnd, kTitleTimerId);
+		break;
+	}
 	case WM_DESTROY:
 		PostQuitMessage(0);
 		return 0;
@@ -155,10 +222,13 @@ LRESULT CALLBACK Win32App::wndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lP
 }
 
 void Win32App::setRenderer(RendererBase* newRenderer) {
+	assert(_renderThread == NULL && "Renderer can't be changed while render thread runs.");
+	_renderLoop.reset();
 	_renderer.reset(newRenderer);
 	if (_renderer != nullptr) {
 		_renderer->init();
 		if (_hWnd != NULL)
 			_renderer->setHWnd(_hWnd);
+		_renderLoop = std::make_unique<RenderLoop>(_renderer.get(), _renderer->getOptions());
 	}
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 using namespace std;
 
 class RendererBase;
+class RenderLoop;
 
 class Win32App
 {
@@ -22,7 +23,7 @@ public:
 	// Window procedure
 	int messageLoop();
 
-	// Renderer
+	// Renderer (can't be changed while render thread runs)
 	RendererBase* getRenderer() const { return _renderer.get(); }
 	void setRenderer(RendererBase* newRenderer);
 
@@ -30,18 +31,19 @@ protected:
 	static LRESULT CALLBACK staticWndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 	virtual LRESULT CALLBACK wndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
+	// Render thread
+	static DWORD WINAPI staticRenderThreadProc(LPVOID parameter);
+	void startRenderThread();
+	void stopRenderThread();
+	void updateTitle();
+
 private:
 	constexpr static size_t kMaxNameLength = 128;
+	constexpr static UINT_PTR kTitleTimerId = 1;
 
 	string _title;
 	HWND _hWnd;
-	HANDLE _renderThread;		// TODO : separate render job from UI thread
+	HANDLE _renderThread;		// runs render loop, unless RendererOptions::renderThread is off
 	shared_ptr<RendererBase> _renderer;
-
-	// application time
-	LARGE_INTEGER _timePrev = {}, _timeCurrent = {}, _timeFrequency = {};
-	float _timeSinceStartup = 0;
-	float _deltaTime = 0;
-	float _fps = 0;
-	float _fpsCheck = 0;
+	unique_ptr<RenderLoop> _renderLoop;		// window events go to renderer through its queue
 };
@@ -8,10 +8,13 @@
 #define PCH_H
 
 // 여기에 미리 컴파일하려는 헤더 추가
+// (graphics API-free sources are also built on Linux by Tests/CMakeLists.txt)
+#if defined(_WIN32)
 #include "framework.h"
 #include <Windows.h>
 #include <d3d12.h>
 #include <d3dcompiler.h>
 #include <wrl.h>
+#endif
 
 #endif //PCH_H
\ No newline at end of file
@@ -1,8 +1,12 @@
 #include "SimpleRenderer.h"
 #include "../Common/Time.h"
+#include "../Common/MipGenerator.h"
+#include "../Common/BlockCompressor.h"
+#include "../Common/Noise.h"
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
 #include <string>
+#include <vector>
 #include <iostream>
 #include <functional>
 
@@ -141,26 +145,46 @@ void SimpleRenderer::_initAssets() {
 	textureDesc.Height = textureWidth;
 	textureDesc.ArraySize = 1;
 	textureDesc.SampleDesc.Count = 1;
-	textureDesc.Format = DXGI_FORMAT_R8_UNORM;
-	textureDesc.MipLevels = 1;
-	constexpr UINT textureSize = textureWidth * textureWidth;
-	//UINT8 texturePointer[textureSize] = { };
-	UINT8* texturePointer = new UINT8[textureSize];
-	_initNoiseTexture(texturePointer);
-	D3D11_SUBRESOURCE_DATA textureResourceData = {};
-	textureResourceData.pSysMem = texturePointer;
-	textureResourceData.SysMemPitch = textureWidth;
-	result = _device->CreateTexture2D(&textureDesc, &textureResourceData, &_texture);
+
+	// heightmap (3 octaves of value noise, seeded so it's the same on every run)
+	NoiseDesc noiseDesc;
+	noiseDesc.basis = NoiseBasis::Value;
+	noiseDesc.fractal = NoiseFractal::FBm;
+	noiseDesc.frequency = 8.0f;
+	noiseDesc.octaveCount = 3;
+	std::vector<UINT8> noise(textureWidth * textureWidth);
+	NoiseGenerator(noiseDesc).fillUnorm8(noise.data(), textureWidth, textureWidth, textureWidth);
+
+	// full mip chain
+	MipGenerator mipGenerator;
+	MipChain mipChain;
+	mipGenerator.generate(noise.data(), textureWidth, textureWidth, textureWidth, MipFormat::R8, MipFilter::Box, mipChain);
+
+	// noise is single channel, so BC4 keeps it at half size of R8
+	BlockCompressor blockCompressor;
+	std::vector<std::vector<UINT8>> textureBlocks(mipChain.getLevelCount());
+	textureDesc.Format = DXGI_FORMAT_BC4_UNORM;
+	textureDesc.MipLevels = mipChain.getLevelCount();
+	std::vector<D3D11_SUBRESOURCE_DATA> textureResourceData(mipChain.getLevelCount());
+	for (UINT level = 0; level < mipChain.getLevelCount(); level++) {
+		const MipLevel& mip = mipChain.levels[level];
+		const size_t blockRowPitch = BlockCompressor::getRowPitch(BlockFormat::BC4, mip.width);
+		textureBlocks[level].resize(blockRowPitch * BlockCompressor::getBlockCount(mip.height));
+		blockCompressor.compress(mipChain.getLevelData(level), mip.width, mip.height, mip.rowPitch, BlockFormat::BC4, BlockCompressionQuality::High,
+			textureBlocks[level].data(), blockRowPitch, 1);
+		textureResourceData[level].pSysMem = textureBlocks[level].data();
+		textureResourceData[level].SysMemPitch = static_cast<UINT>(blockRowPitch);
+	}
+	result = _device->CreateTexture2D(&textureDesc, textureResourceData.data(), &_texture);
 	if (result != S_OK) {
 		std::cerr << "Failed to create texture 2D!" << std::endl;
 		return;
 	}
-	delete[] texturePointer;
 
 	// shader resource view
 	D3D11_SHADER_RESOURCE_VIEW_DESC textureSRVDesc = {};
 	textureSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	textureSRVDesc.Texture2D.MipLevels = 1;
+	textureSRVDesc.Texture2D.MipLevels = textureDesc.MipLevels;
 	result = _device->CreateShaderResourceView(_texture.Get(), &textureSRVDesc, &_textureSRV);
 	if (result != S_OK) {
 		std::cerr << "Failed to create shader resource view for texture!" << std::endl;
@@ -180,45 +204,6 @@ void SimpleRenderer::_initAssets() {
 	}
 }
 
-void SimpleRenderer::_initNoiseTexture(UINT8 *texturePointer) {
-	// make simple noise textures!
-	UINT8* noiseDiv4 = new UINT8[textureWidth * textureWidth / 16];
-	UINT8* noiseDiv2 = new UINT8[textureWidth * textureWidth / 4];
-	UINT8* noise = new UINT8[textureWidth * textureWidth];
-
-//	UINT8 noiseDiv4[textureWidth * textureWidth / 16] = {};
-//	UINT8 noiseDiv2[textureWidth * textureWidth / 4] = {};
-//	UINT8 noise[textureWidth * textureWidth] = {};
-
-	for (int j = 0; j < textureWidth; j++) {
-		for (int i = 0; i < textureWidth; i++) {
-			if (j % 4 == 0 && i % 4 == 0)
-				noiseDiv4[j * textureWidth / 16 + i / 4] = static_cast<UINT8>((float)rand() / RAND_MAX * 255.0f);
-			if (j % 2 == 0 && i % 2 == 0)
-				noiseDiv2[j * textureWidth / 4 + i / 2] = static_cast<UINT8>((float)rand() / RAND_MAX * 255.0f);
-			noise[j * textureWidth + i] = static_cast<UINT8>((float)rand() / RAND_MAX * 255.0f);
-		}
-	}
-
-	auto lerp = [](UINT a, UINT b, float t) { return static_cast<UINT8>(a * (1.0f - t) + b * t); };
-
-	for (int j = 0; j < textureWidth; j++) {
-		for (int i = 0; i < textureWidth; i++) {
-			texturePointer[j * textureWidth + i] = static_cast<UINT8>(noise[j * textureWidth + i] * 0.125f);
-			UINT8 l1 = lerp(noiseDiv2[j * textureWidth / 4 + i / 2], noiseDiv2[j * textureWidth / 4 + i / 2 + 1], (i % 2) / 2.0f);
-			UINT8 l2 = lerp(noiseDiv2[(j + 1) * textureWidth / 4 + i / 2], noiseDiv2[(j + 1) * textureWidth / 4 + i / 2 + 1], (i % 2) / 2.0f);
-			texturePointer[j * textureWidth + i] += static_cast<UINT8>(lerp(l1, l2, (j % 2) / 2.0f) * 0.25f);
-			l1 = lerp(noiseDiv4[j * textureWidth / 16 + i / 4], noiseDiv4[j * textureWidth / 16 + i / 4 + 1], (i % 4) / 4.0f);
-			l2 = lerp(noiseDiv4[(j + 1) * textureWidth / 16 + i / 4], noiseDiv4[(j + 1) * textureWidth / 16 + i / 4 + 1], (i % 4) / 4.0f);
-			texturePointer[j * textureWidth + i] += static_cast<UINT8>(lerp(l1, l2, (j % 4) / 4.0f) * 0.5f);
-		}
-	}
-
-	delete[] noiseDiv4;
-	delete[] noiseDiv2;
-	delete[] noise;
-}
-
 void SimpleRenderer::update(float deltaTime) {
 	float aspectRatio = _width / (float)_height;
 	ObjectInfo info = {};
@@ -6,6 +6,8 @@
 class SimpleRenderer : public RendererD3D11
 {
 public:
+	SimpleRenderer(const RendererOptions& options = RendererOptions()) : RendererD3D11(options) {}
+
 	virtual void update(float deltaTime) override;
 	virtual void init() override;
 	virtual void render() override;
@@ -14,7 +16,6 @@ public:
 protected:
 	void _initAssets();
 	void _cleanupAssets();
-	void _initNoiseTexture(UINT8 *texturePointer);
 
 private:
 	ComPtr<ID3D11InputLayout> _inputLayout;
@@ -6,7 +6,7 @@ int main(int argc, char** argv) {
 	string title = u8"Simple";
 
 	Win32App app(title);
-	app.setRenderer(new SimpleRenderer());
+	app.setRenderer(new SimpleRenderer(RendererOptions::parse(argc, argv)));
 	app.createWindow(640, 480);
 	app.show();
 	return app.messageLoop();
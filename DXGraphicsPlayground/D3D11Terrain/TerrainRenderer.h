@@ -4,6 +4,7 @@
 
 class TerrainRenderer : public RendererD3D11
 {
-
+public:
+	TerrainRenderer(const RendererOptions& options = RendererOptions()) : RendererD3D11(options) {}
 };
 
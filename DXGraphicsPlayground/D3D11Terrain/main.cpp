@@ -6,7 +6,7 @@ int main(int argc, char** argv) {
 	string title = u8"Simple";
 
 	Win32App app(title);
-	TerrainRenderer *renderer = new TerrainRenderer();
+	TerrainRenderer *renderer = new TerrainRenderer(RendererOptions::parse(argc, argv));
 	app.setRenderer(static_cast<RendererBase*>(renderer));
 	app.createWindow(640, 480);
 	app.show();
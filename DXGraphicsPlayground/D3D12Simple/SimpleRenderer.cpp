@@ -1,14 +1,17 @@
 #include "SimpleRenderer.h"
+#include "../Common/GPUBufferView.h"
+#include "../Common/AllocationRegistry.h"
+#include "../Common/TextureStreamer.h"
 #include "../Common/Time.h"
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
+#include <fstream>
+#include <iterator>
 #include <string>
 #include <iostream>
+#include <cstring>
 #include <pix3.h>
 
-#define STB_IMAGE_IMPLEMENTATION 1
-#include "stb_image.h"
-
 using namespace DirectX;
 
 struct VertexInfo {
@@ -26,6 +29,9 @@ static VertexInfo kVertices[] = {
 	{ XMFLOAT3( 0.5f,  0.5f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 1.0f)  },
 };
 
+// Everything that changes decoded texture, which is part of its texture cache key
+static const char* const kDecodedTextureParameters = "channels=4 flip=1 format=rgba8_srgb mips=full filter=kaiser";
+
 _declspec(align(256)) struct CommonInfo {
 	float normalizedSDRWhiteLevel;
 	bool isST2084Output;
@@ -36,6 +42,23 @@ _declspec(align(256)) struct ObjectInfo {
 	XMMATRIX projection;
 };
 
+// Cache lives next to executable, so it doesn't depend on working directory
+static std::string _getTextureCacheDirectory() {
+	char path[MAX_PATH] = {};
+	GetModuleFileNameA(nullptr, path, MAX_PATH);
+	char* lastSlash = strrchr(path, '\\');
+	if (lastSlash)
+		*(lastSlash + 1) = '\0';
+	return std::string(path) + "Cache";
+}
+
+SimpleRenderer::~SimpleRenderer() {
+	if (_textureCacheWriter.joinable())
+		_textureCacheWriter.join();
+	if (_device != nullptr)
+		_cleanupAssets();
+}
+
 void SimpleRenderer::init() {
 	_initAssets();
 }
@@ -43,12 +66,6 @@ void SimpleRenderer::init() {
 void SimpleRenderer::_initAssets() {
 	HRESULT result = S_OK;
 
-	// Prepare command list for initialize
-	auto commandList = _getRenderCommandList();
-	auto commandAllocator = _getRenderCommandAllocator();
-	commandAllocator->Reset();
-	commandList->Reset(_getRenderCommandAllocator(), nullptr);
-
 	// Root signature
 	_initRootSignature();
 
@@ -114,81 +131,71 @@ void SimpleRenderer::_initAssets() {
 		std::cout << "Failed to create pipeline state! : " << result << std::endl;
 	}
 
-	// Vertex buffer
-	D3D12_HEAP_PROPERTIES vertexBufferHeapProps = {};
-	vertexBufferHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
-	vertexBufferHeapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-	vertexBufferHeapProps.CreationNodeMask = 1;
-	vertexBufferHeapProps.VisibleNodeMask = 1;
-	D3D12_RESOURCE_DESC vertexBufferResourceDesc = {};
-	vertexBufferResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	vertexBufferResourceDesc.Width = sizeof(kVertices);
-	vertexBufferResourceDesc.Height = 1;
-	vertexBufferResourceDesc.DepthOrArraySize = 1;
-	vertexBufferResourceDesc.MipLevels = 1;
-	vertexBufferResourceDesc.SampleDesc.Count = 1;
-	vertexBufferResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-	result = _device->CreateCommittedResource(&vertexBufferHeapProps, D3D12_HEAP_FLAG_NONE, &vertexBufferResourceDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&_vertexBuffer));
-	if (result != S_OK) {
-		std::cout << "Failed to create committed resource! : " << result << std::endl;
+	// Vertex buffer (written directly into mapped memory)
+	_vertexBuffer = std::make_unique<GPUBuffer>(_device.Get(), sizeof(kVertices));
+	if (_vertexBuffer->open()) {
+		GPUBufferView<VertexInfo> vertices(_vertexBuffer.get(), 0, _countof(kVertices));
+		for (size_t i = 0; i < _countof(kVertices); i++)
+			vertices[i] = kVertices[i];
+		vertices.commit();
+		_vertexBuffer->close();
 	}
-
-	UINT8* vertexBufferPointer = nullptr;
-	D3D12_RANGE bufferReadRange = { 0, 0 }, bufferWriteRange = { 0, sizeof(kVertices) };
-	result = _vertexBuffer->Map(0, &bufferReadRange, reinterpret_cast<void**>(&vertexBufferPointer));
-	if (result != S_OK) {
-		std::cout << "Failed to copy vertex data! : " << result << std::endl;
+	else {
+		std::cout << "Failed to copy vertex data!" << std::endl;
 	}
-	memcpy(vertexBufferPointer, kVertices, sizeof(kVertices));
-	_vertexBuffer->Unmap(0, nullptr);
 
-	_vertexBufferView.BufferLocation = _vertexBuffer->GetGPUVirtualAddress();
+	_vertexBufferView.BufferLocation = _vertexBuffer->getResource()->GetGPUVirtualAddress();
 	_vertexBufferView.SizeInBytes = sizeof(kVertices);
 	_vertexBufferView.StrideInBytes = sizeof(VertexInfo);
 
-	// CBVs
-	_commonBuffer = std::make_unique<GPUBuffer>(_device.Get(), sizeof(CommonInfo) * kMaxBuffersInFlight);
-	_uniformBuffer = std::make_unique<GPUBuffer>(_device.Get(), sizeof(ObjectInfo) * kMaxBuffersInFlight);
-
-	// Map buffer pointer (we don't unmap until app closes)
-	_commonBuffer->open();
-	_uniformBuffer->open();
-
-	// image flag
-	// NOTE: set TRUE to load image from file!
-	constexpr bool useSTBImage = false;
-
-	// STB image
-	struct
-	{
-		int x, y, channel;
-	} imginfo{};
-	stbi_set_flip_vertically_on_load_thread(TRUE);
-	stbi_uc* stbimg = nullptr;
-	if (useSTBImage) {
-		stbimg = stbi_load("../Assets/Textures/PrinE2013.jpg", &imginfo.x, &imginfo.y, &imginfo.channel, 4);
+	// Decode image on worker threads, checkbox pattern is shown until it's uploaded
+	// Cooked texture is streamed without decoding if it exists (see TextureCooker),
+	// and so is the result of previous launch in texture cache
+	_imageDecoder = std::make_unique<ImageDecoder>();
+	if (_options.loadImage) {
+		_streamedTexture = _textureStreamer->addTexture("../Assets/Textures/PrinE2013.ctex");
+		if (_streamedTexture == TextureStreamingPolicy::kInvalidTexture) {
+			const std::string imagePath = "../Assets/Textures/PrinE2013.jpg";
+			std::ifstream imageFile(imagePath, std::ios::binary);
+			std::vector<unsigned char> encoded((std::istreambuf_iterator<char>(imageFile)), std::istreambuf_iterator<char>());
+			_decodedTextureCacheKey = TextureCache::computeKey(encoded.data(), encoded.size(), kDecodedTextureParameters);
+
+			std::string cachedPath;
+			_textureCache = std::make_unique<TextureCache>(_getTextureCacheDirectory());
+			if (_textureCache->find(_decodedTextureCacheKey, cachedPath))
+				_streamedTexture = _textureStreamer->addTexture(cachedPath);
+			if (_streamedTexture == TextureStreamingPolicy::kInvalidTexture)
+				_imageDecoder->decode(std::move(encoded), imagePath, 4, true, DecodeTarget::MipChain);
+		}
 	}
 
-	// checkbox pattern
-	constexpr size_t checkboxSize = 128;
-	constexpr size_t checkboxCellWidth = 8;
-	const size_t checkboxTextureSize = checkboxSize * checkboxSize * 4;
-	UINT8* checkboxTexturePointer = new UINT8[checkboxTextureSize];
-	for (int j = 0; j < checkboxSize; j++) {
-		for (int i = 0; i < checkboxSize; i++) {
-			checkboxTexturePointer[(j * checkboxSize + i) * 4] = (i / checkboxCellWidth + j / checkboxCellWidth) % 2 ? 255 : 0;
-			checkboxTexturePointer[(j * checkboxSize + i) * 4 + 1] = (i / checkboxCellWidth + j / checkboxCellWidth) % 2 ? 255 : 0;
-			checkboxTexturePointer[(j * checkboxSize + i) * 4 + 2] = (i / checkboxCellWidth + j / checkboxCellWidth) % 2 ? 255 : 0;
-			checkboxTexturePointer[(j * checkboxSize + i) * 4 + 3] = 255;
+	// checkbox pattern (written in place into level 0 of mip chain)
+	constexpr uint32_t checkboxSize = 128;
+	constexpr uint32_t checkboxCellWidth = 8;
+	MipChain checkboxMipChain;
+	MipGenerator::reserve(checkboxSize, checkboxSize, MipFormat::RGBA8_SRGB, checkboxMipChain);
+	UINT8* checkboxPixels = checkboxMipChain.getLevelData(0);
+	for (uint32_t j = 0; j < checkboxSize; j++) {
+		for (uint32_t i = 0; i < checkboxSize; i++) {
+			const UINT8 value = (i / checkboxCellWidth + j / checkboxCellWidth) % 2 ? 255 : 0;
+			UINT8* pixel = checkboxPixels + (j * checkboxSize + i) * 4;
+			pixel[0] = value;
+			pixel[1] = value;
+			pixel[2] = value;
+			pixel[3] = 255;
 		}
 	}
 
-	UINT textureWidth = checkboxSize, textureHeight = checkboxSize;
-	if (stbimg != nullptr) {
-		textureWidth = imginfo.x;
-		textureHeight = imginfo.y;
-	}
+	_textureUploadTicket = _createTexture(checkboxMipChain, MipFilter::Box, _texture, _textureSRV);
+}
+
+UploadTicket SimpleRenderer::_createTexture(MipChain& mipChain, MipFilter filter, ComPtr<ID3D12Resource>& texture, DescriptorRange& srv) {
+	HRESULT result = S_OK;
+
+	// remaining levels from level 0 (filtered in linear space)
+	MipGenerator mipGenerator;
+	mipChain.format = MipFormat::RGBA8_SRGB;
+	mipGenerator.generateLevels(mipChain, filter);
 
 	// texture
 	D3D12_HEAP_PROPERTIES textureHeapProps{};
@@ -197,48 +204,67 @@ void SimpleRenderer::_initAssets() {
 	textureHeapProps.CreationNodeMask = 1;
 	textureHeapProps.VisibleNodeMask = 1;
 	D3D12_RESOURCE_DESC textureDesc{};
-	textureDesc.MipLevels = 1;
+	textureDesc.MipLevels = static_cast<UINT16>(mipChain.getLevelCount());
 	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-	textureDesc.Width = textureWidth;
-	textureDesc.Height = textureHeight;
+	textureDesc.Width = mipChain.levels[0].width;
+	textureDesc.Height = mipChain.levels[0].height;
 	textureDesc.DepthOrArraySize = 1;
 	textureDesc.SampleDesc.Count = 1;
 	textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
 
 	result = _device->CreateCommittedResource(&textureHeapProps, D3D12_HEAP_FLAG_NONE, &textureDesc,
-		D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&_texture));
+		D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&texture));
 	if (result != S_OK) {
 		std::cout << "Failed to map texture buffer! : " << result << std::endl;
+		return UploadQueue::kInvalidTicket;
 	}
-	
-	ResourceUploader textureUploader;
-	if (stbimg != nullptr) {
-		textureUploader.updateSubresource(commandList, 0, stbimg, textureWidth * textureHeight * 4, _texture.Get());
-		stbi_image_free(stbimg);
-	}
-	else {
-		textureUploader.updateSubresource(commandList, 0, checkboxTexturePointer, textureWidth* textureHeight * 4, _texture.Get());
+	AllocationRegistry::getShared().recordAllocation(AllocationCategory::Texture, _device->GetResourceAllocationInfo(0, 1, &textureDesc).SizeInBytes);
+
+	// upload on copy queue (source data is copied to staging memory immediately)
+	std::vector<SubresourceData> textureData(mipChain.getLevelCount());
+	for (UINT level = 0; level < mipChain.getLevelCount(); level++) {
+		textureData[level].data = mipChain.getLevelData(level);
+		textureData[level].rowPitch = mipChain.levels[level].rowPitch;
+		textureData[level].slicePitch = mipChain.levels[level].size;
 	}
+	TextureUpload textureUpload;
+	textureUpload.texture = texture.Get();
+	textureUpload.mipCount = mipChain.getLevelCount();
+	textureUpload.subresources = textureData.data();
+	UploadTicket ticket = _uploadQueue->uploadTextures(&textureUpload, 1);
+
+	_createTextureSRV(texture.Get(), srv);
+	return ticket;
+}
 
-	// texture SRV heap
-	D3D12_DESCRIPTOR_HEAP_DESC textureSRVHeapDesc{};
-	textureSRVHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	textureSRVHeapDesc.NodeMask = 0;
-	textureSRVHeapDesc.NumDescriptors = 1;
-	textureSRVHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	result = _device->CreateDescriptorHeap(&textureSRVHeapDesc, IID_PPV_ARGS(&_textureSRVHeap));
+void SimpleRenderer::_storeInTextureCache(uint64_t key, MipChain&& mipChain) {
+	// writing takes tens of milliseconds, so it's done on its own thread (cache isn't used elsewhere after init)
+	if (_textureCacheWriter.joinable())
+		_textureCacheWriter.join();
+	_textureCacheWriter = std::thread([this, key, mipChain = std::move(mipChain)]() {
+		CookedTextureDesc desc;
+		desc.format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+		desc.width = mipChain.levels[0].width;
+		desc.height = mipChain.levels[0].height;
+		desc.mipCount = mipChain.getLevelCount();
+		CookedTextureWriter writer(desc);
+		for (uint32_t level = 0; level < desc.mipCount; level++)
+			writer.setSubresource(level, mipChain.getLevelData(level), mipChain.levels[level].rowPitch, mipChain.levels[level].size);
+		if (_textureCache->store(key, writer) == false)
+			std::cerr << "Failed to store texture in cache : " << _textureCache->getPath(key) << std::endl;
+	});
+}
+
+void SimpleRenderer::_createTextureSRV(ID3D12Resource* texture, DescriptorRange& srv) {
+	D3D12_RESOURCE_DESC textureDesc = texture->GetDesc();
+	srv = _descriptorAllocator->allocatePersistent(1);
 
 	D3D12_SHADER_RESOURCE_VIEW_DESC textureSRVDesc{};
 	textureSRVDesc.Format = textureDesc.Format;
 	textureSRVDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 	textureSRVDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	textureSRVDesc.Texture2D.MipLevels = 1;
-	_device->CreateShaderResourceView(_texture.Get(), &textureSRVDesc, _textureSRVHeap->GetCPUDescriptorHandleForHeapStart());
-	
-	result = commandList->Close();
-	ID3D12CommandList* commandLists[] = { commandList };
-	_queue->ExecuteCommandLists(1, commandLists);
-	_waitForGpu();
+	textureSRVDesc.Texture2D.MipLevels = textureDesc.MipLevels;
+	_device->CreateShaderResourceView(texture, &textureSRVDesc, srv.cpuHandle);
 }
 
 void SimpleRenderer::_initRootSignature() {
@@ -294,26 +320,87 @@ void SimpleRenderer::_initRootSignature() {
 }
 
 void SimpleRenderer::_cleanupAssets() {
-	_commonBuffer->close();
-	_uniformBuffer->close();
+	_imageDecoder.reset();
+	if (_streamedTexture != TextureStreamingPolicy::kInvalidTexture) {
+		_textureStreamer->removeTexture(_streamedTexture);
+		_streamedTexture = TextureStreamingPolicy::kInvalidTexture;
+	}
 
-	// Because we use ComPtr reference, there's no need to release assets explicitly.
+	// frames in flight may still sample textures, so they're released once GPU passes them
+	DescriptorAllocator* descriptorAllocator = _descriptorAllocator.get();
+	ComPtr<ID3D12Resource>* textures[] = { &_texture, &_decodedTexture };
+	DescriptorRange* srvs[] = { &_textureSRV, &_decodedTextureSRV };
+	for (int i = 0; i < _countof(textures); i++) {
+		UINT64 allocationSize = 0;
+		if (*textures[i] != nullptr) {
+			D3D12_RESOURCE_DESC textureDesc = (*textures[i])->GetDesc();
+			allocationSize = _device->GetResourceAllocationInfo(0, 1, &textureDesc).SizeInBytes;
+		}
+		ComPtr<ID3D12Resource> retiredTexture = std::move(*textures[i]);
+		DescriptorRange retiredSRV = *srvs[i];
+		_deferredReleaseQueue->retire([descriptorAllocator, retiredTexture, retiredSRV, allocationSize]() mutable {
+			descriptorAllocator->free(retiredSRV);
+			if (retiredTexture != nullptr) {
+				AllocationRegistry::getShared().recordFree(AllocationCategory::Texture, allocationSize);
+				retiredTexture.Reset();
+			}
+		});
+		*srvs[i] = DescriptorRange{};
+	}
 }
 
 void SimpleRenderer::update(float deltaTime) {
-	CommonInfo commonInfo = {};
-	commonInfo.normalizedSDRWhiteLevel = _referenceSDRWhiteNits / 10000.0f;
-	commonInfo.isST2084Output = _isHDROutputSupported;
-	_commonBuffer->copy(&commonInfo, sizeof(CommonInfo), _currentFrameIndex * sizeof(CommonInfo));
+	// Upload decoded image as soon as it's ready
+	DecodedImage image;
+	while (_imageDecoder != nullptr && _imageDecoder->tryPop(image)) {
+		if (image.isValid() == false) {
+			std::cerr << "Failed to decode " << image.name << " : " << image.error << std::endl;
+			continue;
+		}
+		if (_decodedTexture == nullptr) {
+			_decodedTextureUploadTicket = _createTexture(image.mipChain, MipFilter::Kaiser, _decodedTexture, _decodedTextureSRV);
+			// levels were copied to staging memory, so chain is handed over to cache writer
+			_storeInTextureCache(_decodedTextureCacheKey, std::move(image.mipChain));
+		}
+	}
+
+	// Quad is half of screen height, so it needs mip that maps texels to those pixels
+	if (_streamedTexture != TextureStreamingPolicy::kInvalidTexture)
+		_textureStreamer->requestScreenSize(_streamedTexture, _height * 0.5f, _height * 0.5f);
+	_textureStreamer->update();
+
+	// Constant buffers live until this frame's fence completes.
+	// Draw is skipped in frames where they can't be allocated (addresses are left 0).
+	_commonBufferAddress = _uniformBufferAddress = 0;
+	auto commonInfo = _constantBufferAllocator->allocate<CommonInfo>();
+	auto objInfo = _constantBufferAllocator->allocate<ObjectInfo>();
+	if (commonInfo.isValid() == false || objInfo.isValid() == false) {
+		std::cerr << "Failed to allocate constant buffers, draw is skipped!" << std::endl;
+		return;
+	}
+
+	commonInfo.cpuPointer->normalizedSDRWhiteLevel = _referenceSDRWhiteNits / 10000.0f;
+	commonInfo.cpuPointer->isST2084Output = _isHDROutputSupported;
+	_commonBufferAddress = commonInfo.gpuAddress;
 
 	float aspectRatio = _width / (float)_height;
-	ObjectInfo objInfo = {};
-	objInfo.view = XMMatrixTranspose(XMMatrixRotationZ(Time::getTimeSinceStartup()));
-	objInfo.projection = XMMatrixTranspose(XMMatrixOrthographicLH(2.0f * aspectRatio, 2.0f, -1.0f, 1.0f));
-	_uniformBuffer->copy(&objInfo, sizeof(ObjectInfo), _currentFrameIndex * sizeof(ObjectInfo));
+	objInfo.cpuPointer->view = XMMatrixTranspose(XMMatrixRotationZ(Time::getTimeSinceStartup()));
+	objInfo.cpuPointer->projection = XMMatrixTranspose(XMMatrixOrthographicLH(2.0f * aspectRatio, 2.0f, -1.0f, 1.0f));
+	_uniformBufferAddress = objInfo.gpuAddress;
 }
 
 void SimpleRenderer::render() {
+	if (_commonBufferAddress == 0 || _uniformBufferAddress == 0)
+		return;
+
+	// wait on GPU for texture upload before first use
+	const bool useDecodedTexture = _decodedTexture != nullptr;
+	UploadTicket& uploadTicket = useDecodedTexture ? _decodedTextureUploadTicket : _textureUploadTicket;
+	if (uploadTicket != UploadQueue::kInvalidTicket) {
+		_uploadQueue->waitOnQueue(_queue.Get(), uploadTicket);
+		uploadTicket = UploadQueue::kInvalidTicket;
+	}
+
 	auto commandList = _getRenderCommandList();
 	commandList->SetName(L"Draw");
 	commandList->SetGraphicsRootSignature(_rootSignature.Get());
@@ -322,15 +409,15 @@ void SimpleRenderer::render() {
 	commandList->SetPipelineState(_renderPipeline.Get());
 	commandList->IASetVertexBuffers(0, 1, &_vertexBufferView);
 
-	ID3D12DescriptorHeap* descriptorHeaps[] = { _textureSRVHeap.Get() };
+	ID3D12DescriptorHeap* descriptorHeaps[] = { _descriptorAllocator->getShaderVisibleHeap() };
 	commandList->SetDescriptorHeaps(1, descriptorHeaps);
-	auto commonBufferAddress = _commonBuffer->getResource()->GetGPUVirtualAddress();
-	commonBufferAddress += (UINT64)_currentFrameIndex * sizeof(CommonInfo);
-	commandList->SetGraphicsRootConstantBufferView(0, commonBufferAddress);
-	auto uniformBufferAddress = _uniformBuffer->getResource()->GetGPUVirtualAddress();
-	uniformBufferAddress += (UINT64)_currentFrameIndex * sizeof(ObjectInfo);
-	commandList->SetGraphicsRootConstantBufferView(1, uniformBufferAddress);
-	commandList->SetGraphicsRootDescriptorTable(2, _textureSRVHeap->GetGPUDescriptorHandleForHeapStart());
+	commandList->SetGraphicsRootConstantBufferView(0, _commonBufferAddress);
+	commandList->SetGraphicsRootConstantBufferView(1, _uniformBufferAddress);
+	// streamed texture is swapped in only after its upload is complete
+	D3D12_GPU_DESCRIPTOR_HANDLE textureHandle = useDecodedTexture ? _decodedTextureSRV.gpuHandle : _textureSRV.gpuHandle;
+	if (_streamedTexture != TextureStreamingPolicy::kInvalidTexture && _textureStreamer->getSRV(_streamedTexture).isValid())
+		textureHandle = _textureStreamer->getSRV(_streamedTexture).gpuHandle;
+	commandList->SetGraphicsRootDescriptorTable(2, textureHandle);
 	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	commandList->DrawInstanced(_countof(kVertices), 1, 0, 0);
 
@@ -3,11 +3,22 @@
 #include "../Common/RendererD3D12.h"
 #include "../Common/ResourceUploader.h"
 #include "../Common/GPUBuffer.h"
+#include "../Common/ConstantBufferAllocator.h"
+#include "../Common/DescriptorAllocator.h"
+#include "../Common/UploadQueue.h"
+#include "../Common/ImageDecoder.h"
+#include "../Common/MipGenerator.h"
+#include "../Common/TextureStreamingPolicy.h"
+#include "../Common/TextureCache.h"
 #include <memory>
+#include <thread>
 
 class SimpleRenderer : public RendererD3D12
 {
 public:
+	SimpleRenderer(const RendererOptions& options = RendererOptions()) : RendererD3D12(options) {}
+	~SimpleRenderer();
+
 	virtual void update(float deltaTime) override;
 	virtual void init() override;
 	virtual void render() override;
@@ -17,17 +28,36 @@ protected:
 	void _initAssets();
 	void _cleanupAssets();
 	void _initRootSignature();
+	// Generates levels 1 ~ from level 0 of mip chain and uploads it as sRGB texture
+	UploadTicket _createTexture(MipChain& mipChain, MipFilter filter, ComPtr<ID3D12Resource>& texture, DescriptorRange& srv);
+	void _createTextureSRV(ID3D12Resource* texture, DescriptorRange& srv);
+	// Saves processed mip chain on writer thread, so next launch streams it instead of decoding
+	void _storeInTextureCache(uint64_t key, MipChain&& mipChain);
 
 private:
 	ComPtr<ID3D12RootSignature> _rootSignature;
 	ComPtr<ID3D12PipelineState> _renderPipeline;
-	ComPtr<ID3D12Resource> _vertexBuffer;
+	std::unique_ptr<GPUBuffer> _vertexBuffer;
 	D3D12_VERTEX_BUFFER_VIEW _vertexBufferView;
 
-	std::unique_ptr<GPUBuffer> _uniformBuffer;
-	std::unique_ptr<GPUBuffer> _commonBuffer;
+	// per-frame constant buffers (0 if allocation failed)
+	D3D12_GPU_VIRTUAL_ADDRESS _commonBufferAddress = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS _uniformBufferAddress = 0;
 
 	ComPtr<ID3D12Resource> _texture;
-	ComPtr<ID3D12DescriptorHeap> _textureSRVHeap;
+	UploadTicket _textureUploadTicket = UploadQueue::kInvalidTicket;
+	DescriptorRange _textureSRV;
+
+	// image decoded on worker threads (replaces placeholder texture when uploaded)
+	std::unique_ptr<ImageDecoder> _imageDecoder;
+	ComPtr<ID3D12Resource> _decodedTexture;
+	UploadTicket _decodedTextureUploadTicket = UploadQueue::kInvalidTicket;
+	DescriptorRange _decodedTextureSRV;
+	std::unique_ptr<TextureCache> _textureCache;		// created only when image has to be decoded
+	std::thread _textureCacheWriter;
+	uint64_t _decodedTextureCacheKey = 0;
+
+	// cooked texture streamed by mip (replaces other textures when its mip tail is uploaded)
+	StreamingTextureId _streamedTexture = TextureStreamingPolicy::kInvalidTexture;
 };
 
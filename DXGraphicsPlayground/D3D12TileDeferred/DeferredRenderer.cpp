@@ -1,9 +1,102 @@
 #include "DeferredRenderer.h"
+#include "../Common/AllocationRegistry.h"
+#include <iostream>
 
 void DeferredRenderer::init() {
 	_initAssets();
 }
 
 void DeferredRenderer::_initAssets() {
-	_gBuffer = std::make_unique<GBuffer>(_device.Get(), _width, _height);
-}
\ No newline at end of file
+	_transientAllocator = std::make_unique<TransientResourceAllocator>(_device.Get());
+	_transientAllocator->setDeferredReleaseQueue(_deferredReleaseQueue.get());
+	_targetBuckets.update(_width, _height);
+	_makeTransientResources();
+
+#if defined(_DEBUG)
+	_heapAllocator->printStatistics(std::cout);
+	AllocationRegistry::getShared().dump(std::cout);
+	AllocationRegistry::getShared().setDumpInterval(600, &std::cout);
+#endif
+}
+
+void DeferredRenderer::_makeTransientResources() {
+	const UINT targetWidth = _targetBuckets.getTargetWidth(), targetHeight = _targetBuckets.getTargetHeight();
+	_transientAllocator->reset();
+
+	// G-buffer is only needed between geometry and lighting pass
+	if (_gBuffer == nullptr) {
+		_gBuffer = std::make_unique<GBuffer>(_transientAllocator.get(), _descriptorAllocator.get(), kGeometryPass, kLightingPass, targetWidth, targetHeight);
+		_gBuffer->setDeferredReleaseQueue(_deferredReleaseQueue.get());
+	}
+	else {
+		_gBuffer->resize(targetWidth, targetHeight);
+	}
+
+	D3D12_RESOURCE_DESC resourceDesc{};
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	resourceDesc.Width = targetWidth;
+	resourceDesc.Height = targetHeight;
+	resourceDesc.DepthOrArraySize = 1;
+	resourceDesc.MipLevels = 1;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+	resourceDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+	_lightingTarget = _transientAllocator->declare(resourceDesc, D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr, kLightingPass, kPostProcessPass, L"Lighting");
+	_postProcessTargets[0] = _transientAllocator->declare(resourceDesc, D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr, kPostProcessPass, kCompositePass, L"Post process 0");
+	_postProcessTargets[1] = _transientAllocator->declare(resourceDesc, D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr, kPostProcessPass, kCompositePass, L"Post process 1");
+
+	if (_transientAllocator->compile() == false) {
+		std::cerr << "Failed to compile transient resources!" << std::endl;
+		return;
+	}
+	_gBuffer->bindTransientTargets();
+}
+
+void DeferredRenderer::resize(int newWidth, int newHeight) {
+	RendererD3D12::resize(newWidth, newHeight);
+
+	// targets are rebuilt only when window leaves their bucket, and previous ones are retired, so frames in flight keep using them
+	if (_transientAllocator != nullptr && _targetBuckets.update(_width, _height))
+		_makeTransientResources();
+}
+
+void DeferredRenderer::update(float deltaTime) {}
+
+void DeferredRenderer::render() {
+	auto commandList = _getRenderCommandList();
+	ID3D12Resource* gBufferTargets[] = { _gBuffer->getAlbedo(), _gBuffer->getNormal(), _gBuffer->getPos(), _gBuffer->getShading(), _gBuffer->getTangent() };
+	const UINT gBufferTargetCount = _countof(gBufferTargets);
+
+	// Geometry
+	_transientAllocator->beginPass(commandList, kGeometryPass);
+	static float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (UINT i = 0; i < gBufferTargetCount; i++)
+		commandList->ClearRenderTargetView(_gBuffer->getRTVDescriptors().getCPUHandle(i), clearColor, 0, nullptr);
+
+	// Lighting
+	_transientAllocator->beginPass(commandList, kLightingPass);
+	D3D12_RESOURCE_BARRIER barriers[gBufferTargetCount]{};
+	for (UINT i = 0; i < gBufferTargetCount; i++) {
+		barriers[i].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		barriers[i].Transition.pResource = gBufferTargets[i];
+		barriers[i].Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+		barriers[i].Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+		barriers[i].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+	}
+	commandList->ResourceBarrier(gBufferTargetCount, barriers);
+
+	// G-buffer ends its lifetime here, so return to initial state before memory is reused
+	for (UINT i = 0; i < gBufferTargetCount; i++) {
+		barriers[i].Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+		barriers[i].Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+	}
+	commandList->ResourceBarrier(gBufferTargetCount, barriers);
+
+	// Post process (reuses G-buffer memory)
+	_transientAllocator->beginPass(commandList, kPostProcessPass);
+
+	// Composite
+	_transientAllocator->beginPass(commandList, kCompositePass);
+}
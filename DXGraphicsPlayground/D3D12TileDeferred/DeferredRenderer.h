@@ -3,22 +3,34 @@
 #include "../Common/GBuffer.h"
 #include "../Common/GPUBuffer.h"
 #include "../Common/RendererD3D12.h"
+#include "../Common/RenderTargetBuckets.h"
+#include "../Common/TransientResourceAllocator.h"
 #include "../Common/Time.h"
 #include <memory>
 
 class DeferredRenderer : public RendererD3D12
 {
 public:
+	DeferredRenderer(const RendererOptions& options = RendererOptions()) : RendererD3D12(options) {}
+
 	virtual void init() override;
 
 	// Rendering
 	virtual void update(float deltaTime) override;
 	virtual void render() override;
+	virtual void resize(int newWidth, int newHeight) override;
 
 protected:
 	void _initAssets();
+	void _makeTransientResources();
 
 private:
+	// Passes which transient resources live through
+	enum { kGeometryPass, kLightingPass, kPostProcessPass, kCompositePass, kPassCount };
+
+	std::unique_ptr<TransientResourceAllocator> _transientAllocator;
+	RenderTargetBuckets _targetBuckets;					// targets are bucket-sized, and window-sized region is rendered
 	std::unique_ptr<GBuffer> _gBuffer;
+	TransientResourceHandle _lightingTarget;			// HDR lighting result
+	TransientResourceHandle _postProcessTargets[2];		// ping-pong scratch
 };
-
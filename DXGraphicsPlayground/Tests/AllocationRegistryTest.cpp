@@ -0,0 +1,114 @@
+#include "AllocationRegistry.h"
+#include "TestCommon.h"
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	const AllocationRegistry::CategoryStatistics& _category(const AllocationRegistry::Snapshot& snapshot, AllocationCategory category) {
+		return snapshot.categories[static_cast<uint32_t>(category)];
+	}
+
+	void _testCounters() {
+		AllocationRegistry registry;
+		registry.recordAllocation(AllocationCategory::Texture, 1000);
+		registry.recordAllocation(AllocationCategory::Texture, 500);
+		registry.recordAllocation(AllocationCategory::Buffer, 64);
+		registry.recordFree(AllocationCategory::Texture, 1000);
+
+		AllocationRegistry::Snapshot snapshot = registry.getSnapshot();
+		const AllocationRegistry::CategoryStatistics& texture = _category(snapshot, AllocationCategory::Texture);
+		CHECK(texture.liveBytes == 500);
+		CHECK(texture.liveCount == 1);
+		CHECK(texture.totalAllocationCount == 2);
+		CHECK(texture.frameAllocationCount == 2);
+		CHECK(texture.frameFreeCount == 1);
+		CHECK(texture.frameAllocatedBytes == 1500);
+		CHECK(_category(snapshot, AllocationCategory::Buffer).liveBytes == 64);
+		CHECK(_category(snapshot, AllocationCategory::Upload).totalAllocationCount == 0);
+		CHECK(snapshot.liveBytes == 564);
+
+		// per-frame counters are reset, live counters are kept
+		registry.endFrame();
+		snapshot = registry.getSnapshot();
+		CHECK(snapshot.frameIndex == 1);
+		CHECK(_category(snapshot, AllocationCategory::Texture).frameAllocationCount == 0);
+		CHECK(_category(snapshot, AllocationCategory::Texture).frameFreeCount == 0);
+		CHECK(_category(snapshot, AllocationCategory::Texture).frameAllocatedBytes == 0);
+		CHECK(_category(snapshot, AllocationCategory::Texture).liveBytes == 500);
+		CHECK(_category(snapshot, AllocationCategory::Texture).totalAllocationCount == 2);
+
+		registry.reset();
+		snapshot = registry.getSnapshot();
+		CHECK(snapshot.liveBytes == 0);
+		CHECK(snapshot.frameIndex == 0);
+		CHECK(_category(snapshot, AllocationCategory::Texture).totalAllocationCount == 0);
+	}
+
+	void _testPeak() {
+		AllocationRegistry registry;
+		registry.recordAllocation(AllocationCategory::RenderTarget, 300);
+		registry.recordAllocation(AllocationCategory::Upload, 200);
+		registry.recordFree(AllocationCategory::Upload, 200);
+		registry.recordAllocation(AllocationCategory::RenderTarget, 100);
+		registry.recordFree(AllocationCategory::RenderTarget, 300);
+		registry.recordAllocation(AllocationCategory::Upload, 50);
+
+		// per-category peak is independent from total peak
+		AllocationRegistry::Snapshot snapshot = registry.getSnapshot();
+		CHECK(_category(snapshot, AllocationCategory::RenderTarget).peakBytes == 400);
+		CHECK(_category(snapshot, AllocationCategory::RenderTarget).liveBytes == 100);
+		CHECK(_category(snapshot, AllocationCategory::Upload).peakBytes == 200);
+		CHECK(_category(snapshot, AllocationCategory::Upload).liveBytes == 50);
+		CHECK(snapshot.peakBytes == 500);
+		CHECK(snapshot.liveBytes == 150);
+
+		// peak survives frame boundary
+		registry.endFrame();
+		CHECK(registry.getSnapshot().peakBytes == 500);
+	}
+
+	void _testConcurrentRecording() {
+		AllocationRegistry registry;
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; t++) {
+			threads.emplace_back([&registry]() {
+				for (int i = 0; i < 10000; i++) {
+					registry.recordAllocation(AllocationCategory::Buffer, 16);
+					registry.recordFree(AllocationCategory::Buffer, 16);
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+			thread.join();
+
+		AllocationRegistry::Snapshot snapshot = registry.getSnapshot();
+		CHECK(_category(snapshot, AllocationCategory::Buffer).totalAllocationCount == 40000);
+		CHECK(_category(snapshot, AllocationCategory::Buffer).liveCount == 0);
+		CHECK(snapshot.liveBytes == 0);
+		CHECK(snapshot.peakBytes >= 16 && snapshot.peakBytes <= 64);
+	}
+
+	void _testDump() {
+		AllocationRegistry registry;
+		std::ostringstream stream;
+		registry.setDumpInterval(2, &stream);
+		registry.recordAllocation(AllocationCategory::Texture, 4096);
+		registry.endFrame();
+		CHECK(stream.str().empty());
+		registry.endFrame();
+		const std::string text = stream.str();
+		CHECK(text.find("frame 1") != std::string::npos);
+		CHECK(text.find("Texture : 1 allocations, 4096 bytes live") != std::string::npos);
+		CHECK(text.find("Buffer") == std::string::npos);
+	}
+}
+
+int main() {
+	_testCounters();
+	_testPeak();
+	_testConcurrentRecording();
+	_testDump();
+	return Test::finish("AllocationRegistryTest");
+}
@@ -0,0 +1,46 @@
+#include "BlockCompressor.h"
+#include "TestCommon.h"
+#include <cmath>
+#include <vector>
+
+// Compresses 2048x2048 RGBA8 image per format and quality on one core. MB/s is measured on source (RGBA8) bytes.
+int main() {
+	const uint32_t kSize = 2048;
+	std::vector<uint8_t> pixels(kSize * kSize * 4);
+	uint32_t random = 12345;
+	for (uint32_t y = 0; y < kSize; y++) {
+		for (uint32_t x = 0; x < kSize; x++) {
+			// smooth image with some noise, like photo texture
+			random = random * 1664525u + 1013904223u;
+			const int noise = static_cast<int>(random >> 28) - 8;
+			uint8_t* pixel = &pixels[(y * kSize + x) * 4];
+			pixel[0] = static_cast<uint8_t>((x / 8 + noise) & 0xFF);
+			pixel[1] = static_cast<uint8_t>((y / 8 - noise) & 0xFF);
+			pixel[2] = static_cast<uint8_t>(128 + 100 * sinf(x * 0.01f + y * 0.02f) + noise);
+			pixel[3] = static_cast<uint8_t>((x + y) / 16);
+		}
+	}
+
+	const BlockFormat formats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5, BlockFormat::BC7 };
+	const BlockCompressionQuality qualities[] = { BlockCompressionQuality::Fast, BlockCompressionQuality::Normal, BlockCompressionQuality::High };
+	const double sourceMegabytes = pixels.size() / (1024.0 * 1024.0);
+	BlockCompressor compressor(1);
+	std::printf("BlockCompressor : %ux%u RGBA8, one core\n", kSize, kSize);
+	for (BlockFormat format : formats) {
+		const size_t blockRowPitch = BlockCompressor::getRowPitch(format, kSize);
+		std::vector<uint8_t> blocks(blockRowPitch * BlockCompressor::getBlockCount(kSize));
+		std::vector<uint8_t> decoded(pixels.size());
+		std::printf("%-4s", BlockCompressor::getFormatName(format));
+		for (BlockCompressionQuality quality : qualities) {
+			const double beginTime = Test::getTime();
+			compressor.compress(pixels.data(), kSize, kSize, kSize * 4, format, quality, blocks.data(), blockRowPitch);
+			const double elapsed = Test::getTime() - beginTime;
+
+			BlockCompressor::decompress(blocks.data(), blockRowPitch, kSize, kSize, format, decoded.data(), kSize * 4);
+			const double psnr = BlockCompressor::computePSNR(pixels.data(), kSize * 4, decoded.data(), kSize * 4, kSize, kSize, format);
+			std::printf(" | %s %.1f MB/s %.2f dB", BlockCompressor::getQualityName(quality), sourceMegabytes / elapsed, psnr);
+		}
+		std::printf("\n");
+	}
+	return 0;
+}
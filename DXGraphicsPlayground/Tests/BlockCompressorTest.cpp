@@ -0,0 +1,178 @@
+#include "BlockCompressor.h"
+#include "TestCommon.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+	const BlockCompressionQuality kQualities[] = { BlockCompressionQuality::Fast, BlockCompressionQuality::Normal, BlockCompressionQuality::High };
+
+	// Smooth color and alpha gradients, with partial blocks on right and bottom edge
+	const uint32_t kWidth = 67;
+	const uint32_t kHeight = 45;
+
+	std::vector<uint8_t> _makeGradient(bool opaque) {
+		std::vector<uint8_t> pixels(kWidth * kHeight * 4);
+		for (uint32_t y = 0; y < kHeight; y++) {
+			for (uint32_t x = 0; x < kWidth; x++) {
+				uint8_t* pixel = &pixels[(y * kWidth + x) * 4];
+				pixel[0] = static_cast<uint8_t>(x * 255 / (kWidth - 1));
+				pixel[1] = static_cast<uint8_t>(y * 255 / (kHeight - 1));
+				pixel[2] = static_cast<uint8_t>(128 + 100 * sinf(x * 0.2f + y * 0.1f));
+				pixel[3] = opaque ? 255 : static_cast<uint8_t>(x * 3 + y * 2);
+			}
+		}
+		return pixels;
+	}
+
+	struct RoundTrip {
+		std::vector<uint8_t> blocks;
+		std::vector<uint8_t> decoded;
+		double psnr;
+		int maxError[4];
+	};
+
+	RoundTrip _roundTrip(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height, BlockFormat format, BlockCompressionQuality quality,
+		uint32_t threadCount = 1) {
+		RoundTrip result{};
+		const size_t blockRowPitch = BlockCompressor::getRowPitch(format, width);
+		result.blocks.resize(blockRowPitch * BlockCompressor::getBlockCount(height));
+		result.decoded.resize(width * height * 4);
+
+		BlockCompressor compressor(threadCount);
+		compressor.compress(pixels.data(), width, height, width * 4, format, quality, result.blocks.data(), blockRowPitch);
+		BlockCompressor::decompress(result.blocks.data(), blockRowPitch, width, height, format, result.decoded.data(), width * 4);
+		result.psnr = BlockCompressor::computePSNR(pixels.data(), width * 4, result.decoded.data(), width * 4, width, height, format);
+		for (size_t i = 0; i < pixels.size(); i++) {
+			const int error = std::abs(static_cast<int>(pixels[i]) - static_cast<int>(result.decoded[i]));
+			result.maxError[i % 4] = error > result.maxError[i % 4] ? error : result.maxError[i % 4];
+		}
+		return result;
+	}
+
+	void _testSizes() {
+		CHECK(BlockCompressor::getBlockSize(BlockFormat::BC1) == 8);
+		CHECK(BlockCompressor::getBlockSize(BlockFormat::BC3) == 16);
+		CHECK(BlockCompressor::getBlockSize(BlockFormat::BC4) == 8);
+		CHECK(BlockCompressor::getBlockSize(BlockFormat::BC5) == 16);
+		CHECK(BlockCompressor::getBlockSize(BlockFormat::BC7) == 16);
+		CHECK(BlockCompressor::getBlockCount(1) == 1);
+		CHECK(BlockCompressor::getBlockCount(67) == 17);
+		CHECK(BlockCompressor::getRowPitch(BlockFormat::BC1, 67) == 17 * 8);
+	}
+
+	void _testBC1ErrorBound() {
+		const std::vector<uint8_t> pixels = _makeGradient(true);
+		double previousPSNR = 0.0;
+		for (BlockCompressionQuality quality : kQualities) {
+			const RoundTrip result = _roundTrip(pixels, kWidth, kHeight, BlockFormat::BC1, quality);
+			// 4 colors per block on a smooth gradient : a few 5:6:5 steps at most
+			CHECK(result.maxError[0] <= 24 && result.maxError[1] <= 24 && result.maxError[2] <= 24);
+			CHECK(result.maxError[3] == 0);
+			CHECK(result.psnr >= (quality == BlockCompressionQuality::Fast ? 31.0 : 33.5));
+			// better quality never loses
+			CHECK(result.psnr >= previousPSNR - 0.01);
+			previousPSNR = result.psnr;
+		}
+	}
+
+	void _testBC1PunchThroughAlpha() {
+		// BC1 keeps 1-bit alpha : pixels under 128 become transparent, others opaque
+		const std::vector<uint8_t> pixels = _makeGradient(false);
+		for (BlockCompressionQuality quality : kQualities) {
+			const RoundTrip result = _roundTrip(pixels, kWidth, kHeight, BlockFormat::BC1, quality);
+			bool alphaMatches = true;
+			for (size_t i = 3; i < pixels.size(); i += 4)
+				alphaMatches &= result.decoded[i] == (pixels[i] < 128 ? 0 : 255);
+			CHECK(alphaMatches);
+			// PSNR skips transparent pixels, whose color is undefined
+			CHECK(result.psnr >= 31.0);
+		}
+	}
+
+	void _testBC3ErrorBound() {
+		const std::vector<uint8_t> pixels = _makeGradient(false);
+		double previousPSNR = 0.0;
+		for (BlockCompressionQuality quality : kQualities) {
+			const RoundTrip result = _roundTrip(pixels, kWidth, kHeight, BlockFormat::BC3, quality);
+			CHECK(result.maxError[0] <= 24 && result.maxError[1] <= 24 && result.maxError[2] <= 24);
+			// 8 interpolated alpha values
+			CHECK(result.maxError[3] <= 12);
+			CHECK(result.psnr >= (quality == BlockCompressionQuality::Fast ? 32.0 : 34.5));
+			CHECK(result.psnr >= previousPSNR - 0.01);
+			previousPSNR = result.psnr;
+		}
+	}
+
+	void _testSingleChannelFormats() {
+		const std::vector<uint8_t> pixels = _makeGradient(true);
+		for (BlockCompressionQuality quality : kQualities) {
+			const RoundTrip bc4 = _roundTrip(pixels, kWidth, kHeight, BlockFormat::BC4, quality);
+			CHECK(bc4.maxError[0] <= 2);
+			CHECK(bc4.psnr >= 50.0);
+			// missing channels decode to 0, alpha to 255
+			CHECK(bc4.decoded[1] == 0 && bc4.decoded[2] == 0 && bc4.decoded[3] == 255);
+
+			const RoundTrip bc5 = _roundTrip(pixels, kWidth, kHeight, BlockFormat::BC5, quality);
+			CHECK(bc5.maxError[0] <= 2 && bc5.maxError[1] <= 2);
+			CHECK(bc5.psnr >= 50.0);
+		}
+	}
+
+	void _testBC7() {
+		const std::vector<uint8_t> pixels = _makeGradient(false);
+		const RoundTrip fast = _roundTrip(pixels, kWidth, kHeight, BlockFormat::BC7, BlockCompressionQuality::Fast);
+		const RoundTrip normal = _roundTrip(pixels, kWidth, kHeight, BlockFormat::BC7, BlockCompressionQuality::Normal);
+		CHECK(fast.psnr >= 32.0);
+		CHECK(normal.psnr >= 37.0);
+		CHECK(normal.maxError[0] <= 16 && normal.maxError[1] <= 16 && normal.maxError[2] <= 48 && normal.maxError[3] <= 12);
+	}
+
+	void _testFlatBlocks() {
+		// random flat colors : only endpoint quantization is left
+		const BlockFormat formats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5, BlockFormat::BC7 };
+		const int maxErrors[] = { 4, 4, 0, 0, 1 };
+		const uint32_t channelCounts[] = { 3, 4, 1, 2, 4 };
+		uint32_t random = 1;
+		for (int i = 0; i < 200; i++) {
+			random = random * 1664525u + 1013904223u;
+			std::vector<uint8_t> pixels(4 * 4 * 4);
+			for (size_t p = 0; p < pixels.size(); p += 4) {
+				pixels[p + 0] = static_cast<uint8_t>(random >> 24);
+				pixels[p + 1] = static_cast<uint8_t>(random >> 16);
+				pixels[p + 2] = static_cast<uint8_t>(random >> 8);
+				pixels[p + 3] = static_cast<uint8_t>(random | 0x80);
+			}
+			for (int f = 0; f < 5; f++) {
+				const RoundTrip result = _roundTrip(pixels, 4, 4, formats[f], BlockCompressionQuality::Normal);
+				for (uint32_t c = 0; c < channelCounts[f]; c++)
+					CHECK(result.maxError[c] <= maxErrors[f]);
+			}
+		}
+	}
+
+	void _testThreadsMatch() {
+		// 256 block rows, enough to be split across threads
+		std::vector<uint8_t> pixels(256 * 1024 * 4);
+		uint32_t random = 7;
+		for (uint8_t& value : pixels) {
+			random = random * 1664525u + 1013904223u;
+			value = static_cast<uint8_t>(random >> 24);
+		}
+		const RoundTrip single = _roundTrip(pixels, 256, 1024, BlockFormat::BC3, BlockCompressionQuality::Normal, 1);
+		const RoundTrip threaded = _roundTrip(pixels, 256, 1024, BlockFormat::BC3, BlockCompressionQuality::Normal, 4);
+		CHECK(single.blocks == threaded.blocks);
+	}
+}
+
+int main() {
+	_testSizes();
+	_testBC1ErrorBound();
+	_testBC1PunchThroughAlpha();
+	_testBC3ErrorBound();
+	_testSingleChannelFormats();
+	_testBC7();
+	_testFlatBlocks();
+	_testThreadsMatch();
+	return Test::finish("BlockCompressorTest");
+}
@@ -0,0 +1,47 @@
+#include "BuddyAllocator.h"
+#include "TestCommon.h"
+#include <cstdint>
+#include <vector>
+
+// Placed resource-like traffic in a 64 MB heap : keeps a working set of live blocks and replaces a random one each step.
+int main() {
+	const uint64_t kCapacity = 64ull * 1024 * 1024;
+	const uint64_t kMinBlockSize = 64 * 1024;	// D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT
+	const int kLiveCount = 256;
+	const int kStepCount = 2000000;
+
+	uint32_t random = 12345;
+	auto nextRandom = [&random]() {
+		random = random * 1664525u + 1013904223u;
+		return random >> 8;
+	};
+
+	BuddyAllocator allocator(kCapacity, kMinBlockSize);
+	std::vector<uint64_t> live(kLiveCount, BuddyAllocator::kInvalidOffset);
+	uint64_t failures = 0, allocationCount = 0, requestedSum = 0, allocatedSum = 0;
+	const double beginTime = Test::getTime();
+	for (int step = 0; step < kStepCount; step++) {
+		uint64_t& slot = live[nextRandom() % kLiveCount];
+		if (slot != BuddyAllocator::kInvalidOffset)
+			allocator.free(slot);
+
+		// mostly small buffers, sometimes larger textures (64 KB .. 1 MB)
+		const uint64_t size = (nextRandom() % 8 == 0) ? 64 * 1024 + nextRandom() % (960 * 1024) : 256 + nextRandom() % (64 * 1024);
+		slot = allocator.allocate(size);
+		allocationCount++;
+		if (slot == BuddyAllocator::kInvalidOffset) {
+			failures++;
+		}
+		else if (step % 64 == 0) {
+			BuddyAllocator::Statistics statistics = allocator.getStatistics();
+			requestedSum += statistics.requestedSize;
+			allocatedSum += statistics.allocatedSize;
+		}
+	}
+	const double elapsed = Test::getTime() - beginTime;
+
+	std::printf("BuddyAllocator : %llu allocate/free pairs in %.3f s (%.1f ns per pair, %.2f M pairs/s), %llu failures, average utilization %.1f%% of allocated size\n",
+		static_cast<unsigned long long>(allocationCount), elapsed, elapsed * 1e9 / allocationCount, allocationCount / elapsed / 1e6,
+		static_cast<unsigned long long>(failures), allocatedSum > 0 ? 100.0 * requestedSum / allocatedSum : 0.0);
+	return 0;
+}
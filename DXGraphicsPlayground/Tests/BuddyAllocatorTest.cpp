@@ -0,0 +1,109 @@
+#include "BuddyAllocator.h"
+#include "TestCommon.h"
+#include <vector>
+
+namespace {
+	void _testCapacityRoundUp() {
+		BuddyAllocator allocator(3000, 256);
+		CHECK(allocator.getCapacity() == 4096);
+		CHECK(allocator.getMinBlockSize() == 256);
+		CHECK(allocator.isEmpty());
+
+		BuddyAllocator::Statistics statistics = allocator.getStatistics();
+		CHECK(statistics.freeBlockCount == 1);
+		CHECK(statistics.largestFreeBlockSize == 4096);
+	}
+
+	void _testSplitAndMerge() {
+		BuddyAllocator allocator(4096, 256);
+
+		// first allocation splits 4096 down to 256 : free blocks of 256, 512, 1024, 2048 remain
+		const uint64_t a = allocator.allocate(200);
+		CHECK(a == 0);
+		BuddyAllocator::Statistics statistics = allocator.getStatistics();
+		CHECK(statistics.freeBlockCount == 4);
+		CHECK(statistics.largestFreeBlockSize == 2048);
+		CHECK(statistics.allocatedSize == 256);
+		CHECK(statistics.requestedSize == 200);
+
+		// buddy of first block is used without splitting
+		const uint64_t b = allocator.allocate(256);
+		CHECK(b == 256);
+		const uint64_t c = allocator.allocate(1000);
+		CHECK(c == 1024);
+		const uint64_t d = allocator.allocate(600);
+		CHECK(d == 2048);
+		CHECK(allocator.getAllocatedSize() == 256 + 256 + 1024 + 1024);
+		CHECK(allocator.getStatistics().freeBlockCount == 2);
+
+		// freeing a doesn't merge while its buddy b is allocated
+		allocator.free(a);
+		CHECK(allocator.getStatistics().freeBlockCount == 3);
+		CHECK(allocator.allocate(256) == 0);
+		allocator.free(0);
+
+		// freeing b merges 256+256 -> 512, then with free 512 -> 1024
+		allocator.free(b);
+		statistics = allocator.getStatistics();
+		CHECK(statistics.freeBlockCount == 2);
+		CHECK(statistics.largestFreeBlockSize == 1024);
+
+		// freeing everything merges back to one block
+		allocator.free(d);
+		allocator.free(c);
+		statistics = allocator.getStatistics();
+		CHECK(allocator.isEmpty());
+		CHECK(statistics.freeBlockCount == 1);
+		CHECK(statistics.largestFreeBlockSize == 4096);
+		CHECK(statistics.allocatedSize == 0);
+		CHECK(statistics.requestedSize == 0);
+	}
+
+	void _testAlignment() {
+		BuddyAllocator allocator(1024 * 1024, 4096);
+		CHECK(allocator.allocate(100) == 0);
+
+		// 64 KB alignment (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) takes a 64 KB block
+		const uint64_t offset = allocator.allocate(100, 65536);
+		CHECK(offset != BuddyAllocator::kInvalidOffset);
+		CHECK(offset % 65536 == 0);
+		CHECK(offset == 65536);
+		CHECK(allocator.getAllocatedSize() == 4096 + 65536);
+	}
+
+	void _testExhaustion() {
+		BuddyAllocator allocator(4096, 256);
+		CHECK(allocator.allocate(0) == BuddyAllocator::kInvalidOffset);
+		CHECK(allocator.allocate(8192) == BuddyAllocator::kInvalidOffset);
+
+		std::vector<uint64_t> offsets;
+		for (int i = 0; i < 16; i++)
+			offsets.push_back(allocator.allocate(256));
+		for (uint64_t offset : offsets)
+			CHECK(offset != BuddyAllocator::kInvalidOffset);
+		CHECK(allocator.allocate(1) == BuddyAllocator::kInvalidOffset);
+		CHECK(allocator.getStatistics().freeBlockCount == 0);
+		CHECK(allocator.getStatistics().largestFreeBlockSize == 0);
+
+		// free every other block : 2 KB free in total, but nothing larger than 256 bytes
+		for (size_t i = 0; i < offsets.size(); i += 2)
+			allocator.free(offsets[i]);
+		BuddyAllocator::Statistics statistics = allocator.getStatistics();
+		CHECK(statistics.freeBlockCount == 8);
+		CHECK(statistics.largestFreeBlockSize == 256);
+		CHECK(allocator.allocate(512) == BuddyAllocator::kInvalidOffset);
+
+		for (size_t i = 1; i < offsets.size(); i += 2)
+			allocator.free(offsets[i]);
+		CHECK(allocator.isEmpty());
+		CHECK(allocator.getStatistics().largestFreeBlockSize == 4096);
+	}
+}
+
+int main() {
+	_testCapacityRoundUp();
+	_testSplitAndMerge();
+	_testAlignment();
+	_testExhaustion();
+	return Test::finish("BuddyAllocatorTest");
+}
@@ -0,0 +1,176 @@
+#include "CookedTexture.h"
+#include "MappedFile.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+	uint8_t _texel(uint32_t subresource, uint32_t x, uint32_t y, uint32_t byte) {
+		return static_cast<uint8_t>(subresource * 61 + x * 7 + y * 13 + byte);
+	}
+
+	std::vector<uint8_t> _readFile(const char* path) {
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void _writeFile(const char* path, const uint8_t* data, size_t size) {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+	}
+
+	void _testLayout() {
+		// non-power-of-two RGBA8 : 100x60, 50x30, 25x15
+		CookedTextureDesc desc;
+		desc.format = CookedTextureFormat::kR8G8B8A8UNorm;
+		desc.width = 100;
+		desc.height = 60;
+		desc.mipCount = 3;
+		CookedTextureWriter writer(desc);
+
+		const CookedTextureHeader& header = writer.getHeader();
+		CHECK(header.subresourceCount == 3);
+		CHECK(header.dataOffset % CookedTextureWriter::kPlacementAlignment == 0);
+		CHECK(header.dataOffset >= sizeof(CookedTextureHeader) + sizeof(CookedSubresource) * 3);
+
+		// row pitch is aligned to 256, subresources are placed at 512
+		CHECK(writer.getSubresource(0).rowSize == 400);
+		CHECK(writer.getSubresource(0).rowPitch == 512);
+		CHECK(writer.getSubresource(0).offset == 0);
+		CHECK(writer.getSubresource(1).width == 50 && writer.getSubresource(1).height == 30);
+		CHECK(writer.getSubresource(1).rowPitch == 256);
+		CHECK(writer.getSubresource(1).offset == 512 * 60);
+		CHECK(writer.getSubresource(2).width == 25 && writer.getSubresource(2).height == 15);
+		CHECK(writer.getSubresource(2).offset == 512 * 60 + 256 * 30);
+		CHECK(header.dataSize == 512 * 60 + 256 * 30 + 256 * 15);
+		for (uint32_t i = 0; i < header.subresourceCount; i++)
+			CHECK(writer.getSubresource(i).offset % CookedTextureWriter::kPlacementAlignment == 0);
+
+		// block-compressed : rows are rows of 4x4 blocks
+		desc.format = CookedTextureFormat::kBC1UNorm;
+		desc.width = 64;
+		desc.height = 64;
+		desc.mipCount = 7;
+		desc.bytesPerBlock = 8;
+		desc.blockSize = 4;
+		CookedTextureWriter bcWriter(desc);
+		CHECK(bcWriter.getSubresource(0).numRows == 16);
+		CHECK(bcWriter.getSubresource(0).rowSize == 128);
+		CHECK(bcWriter.getSubresource(0).rowPitch == 256);
+		CHECK(bcWriter.getSubresource(6).width == 1);
+		CHECK(bcWriter.getSubresource(6).numRows == 1);
+		CHECK(bcWriter.getSubresource(6).rowSize == 8);
+	}
+
+	void _testRoundTrip() {
+		CookedTextureDesc desc;
+		desc.format = CookedTextureFormat::kR8G8B8A8UNorm;
+		desc.width = 100;
+		desc.height = 60;
+		desc.arraySize = 2;
+		desc.mipCount = 3;
+		CookedTextureWriter writer(desc);
+
+		// tightly packed source, as decoder and mip generator produce
+		for (uint32_t index = 0; index < writer.getHeader().subresourceCount; index++) {
+			const CookedSubresource& subresource = writer.getSubresource(index);
+			std::vector<uint8_t> source(subresource.rowSize * subresource.numRows);
+			for (uint32_t y = 0; y < subresource.height; y++)
+				for (uint32_t x = 0; x < subresource.width; x++)
+					for (uint32_t byte = 0; byte < 4; byte++)
+						source[y * subresource.rowSize + x * 4 + byte] = _texel(index, x, y, byte);
+			writer.setSubresource(index, source.data(), subresource.rowSize, source.size());
+		}
+		CHECK(writer.save("RoundTrip.ctex"));
+
+		CookedTextureFile file;
+		CHECK(file.open("RoundTrip.ctex"));
+		if (file.isOpen() == false)
+			return;
+
+		const CookedTextureHeader& header = file.getHeader();
+		CHECK(header.magic == CookedTextureHeader::kMagic);
+		CHECK(header.version == CookedTextureHeader::kVersion);
+		CHECK(header.format == CookedTextureFormat::kR8G8B8A8UNorm);
+		CHECK(header.width == 100 && header.height == 60 && header.depth == 1);
+		CHECK(header.arraySize == 2 && header.mipCount == 3 && header.subresourceCount == 6);
+		CHECK(std::memcmp(&header, &writer.getHeader(), sizeof(header)) == 0);
+
+		bool texelsMatch = true;
+		for (uint32_t index = 0; index < header.subresourceCount; index++) {
+			const CookedSubresource& subresource = file.getSubresource(index);
+			CHECK(std::memcmp(&subresource, &writer.getSubresource(index), sizeof(subresource)) == 0);
+
+			// mapped data is already in placed footprint layout
+			const uint8_t* data = file.getSubresourceData(index);
+			CHECK(reinterpret_cast<uintptr_t>(data) % 16 == 0);
+			for (uint32_t y = 0; y < subresource.height; y++)
+				for (uint32_t x = 0; x < subresource.width; x++)
+					for (uint32_t byte = 0; byte < 4; byte++)
+						texelsMatch &= data[y * subresource.rowPitch + x * 4 + byte] == _texel(index, x, y, byte);
+		}
+		CHECK(texelsMatch);
+		file.close();
+		CHECK(file.isOpen() == false);
+	}
+
+	void _testInvalidFiles() {
+		const std::vector<uint8_t> valid = _readFile("RoundTrip.ctex");
+		CHECK(valid.size() > 1024);
+
+		CookedTextureFile file;
+		CHECK(file.open("Missing.ctex") == false);
+
+		// truncated data
+		_writeFile("Truncated.ctex", valid.data(), valid.size() - 1);
+		CHECK(file.open("Truncated.ctex") == false);
+		CHECK(file.isOpen() == false);
+
+		// truncated header
+		_writeFile("Truncated.ctex", valid.data(), sizeof(CookedTextureHeader) - 4);
+		CHECK(file.open("Truncated.ctex") == false);
+
+		// wrong magic
+		std::vector<uint8_t> corrupted = valid;
+		corrupted[0] ^= 0xFF;
+		_writeFile("Corrupted.ctex", corrupted.data(), corrupted.size());
+		CHECK(file.open("Corrupted.ctex") == false);
+
+		// subresource pointing past data
+		corrupted = valid;
+		CookedSubresource subresource;
+		std::memcpy(&subresource, corrupted.data() + sizeof(CookedTextureHeader), sizeof(subresource));
+		subresource.offset = valid.size();
+		std::memcpy(corrupted.data() + sizeof(CookedTextureHeader), &subresource, sizeof(subresource));
+		_writeFile("Corrupted.ctex", corrupted.data(), corrupted.size());
+		CHECK(file.open("Corrupted.ctex") == false);
+
+		// valid file still opens after failures
+		CHECK(file.open("RoundTrip.ctex"));
+	}
+
+	void _testMappedFile() {
+		const uint8_t bytes[] = { 1, 2, 3, 4, 5 };
+		_writeFile("Mapped.bin", bytes, sizeof(bytes));
+
+		MappedFile file;
+		CHECK(file.open("Mapped.bin"));
+		CHECK(file.isOpen());
+		CHECK(file.getSize() == sizeof(bytes));
+		CHECK(file.getData() != nullptr && std::memcmp(file.getData(), bytes, sizeof(bytes)) == 0);
+		file.close();
+		CHECK(file.isOpen() == false);
+		CHECK(file.getData() == nullptr);
+		CHECK(file.open("Missing.bin") == false);
+	}
+}
+
+int main() {
+	_testLayout();
+	_testRoundTrip();
+	_testInvalidFiles();
+	_testMappedFile();
+	return Test::finish("CookedTextureTest");
+}
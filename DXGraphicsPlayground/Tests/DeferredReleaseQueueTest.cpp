@@ -0,0 +1,139 @@
+#include "DeferredReleaseQueue.h"
+#include "TestCommon.h"
+#include <memory>
+#include <string>
+
+namespace {
+	// Stands in for ID3D12Fence : GPU completes submissions when test says so
+	struct FakeFence {
+		uint64_t nextValue = 1;
+		uint64_t completedValue = 0;
+
+		uint64_t signal() { return nextValue++; }
+		void complete(uint64_t value) { completedValue = value; }
+	};
+
+	// Counts live instances, like a resource that GPU may still read
+	struct Resource {
+		static int liveCount;
+		Resource() { liveCount++; }
+		~Resource() { liveCount--; }
+	};
+	int Resource::liveCount = 0;
+
+	void _testInOrderTagging() {
+		FakeFence fence;
+		DeferredReleaseQueue queue;
+		std::string released;
+		queue.retire([&released]() { released += "a"; });
+		queue.retire([&released]() { released += "b"; });
+		const uint64_t frame1 = fence.signal();
+		queue.finishSubmission(frame1);
+		queue.retire([&released]() { released += "c"; });
+		const uint64_t frame2 = fence.signal();
+		queue.finishSubmission(frame2);
+		queue.retire([&released]() { released += "d"; });
+		CHECK(queue.getPendingCount() == 4);
+
+		queue.reclaim(fence.completedValue);
+		CHECK(released.empty());
+
+		// objects are released in retire order, once their submission completes
+		fence.complete(frame1);
+		queue.reclaim(fence.completedValue);
+		CHECK(released == "ab");
+		fence.complete(frame2);
+		queue.reclaim(fence.completedValue);
+		CHECK(released == "abc");
+
+		// untagged object isn't released however far fence is
+		queue.reclaim(~0ull);
+		CHECK(released == "abc");
+		CHECK(queue.getPendingCount() == 1);
+
+		// later submission tags only untagged entries
+		const uint64_t frame3 = fence.signal();
+		queue.finishSubmission(frame3);
+		fence.complete(frame3);
+		queue.reclaim(fence.completedValue);
+		CHECK(released == "abcd");
+		CHECK(queue.getPendingCount() == 0);
+	}
+
+	void _testRetireObject() {
+		FakeFence fence;
+		DeferredReleaseQueue queue;
+		std::unique_ptr<Resource> resource(new Resource());
+		std::shared_ptr<Resource> shared = std::make_shared<Resource>();
+		queue.retireObject(std::move(resource));
+		queue.retireObject(shared);
+		shared.reset();
+		CHECK(Resource::liveCount == 2);
+
+		const uint64_t fenceValue = fence.signal();
+		queue.finishSubmission(fenceValue);
+		queue.reclaim(fence.completedValue);
+		CHECK(Resource::liveCount == 2);
+		fence.complete(fenceValue);
+		queue.reclaim(fence.completedValue);
+		CHECK(Resource::liveCount == 0);
+	}
+
+	void _testRetireInsideRelease() {
+		// e.g. releasing a heap retires descriptors that point to it
+		FakeFence fence;
+		DeferredReleaseQueue queue;
+		std::string released;
+		queue.retire([&queue, &released]() {
+			released += "outer";
+			queue.retire([&released]() { released += " inner"; });
+		});
+		const uint64_t frame1 = fence.signal();
+		queue.finishSubmission(frame1);
+		fence.complete(frame1);
+		queue.reclaim(fence.completedValue);
+
+		// object retired during release waits for next submission
+		CHECK(released == "outer");
+		CHECK(queue.getPendingCount() == 1);
+		const uint64_t frame2 = fence.signal();
+		queue.finishSubmission(frame2);
+		fence.complete(frame2);
+		queue.reclaim(fence.completedValue);
+		CHECK(released == "outer inner");
+		CHECK(queue.getPendingCount() == 0);
+	}
+
+	void _testReleaseAll() {
+		std::string released;
+		{
+			DeferredReleaseQueue queue;
+			queue.retire([&released]() { released += "a"; });
+			queue.finishSubmission(1);
+			queue.retire([&queue, &released]() {
+				released += "b";
+				queue.retire([&released]() { released += "c"; });
+			});
+
+			// tagged, untagged and newly retired objects are all released
+			queue.releaseAll();
+			CHECK(released == "abc");
+			CHECK(queue.getPendingCount() == 0);
+
+			queue.retire([&released]() { released += "d"; });
+			queue.retireObject(std::unique_ptr<Resource>(new Resource()));
+			CHECK(Resource::liveCount == 1);
+		}
+		// destructor releases remaining objects
+		CHECK(released == "abcd");
+		CHECK(Resource::liveCount == 0);
+	}
+}
+
+int main() {
+	_testInOrderTagging();
+	_testRetireObject();
+	_testRetireInsideRelease();
+	_testReleaseAll();
+	return Test::finish("DeferredReleaseQueueTest");
+}
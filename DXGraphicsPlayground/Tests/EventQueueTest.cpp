@@ -0,0 +1,64 @@
+#include "EventQueue.h"
+#include "TestCommon.h"
+#include <thread>
+
+namespace {
+	void _testFullAndEmpty() {
+		EventQueue<uint32_t> queue(4);
+		CHECK(queue.getCapacity() == 4);
+
+		uint32_t value = 0;
+		CHECK(queue.tryPop(value) == false);
+		for (uint32_t i = 0; i < 4; i++)
+			CHECK(queue.tryPush(i));
+		CHECK(queue.tryPush(4) == false);
+
+		// wraps around after slots are freed
+		for (uint32_t round = 0; round < 10; round++) {
+			CHECK(queue.tryPop(value));
+			CHECK(value == round);
+			CHECK(queue.tryPush(round + 4));
+			CHECK(queue.tryPush(round + 5) == false);
+		}
+		for (uint32_t i = 10; i < 14; i++) {
+			CHECK(queue.tryPop(value));
+			CHECK(value == i);
+		}
+		CHECK(queue.tryPop(value) == false);
+	}
+
+	void _testProducerConsumer() {
+		// many times capacity, so indices wrap while both threads run
+		const uint32_t count = 200000;
+		EventQueue<uint32_t> queue(256);
+
+		std::thread producer([&queue, count]() {
+			for (uint32_t i = 0; i < count; i++) {
+				while (queue.tryPush(i) == false)
+					std::this_thread::yield();
+			}
+		});
+
+		uint32_t expected = 0;
+		uint32_t value = 0;
+		bool isOrdered = true;
+		while (expected < count) {
+			if (queue.tryPop(value) == false) {
+				std::this_thread::yield();
+				continue;
+			}
+			isOrdered = isOrdered && value == expected;
+			expected++;
+		}
+		producer.join();
+
+		CHECK(isOrdered);
+		CHECK(queue.tryPop(value) == false);
+	}
+}
+
+int main() {
+	_testFullAndEmpty();
+	_testProducerConsumer();
+	return Test::finish("EventQueueTest");
+}
@@ -0,0 +1,143 @@
+#include "FramePacer.h"
+#include "TestCommon.h"
+#include <cmath>
+#include <deque>
+
+namespace {
+	bool _near(double a, double b) {
+		return std::fabs(a - b) < 1e-5;
+	}
+
+	void _testTransitions() {
+		FramePacer pacer;
+		CHECK(pacer.getState() == FramePacer::State::Idle);
+		CHECK(pacer.present(0.0) == false);
+		CHECK(pacer.beginFrame(0.0));
+		CHECK(pacer.getState() == FramePacer::State::Recording);
+		CHECK(pacer.beginFrame(1.0) == false);
+		CHECK(pacer.beginWait(1.0) == false);
+		CHECK(pacer.present(1.0));
+		CHECK(pacer.getState() == FramePacer::State::Idle);
+		CHECK(pacer.getStats().frameCount == 1);
+
+		CHECK(pacer.beginWait(2.0));
+		CHECK(pacer.getState() == FramePacer::State::Waiting);
+		CHECK(pacer.beginWait(2.0) == false);
+		CHECK(pacer.present(2.0) == false);
+		CHECK(pacer.beginFrame(2.5));
+		CHECK(_near(pacer.getStats().averageWaitTime, 0.05));	// averaged with first frame's 0
+
+		// cancelled frame isn't counted
+		pacer.cancel();
+		CHECK(pacer.getState() == FramePacer::State::Idle);
+		CHECK(pacer.getStats().frameCount == 1);
+
+		pacer.resetStats();
+		CHECK(pacer.getStats().frameCount == 0);
+		CHECK(pacer.getStats().averageFrameInterval == 0.0);
+
+		FramePacer zeroLatency(FramePacingMode::LowLatency, 0);
+		CHECK(zeroLatency.getMaxFrameLatency() == 1);
+		CHECK(zeroLatency.waitsAtFrameStart());
+		CHECK(pacer.waitsAtFrameStart() == false);
+	}
+
+	struct SimulationResult {
+		FramePacingStats stats;
+		double averageDisplayLatency;	// CPU start of frame to vsync it's shown on
+	};
+
+	// Simulated clock : 60 Hz vsync, 3 ms CPU and 5 ms GPU per frame, 600 frames (first 60 are warm-up).
+	// Throughput mode blocks in Present when 3 frames are queued (swap chain limit),
+	// low latency mode blocks at frame start until fewer than max frame latency frames are queued.
+	SimulationResult _simulate(FramePacingMode mode, uint32_t maxFrameLatency) {
+		const double kVsyncInterval = 1.0 / 60.0, kCPUTime = 0.003, kGPUTime = 0.005;
+		const int kFrameCount = 600, kWarmUpFrameCount = 60;
+
+		struct QueuedFrame {
+			double readyTime;
+			double startTime;
+		};
+		std::deque<QueuedFrame> queue;
+		FramePacer pacer(mode, maxFrameLatency);
+		double time = 0.0, gpuFreeTime = 0.0, nextVsync = kVsyncInterval, displayLatencySum = 0.0;
+		int shownCount = 0;
+		auto advanceDisplay = [&](double until) {
+			for (; nextVsync <= until; nextVsync += kVsyncInterval) {
+				if (queue.empty() || queue.front().readyTime > nextVsync)
+					continue;
+				if (shownCount >= kWarmUpFrameCount)
+					displayLatencySum += nextVsync - queue.front().startTime;
+				shownCount++;
+				queue.pop_front();
+			}
+		};
+
+		const size_t queueLimit = mode == FramePacingMode::LowLatency ? maxFrameLatency : 3;
+		bool transitionsValid = true;
+		for (int frame = 0; frame < kFrameCount; frame++) {
+			if (pacer.waitsAtFrameStart()) {
+				transitionsValid &= pacer.beginWait(time);
+				while (queue.size() >= queueLimit) {
+					time = nextVsync;
+					advanceDisplay(time);
+				}
+			}
+			transitionsValid &= pacer.beginFrame(time);
+			const double startTime = time;
+			time += kCPUTime;
+			advanceDisplay(time);
+
+			while (queue.size() >= queueLimit) {
+				time = nextVsync;
+				advanceDisplay(time);
+			}
+			const double readyTime = (gpuFreeTime > time ? gpuFreeTime : time) + kGPUTime;
+			gpuFreeTime = readyTime;
+			queue.push_back({ readyTime, startTime });
+			transitionsValid &= pacer.present(time);
+
+			if (frame == kWarmUpFrameCount - 1)
+				pacer.resetStats();
+		}
+		CHECK(transitionsValid);
+
+		SimulationResult result;
+		result.stats = pacer.getStats();
+		result.averageDisplayLatency = displayLatencySum / (shownCount - kWarmUpFrameCount);
+		return result;
+	}
+
+	void _testSimulatedClock() {
+		const double kVsyncInterval = 1.0 / 60.0;
+
+		// queued frames add a vsync each : start->display is 4 vsyncs
+		const SimulationResult throughput = _simulate(FramePacingMode::Throughput, 1);
+		CHECK(throughput.stats.frameCount == 540);
+		CHECK(_near(throughput.stats.averageLatency, kVsyncInterval));
+		CHECK(_near(throughput.stats.averageWaitTime, 0.0));
+		CHECK(_near(throughput.stats.averageFrameInterval, kVsyncInterval));
+		CHECK(_near(throughput.averageDisplayLatency, kVsyncInterval * 4));
+
+		// waiting at frame start moves the vsync wait before input is sampled
+		const SimulationResult lowLatency1 = _simulate(FramePacingMode::LowLatency, 1);
+		CHECK(_near(lowLatency1.stats.averageLatency, 0.003));
+		CHECK(_near(lowLatency1.stats.minLatency, 0.003) && _near(lowLatency1.stats.maxLatency, 0.003));
+		CHECK(_near(lowLatency1.stats.averageWaitTime, kVsyncInterval - 0.003));
+		CHECK(_near(lowLatency1.stats.averageFrameInterval, kVsyncInterval));
+		CHECK(_near(lowLatency1.averageDisplayLatency, kVsyncInterval));
+
+		const SimulationResult lowLatency2 = _simulate(FramePacingMode::LowLatency, 2);
+		CHECK(_near(lowLatency2.stats.averageLatency, 0.003));
+		CHECK(_near(lowLatency2.averageDisplayLatency, kVsyncInterval * 2));
+
+		std::printf("start->display : throughput %.1f ms, low latency (max 1) %.1f ms, low latency (max 2) %.1f ms\n",
+			throughput.averageDisplayLatency * 1000.0, lowLatency1.averageDisplayLatency * 1000.0, lowLatency2.averageDisplayLatency * 1000.0);
+	}
+}
+
+int main() {
+	_testTransitions();
+	_testSimulatedClock();
+	return Test::finish("FramePacerTest");
+}
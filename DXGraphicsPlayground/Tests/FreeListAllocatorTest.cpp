@@ -0,0 +1,124 @@
+#include "FreeListAllocator.h"
+#include "RingAllocator.h"
+#include "TestCommon.h"
+#include <vector>
+
+namespace {
+	void _testFirstFit() {
+		FreeListAllocator allocator(100);
+		CHECK(allocator.allocate(0) == FreeListAllocator::kInvalidOffset);
+		CHECK(allocator.allocate(101) == FreeListAllocator::kInvalidOffset);
+		CHECK(allocator.allocate(10) == 0);
+		CHECK(allocator.allocate(20) == 10);
+		CHECK(allocator.allocate(70) == 30);
+		CHECK(allocator.getUsedSize() == 100);
+		CHECK(allocator.getFreeRangeCount() == 0);
+		CHECK(allocator.allocate(1) == FreeListAllocator::kInvalidOffset);
+
+		// first free range which fits is used, even if later one fits better
+		allocator.free(0, 10);
+		allocator.free(30, 5);
+		CHECK(allocator.allocate(5) == 0);
+		CHECK(allocator.allocate(5) == 5);
+		CHECK(allocator.allocate(5) == 30);
+	}
+
+	void _testFragmentationAndCoalescing() {
+		FreeListAllocator allocator(64);
+		std::vector<uint64_t> offsets;
+		for (int i = 0; i < 8; i++)
+			offsets.push_back(allocator.allocate(8));
+
+		// free every other range : half of capacity is free, but fragmented
+		for (size_t i = 0; i < offsets.size(); i += 2)
+			allocator.free(offsets[i], 8);
+		CHECK(allocator.getUsedSize() == 32);
+		CHECK(allocator.getFreeRangeCount() == 4);
+		CHECK(allocator.getLargestFreeRange() == 8);
+		CHECK(allocator.allocate(16) == FreeListAllocator::kInvalidOffset);
+
+		// freeing range between two free ranges merges all three
+		allocator.free(offsets[1], 8);
+		CHECK(allocator.getFreeRangeCount() == 3);
+		CHECK(allocator.getLargestFreeRange() == 24);
+		CHECK(allocator.allocate(16) == 0);
+		allocator.free(0, 16);
+
+		// merge with previous range only, next range only
+		allocator.free(offsets[3], 8);
+		CHECK(allocator.getFreeRangeCount() == 2);
+		CHECK(allocator.getLargestFreeRange() == 40);
+		allocator.free(offsets[7], 8);
+		CHECK(allocator.getFreeRangeCount() == 2);
+		allocator.free(offsets[5], 8);
+
+		// everything is merged back to one range
+		CHECK(allocator.getUsedSize() == 0);
+		CHECK(allocator.getFreeRangeCount() == 1);
+		CHECK(allocator.getLargestFreeRange() == 64);
+		CHECK(allocator.allocate(64) == 0);
+	}
+
+	void _testReset() {
+		FreeListAllocator allocator(32);
+		allocator.allocate(4);
+		allocator.allocate(4);
+		allocator.free(0, 4);
+		allocator.reset();
+		CHECK(allocator.getUsedSize() == 0);
+		CHECK(allocator.getFreeRangeCount() == 1);
+		CHECK(allocator.getLargestFreeRange() == 32);
+	}
+
+	// Same layout as DescriptorAllocator's shader-visible heap :
+	// persistent region (free-list) followed by transient region (per-frame ring reclaimed by fence)
+	void _testDescriptorTransientRegion() {
+		const uint64_t kPersistentCount = 64;
+		const uint64_t kTransientCount = 48;
+		const int kFramesInFlight = 2;
+		FreeListAllocator persistent(kPersistentCount);
+		RingAllocator transient(kTransientCount);
+
+		const uint64_t textureDescriptors = persistent.allocate(16);
+		CHECK(textureDescriptors == 0);
+
+		uint64_t frameFenceValues[kFramesInFlight] = {};
+		uint64_t nextFenceValue = 1, completedFenceValue = 0;
+		for (int frame = 0; frame < 100; frame++) {
+			// wait for frame which used this slot, like RendererD3D12 does before recording
+			const int slot = frame % kFramesInFlight;
+			if (frameFenceValues[slot] > completedFenceValue)
+				completedFenceValue = frameFenceValues[slot];
+			transient.reclaim(completedFenceValue);
+
+			// each frame's tables are contiguous and stay in transient region
+			for (int table = 0; table < 3; table++) {
+				const uint64_t index = transient.allocate(7);
+				CHECK(index != RingAllocator::kInvalidOffset);
+				CHECK(index + 7 <= kTransientCount);
+			}
+			frameFenceValues[slot] = nextFenceValue++;
+			transient.finishSubmission(frameFenceValues[slot]);
+			CHECK(transient.getUsedSize() <= kTransientCount);
+		}
+
+		// without GPU progress, ring fills up and allocation fails instead of overwriting descriptors in flight
+		int allocated = 0;
+		while (transient.allocate(7) != RingAllocator::kInvalidOffset)
+			allocated++;
+		CHECK(allocated < 3);
+
+		// persistent descriptors are untouched by transient traffic
+		persistent.free(textureDescriptors, 16);
+		CHECK(persistent.getUsedSize() == 0);
+		CHECK(persistent.getLargestFreeRange() == kPersistentCount);
+	}
+}
+
+int main() {
+	_testFirstFit();
+	_testFragmentationAndCoalescing();
+	_testReset();
+	_testDescriptorTransientRegion();
+	return Test::finish("FreeListAllocatorTest");
+}
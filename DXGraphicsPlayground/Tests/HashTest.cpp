@@ -0,0 +1,55 @@
+#include "Hash.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <set>
+#include <vector>
+
+namespace {
+	void _testReferenceVectors() {
+		// XXH64() of reference implementation with seed 0
+		CHECK(Hash::xxHash64("", 0) == 0xEF46DB3751D8E999ull);
+		CHECK(Hash::xxHash64("a", 1) == 0xD24EC4F1A98C6E5Bull);
+		CHECK(Hash::xxHash64("abc", 3) == 0x44BC2CF5AD770999ull);
+		const char* fox = "The quick brown fox jumps over the lazy dog";
+		CHECK(Hash::xxHash64(fox, strlen(fox)) == 0x0B242D361FDA71BCull);
+	}
+
+	void _testSeedAndLength() {
+		// seed changes result
+		CHECK(Hash::xxHash64("abc", 3, 1) != Hash::xxHash64("abc", 3, 0));
+
+		// every length covers different tail paths (8, 4, 1 bytes) and 32-byte stripes
+		std::vector<uint8_t> data(300);
+		for (size_t i = 0; i < data.size(); i++)
+			data[i] = static_cast<uint8_t>(i * 31 + 7);
+		std::set<uint64_t> hashes;
+		for (size_t size = 0; size <= data.size(); size++)
+			hashes.insert(Hash::xxHash64(data.data(), size));
+		CHECK(hashes.size() == data.size() + 1);
+
+		// single bit flip anywhere changes hash
+		const uint64_t hash = Hash::xxHash64(data.data(), data.size());
+		bool changed = true;
+		for (size_t i = 0; i < data.size(); i += 13) {
+			data[i] ^= 0x10;
+			changed &= Hash::xxHash64(data.data(), data.size()) != hash;
+			data[i] ^= 0x10;
+		}
+		CHECK(changed);
+	}
+
+	void _testUnalignedInput() {
+		std::vector<uint8_t> buffer(1024 + 8);
+		for (size_t i = 0; i < buffer.size(); i++)
+			buffer[i] = static_cast<uint8_t>(i ^ (i >> 3));
+		std::vector<uint8_t> aligned(buffer.begin() + 3, buffer.begin() + 3 + 1024);
+		CHECK(Hash::xxHash64(buffer.data() + 3, 1024) == Hash::xxHash64(aligned.data(), aligned.size()));
+	}
+}
+
+int main() {
+	_testReferenceVectors();
+	_testSeedAndLength();
+	_testUnalignedInput();
+	return Test::finish("HashTest");
+}
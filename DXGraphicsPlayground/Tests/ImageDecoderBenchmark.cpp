@@ -0,0 +1,117 @@
+#include "ImageDecoder.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace {
+	bool _isImage(const std::string& name) {
+		const char* const extensions[] = { ".jpg", ".jpeg", ".png", ".tga", ".bmp" };
+		for (const char* extension : extensions) {
+			const size_t length = strlen(extension);
+			if (name.size() > length && name.compare(name.size() - length, length, extension) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	void _listImages(const std::string& directory, std::vector<std::string>& paths) {
+#if defined(_WIN32)
+		WIN32_FIND_DATAA findData{};
+		HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &findData);
+		if (find == INVALID_HANDLE_VALUE)
+			return;
+		do {
+			if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0 && _isImage(findData.cFileName))
+				paths.push_back(directory + "\\" + findData.cFileName);
+		} while (FindNextFileA(find, &findData) != FALSE);
+		FindClose(find);
+#else
+		DIR* dir = opendir(directory.c_str());
+		if (dir == nullptr)
+			return;
+		while (dirent* entry = readdir(dir)) {
+			if (_isImage(entry->d_name))
+				paths.push_back(directory + "/" + entry->d_name);
+		}
+		closedir(dir);
+#endif
+	}
+}
+
+// Decoding throughput of worker pool by thread count, as renderers decode images at startup (RGBA8 into mip chain level 0).
+// Encoded files are read into memory first, so only decoding is measured.
+//   ImageDecoderBenchmark [directory] [max thread count]
+int main(int argc, char** argv) {
+	std::vector<std::string> paths;
+	if (argc > 1) {
+		_listImages(argv[1], paths);
+	}
+	else {
+		_listImages(REPOSITORY_DIR "/DXGraphicsPlayground/Assets/Textures", paths);
+		_listImages(REPOSITORY_DIR "/Screenshots", paths);
+	}
+	uint32_t maxThreadCount = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : std::thread::hardware_concurrency();
+	maxThreadCount = maxThreadCount > 0 ? maxThreadCount : 1;
+	if (paths.empty()) {
+		std::fprintf(stderr, "No images found\n");
+		return 1;
+	}
+
+	std::vector<std::vector<unsigned char>> files;
+	size_t encodedSize = 0;
+	for (const std::string& path : paths) {
+		std::ifstream stream(path, std::ios::binary);
+		files.emplace_back((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		encodedSize += files.back().size();
+	}
+
+	// enough jobs to keep every worker busy
+	const uint32_t kMinJobCount = 32;
+	const uint32_t repeatCount = (kMinJobCount + static_cast<uint32_t>(files.size()) - 1) / static_cast<uint32_t>(files.size());
+	const int kPassCount = 3;
+	std::printf("ImageDecoder : %zu images (%.1f MB encoded), each decoded %u times per pass, best of %d passes\n",
+		files.size(), encodedSize / (1024.0 * 1024.0), repeatCount, kPassCount);
+
+	double singleThreadTime = 0.0;
+	for (uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount++) {
+		ImageDecoder decoder(threadCount);
+		double bestTime = 1e9;
+		size_t decodedSize = 0, failures = 0;
+		for (int pass = 0; pass < kPassCount; pass++) {
+			decodedSize = 0;
+			const double beginTime = Test::getTime();
+			for (uint32_t repeat = 0; repeat < repeatCount; repeat++) {
+				for (size_t i = 0; i < files.size(); i++)
+					decoder.decode(std::vector<unsigned char>(files[i]), paths[i], 4, true, DecodeTarget::MipChain);
+			}
+			decoder.waitAll();
+			const double elapsed = Test::getTime() - beginTime;
+			bestTime = elapsed < bestTime ? elapsed : bestTime;
+
+			DecodedImage image;
+			while (decoder.tryPop(image)) {
+				if (image.isValid())
+					decodedSize += image.getSize();
+				else
+					failures++;
+			}
+		}
+		singleThreadTime = threadCount == 1 ? bestTime : singleThreadTime;
+
+		const double imageCount = static_cast<double>(files.size()) * repeatCount;
+		std::printf("%2u threads : %7.1f images/s, %7.1f MB/s encoded, %7.1f MB/s decoded, %.2fx of 1 thread%s\n",
+			threadCount, imageCount / bestTime, encodedSize * repeatCount / bestTime / (1024.0 * 1024.0),
+			decodedSize / bestTime / (1024.0 * 1024.0), singleThreadTime / bestTime, failures > 0 ? " (some images failed)" : "");
+	}
+	return 0;
+}
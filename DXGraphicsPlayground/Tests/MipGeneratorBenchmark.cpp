@@ -0,0 +1,45 @@
+#include "MipGenerator.h"
+#include "TestCommon.h"
+#include <vector>
+
+// Full mip chain from 2048x2048 RGBA8_SRGB, per filter and instruction set (one core), and with all cores.
+int main() {
+	const uint32_t kSize = 2048;
+	const int kIterationCount = 3;
+	std::vector<uint8_t> pixels(kSize * kSize * 4);
+	uint32_t random = 12345;
+	for (uint8_t& value : pixels) {
+		random = random * 1664525u + 1013904223u;
+		value = static_cast<uint8_t>(random >> 24);
+	}
+
+	const MipFilter filters[] = { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos };
+	const MipGeneratorPath paths[] = { MipGeneratorPath::Scalar, MipGeneratorPath::SSE2, MipGeneratorPath::AVX };
+	std::printf("MipGenerator : %ux%u RGBA8_SRGB full chain, best of %d, best path %s\n",
+		kSize, kSize, kIterationCount, MipGenerator::getPathName(MipGenerator::getBestPath()));
+	for (MipFilter filter : filters) {
+		std::printf("%-8s", MipGenerator::getFilterName(filter));
+		for (int p = 0; p <= 3; p++) {
+			// last column uses best path on all cores
+			MipGenerator generator(p < 3 ? 1 : 0);
+			generator.setPath(p < 3 ? paths[p] : MipGenerator::getBestPath());
+			if (p < 3 && generator.getPath() != paths[p])
+				continue;
+
+			MipChain chain;
+			double bestTime = 1e9;
+			for (int i = 0; i < kIterationCount; i++) {
+				const double beginTime = Test::getTime();
+				generator.generate(pixels.data(), kSize, kSize, kSize * 4, MipFormat::RGBA8_SRGB, filter, chain);
+				const double elapsed = Test::getTime() - beginTime;
+				bestTime = elapsed < bestTime ? elapsed : bestTime;
+			}
+			if (p < 3)
+				std::printf(" %s %.1f ms", MipGenerator::getPathName(paths[p]), bestTime * 1000.0);
+			else
+				std::printf(" | %u threads %.1f ms", generator.getThreadCount(), bestTime * 1000.0);
+		}
+		std::printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,193 @@
+#include "MipGenerator.h"
+#include "TestCommon.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+	const MipFilter kFilters[] = { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos };
+
+	std::vector<uint8_t> _makeNoise(uint32_t width, uint32_t height, size_t pixelSize) {
+		std::vector<uint8_t> pixels(width * height * pixelSize);
+		uint32_t random = 12345;
+		for (uint8_t& value : pixels) {
+			random = random * 1664525u + 1013904223u;
+			value = static_cast<uint8_t>(random >> 24);
+		}
+		return pixels;
+	}
+
+	int _maxDifference(const MipChain& a, const MipChain& b) {
+		if (a.data.size() != b.data.size())
+			return 256;
+		int maxDifference = 0;
+		for (size_t i = 0; i < a.data.size(); i++) {
+			const int difference = std::abs(static_cast<int>(a.data[i]) - static_cast<int>(b.data[i]));
+			maxDifference = difference > maxDifference ? difference : maxDifference;
+		}
+		return maxDifference;
+	}
+
+	void _testLevelLayout() {
+		CHECK(MipGenerator::getMipCount(1, 1) == 1);
+		CHECK(MipGenerator::getMipCount(2048, 2048) == 12);
+		CHECK(MipGenerator::getMipCount(100, 3) == 7);
+
+		MipChain chain;
+		MipGenerator::reserve(100, 3, MipFormat::RGBA8, chain);
+		CHECK(chain.getLevelCount() == 7);
+		CHECK(chain.levels[1].width == 50 && chain.levels[1].height == 1);
+		CHECK(chain.levels[2].width == 25 && chain.levels[2].height == 1);
+		CHECK(chain.levels[6].width == 1 && chain.levels[6].height == 1);
+		size_t offset = 0;
+		for (const MipLevel& level : chain.levels) {
+			CHECK(level.offset == offset);
+			CHECK(level.rowPitch == level.width * 4);
+			CHECK(level.size == level.rowPitch * level.height);
+			offset += level.size;
+		}
+		CHECK(chain.data.size() == offset);
+
+		MipGenerator::reserve(100, 3, MipFormat::R8, chain, 2);
+		CHECK(chain.getLevelCount() == 2);
+	}
+
+	void _testBoxNonPowerOfTwo() {
+		MipGenerator generator(1);
+		generator.setPath(MipGeneratorPath::Scalar);
+		MipChain chain;
+
+		// 3 -> 1 averages all covered pixels
+		const uint8_t row3[] = { 30, 60, 90 };
+		generator.generate(row3, 3, 1, 3, MipFormat::R8, MipFilter::Box, chain);
+		CHECK(chain.getLevelCount() == 2);
+		CHECK(chain.getLevelData(1)[0] == 60);
+
+		// 5 -> 2 : each destination pixel covers 2.5 source pixels, the middle one is shared by half
+		const uint8_t row5[] = { 0, 100, 200, 40, 80 };
+		generator.generate(row5, 5, 1, 5, MipFormat::R8, MipFilter::Box, chain, 2);
+		CHECK(chain.levels[1].width == 2);
+		CHECK(chain.getLevelData(1)[0] == 80);	// (0 + 100 + 200 * 0.5) / 2.5
+		CHECK(chain.getLevelData(1)[1] == 88);	// (200 * 0.5 + 40 + 80) / 2.5
+
+		// 6x4 -> 3x2 is plain 2x2 average, row pitch of source may be padded
+		std::vector<uint8_t> image(8 * 4, 0xCD);
+		for (uint32_t y = 0; y < 4; y++)
+			for (uint32_t x = 0; x < 6; x++)
+				image[y * 8 + x] = static_cast<uint8_t>(x * 40 + y * 4);
+		generator.generate(image.data(), 6, 4, 8, MipFormat::R8, MipFilter::Box, chain);
+		CHECK(chain.getLevelCount() == 3);
+		CHECK(chain.levels[1].width == 3 && chain.levels[1].height == 2);
+		bool averaged = true;
+		for (uint32_t y = 0; y < 2; y++)
+			for (uint32_t x = 0; x < 3; x++)
+				averaged &= chain.getLevelData(1)[y * 3 + x] == static_cast<uint8_t>(x * 80 + 20 + y * 8 + 2);
+		CHECK(averaged);
+		CHECK(chain.levels[2].width == 1 && chain.levels[2].height == 1);
+
+		// constant image stays constant for every filter and odd sizes
+		std::vector<uint8_t> constant(37 * 23 * 4, 77);
+		for (MipFilter filter : kFilters) {
+			generator.generate(constant.data(), 37, 23, 37 * 4, MipFormat::RGBA8, filter, chain);
+			bool isConstant = true;
+			for (uint8_t value : chain.data)
+				isConstant &= value == 77;
+			CHECK(isConstant);
+		}
+	}
+
+	void _testSRGBDownsample() {
+		// black and white checker : linear average is 0.5, which is 188 in sRGB (not 128)
+		std::vector<uint8_t> checker(16 * 16 * 4);
+		for (uint32_t y = 0; y < 16; y++)
+			for (uint32_t x = 0; x < 16; x++)
+				for (uint32_t c = 0; c < 4; c++)
+					checker[(y * 16 + x) * 4 + c] = ((x + y) & 1) ? 255 : 0;
+
+		MipGenerator generator(1);
+		MipChain chain;
+		generator.generate(checker.data(), 16, 16, 16 * 4, MipFormat::RGBA8_SRGB, MipFilter::Box, chain);
+		const uint8_t* level1 = chain.getLevelData(1);
+		CHECK(level1[0] == 188 && level1[1] == 188 && level1[2] == 188);
+		CHECK(level1[3] == 128);	// alpha is filtered linearly
+		const uint8_t* last = chain.getLevelData(chain.getLevelCount() - 1);
+		CHECK(last[0] == 188 && last[3] == 128);
+
+		generator.generate(checker.data(), 16, 16, 16 * 4, MipFormat::RGBA8, MipFilter::Box, chain);
+		CHECK(chain.getLevelData(1)[0] == 128);
+
+		// sRGB endpoints are preserved
+		std::vector<uint8_t> ramp(256 * 4);
+		for (uint32_t x = 0; x < 256; x++)
+			for (uint32_t c = 0; c < 4; c++)
+				ramp[x * 4 + c] = static_cast<uint8_t>(x);
+		generator.generate(ramp.data(), 1, 256, 4, MipFormat::RGBA8_SRGB, MipFilter::Box, chain, 1);
+		CHECK(std::memcmp(chain.getLevelData(0), ramp.data(), ramp.size()) == 0);
+	}
+
+	void _testHalfFloat() {
+		// 1.5 in half precision
+		const uint16_t kOneAndHalf = 0x3E00;
+		std::vector<uint16_t> pixels(9 * 7 * 4, kOneAndHalf);
+		MipGenerator generator(1);
+		MipChain chain;
+		generator.generate(pixels.data(), 9, 7, 9 * 8, MipFormat::RGBA16F, MipFilter::Kaiser, chain);
+		CHECK(chain.getLevelCount() == 4);
+		bool isConstant = true;
+		for (size_t i = 0; i + 1 < chain.data.size(); i += 2) {
+			uint16_t value;
+			std::memcpy(&value, &chain.data[i], sizeof(value));
+			isConstant &= value == kOneAndHalf;
+		}
+		CHECK(isConstant);
+	}
+
+	void _testPathsAndThreads() {
+		const uint32_t width = 301, height = 257;
+		const std::vector<uint8_t> pixels = _makeNoise(width, height, 4);
+		const MipFormat formats[] = { MipFormat::R8, MipFormat::RGBA8, MipFormat::RGBA8_SRGB };
+		for (MipFormat format : formats) {
+			for (MipFilter filter : kFilters) {
+				MipGenerator scalarGenerator(1);
+				scalarGenerator.setPath(MipGeneratorPath::Scalar);
+				MipChain reference;
+				scalarGenerator.generate(pixels.data(), width, height, width * MipGenerator::getPixelSize(format), format, filter, reference);
+
+				// SIMD paths may round differently by 1 LSB
+				MipGenerator simdGenerator(1);
+				MipChain simd;
+				simdGenerator.generate(pixels.data(), width, height, width * MipGenerator::getPixelSize(format), format, filter, simd);
+				CHECK(_maxDifference(reference, simd) <= 1);
+
+				// splitting rows across threads gives identical output
+				MipGenerator threadedGenerator(4);
+				MipChain threaded;
+				threadedGenerator.generate(pixels.data(), width, height, width * MipGenerator::getPixelSize(format), format, filter, threaded);
+				CHECK(_maxDifference(simd, threaded) == 0);
+			}
+		}
+	}
+
+	void _testGenerateLevels() {
+		const std::vector<uint8_t> pixels = _makeNoise(64, 48, 4);
+		MipGenerator generator(1);
+		MipChain generated, inPlace;
+		generator.generate(pixels.data(), 64, 48, 64 * 4, MipFormat::RGBA8_SRGB, MipFilter::Lanczos, generated);
+
+		MipGenerator::reserve(64, 48, MipFormat::RGBA8_SRGB, inPlace);
+		std::memcpy(inPlace.getLevelData(0), pixels.data(), pixels.size());
+		generator.generateLevels(inPlace, MipFilter::Lanczos);
+		CHECK(_maxDifference(generated, inPlace) == 0);
+	}
+}
+
+int main() {
+	_testLevelLayout();
+	_testBoxNonPowerOfTwo();
+	_testSRGBDownsample();
+	_testHalfFloat();
+	_testPathsAndThreads();
+	_testGenerateLevels();
+	return Test::finish("MipGeneratorTest");
+}
@@ -0,0 +1,43 @@
+#include "Noise.h"
+#include "TestCommon.h"
+#include <vector>
+
+// Fills 1024x1024 with 6 octaves of fBm per basis and path on one core, and with all cores.
+// Throughput is reported in pixels, and in octave samples (pixels * octaves) in parentheses.
+int main() {
+	const uint32_t kSize = 1024;
+	const int kIterationCount = 3;
+	const NoiseBasis bases[] = { NoiseBasis::Value, NoiseBasis::Perlin, NoiseBasis::Simplex };
+	const NoisePath paths[] = { NoisePath::Scalar, NoisePath::SSE2 };
+	std::vector<float> values(kSize * kSize);
+
+	std::printf("Noise : %ux%u fbm, 6 octaves, best of %d (Mpixels/s)\n", kSize, kSize, kIterationCount);
+	for (NoiseBasis basis : bases) {
+		NoiseDesc desc;
+		desc.basis = basis;
+		desc.octaveCount = 6;
+		std::printf("%-8s", NoiseGenerator::getBasisName(basis));
+		for (int p = 0; p <= 2; p++) {
+			// last column uses best path on all cores
+			NoiseGenerator generator(desc, p < 2 ? 1 : 0);
+			generator.setPath(p < 2 ? paths[p] : NoiseGenerator::getBestPath());
+			if (p < 2 && generator.getPath() != paths[p])
+				continue;
+
+			double bestTime = 1e9;
+			for (int i = 0; i < kIterationCount; i++) {
+				const double beginTime = Test::getTime();
+				generator.fill(values.data(), kSize, kSize, kSize * sizeof(float));
+				const double elapsed = Test::getTime() - beginTime;
+				bestTime = elapsed < bestTime ? elapsed : bestTime;
+			}
+			const double pixelsPerSecond = kSize * kSize / bestTime / 1e6;
+			if (p < 2)
+				std::printf(" %s %.1f (%.1f)", NoiseGenerator::getPathName(paths[p]), pixelsPerSecond, pixelsPerSecond * desc.octaveCount);
+			else
+				std::printf(" | %u threads %.1f (%.1f)", generator.getThreadCount(), pixelsPerSecond, pixelsPerSecond * desc.octaveCount);
+		}
+		std::printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,125 @@
+#include "Noise.h"
+#include "TestCommon.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+	const NoiseBasis kBases[] = { NoiseBasis::Value, NoiseBasis::Perlin, NoiseBasis::Simplex };
+	const NoiseFractal kFractals[] = { NoiseFractal::Single, NoiseFractal::FBm, NoiseFractal::Ridged };
+
+	// width isn't multiple of 4, so SIMD tail is covered
+	const uint32_t kWidth = 203;
+	const uint32_t kHeight = 160;
+
+	std::vector<float> _fill(const NoiseDesc& desc, uint32_t threadCount, NoisePath path) {
+		NoiseGenerator generator(desc, threadCount);
+		generator.setPath(path);
+		std::vector<float> values(kWidth * kHeight);
+		generator.fill(values.data(), kWidth, kHeight, kWidth * sizeof(float));
+		return values;
+	}
+
+	NoiseDesc _makeDesc(NoiseBasis basis, NoiseFractal fractal) {
+		NoiseDesc desc;
+		desc.basis = basis;
+		desc.fractal = fractal;
+		desc.seed = 1234;
+		desc.octaveCount = 6;
+		return desc;
+	}
+
+	void _testDeterminismAcrossThreadCounts() {
+		const uint32_t threadCounts[] = { 2, 3, 8 };
+		for (NoiseBasis basis : kBases) {
+			for (NoiseFractal fractal : kFractals) {
+				const NoiseDesc desc = _makeDesc(basis, fractal);
+				for (NoisePath path : { NoisePath::Scalar, NoiseGenerator::getBestPath() }) {
+					const std::vector<float> reference = _fill(desc, 1, path);
+					for (uint32_t threadCount : threadCounts) {
+						const std::vector<float> values = _fill(desc, threadCount, path);
+						CHECK(std::memcmp(values.data(), reference.data(), values.size() * sizeof(float)) == 0);
+					}
+				}
+			}
+		}
+	}
+
+	void _testScalarMatchesSample() {
+		for (NoiseBasis basis : kBases) {
+			const NoiseDesc desc = _makeDesc(basis, NoiseFractal::FBm);
+			NoiseGenerator generator(desc, 1);
+			const std::vector<float> values = _fill(desc, 1, NoisePath::Scalar);
+			bool matches = true;
+			for (uint32_t y = 0; y < kHeight; y += 7)
+				for (uint32_t x = 0; x < kWidth; x += 5)
+					matches &= values[y * kWidth + x] == generator.sample((x + 0.5f) * (desc.frequency / kWidth), (y + 0.5f) * (desc.frequency / kHeight));
+			CHECK(matches);
+		}
+	}
+
+	void _testSIMDMatchesScalar() {
+		for (NoiseBasis basis : kBases) {
+			for (NoiseFractal fractal : kFractals) {
+				const NoiseDesc desc = _makeDesc(basis, fractal);
+				const std::vector<float> scalar = _fill(desc, 1, NoisePath::Scalar);
+				const std::vector<float> simd = _fill(desc, 1, NoiseGenerator::getBestPath());
+				float maxDifference = 0.0f;
+				for (size_t i = 0; i < scalar.size(); i++)
+					maxDifference = fabsf(scalar[i] - simd[i]) > maxDifference ? fabsf(scalar[i] - simd[i]) : maxDifference;
+				CHECK(maxDifference < 1e-4f);
+			}
+		}
+	}
+
+	void _testRangeAndSeed() {
+		for (NoiseBasis basis : kBases) {
+			for (NoiseFractal fractal : kFractals) {
+				NoiseDesc desc = _makeDesc(basis, fractal);
+				const std::vector<float> values = _fill(desc, 1, NoiseGenerator::getBestPath());
+				float minValue = 1.0f, maxValue = 0.0f;
+				for (float value : values) {
+					minValue = value < minValue ? value : minValue;
+					maxValue = value > maxValue ? value : maxValue;
+				}
+				CHECK(minValue >= 0.0f && maxValue <= 1.0f);
+				// not flat
+				CHECK(maxValue - minValue > 0.2f);
+
+				// same seed gives same values from new generator, other seed doesn't
+				CHECK(_fill(desc, 1, NoiseGenerator::getBestPath()) == values);
+				desc.seed++;
+				CHECK(_fill(desc, 1, NoiseGenerator::getBestPath()) != values);
+			}
+		}
+	}
+
+	void _testUnorm8() {
+		const NoiseDesc desc = _makeDesc(NoiseBasis::Perlin, NoiseFractal::FBm);
+		NoiseGenerator generator(desc, 3);
+		const std::vector<float> values = _fill(desc, 1, generator.getPath());
+
+		// padded row pitch is left untouched
+		const size_t rowPitch = kWidth + 13;
+		std::vector<uint8_t> bytes(rowPitch * kHeight, 0xCD);
+		generator.fillUnorm8(bytes.data(), kWidth, kHeight, rowPitch);
+		bool matches = true, paddingKept = true;
+		for (uint32_t y = 0; y < kHeight; y++) {
+			for (uint32_t x = 0; x < kWidth; x++)
+				matches &= bytes[y * rowPitch + x] == static_cast<uint8_t>(values[y * kWidth + x] * 255.0f + 0.5f);
+			for (size_t x = kWidth; x < rowPitch; x++)
+				paddingKept &= bytes[y * rowPitch + x] == 0xCD;
+		}
+		CHECK(matches);
+		CHECK(paddingKept);
+	}
+}
+
+int main() {
+	_testDeterminismAcrossThreadCounts();
+	_testScalarMatchesSample();
+	_testSIMDMatchesScalar();
+	_testRangeAndSeed();
+	_testUnorm8();
+	return Test::finish("NoiseTest");
+}
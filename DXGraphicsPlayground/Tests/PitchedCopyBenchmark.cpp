@@ -0,0 +1,83 @@
+#include "PitchedCopy.h"
+#include "TestCommon.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Texture uploads from tightly packed source into 256-byte pitched staging memory (ordinary memory, not write-combined).
+// Per-row baseline is what ResourceUploader did before : GPUBuffer::copy for every row, which checks state and bounds per call.
+namespace {
+	struct Format {
+		const char* name;
+		uint32_t blockSize;			// texels per side of block (1 for uncompressed)
+		uint32_t bytesPerBlock;
+	};
+
+	struct FakeBuffer {
+		uint8_t* pointer;
+		size_t size;
+		bool isOpen;
+		size_t writtenBegin, writtenEnd;
+
+		void copy(const void* data, size_t length, size_t offset) {
+			if (isOpen == false)
+				return;
+			if (size < length + offset) {
+				std::fprintf(stderr, "Out of range (%zu < %zu).\n", size, length + offset);
+				return;
+			}
+			memcpy(pointer + offset, data, length);
+			writtenBegin = offset < writtenBegin ? offset : writtenBegin;
+			writtenEnd = offset + length > writtenEnd ? offset + length : writtenEnd;
+		}
+	};
+
+	const size_t kPitchAlignment = 256;		// D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+}
+
+int main() {
+	const Format formats[] = { { "R8", 1, 1 }, { "RGBA8", 1, 4 }, { "RGBA16F", 1, 8 }, { "BC1", 4, 8 }, { "BC3", 4, 16 } };
+	const uint32_t sizes[] = { 250, 1000, 4000 };	// not multiples of 256, so pitches differ
+
+	std::printf("Best path : %s\n", PitchedCopy::getPathName(PitchedCopy::getBestPath()));
+	for (uint32_t size : sizes) {
+		for (const Format& format : formats) {
+			const size_t blocksPerSide = (size + format.blockSize - 1) / format.blockSize;
+			const size_t rowSize = blocksPerSide * format.bytesPerBlock;
+			const size_t rowCount = blocksPerSide;
+			const size_t destinationPitch = (rowSize + kPitchAlignment - 1) & ~(kPitchAlignment - 1);
+			std::vector<uint8_t> source(rowSize * rowCount, 0x5A);
+			std::vector<uint8_t> destination(destinationPitch * rowCount);
+
+			// about 1 GB per measurement
+			const size_t bytes = rowSize * rowCount;
+			const int repeatCount = static_cast<int>(1024ull * 1024 * 1024 / bytes) + 1;
+
+			FakeBuffer buffer{ destination.data(), destination.size(), true, SIZE_MAX, 0 };
+			double beginTime = Test::getTime();
+			for (int repeat = 0; repeat < repeatCount; repeat++) {
+				for (size_t row = 0; row < rowCount; row++)
+					buffer.copy(source.data() + rowSize * row, rowSize, destinationPitch * row);
+			}
+			const double rowTime = (Test::getTime() - beginTime) / repeatCount;
+
+			std::printf("%4ux%-4u %-7s : per-row %7.3f ms (%5.1f GB/s)", size, size, format.name, rowTime * 1000.0, bytes / rowTime / 1e9);
+			const PitchedCopyPath paths[] = { PitchedCopyPath::Scalar, PitchedCopyPath::SSE2, PitchedCopyPath::AVX };
+			for (PitchedCopyPath path : paths) {
+				if (path == PitchedCopyPath::AVX && PitchedCopy::getBestPath() != PitchedCopyPath::AVX)
+					continue;
+				if (path == PitchedCopyPath::SSE2 && PitchedCopy::getBestPath() == PitchedCopyPath::Scalar)
+					continue;
+				PitchedRegion destinationRegion{ destination.data(), destinationPitch, destinationPitch * rowCount };
+				PitchedRegion sourceRegion{ source.data(), rowSize, rowSize * rowCount };
+				beginTime = Test::getTime();
+				for (int repeat = 0; repeat < repeatCount; repeat++)
+					PitchedCopy::copy(destinationRegion, sourceRegion, rowSize, rowCount, 1, path);
+				const double time = (Test::getTime() - beginTime) / repeatCount;
+				std::printf(", %s %7.3f ms (%5.1f GB/s)", PitchedCopy::getPathName(path), time * 1000.0, bytes / time / 1e9);
+			}
+			std::printf("\n");
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,138 @@
+#include "PitchedCopy.h"
+#include "TestCommon.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+	const uint8_t kGuard = 0xCD;
+	const size_t kGuardSize = 64;
+
+	// Paths up to the best one are supported by current CPU
+	std::vector<PitchedCopyPath> _getSupportedPaths() {
+		std::vector<PitchedCopyPath> paths = { PitchedCopyPath::Scalar };
+		const PitchedCopyPath bestPath = PitchedCopy::getBestPath();
+		if (bestPath == PitchedCopyPath::SSE2 || bestPath == PitchedCopyPath::AVX)
+			paths.push_back(PitchedCopyPath::SSE2);
+		if (bestPath == PitchedCopyPath::AVX)
+			paths.push_back(PitchedCopyPath::AVX);
+		return paths;
+	}
+
+	// Copies one region with path and compares it with naive copy of every row.
+	// Destination and source start at given misalignment, and bytes around destination region must be untouched.
+	bool _copyAndCompare(PitchedCopyPath path, size_t rowSize, size_t rowCount, size_t sliceCount,
+		size_t destinationPitch, size_t sourcePitch, size_t destinationSlicePadding, size_t sourceSlicePadding,
+		size_t destinationOffset, size_t sourceOffset, uint32_t& random) {
+		const size_t destinationSlicePitch = destinationPitch * rowCount + destinationSlicePadding;
+		const size_t sourceSlicePitch = sourcePitch * rowCount + sourceSlicePadding;
+		const size_t destinationSize = destinationSlicePitch * sliceCount;
+		const size_t sourceSize = sourceSlicePitch * sliceCount;
+
+		std::vector<uint8_t> sourceMemory(sourceOffset + sourceSize);
+		for (uint8_t& value : sourceMemory) {
+			random = random * 1664525u + 1013904223u;
+			value = static_cast<uint8_t>(random >> 24);
+		}
+		std::vector<uint8_t> destinationMemory(kGuardSize + destinationOffset + destinationSize + kGuardSize, kGuard);
+		std::vector<uint8_t> expected = destinationMemory;
+
+		uint8_t* destination = destinationMemory.data() + kGuardSize + destinationOffset;
+		const uint8_t* source = sourceMemory.data() + sourceOffset;
+		for (size_t slice = 0; slice < sliceCount; slice++) {
+			for (size_t row = 0; row < rowCount; row++) {
+				memcpy(expected.data() + kGuardSize + destinationOffset + destinationSlicePitch * slice + destinationPitch * row,
+					source + sourceSlicePitch * slice + sourcePitch * row, rowSize);
+			}
+		}
+
+		PitchedRegion destinationRegion{ destination, destinationPitch, destinationSlicePitch };
+		PitchedRegion sourceRegion{ const_cast<uint8_t*>(source), sourcePitch, sourceSlicePitch };
+		PitchedCopy::copy(destinationRegion, sourceRegion, rowSize, rowCount, sliceCount, path);
+
+		// rows of the same pitch may be copied as one span, which also copies padding between them from source
+		const bool isPaddingCopied = destinationPitch == sourcePitch && (sliceCount == 1 || destinationSlicePitch == sourceSlicePitch);
+		const size_t regionBegin = kGuardSize + destinationOffset;
+		for (size_t i = 0; i < destinationMemory.size(); i++) {
+			if (destinationMemory[i] == expected[i])
+				continue;
+			const size_t offset = i - regionBegin;
+			const bool isInRegion = i >= regionBegin && offset < destinationSize;
+			if (isInRegion == false || isPaddingCopied == false || offset >= sourceSize || destinationMemory[i] != source[offset])
+				return false;
+		}
+		return true;
+	}
+
+	void _testPaths() {
+		const size_t rowSizes[] = { 1, 15, 16, 63, 64, 65, 127, 128, 129, 333, 1024, 4100 };
+		const size_t rowCounts[] = { 1, 2, 7 };
+		const size_t pitchPaddings[] = { 0, 1, 13, 256 };
+		const size_t offsets[] = { 0, 1, 7, 31 };
+		uint32_t random = 12345;
+
+		for (PitchedCopyPath path : _getSupportedPaths()) {
+			int failureCount = 0;
+			for (size_t rowSize : rowSizes) {
+				for (size_t rowCount : rowCounts) {
+					for (size_t destinationPadding : pitchPaddings) {
+						for (size_t sourcePadding : pitchPaddings) {
+							for (size_t offset : offsets) {
+								// misaligned by different amounts, so source and destination never line up
+								const size_t sourceOffset = (offset * 3) % 32;
+								if (_copyAndCompare(path, rowSize, rowCount, 1, rowSize + destinationPadding, rowSize + sourcePadding,
+									0, 0, offset, sourceOffset, random) == false) {
+									std::fprintf(stderr, "%s : row size %zu, rows %zu, pitches %zu/%zu, offsets %zu/%zu\n", PitchedCopy::getPathName(path),
+										rowSize, rowCount, rowSize + destinationPadding, rowSize + sourcePadding, offset, sourceOffset);
+									failureCount++;
+								}
+							}
+						}
+					}
+				}
+			}
+			CHECK(failureCount == 0);
+		}
+	}
+
+	void _testSlices() {
+		const size_t rowSizes[] = { 3, 64, 100, 515 };
+		const size_t slicePaddings[] = { 0, 5, 512 };
+		uint32_t random = 6789;
+
+		for (PitchedCopyPath path : _getSupportedPaths()) {
+			int failureCount = 0;
+			for (size_t rowSize : rowSizes) {
+				for (size_t destinationSlicePadding : slicePaddings) {
+					for (size_t sourceSlicePadding : slicePaddings) {
+						// odd pitches, same pitches (contiguous slices merge into one region) and tight source
+						const size_t pitchPairs[][2] = { { rowSize + 7, rowSize + 3 }, { rowSize + 9, rowSize + 9 }, { rowSize + 256, rowSize } };
+						for (const auto& pitches : pitchPairs) {
+							if (_copyAndCompare(path, rowSize, 5, 4, pitches[0], pitches[1], destinationSlicePadding, sourceSlicePadding,
+								3, 1, random) == false) {
+								std::fprintf(stderr, "%s : row size %zu, pitches %zu/%zu, slice paddings %zu/%zu\n", PitchedCopy::getPathName(path),
+									rowSize, pitches[0], pitches[1], destinationSlicePadding, sourceSlicePadding);
+								failureCount++;
+							}
+						}
+					}
+				}
+			}
+			CHECK(failureCount == 0);
+		}
+	}
+
+	void _testPathNames() {
+		CHECK(strcmp(PitchedCopy::getPathName(PitchedCopyPath::Scalar), "Scalar") == 0);
+		CHECK(strcmp(PitchedCopy::getPathName(PitchedCopyPath::SSE2), "SSE2") == 0);
+		CHECK(strcmp(PitchedCopy::getPathName(PitchedCopyPath::AVX), "AVX") == 0);
+		CHECK(PitchedCopy::getBestPath() == PitchedCopy::getBestPath());
+	}
+}
+
+int main() {
+	_testPaths();
+	_testSlices();
+	_testPathNames();
+	return Test::finish("PitchedCopyTest");
+}
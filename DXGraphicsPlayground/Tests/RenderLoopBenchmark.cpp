@@ -0,0 +1,119 @@
+#include "RenderLoop.h"
+#include "RenderTargetBuckets.h"
+#include "TestCommon.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Window sizing drag : one size event per millisecond for 600 ms (800x600 to 1400x900), while frames are rendered.
+// Renderer costs are simulated with sleeps, as RendererD3D12::resize waits for GPU, resizes swap chain and rebuilds targets.
+namespace {
+	const double kFrameTime = 0.004;		// recording and present
+	const double kFlushTime = 0.002;		// _waitForGpu() with frames in flight
+	const double kResizeBuffersTime = 0.0005;
+	const double kRebuildTime = 0.003;		// window-sized targets and their descriptors
+	const int kEventCount = 600;
+	const double kEventInterval = 0.001;
+
+	void _wait(double seconds) {
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+	}
+
+	struct FakeRenderer : public RenderLoopDelegate {
+		bool useBuckets = true;
+		RenderTargetBuckets buckets;
+		uint32_t resizeCount = 0;
+		uint32_t rebuildCount = 0;
+		std::vector<double> frameEndTimes;
+
+		void update(float) override {}
+		void render() override {
+			_wait(kFrameTime);
+		}
+		void move(int, int) override {}
+		void resize(int newWidth, int newHeight) override {
+			resizeCount++;
+			_wait(kFlushTime + kResizeBuffersTime);
+			const bool isRebuilt = useBuckets ? buckets.update(newWidth, newHeight) : true;
+			if (isRebuilt) {
+				rebuildCount++;
+				_wait(kRebuildTime);
+			}
+		}
+		void displayDidChange() override {}
+		void beginFrame() override {}
+		void endFrame() override {
+			frameEndTimes.push_back(Test::getTime());
+		}
+	};
+
+	void _postDueEvents(RenderLoop& loop, double beginTime, int& postedCount) {
+		const double time = Test::getTime();
+		while (postedCount < kEventCount && beginTime + postedCount * kEventInterval <= time) {
+			postedCount++;
+			loop.postResize(800 + postedCount, 600 + postedCount / 2);
+		}
+	}
+
+	void _run(const char* name, bool renderThread, bool coalesceResize, bool useBuckets) {
+		RendererOptions options;
+		options.renderThread = renderThread;
+		options.coalesceResize = coalesceResize;
+		FakeRenderer renderer;
+		renderer.useBuckets = useBuckets;
+		RenderLoop loop(&renderer, options);
+		loop.postResize(800, 600);
+		loop.runFrame();
+
+		int postedCount = 0;
+		const double beginTime = Test::getTime();
+		const size_t firstFrame = renderer.frameEndTimes.size();
+		const uint32_t firstResize = renderer.resizeCount, firstRebuild = renderer.rebuildCount;
+		if (renderThread) {
+			std::thread thread([&loop]() {
+				loop.run();
+			});
+			while (postedCount < kEventCount) {
+				_postDueEvents(loop, beginTime, postedCount);
+				_wait(kEventInterval * 0.5);
+			}
+			// one more frame applies last size
+			const uint64_t frameCount = loop.getFrameCount();
+			while (loop.getFrameCount() < frameCount + 2)
+				_wait(kEventInterval * 0.5);
+			loop.requestStop();
+			thread.join();
+		}
+		else {
+			// messages wait while window thread renders
+			while (postedCount < kEventCount) {
+				_postDueEvents(loop, beginTime, postedCount);
+				loop.runFrame();
+			}
+			loop.runFrame();
+		}
+		const double elapsed = Test::getTime() - beginTime;
+
+		double sum = 0, maxFrameTime = 0;
+		const size_t frameCount = renderer.frameEndTimes.size() - firstFrame;
+		for (size_t i = firstFrame; i < renderer.frameEndTimes.size(); i++) {
+			const double frameTime = renderer.frameEndTimes[i] - renderer.frameEndTimes[i - 1];
+			sum += frameTime;
+			maxFrameTime = frameTime > maxFrameTime ? frameTime : maxFrameTime;
+		}
+		std::printf("%-40s : %3u resizes, %3u target rebuilds, %3zu frames in %.0f ms, frame time avg %5.1f ms, max %5.1f ms\n",
+			name, renderer.resizeCount - firstResize, renderer.rebuildCount - firstRebuild, frameCount, elapsed * 1000.0,
+			frameCount > 0 ? sum * 1000.0 / frameCount : 0.0, maxFrameTime * 1000.0);
+	}
+}
+
+int main() {
+	std::printf("Simulated frame %.1f ms, resize %.1f ms (flush and ResizeBuffers), target rebuild %.1f ms, %d size events\n",
+		kFrameTime * 1000.0, (kFlushTime + kResizeBuffersTime) * 1000.0, kRebuildTime * 1000.0, kEventCount);
+	_run("window thread, immediate, no buckets", false, false, false);
+	_run("window thread, coalesced, buckets", false, true, true);
+	_run("render thread, immediate, buckets", true, false, true);
+	_run("render thread, coalesced, no buckets", true, true, false);
+	_run("render thread, coalesced, buckets", true, true, true);
+	return 0;
+}
@@ -0,0 +1,196 @@
+#include "RenderLoop.h"
+#include "TestCommon.h"
+#include <thread>
+
+namespace {
+	// Records calls of render loop, frames are called on render thread and read after it stops
+	struct FakeRenderer : public RenderLoopDelegate {
+		std::atomic<uint32_t> frameCount{ 0 };
+		uint32_t updateCount = 0;
+		uint32_t resizeCount = 0;
+		uint32_t moveCount = 0;
+		uint32_t displayChangeCount = 0;
+		int width = 0;
+		int height = 0;
+		bool isInFrame = false;
+		bool isNested = false;
+		std::atomic<bool> isBlocked{ false };	// render() waits while set, like Present() waiting for window thread
+
+		void update(float) override {
+			updateCount++;
+		}
+		void render() override {
+			isNested = isNested || isInFrame == false;
+			while (isBlocked)
+				std::this_thread::yield();
+		}
+		void move(int, int) override {
+			moveCount++;
+		}
+		void resize(int newWidth, int newHeight) override {
+			resizeCount++;
+			width = newWidth;
+			height = newHeight;
+			isNested = isNested || isInFrame;
+		}
+		void displayDidChange() override {
+			displayChangeCount++;
+		}
+		void beginFrame() override {
+			isNested = isNested || isInFrame;
+			isInFrame = true;
+		}
+		void endFrame() override {
+			isInFrame = false;
+			frameCount++;
+		}
+	};
+
+	RendererOptions _makeOptions(bool renderThread, bool coalesceResize) {
+		RendererOptions options;
+		options.renderThread = renderThread;
+		options.coalesceResize = coalesceResize;
+		return options;
+	}
+
+	void _testCoalescedResize() {
+		FakeRenderer renderer;
+		RenderLoop loop(&renderer, _makeOptions(false, true));
+
+		loop.postBeginSizing();
+		for (int i = 1; i <= 10; i++)
+			loop.postResize(100 + i, 200 + i);
+		loop.postMove();
+		CHECK(renderer.resizeCount == 0);
+
+		// only last size is applied, before frame begins
+		loop.runFrame();
+		CHECK(renderer.resizeCount == 1);
+		CHECK(renderer.width == 110 && renderer.height == 210);
+		CHECK(renderer.moveCount == 1);
+		CHECK(renderer.frameCount == 1);
+		CHECK(renderer.updateCount == 1);
+
+		loop.postResize(300, 400);
+		loop.postEndSizing();
+		loop.postDisplayChange();
+		loop.runFrame();
+		CHECK(renderer.resizeCount == 2);
+		CHECK(renderer.width == 300 && renderer.height == 400);
+		CHECK(renderer.displayChangeCount == 1);
+		CHECK(loop.getFrameCount() == 2);
+		CHECK(renderer.isNested == false);
+	}
+
+	void _testImmediateResize() {
+		FakeRenderer renderer;
+		RenderLoop loop(&renderer, _makeOptions(false, false));
+
+		for (int i = 1; i <= 10; i++)
+			loop.postResize(100 + i, 200 + i);
+		CHECK(renderer.resizeCount == 10);
+		CHECK(renderer.width == 110 && renderer.height == 210);
+		CHECK(renderer.frameCount == 0);
+	}
+
+	void _testOverflow() {
+		FakeRenderer renderer;
+		RenderLoop loop(&renderer, _makeOptions(false, true));
+
+		// more events than queue holds, posting doesn't wait for frame
+		const int count = static_cast<int>(RenderLoop::kEventCapacity) * 3;
+		loop.postBeginSizing();
+		for (int i = 1; i <= count; i++) {
+			loop.postResize(i, i * 2);
+			loop.postMove(i, i);
+		}
+		loop.postDisplayChange();
+		loop.postEndSizing();
+		CHECK(renderer.resizeCount == 0);
+
+		loop.runFrame();
+		CHECK(renderer.resizeCount == 1);
+		CHECK(renderer.width == count && renderer.height == count * 2);
+		// moves that fit in queue after begin sizing, and one merged
+		CHECK(renderer.moveCount == (RenderLoop::kEventCapacity - 1) / 2 + 1);
+		CHECK(renderer.displayChangeCount == 1);
+
+		// queue is used again after overflow is drained
+		loop.postResize(10, 20);
+		loop.runFrame();
+		CHECK(renderer.resizeCount == 2);
+		CHECK(renderer.width == 10 && renderer.height == 20);
+		CHECK(renderer.frameCount == 2);
+	}
+
+	void _testBlockedRenderThread() {
+		FakeRenderer renderer;
+		renderer.isBlocked = true;
+		RenderLoop loop(&renderer, _makeOptions(true, true));
+		std::thread renderThread([&loop]() {
+			loop.run();
+		});
+
+		// window thread keeps posting while render thread is stuck in frame
+		for (int i = 1; i <= 10000; i++)
+			loop.postResize(i, i);
+		loop.postDisplayChange();
+
+		loop.requestStop();
+		renderer.isBlocked = false;
+		renderThread.join();
+		loop.runFrame();
+		CHECK(renderer.width == 10000 && renderer.height == 10000);
+		CHECK(renderer.displayChangeCount == 1);
+	}
+
+	void _testRenderThread() {
+		FakeRenderer renderer;
+		RenderLoop loop(&renderer, _makeOptions(true, true));
+		CHECK(loop.isStopRequested() == false);
+
+		std::thread renderThread([&loop]() {
+			loop.run();
+		});
+
+		// events arrive while frames run
+		for (int i = 1; i <= 1000; i++) {
+			loop.postResize(i, i * 2);
+			if (i % 100 == 0)
+				std::this_thread::yield();
+		}
+		loop.postMove();
+
+		// frame started after last post has seen all events
+		const uint32_t postedFrameCount = renderer.frameCount;
+		while (renderer.frameCount < postedFrameCount + 2)
+			std::this_thread::yield();
+
+		loop.requestStop();
+		renderThread.join();
+		CHECK(loop.isStopRequested());
+
+		// stop is seen between frames, so every frame is complete
+		CHECK(renderer.isInFrame == false);
+		CHECK(renderer.isNested == false);
+		CHECK(loop.getFrameCount() == renderer.frameCount);
+		CHECK(renderer.updateCount == renderer.frameCount);
+		CHECK(renderer.resizeCount >= 1 && renderer.resizeCount <= renderer.frameCount);
+		CHECK(renderer.width == 1000 && renderer.height == 2000);
+		CHECK(renderer.moveCount == 1);
+
+		// frames can still be run by caller after thread stops
+		const uint32_t frameCount = renderer.frameCount;
+		loop.runFrame();
+		CHECK(renderer.frameCount == frameCount + 1);
+	}
+}
+
+int main() {
+	_testCoalescedResize();
+	_testImmediateResize();
+	_testOverflow();
+	_testBlockedRenderThread();
+	_testRenderThread();
+	return Test::finish("RenderLoopTest");
+}
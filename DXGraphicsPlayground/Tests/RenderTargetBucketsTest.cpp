@@ -0,0 +1,105 @@
+#include "RenderTargetBuckets.h"
+#include "TestCommon.h"
+
+namespace {
+	void _testRoundUp() {
+		CHECK(RenderTargetBuckets::roundUp(0, 128) == 128);
+		CHECK(RenderTargetBuckets::roundUp(1, 128) == 128);
+		CHECK(RenderTargetBuckets::roundUp(128, 128) == 128);
+		CHECK(RenderTargetBuckets::roundUp(129, 128) == 256);
+		CHECK(RenderTargetBuckets::roundUp(1920, 128) == 1920);
+		CHECK(RenderTargetBuckets::roundUp(1080, 128) == 1152);
+		CHECK(RenderTargetBuckets::roundUp(7, 1) == 7);
+
+		RenderTargetBuckets buckets;
+		CHECK(buckets.getGranularity() == RenderTargetBuckets::kDefaultGranularity);
+		CHECK(buckets.getRebuildCount() == 0);
+		CHECK(buckets.update(800, 600));
+		CHECK(buckets.getTargetWidth() == 896);
+		CHECK(buckets.getTargetHeight() == 640);
+
+		// zero granularity would divide by zero, so it's clamped
+		RenderTargetBuckets exact(0);
+		CHECK(exact.getGranularity() == 1);
+		CHECK(exact.update(801, 601));
+		CHECK(exact.getTargetWidth() == 801);
+		CHECK(exact.getTargetHeight() == 601);
+	}
+
+	void _testGrow() {
+		RenderTargetBuckets buckets;
+		CHECK(buckets.update(800, 600));
+		// within bucket
+		CHECK(buckets.update(896, 640) == false);
+		// one axis past bucket
+		CHECK(buckets.update(897, 640));
+		CHECK(buckets.getTargetWidth() == 1024);
+		CHECK(buckets.getTargetHeight() == 640);
+		CHECK(buckets.update(1024, 641));
+		CHECK(buckets.getTargetHeight() == 768);
+		CHECK(buckets.getRebuildCount() == 3);
+	}
+
+	void _testShrinkHysteresis() {
+		RenderTargetBuckets buckets;
+		CHECK(buckets.update(1024, 1024));
+
+		// 1024x1024 is kept while it's at most twice the bucket area
+		CHECK(buckets.update(1000, 1000) == false);
+		CHECK(buckets.update(1024, 512) == false);
+		CHECK(buckets.update(512, 1024) == false);
+		CHECK(buckets.getTargetWidth() == 1024);
+		CHECK(buckets.getTargetHeight() == 1024);
+
+		// 1024x384 bucket would waste more than half of texels
+		CHECK(buckets.update(1024, 384));
+		CHECK(buckets.getTargetWidth() == 1024);
+		CHECK(buckets.getTargetHeight() == 384);
+		CHECK(buckets.getRebuildCount() == 2);
+
+		// growing back rebuilds, even though it was that size before
+		CHECK(buckets.update(1024, 1024));
+		CHECK(buckets.getRebuildCount() == 3);
+
+		// small window is rebuilt, then kept while it grows within bucket
+		CHECK(buckets.update(100, 100));
+		CHECK(buckets.getTargetWidth() == 128);
+		CHECK(buckets.getTargetHeight() == 128);
+		CHECK(buckets.update(1, 1) == false);
+		CHECK(buckets.update(0, 0) == false);
+		CHECK(buckets.getRebuildCount() == 4);
+	}
+
+	void _testRepeatedResizes() {
+		// window dragged back and forth within one bucket, as during live resize
+		RenderTargetBuckets buckets;
+		CHECK(buckets.update(1280, 720));
+		int rebuildCount = 0;
+		for (int i = 0; i < 1000; i++) {
+			const uint32_t width = 1153 + i % 128;
+			const uint32_t height = 641 + (i * 7) % 127;
+			if (buckets.update(width, height))
+				rebuildCount++;
+		}
+		CHECK(rebuildCount == 0);
+		CHECK(buckets.getRebuildCount() == 1);
+		CHECK(buckets.getTargetWidth() == 1280);
+		CHECK(buckets.getTargetHeight() == 768);
+
+		// alternating between two sizes, at most one rebuild each way before targets settle
+		CHECK(buckets.update(1600, 900));
+		for (int i = 0; i < 100; i++) {
+			CHECK(buckets.update(1280, 720) == false);
+			CHECK(buckets.update(1600, 900) == false);
+		}
+		CHECK(buckets.getRebuildCount() == 2);
+	}
+}
+
+int main() {
+	_testRoundUp();
+	_testGrow();
+	_testShrinkHysteresis();
+	_testRepeatedResizes();
+	return Test::finish("RenderTargetBucketsTest");
+}
@@ -0,0 +1,43 @@
+#include "RingAllocator.h"
+#include "TestCommon.h"
+#include <cstdint>
+#include <vector>
+
+// Upload-like traffic : every frame allocates placement-aligned chunks, and fake GPU completes frames 2 frames later.
+int main() {
+	const uint64_t kCapacity = 64ull * 1024 * 1024;
+	const int kFrameCount = 200000;
+	const int kAllocationsPerFrame = 32;
+	const uint64_t kAlignment = 512;	// D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+
+	std::vector<uint64_t> sizes(1024);
+	uint32_t random = 12345;
+	for (uint64_t& size : sizes) {
+		random = random * 1664525u + 1013904223u;
+		size = 256 + (random >> 8) % (64 * 1024);
+	}
+
+	RingAllocator ring(kCapacity);
+	uint64_t fenceValues[3] = {};
+	uint64_t nextFenceValue = 1, failures = 0, allocatedBytes = 0;
+	const double beginTime = Test::getTime();
+	for (int frame = 0; frame < kFrameCount; frame++) {
+		for (int i = 0; i < kAllocationsPerFrame; i++) {
+			const uint64_t size = sizes[(frame * kAllocationsPerFrame + i) % sizes.size()];
+			if (ring.allocate(size, kAlignment) == RingAllocator::kInvalidOffset)
+				failures++;
+			else
+				allocatedBytes += size;
+		}
+		fenceValues[frame % 3] = nextFenceValue++;
+		ring.finishSubmission(fenceValues[frame % 3]);
+		ring.reclaim(fenceValues[(frame + 1) % 3]);
+	}
+	const double elapsed = Test::getTime() - beginTime;
+
+	const double allocationCount = static_cast<double>(kFrameCount) * kAllocationsPerFrame;
+	std::printf("RingAllocator : %.0f allocations in %.3f s (%.1f ns per allocation, %.1f M allocations/s), %.1f GB sub-allocated, %llu failures\n",
+		allocationCount, elapsed, elapsed * 1e9 / allocationCount, allocationCount / elapsed / 1e6,
+		allocatedBytes / (1024.0 * 1024.0 * 1024.0), static_cast<unsigned long long>(failures));
+	return 0;
+}
@@ -0,0 +1,125 @@
+#include "RingAllocator.h"
+#include "TestCommon.h"
+
+namespace {
+	// Stands in for ID3D12Fence : GPU completes submissions when test says so
+	struct FakeFence {
+		uint64_t nextValue = 1;
+		uint64_t completedValue = 0;
+
+		uint64_t signal() { return nextValue++; }
+		void complete(uint64_t value) { completedValue = value; }
+	};
+
+	void _testAlignment() {
+		RingAllocator ring(4096);
+		CHECK(ring.allocate(100, 1) == 0);
+		CHECK(ring.allocate(100, 512) == 512);
+		CHECK(ring.allocate(1, 256) == 768);
+		CHECK(ring.getUsedSize() == 769);
+		CHECK(ring.getPendingSize() == 769);
+	}
+
+	void _testFullAndReclaim() {
+		FakeFence fence;
+		RingAllocator ring(1024);
+		CHECK(ring.allocate(512) == 0);
+		CHECK(ring.allocate(512) == 512);
+		CHECK(ring.allocate(1) == RingAllocator::kInvalidOffset);
+		CHECK(ring.allocate(2048) == RingAllocator::kInvalidOffset);
+		CHECK(ring.allocate(0) == RingAllocator::kInvalidOffset);
+
+		// pending allocations aren't reclaimed, however far fence is
+		ring.reclaim(100);
+		CHECK(ring.getUsedSize() == 1024);
+
+		const uint64_t fenceValue = fence.signal();
+		ring.finishSubmission(fenceValue);
+		CHECK(ring.getPendingSize() == 0);
+		ring.reclaim(fence.completedValue);
+		CHECK(ring.getUsedSize() == 1024);
+
+		fence.complete(fenceValue);
+		ring.reclaim(fence.completedValue);
+		CHECK(ring.isEmpty());
+		// empty ring rewinds, so whole capacity is available again
+		CHECK(ring.allocate(1024) == 0);
+	}
+
+	void _testWrap() {
+		FakeFence fence;
+		RingAllocator ring(1000);
+		CHECK(ring.allocate(400) == 0);
+		const uint64_t first = fence.signal();
+		ring.finishSubmission(first);
+		CHECK(ring.allocate(400) == 400);
+		const uint64_t second = fence.signal();
+		ring.finishSubmission(second);
+
+		// 200 bytes left at end, but only after first submission completes there's room at front
+		CHECK(ring.allocate(300) == RingAllocator::kInvalidOffset);
+		fence.complete(first);
+		ring.reclaim(fence.completedValue);
+		CHECK(ring.getUsedSize() == 400);
+		CHECK(ring.allocate(300) == 0);
+		// tail of ring is wasted until the wrapped submission is reclaimed
+		CHECK(ring.getUsedSize() == 400 + 200 + 300);
+		CHECK(ring.allocate(200) == RingAllocator::kInvalidOffset);
+		CHECK(ring.allocate(100) == 300);
+		const uint64_t third = fence.signal();
+		ring.finishSubmission(third);
+
+		// wasted tail is freed with the wrapped submission
+		fence.complete(second);
+		ring.reclaim(fence.completedValue);
+		CHECK(ring.getUsedSize() == 200 + 300 + 100);
+		fence.complete(third);
+		ring.reclaim(fence.completedValue);
+		CHECK(ring.isEmpty());
+	}
+
+	void _testSameFenceValueMerges() {
+		RingAllocator ring(1024);
+		ring.allocate(100);
+		ring.finishSubmission(5);
+		ring.allocate(100);
+		ring.finishSubmission(5);
+		ring.finishSubmission(6);		// nothing pending, no submission
+		ring.reclaim(4);
+		CHECK(ring.getUsedSize() == 200);
+		ring.reclaim(5);
+		CHECK(ring.isEmpty());
+	}
+
+	void _testFramesInFlight() {
+		// steady stream of frames with GPU two frames behind never fails or leaks
+		FakeFence fence;
+		RingAllocator ring(64 * 1024);
+		uint64_t submitted[3] = {};
+		bool failed = false;
+		for (int frame = 0; frame < 1000; frame++) {
+			for (int i = 0; i < 7; i++) {
+				const uint64_t size = 512 + (frame * 7 + i) % 13 * 300;
+				if (ring.allocate(size, 512) == RingAllocator::kInvalidOffset)
+					failed = true;
+			}
+			submitted[frame % 3] = fence.signal();
+			ring.finishSubmission(submitted[frame % 3]);
+			fence.complete(submitted[(frame + 1) % 3]);
+			ring.reclaim(fence.completedValue);
+		}
+		CHECK(failed == false);
+		fence.complete(fence.nextValue - 1);
+		ring.reclaim(fence.completedValue);
+		CHECK(ring.isEmpty());
+	}
+}
+
+int main() {
+	_testAlignment();
+	_testFullAndReclaim();
+	_testWrap();
+	_testSameFenceValueMerges();
+	_testFramesInFlight();
+	return Test::finish("RingAllocatorTest");
+}
@@ -0,0 +1,65 @@
+#include "SkylinePacker.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+	struct Rect {
+		uint32_t width;
+		uint32_t height;
+	};
+
+	// Packs rectangles (tall ones first) into first 2048x2048 page that has room, like TextureAtlasBuilder
+	void _run(const char* name, std::vector<Rect> rects) {
+		std::sort(rects.begin(), rects.end(), [](const Rect& a, const Rect& b) {
+			return a.height != b.height ? a.height > b.height : a.width > b.width;
+		});
+
+		const double beginTime = Test::getTime();
+		std::vector<SkylinePacker> pages;
+		uint64_t area = 0;
+		for (const Rect& rect : rects) {
+			uint32_t x = 0, y = 0;
+			size_t page = 0;
+			while (page < pages.size() && pages[page].pack(rect.width, rect.height, x, y) == false)
+				page++;
+			if (page == pages.size()) {
+				pages.emplace_back(2048, 2048);
+				pages.back().pack(rect.width, rect.height, x, y);
+			}
+			area += static_cast<uint64_t>(rect.width) * rect.height;
+		}
+		const double elapsed = Test::getTime() - beginTime;
+
+		// last page is usually partially filled
+		uint64_t fullPagesArea = 0;
+		for (size_t i = 0; i + 1 < pages.size(); i++)
+			fullPagesArea += pages[i].getUsedArea();
+		const double pageArea = 2048.0 * 2048.0;
+		std::printf("%-22s %zu rects, %zu pages, occupancy %.1f%% (%.1f%% of full pages), %.2f us/rect\n",
+			name, rects.size(), pages.size(), 100.0 * area / (pageArea * pages.size()),
+			pages.size() > 1 ? 100.0 * fullPagesArea / (pageArea * (pages.size() - 1)) : 0.0, elapsed * 1e6 / rects.size());
+	}
+}
+
+// 2000 rectangles into 2048x2048 pages, single core
+int main() {
+	const int kRectCount = 2000;
+	uint32_t random = 1;
+	auto nextRandom = [&random]() {
+		random = random * 1664525u + 1013904223u;
+		return random >> 8;
+	};
+
+	std::vector<Rect> randomSizes, powerOfTwoSizes, powerOfTwoSquares;
+	for (int i = 0; i < kRectCount; i++) {
+		randomSizes.push_back({ 16 + nextRandom() % 241, 16 + nextRandom() % 241 });
+		powerOfTwoSizes.push_back({ 16u << (nextRandom() % 5), 16u << (nextRandom() % 5) });
+		const uint32_t size = 16u << (nextRandom() % 5);
+		powerOfTwoSquares.push_back({ size, size });
+	}
+	_run("random 16-256 sizes", randomSizes);
+	_run("pow2 16-256 sizes", powerOfTwoSizes);
+	_run("pow2 squares", powerOfTwoSquares);
+	return 0;
+}
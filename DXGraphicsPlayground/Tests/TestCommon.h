@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+// Minimal checks for tests of graphics API-free code in Common (no test framework needed)
+namespace Test {
+	inline int& getFailureCount() {
+		static int failureCount = 0;
+		return failureCount;
+	}
+
+	// Returns exit code of test executable
+	inline int finish(const char* name) {
+		const int failureCount = getFailureCount();
+		if (failureCount == 0)
+			std::printf("%s : passed\n", name);
+		else
+			std::printf("%s : %d checks failed\n", name, failureCount);
+		return failureCount == 0 ? 0 : 1;
+	}
+
+	// Seconds since an arbitrary point, for benchmarks
+	inline double getTime() {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			Test::getFailureCount()++; \
+		} \
+	} while (false)
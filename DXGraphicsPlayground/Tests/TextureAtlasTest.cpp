@@ -0,0 +1,225 @@
+#include "SkylinePacker.h"
+#include "TextureAtlas.h"
+#include "TestCommon.h"
+#include <vector>
+
+namespace {
+	uint32_t _nextRandom(uint32_t& random) {
+		random = random * 1664525u + 1013904223u;
+		return random >> 8;
+	}
+
+	// Marks rectangles on a grid of bin texels, so overlap and out-of-bin placement are caught
+	struct Coverage {
+		uint32_t width;
+		uint32_t height;
+		std::vector<uint8_t> texels;
+		bool isValid = true;
+
+		Coverage(uint32_t width, uint32_t height) : width(width), height(height), texels(width * height, 0) {}
+
+		void add(uint32_t x, uint32_t y, uint32_t rectWidth, uint32_t rectHeight) {
+			if (x + rectWidth > width || y + rectHeight > height) {
+				isValid = false;
+				return;
+			}
+			for (uint32_t j = y; j < y + rectHeight; j++) {
+				for (uint32_t i = x; i < x + rectWidth; i++) {
+					isValid &= texels[j * width + i] == 0;
+					texels[j * width + i] = 1;
+				}
+			}
+		}
+	};
+
+	void _testPackerNoOverlap() {
+		SkylinePacker packer(512, 512);
+		Coverage coverage(512, 512);
+		uint32_t random = 1;
+		uint64_t area = 0;
+		int packedCount = 0;
+		for (int i = 0; i < 1000; i++) {
+			const uint32_t width = 1 + _nextRandom(random) % 64, height = 1 + _nextRandom(random) % 64;
+			uint32_t x = 0, y = 0;
+			if (packer.pack(width, height, x, y) == false)
+				continue;
+			coverage.add(x, y, width, height);
+			area += width * height;
+			packedCount++;
+		}
+		CHECK(coverage.isValid);
+		CHECK(packedCount > 50);
+		CHECK(packer.getUsedArea() == area);
+		CHECK(packer.getOccupancy() == static_cast<float>(area / (512.0 * 512.0)));
+	}
+
+	void _testPackerFull() {
+		SkylinePacker packer(256, 128);
+		uint32_t x = 0, y = 0;
+		CHECK(packer.pack(257, 1, x, y) == false);
+		CHECK(packer.pack(1, 129, x, y) == false);
+		CHECK(packer.pack(0, 10, x, y) == false);
+
+		// bottom-left : rows fill from left, next row starts on top of lowest segment
+		CHECK(packer.pack(128, 64, x, y) && x == 0 && y == 0);
+		CHECK(packer.pack(128, 32, x, y) && x == 128 && y == 0);
+		CHECK(packer.pack(128, 32, x, y) && x == 128 && y == 32);
+		CHECK(packer.pack(256, 64, x, y) && x == 0 && y == 64);
+		CHECK(packer.getOccupancy() == 1.0f);
+
+		// failure leaves packer untouched
+		CHECK(packer.pack(1, 1, x, y) == false);
+		CHECK(packer.getUsedArea() == 256 * 128);
+
+		packer.reset();
+		CHECK(packer.getUsedArea() == 0);
+		CHECK(packer.pack(256, 128, x, y) && x == 0 && y == 0);
+	}
+
+	void _testPackerSquares() {
+		// power of two squares, largest first, fill bin exactly
+		SkylinePacker packer(256, 256);
+		Coverage coverage(256, 256);
+		std::vector<uint32_t> sizes(1, 128);
+		sizes.insert(sizes.end(), 7, 64);
+		sizes.insert(sizes.end(), 20, 32);
+		uint64_t area = 0;
+		for (uint32_t size : sizes) {
+			uint32_t x = 0, y = 0;
+			CHECK(packer.pack(size, size, x, y));
+			coverage.add(x, y, size, size);
+			area += size * size;
+		}
+		CHECK(coverage.isValid);
+		CHECK(area == 256 * 256);
+		CHECK(packer.getOccupancy() == 1.0f);
+	}
+
+	// Texture whose texels all have index as color
+	void _makeTexture(uint32_t index, uint32_t width, uint32_t height, MipChain& chain) {
+		std::vector<uint8_t> pixels(width * height * 4);
+		for (size_t i = 0; i < pixels.size(); i += 4) {
+			pixels[i + 0] = static_cast<uint8_t>(index & 0xFF);
+			pixels[i + 1] = static_cast<uint8_t>(index >> 8);
+			pixels[i + 2] = 7;
+			pixels[i + 3] = 255;
+		}
+		MipGenerator generator(1);
+		generator.generate(pixels.data(), width, height, width * 4, MipFormat::RGBA8, MipFilter::Box, chain);
+	}
+
+	void _testAtlas() {
+		TextureAtlasDesc desc;
+		desc.pageWidth = 512;
+		desc.pageHeight = 512;
+		desc.mipCount = 4;
+		desc.border = 1;
+		const uint32_t alignment = 1u << (desc.mipCount - 1);
+		const uint32_t padding = desc.border << (desc.mipCount - 1);
+
+		// one texture of page size, others of random (non-power-of-two) size
+		const uint32_t textureCount = 80;
+		std::vector<MipChain> chains(textureCount);
+		TextureAtlasBuilder builder(desc);
+		uint32_t random = 2;
+		double textureArea = 0.0;
+		for (uint32_t i = 0; i < textureCount; i++) {
+			const uint32_t width = i == 0 ? 512 : 4 + _nextRandom(random) % 120;
+			const uint32_t height = i == 0 ? 512 : 4 + _nextRandom(random) % 120;
+			_makeTexture(i, width, height, chains[i]);
+			CHECK(builder.addTexture(&chains[i]) == i);
+			textureArea += static_cast<double>(width) * height;
+		}
+
+		TextureAtlas atlas;
+		CHECK(builder.build(atlas));
+		CHECK(atlas.entries.size() == textureCount);
+		CHECK(atlas.getPageCount() >= 2);
+		// occupancy report counts texels of textures (without border) over texels of pages
+		CHECK(atlas.getOccupancy() == static_cast<float>(textureArea / (512.0 * 512.0 * atlas.getPageCount())));
+		CHECK(atlas.getOccupancy() > 0.5f);
+
+		// page-sized texture takes a whole slice without border
+		const TextureAtlasEntry& whole = atlas.entries[0];
+		CHECK(whole.x == 0 && whole.y == 0 && whole.width == 512 && whole.height == 512);
+		CHECK(whole.uvScale[0] == 1.0f && whole.uvOffset[0] == 0.0f);
+
+		std::vector<Coverage> coverages(atlas.getPageCount(), Coverage(512, 512));
+		bool bordersMatch = true, aligned = true, uvMatches = true;
+		for (uint32_t i = 1; i < textureCount; i++) {
+			const TextureAtlasEntry& entry = atlas.entries[i];
+			CHECK(entry.slice < atlas.getPageCount() && entry.slice != whole.slice);
+			aligned &= (entry.x - padding) % alignment == 0 && (entry.y - padding) % alignment == 0;
+			uvMatches &= entry.uvOffset[0] == entry.x / 512.0f && entry.uvScale[1] == entry.height / 512.0f;
+
+			// padded footprints don't overlap
+			coverages[entry.slice].add(entry.x - padding, entry.y - padding, entry.width + padding * 2, entry.height + padding * 2);
+
+			// content and border of every mip have color of texture (nothing bleeds in)
+			const MipChain& page = atlas.pages[entry.slice];
+			for (uint32_t level = 0; level < desc.mipCount; level++) {
+				const MipLevel& pageLevel = page.levels[level];
+				const uint32_t width = entry.width >> level > 0 ? entry.width >> level : 1;
+				const uint32_t height = entry.height >> level > 0 ? entry.height >> level : 1;
+				const uint32_t x0 = (entry.x >> level) - desc.border, y0 = (entry.y >> level) - desc.border;
+				for (uint32_t y = y0; y < y0 + height + desc.border * 2; y++) {
+					for (uint32_t x = x0; x < x0 + width + desc.border * 2; x++) {
+						const uint8_t* texel = page.getLevelData(level) + pageLevel.rowPitch * y + x * 4;
+						bordersMatch &= texel[0] == (i & 0xFF) && texel[1] == (i >> 8) && texel[2] == 7;
+					}
+				}
+			}
+		}
+		CHECK(aligned);
+		CHECK(uvMatches);
+		CHECK(bordersMatch);
+		for (const Coverage& coverage : coverages)
+			CHECK(coverage.isValid);
+	}
+
+	void _testAtlasFailures() {
+		TextureAtlasDesc desc;
+		desc.pageWidth = 256;
+		desc.pageHeight = 256;
+
+		// texture that fits page only without border
+		MipChain large;
+		_makeTexture(1, 250, 100, large);
+		TextureAtlasBuilder builder(desc);
+		builder.addTexture(&large);
+		TextureAtlas atlas;
+		CHECK(builder.build(atlas) == false);
+
+		// mixed formats
+		MipChain rgba, r8;
+		_makeTexture(2, 16, 16, rgba);
+		std::vector<uint8_t> pixels(16 * 16, 0);
+		MipGenerator(1).generate(pixels.data(), 16, 16, 16, MipFormat::R8, MipFilter::Box, r8);
+		builder.clear();
+		builder.addTexture(&rgba);
+		builder.addTexture(&r8);
+		CHECK(builder.build(atlas) == false);
+
+		// missing mips
+		MipChain single;
+		MipGenerator(1).generate(pixels.data(), 16, 16, 16, MipFormat::R8, MipFilter::Box, single, 1);
+		builder.clear();
+		builder.addTexture(&single);
+		CHECK(builder.build(atlas) == false);
+
+		// empty atlas is valid
+		builder.clear();
+		CHECK(builder.build(atlas));
+		CHECK(atlas.getPageCount() == 0);
+		CHECK(atlas.getOccupancy() == 0.0f);
+	}
+}
+
+int main() {
+	_testPackerNoOverlap();
+	_testPackerFull();
+	_testPackerSquares();
+	_testAtlas();
+	_testAtlasFailures();
+	return Test::finish("TextureAtlasTest");
+}
@@ -0,0 +1,91 @@
+#include "Hash.h"
+#include "ImageDecoder.h"
+#include "MipGenerator.h"
+#include "TextureCache.h"
+#include "TestCommon.h"
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+	const char* const kParameters = "channels=4 flip=1 format=rgba8_srgb mips=full filter=kaiser";
+
+	// Same steps as D3D12Simple : hash source, then map cached entry, or decode, generate mips and store on miss
+	bool _load(TextureCache& cache, const std::string& path, CookedTextureFile& file) {
+		std::ifstream stream(path, std::ios::binary);
+		std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		if (bytes.empty())
+			return false;
+
+		const uint64_t key = TextureCache::computeKey(bytes.data(), bytes.size(), kParameters);
+		std::string cachedPath;
+		if (cache.find(key, cachedPath))
+			return file.open(cachedPath);
+
+		ImageDecoder decoder(1);
+		decoder.decode(std::move(bytes), path, 4, true, DecodeTarget::MipChain);
+		decoder.waitAll();
+		DecodedImage image;
+		if (decoder.tryPop(image) == false || image.isValid() == false)
+			return false;
+
+		MipChain& mipChain = image.mipChain;
+		mipChain.format = MipFormat::RGBA8_SRGB;
+		MipGenerator(1).generateLevels(mipChain, MipFilter::Kaiser);
+
+		CookedTextureDesc desc;
+		desc.format = CookedTextureFormat::kR8G8B8A8UNormSRGB;
+		desc.width = mipChain.levels[0].width;
+		desc.height = mipChain.levels[0].height;
+		desc.mipCount = mipChain.getLevelCount();
+		CookedTextureWriter writer(desc);
+		for (uint32_t level = 0; level < desc.mipCount; level++)
+			writer.setSubresource(level, mipChain.getLevelData(level), mipChain.levels[level].rowPitch, mipChain.levels[level].size);
+		return cache.store(key, writer) && cache.find(key, cachedPath) && file.open(cachedPath);
+	}
+}
+
+// Startup cost of textures with empty (cold) and filled (warm) cache, on one core.
+// Images are given as arguments, or the repository's JPEG and PNG screenshots are used.
+int main(int argc, char** argv) {
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; i++)
+		paths.push_back(argv[i]);
+	if (paths.empty()) {
+		paths.push_back(REPOSITORY_DIR "/DXGraphicsPlayground/Assets/Textures/PrinE2013.jpg");
+		paths.push_back(REPOSITORY_DIR "/Screenshots/D3D11Simple.png");
+		paths.push_back(REPOSITORY_DIR "/Screenshots/D3D12Simple.png");
+	}
+
+	const std::string directory = "TextureCacheBenchmark.cache";
+	const int kWarmIterationCount = 10;
+	double coldTime = 0.0, warmTime = 1e9;
+	for (int pass = 0; pass <= kWarmIterationCount; pass++) {
+		// size limit 0 empties cache before cold pass
+		if (pass == 0)
+			TextureCache(directory, 0);
+
+		TextureCache cache(directory);
+		const double beginTime = Test::getTime();
+		for (const std::string& path : paths) {
+			CookedTextureFile file;
+			if (_load(cache, path, file) == false) {
+				std::fprintf(stderr, "Can't load %s\n", path.c_str());
+				return 1;
+			}
+		}
+		const double elapsed = Test::getTime() - beginTime;
+		if (pass == 0) {
+			coldTime = elapsed;
+			std::printf("TextureCache : %zu images, %u stored, %.1f MB on disk\n",
+				paths.size(), cache.getStats().stores, cache.getStats().size / (1024.0 * 1024.0));
+		}
+		else {
+			warmTime = elapsed < warmTime ? elapsed : warmTime;
+		}
+	}
+	std::printf("cold (read + decode + Kaiser mips + store) %.1f ms, warm (read + hash + validate + map, best of %d) %.1f ms\n",
+		coldTime * 1000.0, kWarmIterationCount, warmTime * 1000.0);
+	return 0;
+}
@@ -0,0 +1,142 @@
+#include "BlockCompressor.h"
+#include "CookedTexture.h"
+#include "TestCommon.h"
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+	const uint32_t kWidth = 64;
+	const uint32_t kHeight = 32;
+	const char* const kImagePath = "TextureCookerTest.tga";
+
+	// Gradient with row index in green, so orientation can be checked
+	void _pixel(uint32_t x, uint32_t y, uint8_t* rgba) {
+		rgba[0] = static_cast<uint8_t>(x * 4);
+		rgba[1] = static_cast<uint8_t>(y * 8);
+		rgba[2] = 128;
+		rgba[3] = 255;
+	}
+
+	// Uncompressed 32-bit TGA with top-left origin
+	bool _writeImage(const char* path) {
+		std::vector<uint8_t> bytes(18 + kWidth * kHeight * 4);
+		bytes[2] = 2;
+		bytes[12] = kWidth & 0xFF;
+		bytes[13] = static_cast<uint8_t>(kWidth >> 8);
+		bytes[14] = kHeight & 0xFF;
+		bytes[15] = static_cast<uint8_t>(kHeight >> 8);
+		bytes[16] = 32;
+		bytes[17] = 0x28;
+		for (uint32_t y = 0; y < kHeight; y++) {
+			for (uint32_t x = 0; x < kWidth; x++) {
+				uint8_t rgba[4];
+				_pixel(x, y, rgba);
+				uint8_t* bgra = bytes.data() + 18 + (y * kWidth + x) * 4;
+				bgra[0] = rgba[2];
+				bgra[1] = rgba[1];
+				bgra[2] = rgba[0];
+				bgra[3] = rgba[3];
+			}
+		}
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		return file.good();
+	}
+
+	int _cook(const std::string& input, const std::string& output, const std::string& options) {
+		const std::string command = "\"" TEXTURE_COOKER_PATH "\" \"" + input + "\" \"" + output + "\" " + options;
+		return std::system(command.c_str());
+	}
+
+	// Level 0 is flipped vertically like runtime loading, so first row holds bottom of image
+	bool _matchesImage(const uint8_t* data, size_t rowPitch, int tolerance) {
+		for (uint32_t y = 0; y < kHeight; y++) {
+			for (uint32_t x = 0; x < kWidth; x++) {
+				uint8_t expected[4];
+				_pixel(x, kHeight - 1 - y, expected);
+				const uint8_t* texel = data + y * rowPitch + x * 4;
+				for (int c = 0; c < 4; c++) {
+					const int difference = texel[c] - expected[c];
+					if (difference > tolerance || difference < -tolerance)
+						return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	void _testRGBA8() {
+		const char* path = "TextureCookerTest.rgba8.ctex";
+		CHECK(_cook(kImagePath, path, "--no-mips --format rgba8") == 0);
+
+		CookedTextureFile file;
+		CHECK(file.open(path));
+		if (file.isOpen() == false)
+			return;
+		const CookedTextureHeader& header = file.getHeader();
+		CHECK(header.format == CookedTextureFormat::kR8G8B8A8UNormSRGB);
+		CHECK(header.width == kWidth && header.height == kHeight);
+		CHECK(header.mipCount == 1 && header.arraySize == 1);
+		CHECK(header.bytesPerBlock == 4 && header.blockSize == 1);
+		const CookedSubresource& subresource = file.getSubresource(0);
+		CHECK(subresource.rowSize == kWidth * 4 && subresource.numRows == kHeight);
+		CHECK(_matchesImage(file.getSubresourceData(0), subresource.rowPitch, 0));
+	}
+
+	void _testMips() {
+		const char* path = "TextureCookerTest.mips.ctex";
+		CHECK(_cook(kImagePath, path, "--linear --filter box --format rgba8") == 0);
+
+		CookedTextureFile file;
+		CHECK(file.open(path));
+		if (file.isOpen() == false)
+			return;
+		const CookedTextureHeader& header = file.getHeader();
+		CHECK(header.format == CookedTextureFormat::kR8G8B8A8UNorm);
+		CHECK(header.mipCount == 7);	// 64x32 .. 1x1
+		CHECK(_matchesImage(file.getSubresourceData(0), file.getSubresource(0).rowPitch, 0));
+
+		// box filter of linear gradient keeps constant channels
+		const CookedSubresource& last = file.getSubresource(header.mipCount - 1);
+		CHECK(last.width == 1 && last.height == 1);
+		const uint8_t* texel = file.getSubresourceData(header.mipCount - 1);
+		CHECK(texel[2] == 128 && texel[3] == 255);
+	}
+
+	void _testBC1() {
+		const char* path = "TextureCookerTest.bc1.ctex";
+		CHECK(_cook(kImagePath, path, "--no-mips --format bc1 --quality fast") == 0);
+
+		CookedTextureFile file;
+		CHECK(file.open(path));
+		if (file.isOpen() == false)
+			return;
+		const CookedTextureHeader& header = file.getHeader();
+		CHECK(header.format == CookedTextureFormat::kBC1UNormSRGB);
+		CHECK(header.bytesPerBlock == 8 && header.blockSize == 4);
+		const CookedSubresource& subresource = file.getSubresource(0);
+		CHECK(subresource.rowSize == kWidth / 4 * 8 && subresource.numRows == kHeight / 4);
+
+		// 4 colors on a line per block can't follow gradient in both directions exactly, so error is a few 565 steps
+		std::vector<uint8_t> decoded(kWidth * kHeight * 4);
+		BlockCompressor::decompress(file.getSubresourceData(0), subresource.rowPitch, kWidth, kHeight, BlockFormat::BC1, decoded.data(), kWidth * 4);
+		CHECK(_matchesImage(decoded.data(), kWidth * 4, 16));
+	}
+
+	void _testFailures() {
+		CHECK(_cook("TextureCookerTest.missing.tga", "TextureCookerTest.missing.ctex", "") != 0);
+		CHECK(_cook(kImagePath, "TextureCookerTest.unknown.ctex", "--format bc9") != 0);
+	}
+}
+
+// Runs cooker executable on a generated image and loads its output back
+int main() {
+	CHECK(_writeImage(kImagePath));
+	_testRGBA8();
+	_testMips();
+	_testBC1();
+	_testFailures();
+	return Test::finish("TextureCookerTest");
+}
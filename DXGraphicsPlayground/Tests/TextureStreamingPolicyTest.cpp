@@ -0,0 +1,237 @@
+#include "TextureStreamingPolicy.h"
+#include "TestCommon.h"
+#include <cmath>
+#include <deque>
+#include <vector>
+
+namespace {
+	// BC7 (16 bytes per 4x4 block) square texture with full mip chain
+	std::vector<uint64_t> _makeBC7MipSizes(uint32_t size, uint32_t& mipCount) {
+		std::vector<uint64_t> sizes;
+		for (uint32_t mipSize = size; ; mipSize >>= 1) {
+			const uint64_t blockCount = (mipSize + 3) / 4;
+			sizes.push_back(blockCount * blockCount * 16);
+			if (mipSize == 1)
+				break;
+		}
+		mipCount = static_cast<uint32_t>(sizes.size());
+		return sizes;
+	}
+
+	uint64_t _sumFrom(const std::vector<uint64_t>& sizes, uint32_t firstMip) {
+		uint64_t sum = 0;
+		for (size_t mip = firstMip; mip < sizes.size(); mip++)
+			sum += sizes[mip];
+		return sum;
+	}
+
+	// Completes every change right away (no upload latency)
+	void _updateAndComplete(TextureStreamingPolicy& policy, uint64_t frameIndex, std::vector<TextureResidencyChange>& changes) {
+		changes.clear();
+		policy.update(frameIndex, changes);
+		for (const TextureResidencyChange& change : changes)
+			policy.completeChange(change.texture);
+	}
+
+	void _testComputeMip() {
+		CHECK(TextureStreamingPolicy::computeMip(1024, 1024, 1024.0f, 1024.0f) == 0.0f);
+		CHECK(TextureStreamingPolicy::computeMip(1024, 1024, 256.0f, 256.0f) == 2.0f);
+		CHECK(TextureStreamingPolicy::computeMip(1024, 256, 256.0f, 256.0f) == 2.0f);	// larger ratio is used
+		CHECK(TextureStreamingPolicy::computeMip(1024, 1024, 2048.0f, 2048.0f) < 0.0f);
+		CHECK(TextureStreamingPolicy::computeMip(1024, 1024, 0.0f, 100.0f) >= 32.0f);
+	}
+
+	void _testTail() {
+		TextureStreamingPolicy policy;
+		uint32_t mipCount = 0;
+		const std::vector<uint64_t> sizes = _makeBC7MipSizes(2048, mipCount);
+		const StreamingTextureId texture = policy.addTexture(2048, 2048, mipCount, sizes.data(), 4);
+		CHECK(mipCount == 12);
+		CHECK(policy.getTailFirstMip(texture) == 5);	// 64x64
+		CHECK(policy.getResidentFirstMip(texture) == mipCount);
+
+		// block-compressed mips whose size isn't multiple of 4 can't be top level
+		const StreamingTextureId odd = policy.addTexture(200, 200, 8, sizes.data(), 4);
+		CHECK(policy.getTailFirstMip(odd) == 1);	// 100x100 (50x50 isn't multiple of 4)
+
+		// tail is loaded on first update without any request
+		std::vector<TextureResidencyChange> changes;
+		policy.update(1, changes);
+		CHECK(changes.size() == 2);
+		CHECK(changes[0].texture == texture && changes[0].firstMip == 5);
+		CHECK(policy.isChangePending(texture));
+		CHECK(policy.getStats().pendingSize == _sumFrom(sizes, 5) + _sumFrom(sizes, 1) - _sumFrom(sizes, 8));
+		policy.completeChange(texture);
+		policy.cancelChange(odd);
+		CHECK(policy.getResidentFirstMip(texture) == 5);
+		CHECK(policy.getStats().residentSize == _sumFrom(sizes, 5));
+		CHECK(policy.getStats().pendingSize == 0);
+
+		// removing texture releases its memory
+		policy.removeTexture(texture);
+		CHECK(policy.getUsedSize() == 0);
+	}
+
+	void _testRequestAndEviction() {
+		uint32_t mipCount = 0;
+		const std::vector<uint64_t> sizes = _makeBC7MipSizes(1024, mipCount);
+		// budget fits two full textures, tails of all three, and tail reserved for eviction
+		TextureStreamingConfig config;
+		config.budget = _sumFrom(sizes, 0) * 2 + _sumFrom(sizes, 4) * 4;
+		TextureStreamingPolicy policy(config);
+		StreamingTextureId textures[3];
+		for (StreamingTextureId& texture : textures)
+			texture = policy.addTexture(1024, 1024, mipCount, sizes.data(), 4);
+
+		std::vector<TextureResidencyChange> changes;
+		_updateAndComplete(policy, 1, changes);
+		CHECK(policy.getResidentFirstMip(textures[0]) == 4);
+
+		// fractional mip request loads floor of it
+		policy.requestMip(textures[0], 1.7f);
+		policy.requestMip(textures[0], 0.3f);	// most detailed request wins
+		policy.requestMip(textures[1], 0.0f);
+		_updateAndComplete(policy, 2, changes);
+		CHECK(policy.getResidentFirstMip(textures[0]) == 0);
+		CHECK(policy.getResidentFirstMip(textures[1]) == 0);
+		CHECK(policy.getStats().requestedTextureCount == 2);
+		CHECK(policy.getStats().missingMipCount == 8);
+
+		// texture 1 is requested more recently than texture 0
+		policy.requestMip(textures[1], 0.0f);
+		_updateAndComplete(policy, 3, changes);
+		CHECK(policy.getStats().missingMipCount == 0);
+
+		// texture 2 doesn't fit : least recently requested texture 0 is evicted to its tail, texture 1 is kept
+		policy.requestMip(textures[2], 0.0f);
+		changes.clear();
+		policy.update(4, changes);
+		CHECK(changes.size() == 1);
+		CHECK(changes[0].texture == textures[0] && changes[0].firstMip == 4);
+		CHECK(policy.getStats().evictionCount == 1);
+		for (const TextureResidencyChange& change : changes)
+			policy.completeChange(change.texture);
+
+		// evicted memory is available on next update
+		policy.requestMip(textures[2], 0.0f);
+		_updateAndComplete(policy, 5, changes);
+		CHECK(policy.getResidentFirstMip(textures[0]) == 4);
+		CHECK(policy.getResidentFirstMip(textures[1]) == 0);
+		CHECK(policy.getResidentFirstMip(textures[2]) == 0);
+		CHECK(policy.getUsedSize() <= config.budget);
+	}
+
+	void _testPartialLoadWithinBudget() {
+		uint32_t mipCount = 0;
+		const std::vector<uint64_t> sizes = _makeBC7MipSizes(1024, mipCount);
+		// mip 0 doesn't fit
+		TextureStreamingConfig config;
+		config.budget = _sumFrom(sizes, 1) + sizes[0] / 2;
+		TextureStreamingPolicy policy(config);
+		const StreamingTextureId texture = policy.addTexture(1024, 1024, mipCount, sizes.data(), 4);
+		std::vector<TextureResidencyChange> changes;
+		_updateAndComplete(policy, 1, changes);
+
+		// most detailed mips that fit are loaded instead
+		policy.requestMip(texture, 0.0f);
+		_updateAndComplete(policy, 2, changes);
+		CHECK(policy.getResidentFirstMip(texture) == 1);
+		CHECK(policy.getUsedSize() <= config.budget);
+
+		// and requested mip isn't loaded later either (old mips would be alive with new ones)
+		policy.requestMip(texture, 0.0f);
+		_updateAndComplete(policy, 3, changes);
+		CHECK(changes.empty());
+		CHECK(policy.getResidentFirstMip(texture) == 1);
+		CHECK(policy.getStats().missingMipCount == 1);
+	}
+
+	// Camera trace over a row of textures : requested mips follow distance to camera,
+	// and residency changes complete after upload latency.
+	struct SimulationResult {
+		uint64_t peakUsedSize;
+		uint64_t overBudgetFrameCount;
+		uint64_t loadCount;
+		uint64_t evictionCount;
+		double averageMissingMips;
+	};
+
+	SimulationResult _simulate(uint64_t budget) {
+		const int kTextureCount = 400;
+		const uint32_t kTextureSize = 2048;
+		const int kFrameCount = 4000;
+		const uint64_t kUploadLatency = 3;
+
+		TextureStreamingConfig config;
+		config.budget = budget;
+		TextureStreamingPolicy policy(config);
+		uint32_t mipCount = 0;
+		const std::vector<uint64_t> sizes = _makeBC7MipSizes(kTextureSize, mipCount);
+		for (int i = 0; i < kTextureCount; i++)
+			policy.addTexture(kTextureSize, kTextureSize, mipCount, sizes.data(), 4);
+
+		struct PendingChange {
+			StreamingTextureId texture;
+			uint64_t completeFrame;
+		};
+		std::deque<PendingChange> pendingChanges;
+		std::vector<TextureResidencyChange> changes;
+		SimulationResult result{};
+		uint64_t missingMipSum = 0, requestedSum = 0;
+		for (uint64_t frame = 1; frame <= kFrameCount; frame++) {
+			// camera moves back and forth over the row, textures within 300 units are visible
+			const float camera = 2000.0f + 1500.0f * sinf(frame * 0.002f);
+			for (int i = 0; i < kTextureCount; i++) {
+				const float distance = fabsf(i * 10.0f - camera);
+				if (distance > 300.0f)
+					continue;
+				const float screenSize = 1080.0f * 10.0f / (distance + 5.0f);
+				policy.requestMip(i, TextureStreamingPolicy::computeMip(kTextureSize, kTextureSize, screenSize, screenSize));
+			}
+
+			changes.clear();
+			policy.update(frame, changes);
+			for (const TextureResidencyChange& change : changes)
+				pendingChanges.push_back({ change.texture, frame + kUploadLatency });
+			while (pendingChanges.empty() == false && pendingChanges.front().completeFrame <= frame) {
+				policy.completeChange(pendingChanges.front().texture);
+				pendingChanges.pop_front();
+			}
+
+			const uint64_t usedSize = policy.getUsedSize();
+			result.peakUsedSize = usedSize > result.peakUsedSize ? usedSize : result.peakUsedSize;
+			if (usedSize > budget)
+				result.overBudgetFrameCount++;
+			missingMipSum += policy.getStats().missingMipCount;
+			requestedSum += policy.getStats().requestedTextureCount;
+		}
+		result.loadCount = policy.getStats().loadCount;
+		result.evictionCount = policy.getStats().evictionCount;
+		result.averageMissingMips = requestedSum > 0 ? static_cast<double>(missingMipSum) / requestedSum : 0.0;
+		return result;
+	}
+
+	void _testTraceSimulation() {
+		const uint64_t budgets[] = { 64ull << 20, 256ull << 20, 1024ull << 20 };
+		for (uint64_t budget : budgets) {
+			const SimulationResult result = _simulate(budget);
+			std::printf("budget %llu MB : peak %.1f MB, %llu loads, %llu evictions, %.3f missing mips per requested texture\n",
+				static_cast<unsigned long long>(budget >> 20), result.peakUsedSize / (1024.0 * 1024.0),
+				static_cast<unsigned long long>(result.loadCount), static_cast<unsigned long long>(result.evictionCount), result.averageMissingMips);
+			CHECK(result.overBudgetFrameCount == 0);
+			CHECK(result.peakUsedSize <= budget);
+			CHECK(result.loadCount > 0);
+			CHECK(result.evictionCount > 0);
+			CHECK(result.averageMissingMips < 0.25);
+		}
+	}
+}
+
+int main() {
+	_testComputeMip();
+	_testTail();
+	_testRequestAndEviction();
+	_testPartialLoadWithinBudget();
+	_testTraceSimulation();
+	return Test::finish("TextureStreamingPolicyTest");
+}
@@ -0,0 +1,139 @@
+#include "TransientResourcePlanner.h"
+#include "TestCommon.h"
+
+namespace {
+	bool _overlapsInTime(const TransientResourcePlanner& planner, uint32_t a, uint32_t b) {
+		return planner.getFirstPass(a) <= planner.getLastPass(b) && planner.getFirstPass(b) <= planner.getLastPass(a);
+	}
+
+	bool _overlapsInMemory(const TransientResourcePlanner& planner, uint32_t a, uint32_t b) {
+		return planner.getOffset(a) < planner.getOffset(b) + planner.getSize(b) &&
+			planner.getOffset(b) < planner.getOffset(a) + planner.getSize(a);
+	}
+
+	// Resources alive at the same time never share a byte, and all fit in heap
+	bool _isValidPlan(const TransientResourcePlanner& planner) {
+		for (uint32_t a = 0; a < planner.getResourceCount(); a++) {
+			if (planner.getOffset(a) == TransientResourcePlanner::kInvalidOffset ||
+				planner.getOffset(a) + planner.getSize(a) > planner.getHeapSize())
+				return false;
+			for (uint32_t b = a + 1; b < planner.getResourceCount(); b++) {
+				if (_overlapsInTime(planner, a, b) && _overlapsInMemory(planner, a, b))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// Largest sum of sizes alive in one pass, no plan can use less memory
+	uint64_t _getPeakLiveSize(const TransientResourcePlanner& planner, uint32_t passCount) {
+		uint64_t peak = 0;
+		for (uint32_t pass = 0; pass < passCount; pass++) {
+			uint64_t live = 0;
+			for (uint32_t i = 0; i < planner.getResourceCount(); i++) {
+				if (planner.getFirstPass(i) <= pass && pass <= planner.getLastPass(i))
+					live += planner.getSize(i);
+			}
+			peak = live > peak ? live : peak;
+		}
+		return peak;
+	}
+
+	void _testOverlappingLifetimes() {
+		TransientResourcePlanner planner;
+		const uint32_t a = planner.addResource(1000, 256, 0, 2);
+		const uint32_t b = planner.addResource(500, 256, 1, 3);
+		const uint32_t c = planner.addResource(300, 256, 2, 2);
+		planner.plan();
+		CHECK(_isValidPlan(planner));
+		CHECK(planner.isAliased(a) == false);
+		CHECK(planner.isAliased(b) == false);
+		CHECK(planner.isAliased(c) == false);
+		CHECK(planner.getOffset(a) % 256 == 0);
+		CHECK(planner.getOffset(b) % 256 == 0);
+		CHECK(planner.getOffset(c) % 256 == 0);
+		CHECK(planner.getUnaliasedSize() == 1800);
+		CHECK(planner.getHeapSize() >= planner.getUnaliasedSize());
+	}
+
+	void _testDisjointLifetimesAlias() {
+		TransientResourcePlanner planner;
+		const uint32_t gbuffer = planner.addResource(4096, 256, 0, 1);
+		const uint32_t bloom = planner.addResource(2048, 256, 2, 3);
+		const uint32_t blur = planner.addResource(1024, 256, 4, 4);
+		CHECK(planner.plan() == 4096);
+		CHECK(_isValidPlan(planner));
+		CHECK(planner.getOffset(gbuffer) == 0);
+		CHECK(planner.getOffset(bloom) == 0);
+		CHECK(planner.getOffset(blur) == 0);
+		CHECK(planner.isAliased(gbuffer));
+		CHECK(planner.isAliased(bloom));
+		CHECK(planner.isAliased(blur));
+		CHECK(planner.getUnaliasedSize() == 7168);
+
+		// lifetimes are inclusive, so touching at one pass means overlap
+		planner.clear();
+		const uint32_t first = planner.addResource(1024, 1, 0, 2);
+		const uint32_t second = planner.addResource(1024, 1, 2, 4);
+		CHECK(planner.plan() == 2048);
+		CHECK(_isValidPlan(planner));
+		CHECK(planner.isAliased(first) == false);
+		CHECK(planner.isAliased(second) == false);
+	}
+
+	void _testGapReuse() {
+		// smaller resource fits between two placed ones alive at same time
+		TransientResourcePlanner planner;
+		planner.addResource(2048, 1, 0, 1);
+		planner.addResource(1024, 1, 2, 3);
+		planner.addResource(1024, 1, 0, 3);
+		const uint32_t small = planner.addResource(512, 1, 2, 3);
+		CHECK(planner.plan() == 3072);
+		CHECK(_isValidPlan(planner));
+		CHECK(planner.getOffset(small) == 1024);
+	}
+
+	void _testRandomFrames() {
+		const uint32_t kPassCount = 16;
+		uint32_t random = 1;
+		bool isValid = true, isBounded = true, isAliased = false;
+		uint64_t heapSum = 0, naiveSum = 0;
+		TransientResourcePlanner planner;
+		for (int frame = 0; frame < 200; frame++) {
+			planner.clear();
+			uint64_t naiveSize = 0;
+			const uint32_t count = 4 + frame % 29;
+			for (uint32_t i = 0; i < count; i++) {
+				random = random * 1664525u + 1013904223u;
+				const uint64_t size = 256 + (random >> 8) % 65536;
+				const uint64_t alignment = 1ull << ((random >> 4) % 17);
+				const uint32_t firstPass = (random >> 24) % kPassCount;
+				const uint32_t lastPass = firstPass + (random >> 28) % (kPassCount - firstPass);
+				planner.addResource(size, alignment, firstPass, lastPass);
+				naiveSize += size;
+			}
+			planner.plan();
+			isValid = isValid && _isValidPlan(planner);
+			isBounded = isBounded && planner.getUnaliasedSize() == naiveSize &&
+				planner.getHeapSize() >= _getPeakLiveSize(planner, kPassCount);
+			for (uint32_t i = 0; i < count; i++)
+				isAliased = isAliased || planner.isAliased(i);
+			heapSum += planner.getHeapSize();
+			naiveSum += naiveSize;
+		}
+		CHECK(isValid);
+		CHECK(isBounded);
+		CHECK(isAliased);
+		// alignment padding may grow single frame past naive sum, but aliasing must win overall
+		CHECK(heapSum < naiveSum);
+		std::printf("Heap size %.1f%% of naive sum over 200 random frames\n", heapSum * 100.0 / naiveSum);
+	}
+}
+
+int main() {
+	_testOverlappingLifetimes();
+	_testDisjointLifetimesAlias();
+	_testGapReuse();
+	_testRandomFrames();
+	return Test::finish("TransientResourcePlannerTest");
+}
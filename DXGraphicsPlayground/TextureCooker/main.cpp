@@ -0,0 +1,239 @@
+#include "../Common/BlockCompressor.h"
+#include "../Common/CookedTexture.h"
+#include "../Common/ImageDecoder.h"
+#include "../Common/MipGenerator.h"
+#include "../Common/TextureAtlas.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cout << "Usage : TextureCooker <input image> <output.ctex> [--linear] [--no-mips] [--filter box|kaiser|lanczos]" << std::endl;
+		std::cout << "                      [--format rgba8|bc1|bc3|bc4|bc5|bc7] [--quality fast|normal|high]" << std::endl;
+		std::cout << "                      [--atlas <page size>]  (input is a text file listing images, one per line)" << std::endl;
+		return 1;
+	}
+
+	const std::string inputPath = argv[1], outputPath = argv[2];
+	bool linear = false, generateMips = true, compress = false;
+	MipFilter filter = MipFilter::Kaiser;
+	BlockFormat blockFormat = BlockFormat::BC7;
+	BlockCompressionQuality quality = BlockCompressionQuality::Normal;
+	uint32_t atlasPageSize = 0;
+	for (int i = 3; i < argc; i++) {
+		if (strcmp(argv[i], "--linear") == 0) {
+			linear = true;
+		}
+		else if (strcmp(argv[i], "--no-mips") == 0) {
+			generateMips = false;
+		}
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			i++;
+			const MipFilter filters[] = { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos };
+			bool found = false;
+			for (MipFilter candidate : filters) {
+				if (strcmp(argv[i], MipGenerator::getFilterName(candidate)) == 0) {
+					filter = candidate;
+					found = true;
+				}
+			}
+			if (found == false) {
+				std::cerr << "Unknown filter : " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+			i++;
+			const BlockFormat formats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5, BlockFormat::BC7 };
+			bool found = strcmp(argv[i], "rgba8") == 0;
+			compress = false;
+			for (BlockFormat candidate : formats) {
+				if (strcmp(argv[i], BlockCompressor::getFormatName(candidate)) == 0) {
+					blockFormat = candidate;
+					compress = found = true;
+				}
+			}
+			if (found == false) {
+				std::cerr << "Unknown format : " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--quality") == 0 && i + 1 < argc) {
+			i++;
+			const BlockCompressionQuality qualities[] = { BlockCompressionQuality::Fast, BlockCompressionQuality::Normal, BlockCompressionQuality::High };
+			bool found = false;
+			for (BlockCompressionQuality candidate : qualities) {
+				if (strcmp(argv[i], BlockCompressor::getQualityName(candidate)) == 0) {
+					quality = candidate;
+					found = true;
+				}
+			}
+			if (found == false) {
+				std::cerr << "Unknown quality : " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--atlas") == 0 && i + 1 < argc) {
+			i++;
+			atlasPageSize = static_cast<uint32_t>(strtoul(argv[i], nullptr, 10));
+			if (atlasPageSize == 0 || atlasPageSize % 4 != 0) {
+				std::cerr << "Atlas page size must be multiple of 4 : " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	// BC4 (height, mask) and BC5 (normal) store data, not color
+	if (compress && (blockFormat == BlockFormat::BC4 || blockFormat == BlockFormat::BC5))
+		linear = true;
+
+	// input images (atlas lists them in a text file)
+	std::vector<std::string> imagePaths;
+	if (atlasPageSize > 0) {
+		std::ifstream listFile(inputPath);
+		if (listFile.is_open() == false) {
+			std::cerr << "Can't open image list " << inputPath << std::endl;
+			return 1;
+		}
+		std::string line;
+		while (std::getline(listFile, line)) {
+			if (line.empty() == false && line.back() == '\r')
+				line.pop_back();
+			if (line.empty() == false)
+				imagePaths.push_back(line);
+		}
+	}
+	else {
+		imagePaths.push_back(inputPath);
+	}
+
+	// decode into level 0 of mip chains (textures are flipped like runtime loading)
+	ImageDecoder decoder(atlasPageSize > 0 ? 0 : 1);
+	std::vector<uint32_t> jobIds;
+	for (const std::string& path : imagePaths)
+		jobIds.push_back(decoder.decodeFile(path, 4, true, DecodeTarget::MipChain));
+	decoder.waitAll();
+	std::vector<DecodedImage> images(imagePaths.size());
+	DecodedImage image;
+	while (decoder.tryPop(image)) {
+		const size_t index = std::find(jobIds.begin(), jobIds.end(), image.jobId) - jobIds.begin();
+		images[index] = std::move(image);
+	}
+
+	// sRGB images are filtered in linear space
+	MipGenerator mipGenerator;
+	for (DecodedImage& decodedImage : images) {
+		if (decodedImage.isValid() == false) {
+			std::cerr << "Failed to decode " << decodedImage.name << " : " << decodedImage.error << std::endl;
+			return 1;
+		}
+		if (compress && atlasPageSize == 0 && (decodedImage.width % 4 != 0 || decodedImage.height % 4 != 0)) {
+			std::cerr << "Block-compressed textures need width and height in multiples of 4 (" << decodedImage.width << "x" << decodedImage.height << ")" << std::endl;
+			return 1;
+		}
+
+		MipChain& chain = decodedImage.mipChain;
+		chain.format = linear ? MipFormat::RGBA8 : MipFormat::RGBA8_SRGB;
+		if (generateMips == false && atlasPageSize == 0) {
+			chain.levels.resize(1);
+			chain.data.resize(chain.levels[0].size);
+		}
+		mipGenerator.generateLevels(chain, filter);
+	}
+
+	// slices of cooked texture (atlas pages, or the image)
+	std::vector<const MipChain*> slices;
+	TextureAtlas atlas;
+	if (atlasPageSize > 0) {
+		TextureAtlasDesc atlasDesc;
+		atlasDesc.pageWidth = atlasDesc.pageHeight = atlasPageSize;
+		if (generateMips == false)
+			atlasDesc.mipCount = 1;
+		TextureAtlasBuilder atlasBuilder(atlasDesc);
+		for (const DecodedImage& decodedImage : images)
+			atlasBuilder.addTexture(&decodedImage.mipChain);
+		if (atlasBuilder.build(atlas) == false)
+			return 1;
+		for (const MipChain& page : atlas.pages)
+			slices.push_back(&page);
+	}
+	else {
+		slices.push_back(&images[0].mipChain);
+	}
+
+	CookedTextureDesc desc;
+	desc.format = linear ? CookedTextureFormat::kR8G8B8A8UNorm : CookedTextureFormat::kR8G8B8A8UNormSRGB;
+	desc.width = slices[0]->levels[0].width;
+	desc.height = slices[0]->levels[0].height;
+	desc.arraySize = static_cast<uint32_t>(slices.size());
+	desc.bytesPerBlock = 4;
+	desc.mipCount = slices[0]->getLevelCount();
+	if (compress) {
+		const uint32_t linearFormats[] = { CookedTextureFormat::kBC1UNorm, CookedTextureFormat::kBC3UNorm, CookedTextureFormat::kBC4UNorm,
+			CookedTextureFormat::kBC5UNorm, CookedTextureFormat::kBC7UNorm };
+		const uint32_t srgbFormats[] = { CookedTextureFormat::kBC1UNormSRGB, CookedTextureFormat::kBC3UNormSRGB, CookedTextureFormat::kBC4UNorm,
+			CookedTextureFormat::kBC5UNorm, CookedTextureFormat::kBC7UNormSRGB };
+		desc.format = (linear ? linearFormats : srgbFormats)[static_cast<int>(blockFormat)];
+		desc.bytesPerBlock = static_cast<uint32_t>(BlockCompressor::getBlockSize(blockFormat));
+		desc.blockSize = 4;
+	}
+
+	CookedTextureWriter writer(desc);
+	BlockCompressor compressor;
+	std::vector<uint8_t> blocks;
+	for (uint32_t slice = 0; slice < desc.arraySize; slice++) {
+		const MipChain& chain = *slices[slice];
+		for (uint32_t level = 0; level < desc.mipCount; level++) {
+			const MipLevel& mip = chain.levels[level];
+			const uint32_t subresource = level + slice * desc.mipCount;
+			if (compress == false) {
+				writer.setSubresource(subresource, chain.getLevelData(level), mip.rowPitch, mip.size);
+				continue;
+			}
+
+			const size_t blockRowPitch = BlockCompressor::getRowPitch(blockFormat, mip.width);
+			blocks.resize(blockRowPitch * BlockCompressor::getBlockCount(mip.height));
+			compressor.compress(chain.getLevelData(level), mip.width, mip.height, mip.rowPitch, blockFormat, quality, blocks.data(), blockRowPitch);
+			writer.setSubresource(subresource, blocks.data(), blockRowPitch, blocks.size());
+
+			// quality of top level
+			if (level == 0 && slice == 0) {
+				std::vector<uint8_t> decoded(mip.size);
+				BlockCompressor::decompress(blocks.data(), blockRowPitch, mip.width, mip.height, blockFormat, decoded.data(), mip.rowPitch);
+				std::cout << BlockCompressor::getFormatName(blockFormat) << " (" << BlockCompressor::getQualityName(quality) << ") PSNR : "
+					<< BlockCompressor::computePSNR(chain.getLevelData(level), mip.rowPitch, decoded.data(), mip.rowPitch, mip.width, mip.height, blockFormat) << " dB" << std::endl;
+			}
+		}
+	}
+
+	if (writer.save(outputPath) == false)
+		return 1;
+
+	// UV remap table of atlas : <image> <slice> <u scale> <v scale> <u offset> <v offset>
+	if (atlasPageSize > 0) {
+		const std::string tablePath = outputPath + ".atlas";
+		std::ofstream tableFile(tablePath);
+		if (tableFile.is_open() == false) {
+			std::cerr << "Can't write atlas table " << tablePath << std::endl;
+			return 1;
+		}
+		for (size_t i = 0; i < atlas.entries.size(); i++) {
+			const TextureAtlasEntry& entry = atlas.entries[i];
+			tableFile << imagePaths[i] << " " << entry.slice << " " << entry.uvScale[0] << " " << entry.uvScale[1] << " "
+				<< entry.uvOffset[0] << " " << entry.uvOffset[1] << "\n";
+		}
+		std::cout << "Packed " << atlas.entries.size() << " images into " << atlas.getPageCount() << " pages ("
+			<< atlas.getOccupancy() * 100.0f << "% occupancy) -> " << tablePath << std::endl;
+	}
+
+	const CookedTextureHeader& header = writer.getHeader();
+	std::cout << "Cooked " << inputPath << " -> " << outputPath << " (" << header.width << "x" << header.height << ", "
+		<< header.arraySize << " slices, " << header.mipCount << " mips, " << MipGenerator::getFilterName(filter) << " filter, "
+		<< header.dataSize << " bytes)" << std::endl;
+	return 0;
+}